@@ -1972,6 +1972,113 @@ static u32 merge_hevc_config(GF_ISOFile *dest, u32 tk_id, GF_ISOFile *orig, u32
 
 GF_Err cat_playlist(GF_ISOFile *dest, char *playlistName, u32 import_flags, Double force_fps, u32 frames_per_sample, char *tmp_dir, Bool force_cat, Bool align_timelines, Bool allow_add_in_command);
 
+/*max number of samples and bytes copied in one go when splicing a track*/
+#define CAT_SPLICE_MAX_SAMPLES	4096
+#define CAT_SPLICE_MAX_SIZE		0x1000000
+
+/*checks if the samples of the track can be spliced, i.e. their data copied as is from the source file*/
+static Bool cat_can_splice_track(GF_ISOFile *orig, u32 track)
+{
+	u32 i, di;
+	u64 offset;
+	GF_ISOSample *samp;
+
+	/*samples are rewritten when fetched (parameter sets insertion, layered or tiled video reconstruction)*/
+	if (gf_isom_get_nalu_extract_mode(orig, track) != GF_ISOM_NALU_EXTRACT_DEFAULT) return GF_FALSE;
+	if (gf_isom_get_reference_count(orig, track, GF_ISOM_REF_SCAL)>0) return GF_FALSE;
+	if (gf_isom_get_reference_count(orig, track, GF_ISOM_REF_SABT)>0) return GF_FALSE;
+	if (gf_isom_get_reference_count(orig, track, GF_ISOM_REF_TBAS)>0) return GF_FALSE;
+	if (gf_isom_get_reference_count(orig, track, GF_ISOM_REF_BASE)>0) return GF_FALSE;
+
+	for (i=0; i<gf_isom_get_sample_description_count(orig, track); i++) {
+		if (!gf_isom_is_self_contained(orig, track, i+1)) return GF_FALSE;
+	}
+	if (!gf_isom_get_sample_count(orig, track)) return GF_FALSE;
+
+	/*only the RAP status of NAL-based samples is refined in inspect mode*/
+	gf_isom_set_nalu_extract_mode(orig, track, GF_ISOM_NALU_EXTRACT_INSPECT);
+	samp = gf_isom_get_sample_ref(orig, track, 1, &di, &offset);
+	if (!samp) {
+		gf_isom_set_nalu_extract_mode(orig, track, GF_ISOM_NALU_EXTRACT_DEFAULT);
+		return GF_FALSE;
+	}
+	gf_isom_sample_del(&samp);
+	return GF_TRUE;
+}
+
+/*appends all samples of the track by copying the data of contiguous samples in one go, only sample tables are rebuilt*/
+static GF_Err cat_splice_track(GF_ISOFile *dest, u32 dst_tk, GF_ISOFile *orig, u32 track, FILE *src, Double ts_scale, u64 dts_offset, u64 *last_DTS, u32 *nb_done, u32 nb_samp, u64 *nb_bytes)
+{
+	u32 j, k, count, di, run_di, nb_run;
+	u64 offset, run_offset, run_size, dst_offset;
+	GF_ISOSample *samp, **run;
+	GF_Err e = GF_OK;
+
+	run = (GF_ISOSample **) gf_malloc(sizeof(GF_ISOSample *) * CAT_SPLICE_MAX_SAMPLES);
+	if (!run) return GF_OUT_OF_MEM;
+	run_di = nb_run = 0;
+	run_offset = run_size = 0;
+	di = 0;
+	offset = 0;
+
+	count = gf_isom_get_sample_count(orig, track);
+	for (j=0; j<=count; j++) {
+		samp = NULL;
+		if (j<count) {
+			samp = gf_isom_get_sample_ref(orig, track, j+1, &di, &offset);
+			if (!samp) {
+				e = gf_isom_last_error(orig);
+				if (!e) e = GF_IO_ERR;
+				break;
+			}
+			/*contiguous with the current run*/
+			if (nb_run && (di == run_di) && (run_offset + run_size == offset)
+			        && (nb_run < CAT_SPLICE_MAX_SAMPLES) && (run_size + samp->dataLength <= CAT_SPLICE_MAX_SIZE)) {
+				run[nb_run] = samp;
+				nb_run++;
+				run_size += samp->dataLength;
+				continue;
+			}
+		}
+		/*flush current run*/
+		if (nb_run) {
+			e = gf_isom_add_sample_data_from_file(dest, dst_tk, run_di, src, run_offset, run_size, &dst_offset);
+			for (k=0; k<nb_run; k++) {
+				if (!e) {
+					*last_DTS = run[k]->DTS;
+					run[k]->DTS = (u64) (ts_scale * run[k]->DTS + dts_offset);
+					run[k]->CTS_Offset = (u32) (run[k]->CTS_Offset * ts_scale);
+					e = gf_isom_add_sample_at_offset(dest, dst_tk, run_di, run[k], dst_offset);
+					dst_offset += run[k]->dataLength;
+				}
+				if (!e) e = gf_isom_copy_sample_info(dest, dst_tk, orig, track, j - nb_run + k + 1);
+				gf_isom_sample_del(&run[k]);
+
+				gf_set_progress("Appending", *nb_done, nb_samp);
+				(*nb_done)++;
+			}
+			*nb_bytes += run_size;
+			nb_run = 0;
+			if (e) {
+				if (samp) gf_isom_sample_del(&samp);
+				break;
+			}
+		}
+		if (samp) {
+			run[0] = samp;
+			nb_run = 1;
+			run_di = di;
+			run_offset = offset;
+			run_size = samp->dataLength;
+		}
+	}
+	for (k=0; k<nb_run; k++) {
+		gf_isom_sample_del(&run[k]);
+	}
+	gf_free(run);
+	return e;
+}
+
 GF_Err cat_isomedia_file(GF_ISOFile *dest, char *fileName, u32 import_flags, Double force_fps, u32 frames_per_sample, char *tmp_dir, Bool force_cat, Bool align_timelines, Bool allow_add_in_command, Bool is_pl)
 {
 	u32 i, j, count, nb_tracks, nb_samp, nb_done;
@@ -1980,11 +2087,13 @@ GF_Err cat_isomedia_file(GF_ISOFile *dest, char *fileName, u32 import_flags, Dou
 	char *opts, *multi_cat;
 	Double ts_scale;
 	Double dest_orig_dur;
-	u32 dst_tk, tk_id, mtype;
+	u32 dst_tk, tk_id, mtype, major_brand;
 	u64 insert_dts;
 	Bool is_isom;
 	GF_ISOSample *samp;
 	Double aligned_to_DTS = 0;
+	FILE *src = NULL;
+	u64 nb_bytes = 0, clock_start;
 
 	if (is_pl) return cat_playlist(dest, fileName, import_flags, force_fps, frames_per_sample, tmp_dir, force_cat, align_timelines, allow_add_in_command);
 
@@ -2011,6 +2120,8 @@ GF_Err cat_isomedia_file(GF_ISOFile *dest, char *fileName, u32 import_flags, Dou
 	} else {
 		/*we open the original file in edit mode since we may have to rewrite AVC samples*/
 		orig = gf_isom_open(fileName, GF_ISOM_OPEN_EDIT, tmp_dir);
+		/*source of data ranges for tracks whose samples are appended as is*/
+		if (orig && !multi_cat) src = gf_fopen(fileName, "rb");
 	}
 
 	while (multi_cat) {
@@ -2081,6 +2192,7 @@ GF_Err cat_isomedia_file(GF_ISOFile *dest, char *fileName, u32 import_flags, Dou
 
 	fprintf(stderr, "Appending file %s\n", fileName);
 	nb_done = 0;
+	clock_start = gf_sys_clock_high_res();
 	for (i=0; i<nb_tracks; i++) {
 		u64 last_DTS, dest_track_dur_before_cat;
 		u32 nb_edits = 0;
@@ -2088,6 +2200,7 @@ GF_Err cat_isomedia_file(GF_ISOFile *dest, char *fileName, u32 import_flags, Dou
 		Bool use_ts_dur = 1;
 		Bool merge_edits = 0;
 		Bool new_track = 0;
+		Bool config_merged = 0;
 		mtype = gf_isom_get_media_type(orig, i+1);
 		switch (mtype) {
 		case GF_ISOM_MEDIA_HINT:
@@ -2194,6 +2307,7 @@ GF_Err cat_isomedia_file(GF_ISOFile *dest, char *fileName, u32 import_flags, Dou
 			}
 
 			if (!dst_tk) {
+				config_merged = 1;
 				/*merge AVC config if possible*/
 				if ((stype == GF_ISOM_SUBTYPE_AVC_H264)
 				        || (stype == GF_ISOM_SUBTYPE_AVC2_H264)
@@ -2285,10 +2399,15 @@ GF_Err cat_isomedia_file(GF_ISOFile *dest, char *fileName, u32 import_flags, Dou
 			}
 		}
 
-		gf_isom_enable_raw_pack(orig, i+1, 2048);
-
 		last_DTS = 0;
-		count = gf_isom_get_sample_count(orig, i+1);
+		/*raw audio is appended by packs of samples, other tracks are spliced if their samples were not modified*/
+		if (!gf_isom_enable_raw_pack(orig, i+1, 2048) && src && !config_merged && cat_can_splice_track(orig, i+1)) {
+			e = cat_splice_track(dest, dst_tk, orig, i+1, src, ts_scale, new_track ? 0 : insert_dts, &last_DTS, &nb_done, nb_samp, &nb_bytes);
+			if (e) goto err_exit;
+			count = 0;
+		} else {
+			count = gf_isom_get_sample_count(orig, i+1);
+		}
 		for (j=0; j<count; j++) {
 			u32 di;
 			samp = gf_isom_get_sample(orig, i+1, j+1, &di);
@@ -2307,6 +2426,7 @@ GF_Err cat_isomedia_file(GF_ISOFile *dest, char *fileName, u32 import_flags, Dou
 			if (samp->nb_pack)
 				j+= samp->nb_pack-1;
 
+			nb_bytes += samp->dataLength;
 			gf_isom_sample_del(&samp);
 			if (e) goto err_exit;
 
@@ -2420,9 +2540,12 @@ GF_Err cat_isomedia_file(GF_ISOFile *dest, char *fileName, u32 import_flags, Dou
 
 	}
 	gf_set_progress("Appending", nb_samp, nb_samp);
+	clock_start = gf_sys_clock_high_res() - clock_start;
+	fprintf(stderr, "Appended "LLU" bytes in "LLU" ms (%.02f MB/s)\n", nb_bytes, clock_start/1000, clock_start ? ((Double) (s64) nb_bytes) / (s64) clock_start : 0);
 
 	/*check brands*/
-	gf_isom_get_brand_info(orig, NULL, NULL, &j);
+	j = 0;
+	gf_isom_get_brand_info(orig, &major_brand, NULL, &j);
 	for (i=0; i<j; i++) {
 		u32 brand;
 		gf_isom_get_alternate_brand(orig, i+1, &brand);
@@ -2454,6 +2577,7 @@ GF_Err cat_isomedia_file(GF_ISOFile *dest, char *fileName, u32 import_flags, Dou
 
 err_exit:
 	gf_isom_delete(orig);
+	if (src) gf_fclose(src);
 	return e;
 }
 
@@ -927,14 +927,12 @@ u32 grab_live_m2ts(const char *grab_m2ts, const char *grab_ifce, const char *out
 		/*process chunk*/
 		if (is_rtp) {
 #ifndef GPAC_DISABLE_STREAMING
-			char *pck;
+			const char *pck;
 			seq_num = ((data[2] << 8) & 0xFF00) | (data[3] & 0xFF);
 			gf_rtp_reorderer_add(ch, (void *) data, size, seq_num);
 
-			pck = (char *) gf_rtp_reorderer_get(ch, &size);
-			if (pck) {
+			while ((pck = gf_rtp_reorderer_get_packet(ch, &size, NULL)) != NULL) {
 				fwrite(pck+12, size-12, 1, output);
-				gf_free(pck);
 			}
 #else
 			fwrite(data+12, size-12, 1, output);
@@ -227,6 +227,8 @@ void PrintGeneralUsage()
 	        " -flat                stores file with all media data first, non-interleaved\n"
 	        "                       * Specifying -flat -inter 0 will move the media data at the end (no interleaving)\n"
 	        "                       * If -flat is used on a new file, no temporary file is used\n"
+	        " -moov-reserve size   reserves size bytes for the moov before media data when creating a new file with -inter 0\n"
+	        "                       * Note: the moov is written in this space if large enough, avoiding to rewrite the file\n"
 	        " -frag time_in_ms     fragments file (track fragments of time_in_ms)\n"
 	        "                       * Note: Always disables interleaving\n"
 	        " -out filename        specifies output file name\n"
@@ -2251,7 +2253,7 @@ Bool HintIt, needSave, FullInter, Frag, HintInter, dump_rtp, regular_iod, remove
 Bool print_sdp, open_edit, dump_cr, force_ocr, encode, do_log, dump_srt, dump_ttxt, do_saf, dump_m2ts, dump_cart, do_hash, verbose, force_cat, align_cat, pack_wgt, single_group, clean_groups, dash_live, no_fragments_defaults, single_traf_per_moof, tfdt_per_traf, dump_nal_crc, do_mpd_rip, get_nb_tracks;
 char *inName, *outName, *arg, *mediaSource, *tmpdir, *input_ctx, *output_ctx, *drm_file, *avi2raw, *cprt, *chap_file, *pes_dump, *itunes_tags, *pack_file, *raw_cat, *seg_name, *dash_ctx_file, *compress_top_boxes, *hdr_filename;
 u32 track_dump_type, dump_isom, dump_timestamps;
-u32 trackID, do_flat, print_info;
+u32 trackID, do_flat, print_info, moov_reserve;
 Bool comp_lzma=GF_FALSE;
 Double min_buffer = 1.5;
 u32 comp_top_box_version = 0;
@@ -2568,6 +2570,11 @@ u32 mp4box_parse_args_continue(int argc, char **argv, u32 *current_index)
 			open_edit = GF_TRUE;
 			do_flat = 1;
 		}
+		else if (!stricmp(arg, "-moov-reserve")) {
+			CHECK_NEXT_ARG
+			moov_reserve = atoi(argv[i + 1]);
+			i++;
+		}
 		else if (!stricmp(arg, "-keep-utc")) keep_utc = GF_TRUE;
 		else if (!stricmp(arg, "-new")) force_new = GF_TRUE;
 		else if (!stricmp(arg, "-timescale")) {
@@ -4061,6 +4068,7 @@ int mp4boxMain(int argc, char **argv)
 	program_number = 0;
 	info_track_id = 0;
 	do_flat = 0;
+	moov_reserve = 0;
 	inName = outName = mediaSource = input_ctx = output_ctx = drm_file = avi2raw = cprt = chap_file = pack_file = raw_cat = hdr_filename = NULL;
 
 #ifndef GPAC_DISABLE_SWF_IMPORT
@@ -4419,6 +4427,9 @@ int mp4boxMain(int argc, char **argv)
 			fprintf(stderr, "Cannot open destination file %s: %s\n", inName, gf_error_to_string(gf_isom_last_error(NULL)) );
 			return mp4box_cleanup(1);
 		}
+		if (moov_reserve && (open_mode == GF_ISOM_OPEN_WRITE)) {
+			gf_isom_reserve_moov_space(file, moov_reserve);
+		}
 
 		for (i=0; i<(u32) argc; i++) {
 			if (!strcmp(argv[i], "-add")) {
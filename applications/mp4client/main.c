@@ -2535,6 +2535,7 @@ void PrintAVInfo(Bool final)
 					fprintf(stderr, " (Error during bench: %d frames drop)", v_odi.nb_dropped);
 				}
 				fprintf(stderr, "\n");
+				if (v_odi.cb_max_count) fprintf(stderr, "Frame hand-off to compositor%s: %d us avg %d us max\n", v_odi.lock_free_cb ? " (lock-free)" : "", v_odi.avg_handoff_time, v_odi.max_handoff_time);
 			}
 		}
 		if (audio_odm) {
@@ -2942,7 +2943,8 @@ void ViewOD(GF_Terminal *term, u32 OD_ID, u32 number, const char *szURL)
 	else fprintf(stderr, "Not buffering - ");
 	fprintf(stderr, "Clock drift: %d ms\n", odi.clock_drift);
 	if (odi.db_unit_count) fprintf(stderr, "%d AU in DB\n", odi.db_unit_count);
-	if (odi.cb_max_count) fprintf(stderr, "Composition Buffer: %d CU (%d max)\n", odi.cb_unit_count, odi.cb_max_count);
+	if (odi.db_pool_hits + odi.db_pool_misses) fprintf(stderr, "DB pool hit rate %d %%\n", (u32) (100 * (u64) odi.db_pool_hits / (odi.db_pool_hits + odi.db_pool_misses)));
+	if (odi.cb_max_count) fprintf(stderr, "Composition Buffer: %d CU (%d max)%s - frame hand-off %d us avg %d us max\n", odi.cb_unit_count, odi.cb_max_count, odi.lock_free_cb ? " lock-free" : "", odi.avg_handoff_time, odi.max_handoff_time);
 	fprintf(stderr, "\n");
 
 	if (odi.owns_service) {
@@ -3118,6 +3120,12 @@ void ViewODs(GF_Terminal *term, Bool show_timing)
 	} else {
 		PrintODBuffer(term, root_odm, 0);
 	}
+	if (!show_timing) {
+		GF_DecoderPoolInfo pool;
+		if ((gf_term_get_decoder_pool_info(term, &pool)==GF_OK) && pool.nb_threads) {
+			fprintf(stderr, "Decoder pool: %d threads - %d decoders - usage %d %% - %d tasks (%d stolen)\n", pool.nb_threads, pool.nb_decoders, pool.usage, (u32) pool.nb_tasks, (u32) pool.nb_steals);
+		}
+	}
 	fprintf(stderr, "\n");
 }
 
@@ -0,0 +1,171 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - configuration file benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/config_file.h>
+
+/*simulates the context of a live DASH session: each pass appends one segment per representation, updates the
+representation state, and purges the segments out of the time shift window. The time of the passes is reported
+as the context grows; the context is then saved, reloaded and checked against the in-memory one*/
+
+static void usage()
+{
+	fprintf(stderr, "usage: cfgbench [options]\n"
+	        "\t-reps N:   number of representations (default 8)\n"
+	        "\t-segs N:   number of segments per representation (default 10000)\n"
+	        "\t-window N: number of segments kept in the context, 0 keeps all (default 0)\n"
+	        "\t-out file: context file to save and reload (default cfgbench.txt, deleted at the end)\n"
+	       );
+}
+
+static void do_pass(GF_Config *ctx, u32 nb_reps, u32 seg, u32 window)
+{
+	u32 r;
+	char szSec[100], szURLs[100], szKey[100], szVal[200];
+	char szIdx[20], szDur[40];
+	const char *names[2] = {"NextSegmentIndex", "CumulatedDuration"};
+	const char *vals[2];
+
+	for (r=0; r<nb_reps; r++) {
+		sprintf(szSec, "Representation_%d", r);
+		sprintf(szURLs, "URLs_%d", r);
+
+		sprintf(szKey, "rep%d_seg%d.m4s", r, seg);
+		sprintf(szVal, LLU"-1000-1000@%d", ((u64) seg) * 1000, r);
+		gf_cfg_set_key(ctx, "SegmentsStartTimes", szKey, szVal);
+
+		sprintf(szKey, "URL_%d", seg);
+		sprintf(szVal, "<SegmentURL media=\"rep%d_seg%d.m4s\"/>", r, seg);
+		gf_cfg_set_key(ctx, szURLs, szKey, szVal);
+
+		/*restore the representation state as the segmenter does*/
+		gf_cfg_get_key(ctx, szSec, "NextSegmentIndex");
+		gf_cfg_get_key(ctx, szSec, "CumulatedDuration");
+		gf_cfg_get_key(ctx, "DASH", "GenerationNTP");
+
+		sprintf(szIdx, "%d", seg+1);
+		sprintf(szDur, LLU, ((u64) seg+1) * 1000);
+		vals[0] = szIdx;
+		vals[1] = szDur;
+		gf_cfg_set_keys(ctx, szSec, 2, names, vals);
+
+		if (window && (seg>=window)) {
+			sprintf(szKey, "rep%d_seg%d.m4s", r, seg-window);
+			gf_cfg_set_key(ctx, "SegmentsStartTimes", szKey, NULL);
+			sprintf(szKey, "URL_%d", seg-window);
+			gf_cfg_set_key(ctx, szURLs, szKey, NULL);
+		}
+	}
+	sprintf(szVal, "%d", seg);
+	gf_cfg_set_key(ctx, "DASH", "GenerationNTP", szVal);
+}
+
+static Bool check_config(GF_Config *ref, GF_Config *test)
+{
+	u32 i, j, nb_sec = gf_cfg_get_section_count(ref);
+	if (nb_sec != gf_cfg_get_section_count(test)) return GF_FALSE;
+	for (i=0; i<nb_sec; i++) {
+		const char *sec = gf_cfg_get_section_name(ref, i);
+		u32 nb_keys = gf_cfg_get_key_count(ref, sec);
+		if (strcmp(sec, gf_cfg_get_section_name(test, i))) return GF_FALSE;
+		if (nb_keys != gf_cfg_get_key_count(test, sec)) return GF_FALSE;
+		for (j=0; j<nb_keys; j++) {
+			const char *name = gf_cfg_get_key_name(ref, sec, j);
+			const char *val = gf_cfg_get_key_value(ref, sec, j);
+			if (strcmp(name, gf_cfg_get_key_name(test, sec, j))) return GF_FALSE;
+			if (strcmp(val, gf_cfg_get_key(test, sec, name))) return GF_FALSE;
+			if (strcmp(val, gf_cfg_get_key(ref, sec, name))) return GF_FALSE;
+		}
+	}
+	return GF_TRUE;
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, nb_reps, nb_segs, window, report;
+	u64 start, last;
+	const char *out;
+	GF_Config *ctx, *reload;
+	Bool res;
+
+	nb_reps = 8;
+	nb_segs = 10000;
+	window = 0;
+	out = "cfgbench.txt";
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (i+1 == (u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(arg, "-reps")) nb_reps = atoi(argv[++i]);
+		else if (!strcmp(arg, "-segs")) nb_segs = atoi(argv[++i]);
+		else if (!strcmp(arg, "-window")) window = atoi(argv[++i]);
+		else if (!strcmp(arg, "-out")) out = argv[++i];
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (!nb_reps || !nb_segs) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+
+	gf_delete_file(out);
+	ctx = gf_cfg_force_new(NULL, out);
+	gf_cfg_set_key(ctx, "DASH", "SessionType", "dynamic");
+
+	report = nb_segs/10;
+	if (!report) report = 1;
+	start = last = gf_sys_clock_high_res();
+	for (i=0; i<nb_segs; i++) {
+		do_pass(ctx, nb_reps, i, window);
+		if ((i+1) % report == 0) {
+			u64 now = gf_sys_clock_high_res();
+			fprintf(stderr, "%d segments - %d keys in SegmentsStartTimes - %.2f us per pass\n", i+1, gf_cfg_get_key_count(ctx, "SegmentsStartTimes"), ((Double) (s64) (now - last)) / report);
+			last = now;
+		}
+	}
+	fprintf(stderr, "Total "LLU" ms\n", (gf_sys_clock_high_res() - start) / 1000);
+
+	start = gf_sys_clock_high_res();
+	gf_cfg_save(ctx);
+	reload = gf_cfg_new(NULL, out);
+	fprintf(stderr, "Save and reload "LLU" ms\n", (gf_sys_clock_high_res() - start) / 1000);
+
+	res = reload ? check_config(ctx, reload) : GF_FALSE;
+	fprintf(stderr, "Reloaded context %s\n", res ? "OK" : "differs");
+
+	if (reload) {
+		gf_cfg_discard_changes(reload);
+		gf_cfg_del(reload);
+	}
+	gf_cfg_discard_changes(ctx);
+	gf_cfg_remove(ctx);
+	gf_sys_close();
+	return res ? 0 : 1;
+}
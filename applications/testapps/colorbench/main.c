@@ -0,0 +1,326 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - software stretch benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/color.h>
+#include <gpac/constants.h>
+
+/*checks the YUV to RGB conversions of the software stretch against the reference formula, then stretches a frame
+from every supported source pixel format to every supported destination pixel format, on a single thread and on
+several threads, reporting the time of each conversion and checking both outputs are identical*/
+
+typedef struct
+{
+	u32 pf;
+	const char *name;
+	/*bytes per pixel of the first plane*/
+	u32 Bpp;
+	/*total size of the frame in pixels of the first plane, x2*/
+	u32 size_x2;
+	Bool is_10bits;
+} FormatDesc;
+
+static const FormatDesc src_formats[] =
+{
+	{GF_PIXEL_GREYSCALE, "Grey", 1, 2, GF_FALSE},
+	{GF_PIXEL_ALPHAGREY, "AlphaGrey", 2, 2, GF_FALSE},
+	{GF_PIXEL_RGB_555, "RGB555", 2, 2, GF_FALSE},
+	{GF_PIXEL_RGB_565, "RGB565", 2, 2, GF_FALSE},
+	{GF_PIXEL_RGB_24, "RGB24", 3, 2, GF_FALSE},
+	{GF_PIXEL_BGR_24, "BGR24", 3, 2, GF_FALSE},
+	{GF_PIXEL_ARGB, "ARGB", 4, 2, GF_FALSE},
+	{GF_PIXEL_RGBA, "RGBA", 4, 2, GF_FALSE},
+	{GF_PIXEL_RGB_32, "RGB32", 4, 2, GF_FALSE},
+	{GF_PIXEL_BGR_32, "BGR32", 4, 2, GF_FALSE},
+	{GF_PIXEL_RGBD, "RGBD", 4, 2, GF_FALSE},
+	{GF_PIXEL_RGBDS, "RGBDS", 4, 2, GF_FALSE},
+	{GF_PIXEL_YV12, "YV12", 1, 3, GF_FALSE},
+	{GF_PIXEL_YUV422, "YUV422", 1, 4, GF_FALSE},
+	{GF_PIXEL_YUV444, "YUV444", 1, 6, GF_FALSE},
+	{GF_PIXEL_YV12_10, "YV12_10", 2, 3, GF_TRUE},
+	{GF_PIXEL_YUV422_10, "YUV422_10", 2, 4, GF_TRUE},
+	{GF_PIXEL_YUV444_10, "YUV444_10", 2, 6, GF_TRUE},
+	{GF_PIXEL_NV12, "NV12", 1, 3, GF_FALSE},
+	{GF_PIXEL_YUVA, "YUVA", 1, 5, GF_FALSE},
+	{GF_PIXEL_YUY2, "YUY2", 2, 2, GF_FALSE},
+};
+
+static const FormatDesc dst_formats[] =
+{
+	{GF_PIXEL_RGB_555, "RGB555", 2, 2, GF_FALSE},
+	{GF_PIXEL_RGB_565, "RGB565", 2, 2, GF_FALSE},
+	{GF_PIXEL_RGB_24, "RGB24", 3, 2, GF_FALSE},
+	{GF_PIXEL_BGR_24, "BGR24", 3, 2, GF_FALSE},
+	{GF_PIXEL_RGB_32, "RGB32", 4, 2, GF_FALSE},
+	{GF_PIXEL_ARGB, "ARGB", 4, 2, GF_FALSE},
+	{GF_PIXEL_RGBD, "RGBD", 4, 2, GF_FALSE},
+	{GF_PIXEL_RGBA, "RGBA", 4, 2, GF_FALSE},
+	{GF_PIXEL_BGR_32, "BGR32", 4, 2, GF_FALSE},
+};
+
+#define NB_SRC_FORMATS	(sizeof(src_formats)/sizeof(FormatDesc))
+#define NB_DST_FORMATS	(sizeof(dst_formats)/sizeof(FormatDesc))
+
+static u32 seed = 0x12345678;
+static u32 rnd()
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7FFF;
+}
+
+static u8 *setup_source(GF_VideoSurface *vs, const FormatDesc *fmt, u32 width, u32 height)
+{
+	u32 i, size = width * height * fmt->Bpp * fmt->size_x2 / 2;
+	u8 *buf = (u8*)gf_malloc(size);
+	for (i=0; i<size; i++) buf[i] = (u8) rnd();
+	/*10 bits samples*/
+	if (fmt->is_10bits) {
+		for (i=1; i<size; i+=2) buf[i] &= 0x3;
+	}
+	memset(vs, 0, sizeof(GF_VideoSurface));
+	vs->width = width;
+	vs->height = height;
+	vs->pitch_x = fmt->Bpp;
+	vs->pitch_y = width * fmt->Bpp;
+	vs->pixel_format = fmt->pf;
+	vs->video_buffer = (char *) buf;
+	return buf;
+}
+
+static u8 clip(s32 v)
+{
+	return (v<0) ? 0 : ((v>255) ? 255 : (u8) v);
+}
+
+#define COEF(x)	((s32) ((x) * 8192 + 0.5))
+
+static u32 yuv_to_rgba(s32 y, s32 u, s32 v)
+{
+	s32 r, g, b;
+	y -= 16;
+	u -= 128;
+	v -= 128;
+	r = (COEF(1.164)*y + COEF(1.596)*v) >> 13;
+	g = (COEF(1.164)*y - COEF(0.391)*u - COEF(0.813)*v) >> 13;
+	b = (COEF(1.164)*y + COEF(2.018)*u) >> 13;
+	return clip(r) | (clip(g)<<8) | (clip(b)<<16) | (0xFF<<24);
+}
+
+/*checks the conversion of a YUV source to RGBA against the reference formula*/
+static Bool check_yuv(const FormatDesc *fmt, u32 width, u32 height)
+{
+	u32 i, j;
+	GF_VideoSurface src, dst;
+	Bool res = GF_TRUE;
+	u8 *src_buf = setup_source(&src, fmt, width, height);
+	u32 *dst_buf = (u32*)gf_malloc(sizeof(u32) * width * height);
+
+	memset(&dst, 0, sizeof(GF_VideoSurface));
+	dst.width = width;
+	dst.height = height;
+	dst.pitch_x = 4;
+	dst.pitch_y = 4 * width;
+	dst.pixel_format = GF_PIXEL_RGBA;
+	dst.video_buffer = (char *) dst_buf;
+	gf_stretch_bits(&dst, &src, NULL, NULL, 0xFF, GF_FALSE, NULL, NULL);
+
+	for (j=0; res && (j<height); j++) {
+		for (i=0; i<width; i++) {
+			s32 y, u, v;
+			u32 col;
+			u8 *pY = src_buf;
+			u16 *pY16 = (u16 *)src_buf;
+			switch (fmt->pf) {
+			case GF_PIXEL_YV12:
+				y = pY[j*width + i];
+				u = pY[width*height + (j/2)*(width/2) + i/2];
+				v = pY[5*width*height/4 + (j/2)*(width/2) + i/2];
+				break;
+			case GF_PIXEL_YUV422:
+				y = pY[j*width + i];
+				u = pY[width*height + j*(width/2) + i/2];
+				v = pY[3*width*height/2 + j*(width/2) + i/2];
+				break;
+			case GF_PIXEL_YUV444:
+				y = pY[j*width + i];
+				u = pY[width*height + j*width + i];
+				v = pY[2*width*height + j*width + i];
+				break;
+			case GF_PIXEL_YV12_10:
+				y = pY16[j*width + i] >> 2;
+				u = pY16[width*height + (j/2)*(width/2) + i/2] >> 2;
+				v = pY16[5*width*height/4 + (j/2)*(width/2) + i/2] >> 2;
+				break;
+			case GF_PIXEL_YUV422_10:
+				y = pY16[j*width + i] >> 2;
+				u = pY16[width*height + j*(width/2) + i/2] >> 2;
+				v = pY16[3*width*height/2 + j*(width/2) + i/2] >> 2;
+				break;
+			case GF_PIXEL_YUV444_10:
+				y = pY16[j*width + i] >> 2;
+				u = pY16[width*height + j*width + i] >> 2;
+				v = pY16[2*width*height + j*width + i] >> 2;
+				break;
+			case GF_PIXEL_YUY2:
+				y = pY[2*(j*width + i)];
+				u = pY[2*(j*width + i - i%2) + 1];
+				v = pY[2*(j*width + i - i%2) + 3];
+				break;
+			default:
+				res = GF_FALSE;
+				continue;
+			}
+			col = yuv_to_rgba(y, u, v);
+			if (dst_buf[j*width + i] != col) {
+				fprintf(stderr, "%s: mismatch at pixel %d x %d - got %08X expected %08X\n", fmt->name, i, j, dst_buf[j*width + i], col);
+				res = GF_FALSE;
+				break;
+			}
+		}
+	}
+	fprintf(stderr, "%s to RGBA: %s\n", fmt->name, res ? "OK" : "FAILED");
+	gf_free(src_buf);
+	gf_free(dst_buf);
+	return res;
+}
+
+/*returns the stretch time in microseconds*/
+static u64 do_stretch(GF_StretchPool *pool, GF_VideoSurface *dst, GF_VideoSurface *src, u32 nb_frames)
+{
+	u32 i;
+	u64 start = gf_sys_clock_high_res();
+	for (i=0; i<nb_frames; i++) {
+		gf_stretch_bits_ex(pool, dst, src, NULL, NULL, 0xFF, GF_FALSE, NULL, NULL);
+	}
+	return (gf_sys_clock_high_res() - start) / nb_frames;
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: colorbench [options]\n"
+	        "\t-w W:       source width (default 1920)\n"
+	        "\t-h H:       source height (default 1080)\n"
+	        "\t-scale S:   destination size in percent of the source size (default 100)\n"
+	        "\t-frames N:  number of frames stretched for each format pair (default 5)\n"
+	        "\t-threads N: number of threads for the threaded run, 0 for the number of CPU cores (default 0)\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, j, width, height, scale, nb_frames, nb_threads, dst_w, dst_h, nb_failed;
+	u8 *ref, *test;
+	GF_StretchPool *pool;
+
+	width = 1920;
+	height = 1080;
+	scale = 100;
+	nb_frames = 5;
+	nb_threads = 0;
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (i+1 == (u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(arg, "-w")) width = atoi(argv[++i]);
+		else if (!strcmp(arg, "-h")) height = atoi(argv[++i]);
+		else if (!strcmp(arg, "-scale")) scale = atoi(argv[++i]);
+		else if (!strcmp(arg, "-frames")) nb_frames = atoi(argv[++i]);
+		else if (!strcmp(arg, "-threads")) nb_threads = atoi(argv[++i]);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	dst_w = width * scale / 100;
+	dst_h = height * scale / 100;
+	/*YUV sources need even sizes*/
+	if ((width<2) || (height<2) || (width%2) || (height%2) || !dst_w || !dst_h || !nb_frames) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+
+	/*odd number of 16 pixels blocks and a remainder, to check both the SIMD and the C paths*/
+	nb_failed = 0;
+	for (i=0; i<NB_SRC_FORMATS; i++) {
+		switch (src_formats[i].pf) {
+		case GF_PIXEL_YV12:
+		case GF_PIXEL_YUV422:
+		case GF_PIXEL_YUV444:
+		case GF_PIXEL_YV12_10:
+		case GF_PIXEL_YUV422_10:
+		case GF_PIXEL_YUV444_10:
+		case GF_PIXEL_YUY2:
+			if (!check_yuv(&src_formats[i], 16*17 + 6, 24)) nb_failed++;
+			break;
+		}
+	}
+
+	pool = gf_stretch_pool_new(nb_threads);
+	ref = (u8*)gf_malloc(4 * dst_w * dst_h);
+	test = (u8*)gf_malloc(4 * dst_w * dst_h);
+	fprintf(stderr, "Stretching %dx%d to %dx%d - time per frame in ms, single thread / threaded\n", width, height, dst_w, dst_h);
+	for (i=0; i<NB_SRC_FORMATS; i++) {
+		GF_VideoSurface src;
+		u8 *src_buf = setup_source(&src, &src_formats[i], width, height);
+		fprintf(stderr, "%-10s", src_formats[i].name);
+		for (j=0; j<NB_DST_FORMATS; j++) {
+			u64 ref_time, test_time;
+			GF_VideoSurface dst;
+			memset(&dst, 0, sizeof(GF_VideoSurface));
+			dst.width = dst_w;
+			dst.height = dst_h;
+			dst.pitch_x = dst_formats[j].Bpp;
+			dst.pitch_y = dst_w * dst_formats[j].Bpp;
+			dst.pixel_format = dst_formats[j].pf;
+
+			/*destination pixels not written for transparent source pixels must match*/
+			memset(ref, 0, 4 * dst_w * dst_h);
+			memset(test, 0, 4 * dst_w * dst_h);
+
+			dst.video_buffer = (char *) ref;
+			ref_time = do_stretch(NULL, &dst, &src, nb_frames);
+
+			dst.video_buffer = (char *) test;
+			test_time = do_stretch(pool, &dst, &src, nb_frames);
+
+			fprintf(stderr, " %s %.1f/%.1f", dst_formats[j].name, ((Double) (s64) ref_time) / 1000, ((Double) (s64) test_time) / 1000);
+			if (memcmp(ref, test, dst.pitch_y * dst_h)) {
+				fprintf(stderr, " FAILED");
+				nb_failed++;
+			}
+		}
+		fprintf(stderr, "\n");
+		gf_free(src_buf);
+	}
+	gf_stretch_pool_del(pool);
+
+	gf_free(ref);
+	gf_free(test);
+	gf_sys_close();
+	return nb_failed ? 1 : 0;
+}
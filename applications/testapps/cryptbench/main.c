@@ -0,0 +1,415 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - AES encryption benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/crypt.h>
+
+/*checks the AES-NI backend against the NIST SP800-38A vectors and against the software backend, then encrypts synthetic
+samples with the cenc, cbc1, cens and cbcs schemes of Common Encryption using both backends, and with the multiple
+ranges API for the full sample schemes, reporting the throughput of each*/
+
+static u32 seed = 0x12345678;
+static u32 rnd()
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7FFF;
+}
+
+static void fill_random(u8 *data, u32 size)
+{
+	u32 i;
+	for (i=0; i<size; i++) data[i] = (u8) rnd();
+}
+
+static void hex_to_bin(const char *hex, u8 *data)
+{
+	u32 i, len = (u32) strlen(hex) / 2;
+	for (i=0; i<len; i++) {
+		u32 v;
+		sscanf(hex + 2*i, "%02x", &v);
+		data[i] = (u8) v;
+	}
+}
+
+static const char *nist_key = "2b7e151628aed2a6abf7158809cf4f3c";
+static const char *nist_plain = "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e5130c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+static const char *nist_cbc_iv = "000102030405060708090a0b0c0d0e0f";
+static const char *nist_cbc = "7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b273bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7";
+static const char *nist_ctr_iv = "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+static const char *nist_ctr = "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee";
+
+static GF_Crypt *open_crypt(GF_CRYPTO_MODE mode, GF_CRYPTO_BACKEND backend, u8 *key, u8 *IV)
+{
+	GF_Crypt *mc = gf_crypt_open_ex(GF_AES_128, mode, backend);
+	if (!mc) return NULL;
+	if (gf_crypt_init(mc, key, IV) != GF_OK) return NULL;
+	return mc;
+}
+
+static Bool check_nist(GF_CRYPTO_MODE mode, GF_CRYPTO_BACKEND backend)
+{
+	u8 key[16], IV[16], data[64], res[64];
+	Bool ok;
+	GF_Crypt *mc;
+	hex_to_bin(nist_key, key);
+	hex_to_bin((mode==GF_CBC) ? nist_cbc_iv : nist_ctr_iv, IV);
+	hex_to_bin(nist_plain, data);
+	hex_to_bin((mode==GF_CBC) ? nist_cbc : nist_ctr, res);
+
+	mc = open_crypt(mode, backend, key, IV);
+	if (!mc) return GF_FALSE;
+	gf_crypt_encrypt(mc, data, 64);
+	ok = memcmp(data, res, 64) ? GF_FALSE : GF_TRUE;
+	gf_crypt_close(mc);
+
+	/*decrypt back*/
+	mc = open_crypt(mode, backend, key, IV);
+	gf_crypt_decrypt(mc, data, 64);
+	hex_to_bin(nist_plain, res);
+	if (memcmp(data, res, 64)) ok = GF_FALSE;
+	gf_crypt_close(mc);
+	return ok;
+}
+
+/*encrypts the same random data in chunks of random sizes (multiple of 16 bytes for CBC) with both backends*/
+static Bool check_vs_soft(GF_CRYPTO_MODE mode, Bool counter_wrap)
+{
+	u8 key[16], IV[16], *ref, *test;
+	u32 pos, size = 100000;
+	Bool ok;
+	GF_Crypt *mc_ref, *mc_test;
+
+	fill_random(key, 16);
+	fill_random(IV, 16);
+	/*counter close to the wrap of its low 64 bits*/
+	if (counter_wrap) memset(IV+8, 0xFF, 7);
+	ref = (u8 *)gf_malloc(size);
+	test = (u8 *)gf_malloc(size);
+	fill_random(ref, size);
+	memcpy(test, ref, size);
+
+	mc_ref = open_crypt(mode, GF_CRYPTO_BACKEND_SOFT, key, IV);
+	mc_test = open_crypt(mode, GF_CRYPTO_BACKEND_AESNI, key, IV);
+	pos = 0;
+	while (pos < size) {
+		u32 len = 1 + rnd() % 600;
+		if (pos + len > size) len = size - pos;
+		if (mode==GF_CBC) len -= len % 16;
+		if (!len) break;
+		gf_crypt_encrypt(mc_ref, ref + pos, len);
+		gf_crypt_encrypt(mc_test, test + pos, len);
+		pos += len;
+	}
+	ok = memcmp(ref, test, size) ? GF_FALSE : GF_TRUE;
+	gf_crypt_close(mc_ref);
+	gf_crypt_close(mc_test);
+
+	/*decrypt the AES-NI output with the software backend*/
+	mc_ref = open_crypt(mode, GF_CRYPTO_BACKEND_SOFT, key, IV);
+	mc_test = open_crypt(mode, GF_CRYPTO_BACKEND_AESNI, key, IV);
+	gf_crypt_decrypt(mc_ref, ref, pos);
+	gf_crypt_decrypt(mc_test, test, pos);
+	if (memcmp(ref, test, pos)) ok = GF_FALSE;
+	gf_crypt_close(mc_ref);
+	gf_crypt_close(mc_test);
+
+	gf_free(ref);
+	gf_free(test);
+	return ok;
+}
+
+/*CTR state saved in the middle of a block and restored in another context*/
+static Bool check_ctr_resume()
+{
+	u8 key[16], IV[16], state[17], ref[100], test[100];
+	u32 state_size = 17;
+	GF_Crypt *mc;
+	fill_random(key, 16);
+	fill_random(IV, 16);
+	fill_random(ref, 100);
+	memcpy(test, ref, 100);
+
+	mc = open_crypt(GF_CTR, GF_CRYPTO_BACKEND_SOFT, key, IV);
+	gf_crypt_encrypt(mc, ref, 100);
+	gf_crypt_close(mc);
+
+	mc = open_crypt(GF_CTR, GF_CRYPTO_BACKEND_AESNI, key, IV);
+	gf_crypt_encrypt(mc, test, 37);
+	gf_crypt_get_IV(mc, state, &state_size);
+	gf_crypt_close(mc);
+	mc = open_crypt(GF_CTR, GF_CRYPTO_BACKEND_AESNI, key, IV);
+	gf_crypt_set_IV(mc, state, state_size);
+	gf_crypt_encrypt(mc, test+37, 63);
+	gf_crypt_close(mc);
+	return memcmp(ref, test, 100) ? GF_FALSE : GF_TRUE;
+}
+
+/*multiple ranges call against one call per range on the software backend*/
+static Bool check_ranges(GF_CRYPTO_MODE mode, GF_CRYPTO_BACKEND backend)
+{
+	u8 key[16], IV[16], IV_state[17], a[64], b[64], *ref, *test, *orig;
+	u32 i, pos, size=0, nb_ranges = 37;
+	GF_CryptRange ranges[37];
+	Bool ok = GF_TRUE;
+	GF_Crypt *mc_ref, *mc_test;
+
+	fill_random(key, 16);
+	fill_random(IV, 16);
+	/*range sizes up to about 5000 bytes, not multiple of 16 bytes, with an empty range and a range smaller than a block*/
+	for (i=0; i<nb_ranges; i++) {
+		ranges[i].size = (i==3) ? 0 : ((i==4) ? 15 : (rnd() % 5000));
+		fill_random(ranges[i].IV, 16);
+		size += ranges[i].size;
+	}
+	ref = (u8 *)gf_malloc(size);
+	test = (u8 *)gf_malloc(size);
+	orig = (u8 *)gf_malloc(size);
+	fill_random(orig, size);
+	memcpy(ref, orig, size);
+	memcpy(test, orig, size);
+
+	mc_ref = open_crypt(mode, GF_CRYPTO_BACKEND_SOFT, key, IV);
+	pos = 0;
+	for (i=0; i<nb_ranges; i++) {
+		u32 len = ranges[i].size;
+		if (mode==GF_CTR) {
+			IV_state[0] = 0;
+			memcpy(IV_state+1, ranges[i].IV, 16);
+			gf_crypt_set_IV(mc_ref, IV_state, 17);
+		} else {
+			len -= len % 16;
+			gf_crypt_set_IV(mc_ref, ranges[i].IV, 16);
+		}
+		if (len) gf_crypt_encrypt(mc_ref, ref + pos, len);
+		ranges[i].data = test + pos;
+		pos += ranges[i].size;
+	}
+	gf_crypt_close(mc_ref);
+
+	mc_test = open_crypt(mode, backend, key, IV);
+	gf_crypt_encrypt_ranges(mc_test, ranges, nb_ranges);
+	if (memcmp(ref, test, size)) ok = GF_FALSE;
+
+	/*the context state must be unchanged*/
+	memcpy(a, orig, 64);
+	memcpy(b, orig, 64);
+	gf_crypt_encrypt(mc_test, a, 64);
+	mc_ref = open_crypt(mode, GF_CRYPTO_BACKEND_SOFT, key, IV);
+	gf_crypt_encrypt(mc_ref, b, 64);
+	if (memcmp(a, b, 64)) ok = GF_FALSE;
+	gf_crypt_close(mc_ref);
+
+	gf_crypt_decrypt_ranges(mc_test, ranges, nb_ranges);
+	if (memcmp(test, orig, size)) ok = GF_FALSE;
+	gf_crypt_close(mc_test);
+
+	gf_free(ref);
+	gf_free(test);
+	gf_free(orig);
+	return ok;
+}
+
+enum
+{
+	SCHEME_CENC = 0,
+	SCHEME_CBC1,
+	SCHEME_CENS,
+	SCHEME_CBCS,
+};
+static const char *scheme_names[] = {"cenc", "cbc1", "cens", "cbcs"};
+
+/*clear bytes at the start of each sample, as for a NAL header and slice header*/
+#define CLEAR_HEADER	32
+/*pattern of cens and cbcs: 1 encrypted block every 10 blocks*/
+#define CRYPT_BLOCKS	1
+#define SKIP_BLOCKS		9
+#define RANGES_BATCH	32
+
+/*encrypts all samples the way the CENC encryptor does, one call per encrypted block or range, and returns the time in us*/
+static u64 run_scheme(u32 scheme, GF_CRYPTO_BACKEND backend, Bool use_ranges, u8 *data, u32 nb_samples, u32 sample_size)
+{
+	u8 key[16], IV[17];
+	u32 i, batch = 0;
+	u64 start;
+	GF_CryptRange ranges[RANGES_BATCH];
+	GF_CRYPTO_MODE mode = ((scheme==SCHEME_CENC) || (scheme==SCHEME_CENS)) ? GF_CTR : GF_CBC;
+	GF_Crypt *mc;
+
+	memset(key, 0x2B, 16);
+	memset(IV, 0, 17);
+	mc = open_crypt(mode, backend, key, IV+1);
+	if (!mc) return 0;
+
+	start = gf_sys_clock_high_res();
+	for (i=0; i<nb_samples; i++) {
+		u8 *buf = data + i*sample_size + CLEAR_HEADER;
+		u32 res = sample_size - CLEAR_HEADER;
+		/*per sample IV*/
+		IV[0] = 0;
+		IV[7] = (u8) (i>>8);
+		IV[8] = (u8) i;
+
+		if (use_ranges) {
+			ranges[batch].data = buf;
+			ranges[batch].size = res;
+			memcpy(ranges[batch].IV, IV+1, 16);
+			batch++;
+			if ((batch==RANGES_BATCH) || (i+1==nb_samples)) {
+				gf_crypt_encrypt_ranges(mc, ranges, batch);
+				batch = 0;
+			}
+			continue;
+		}
+
+		switch (scheme) {
+		case SCHEME_CENC:
+			gf_crypt_set_IV(mc, IV, 17);
+			gf_crypt_encrypt(mc, buf, res);
+			break;
+		case SCHEME_CBC1:
+			gf_crypt_set_IV(mc, IV+1, 16);
+			gf_crypt_encrypt(mc, buf, res - res%16);
+			break;
+		case SCHEME_CENS:
+		case SCHEME_CBCS:
+			if (scheme==SCHEME_CENS) gf_crypt_set_IV(mc, IV, 17);
+			/*constant IV, reset at each subsample*/
+			else gf_crypt_set_IV(mc, IV+1, 16);
+			while (res >= 16*CRYPT_BLOCKS) {
+				gf_crypt_encrypt(mc, buf, 16*CRYPT_BLOCKS);
+				if (res <= 16*(CRYPT_BLOCKS+SKIP_BLOCKS)) break;
+				buf += 16*(CRYPT_BLOCKS+SKIP_BLOCKS);
+				res -= 16*(CRYPT_BLOCKS+SKIP_BLOCKS);
+			}
+			break;
+		}
+	}
+	start = gf_sys_clock_high_res() - start;
+	gf_crypt_close(mc);
+	return start;
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: cryptbench [options]\n"
+	        "\t-size N:   sample size in bytes (default 20000)\n"
+	        "\t-n N:      number of samples (default 2000)\n"
+	        "\t-runs N:   number of runs of each test, the best one is reported (default 5)\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, sample_size, nb_samples, nb_runs, nb_failed = 0;
+	u8 *data, *ref, *result;
+	Bool has_aesni;
+	GF_Crypt *mc;
+
+	sample_size = 20000;
+	nb_samples = 2000;
+	nb_runs = 5;
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (i+1 == (u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(arg, "-size")) sample_size = atoi(argv[++i]);
+		else if (!strcmp(arg, "-n")) nb_samples = atoi(argv[++i]);
+		else if (!strcmp(arg, "-runs")) nb_runs = atoi(argv[++i]);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if ((sample_size <= CLEAR_HEADER) || !nb_samples || !nb_runs) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+
+	mc = gf_crypt_open_ex(GF_AES_128, GF_CTR, GF_CRYPTO_BACKEND_AESNI);
+	has_aesni = mc ? GF_TRUE : GF_FALSE;
+	if (mc) gf_crypt_close(mc);
+
+#define CHECK(_name, _test) { Bool _ok = _test; fprintf(stderr, "%s: %s\n", _name, _ok ? "OK" : "FAILED"); if (!_ok) nb_failed++; }
+
+	CHECK("Software CBC SP800-38A", check_nist(GF_CBC, GF_CRYPTO_BACKEND_SOFT));
+	CHECK("Software CTR SP800-38A", check_nist(GF_CTR, GF_CRYPTO_BACKEND_SOFT));
+	CHECK("Software CBC ranges", check_ranges(GF_CBC, GF_CRYPTO_BACKEND_SOFT));
+	CHECK("Software CTR ranges", check_ranges(GF_CTR, GF_CRYPTO_BACKEND_SOFT));
+	if (has_aesni) {
+		CHECK("AES-NI CBC SP800-38A", check_nist(GF_CBC, GF_CRYPTO_BACKEND_AESNI));
+		CHECK("AES-NI CTR SP800-38A", check_nist(GF_CTR, GF_CRYPTO_BACKEND_AESNI));
+		CHECK("AES-NI CBC vs software", check_vs_soft(GF_CBC, GF_FALSE));
+		CHECK("AES-NI CTR vs software", check_vs_soft(GF_CTR, GF_FALSE));
+		CHECK("AES-NI CTR vs software, counter wrap", check_vs_soft(GF_CTR, GF_TRUE));
+		CHECK("AES-NI CTR state restore", check_ctr_resume());
+		CHECK("AES-NI CBC ranges", check_ranges(GF_CBC, GF_CRYPTO_BACKEND_AESNI));
+		CHECK("AES-NI CTR ranges", check_ranges(GF_CTR, GF_CRYPTO_BACKEND_AESNI));
+	} else {
+		fprintf(stderr, "AES-NI not supported by this CPU\n");
+	}
+
+	data = (u8 *)gf_malloc(sample_size * nb_samples);
+	ref = (u8 *)gf_malloc(sample_size * nb_samples);
+	result = (u8 *)gf_malloc(sample_size * nb_samples);
+	fill_random(ref, sample_size * nb_samples);
+
+	fprintf(stderr, "\n%d samples of %d bytes - throughput in MB/s of sample data, software / AES-NI / AES-NI ranges\n", nb_samples, sample_size);
+	for (i=0; i<4; i++) {
+		u32 j, k;
+		Double rates[3];
+		/*ranges only apply to full sample encryption*/
+		u32 nb_tests = has_aesni ? ((i<=SCHEME_CBC1) ? 3 : 2) : 1;
+		for (j=0; j<nb_tests; j++) {
+			u64 best = 0;
+			for (k=0; k<nb_runs; k++) {
+				u64 time;
+				memcpy(data, ref, sample_size * nb_samples);
+				time = run_scheme(i, j ? GF_CRYPTO_BACKEND_AESNI : GF_CRYPTO_BACKEND_SOFT, (j==2) ? GF_TRUE : GF_FALSE, data, nb_samples, sample_size);
+				if (!best || (time < best)) best = time;
+			}
+			rates[j] = best ? ((Double) sample_size) * nb_samples / (s64) best : 0;
+			/*all backends must produce the same output*/
+			if (!j) {
+				memcpy(result, data, sample_size * nb_samples);
+			} else if (memcmp(result, data, sample_size * nb_samples)) {
+				fprintf(stderr, "%s: output mismatch between software and AES-NI%s\n", scheme_names[i], (j==2) ? " ranges" : "");
+				nb_failed++;
+			}
+		}
+		fprintf(stderr, "%s: %.1f", scheme_names[i], rates[0]);
+		for (j=1; j<nb_tests; j++) fprintf(stderr, " / %.1f", rates[j]);
+		if (nb_tests>1) fprintf(stderr, " - x%.2f", rates[nb_tests-1] / rates[0]);
+		fprintf(stderr, "\n");
+	}
+
+	gf_free(data);
+	gf_free(ref);
+	gf_free(result);
+	gf_sys_close();
+	return nb_failed ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - lazy fragment parsing check
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/isomedia.h>
+
+/*opens a fragmented file in GF_ISOM_OPEN_READ and GF_ISOM_OPEN_READ_LAZY modes and checks that all per-sample accessors
+and time-based sample lookups give the same results, browsing samples in order then at random*/
+
+static u32 nb_errors = 0;
+
+#define CHECK(_cond, _msg) \
+	if (!(_cond)) { \
+		nb_errors++; \
+		if (nb_errors<=20) fprintf(stderr, "track %d sample %d: %s differs\n", track, sample_num, _msg); \
+	}
+
+static u32 seed = 0x12345678;
+static u32 rnd()
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7FFF;
+}
+
+static Bool same_sample(GF_ISOSample *a, GF_ISOSample *b)
+{
+	if (!a || !b) return (a==b) ? GF_TRUE : GF_FALSE;
+	if ((a->DTS != b->DTS) || (a->CTS_Offset != b->CTS_Offset) || (a->IsRAP != b->IsRAP) || (a->dataLength != b->dataLength)) return GF_FALSE;
+	if (a->data && b->data && memcmp(a->data, b->data, a->dataLength)) return GF_FALSE;
+	return GF_TRUE;
+}
+
+static void check_sample(GF_ISOFile *ref, GF_ISOFile *lazy, u32 track, u32 sample_num)
+{
+	u32 di_a, di_b, i, a[4], b[4];
+	u64 offset_a, offset_b;
+	u8 pad_a, pad_b;
+	Bool rap_a, rap_b, roll_a, roll_b;
+	s32 dist_a, dist_b;
+	u8 iv_a, iv_b;
+	bin128 kid_a, kid_b;
+	GF_Err e_a, e_b;
+	GF_ISOSample *s_a, *s_b;
+
+	s_a = gf_isom_get_sample(ref, track, sample_num, &di_a);
+	s_b = gf_isom_get_sample(lazy, track, sample_num, &di_b);
+	CHECK(same_sample(s_a, s_b) && (di_a==di_b), "sample")
+	if (s_a) gf_isom_sample_del(&s_a);
+	if (s_b) gf_isom_sample_del(&s_b);
+
+	s_a = gf_isom_get_sample_info(ref, track, sample_num, &di_a, &offset_a);
+	s_b = gf_isom_get_sample_info(lazy, track, sample_num, &di_b, &offset_b);
+	CHECK(same_sample(s_a, s_b) && (di_a==di_b) && (offset_a==offset_b), "sample info")
+	if (s_a) gf_isom_sample_del(&s_a);
+	if (s_b) gf_isom_sample_del(&s_b);
+
+	CHECK(gf_isom_get_sample_dts(ref, track, sample_num) == gf_isom_get_sample_dts(lazy, track, sample_num), "DTS")
+	CHECK(gf_isom_get_sample_duration(ref, track, sample_num) == gf_isom_get_sample_duration(lazy, track, sample_num), "duration")
+	CHECK(gf_isom_get_sample_size(ref, track, sample_num) == gf_isom_get_sample_size(lazy, track, sample_num), "size")
+	CHECK(gf_isom_get_sample_sync(ref, track, sample_num) == gf_isom_get_sample_sync(lazy, track, sample_num), "sync")
+
+	e_a = gf_isom_get_sample_flags(ref, track, sample_num, &a[0], &a[1], &a[2], &a[3]);
+	e_b = gf_isom_get_sample_flags(lazy, track, sample_num, &b[0], &b[1], &b[2], &b[3]);
+	CHECK((e_a==e_b) && !memcmp(a, b, sizeof(a)), "dependency flags")
+
+	pad_a = pad_b = 0;
+	e_a = gf_isom_get_sample_padding_bits(ref, track, sample_num, &pad_a);
+	e_b = gf_isom_get_sample_padding_bits(lazy, track, sample_num, &pad_b);
+	CHECK((e_a==e_b) && (pad_a==pad_b), "padding bits")
+
+	e_a = gf_isom_get_sample_rap_roll_info(ref, track, sample_num, &rap_a, &roll_a, &dist_a);
+	e_b = gf_isom_get_sample_rap_roll_info(lazy, track, sample_num, &rap_b, &roll_b, &dist_b);
+	CHECK((e_a==e_b) && (rap_a==rap_b) && (roll_a==roll_b) && (dist_a==dist_b), "rap/roll info")
+
+	CHECK(gf_isom_sample_was_traf_start(ref, track, sample_num) == gf_isom_sample_was_traf_start(lazy, track, sample_num), "traf start")
+
+	a[0] = gf_isom_sample_has_subsamples(ref, track, sample_num, 0);
+	b[0] = gf_isom_sample_has_subsamples(lazy, track, sample_num, 0);
+	CHECK(a[0]==b[0], "subsample count")
+	for (i=0; (a[0]==b[0]) && (i<a[0]); i++) {
+		u8 prio_a, prio_b;
+		Bool disc_a, disc_b;
+		gf_isom_sample_get_subsample(ref, track, sample_num, 0, i+1, &a[1], &prio_a, &a[2], &disc_a);
+		gf_isom_sample_get_subsample(lazy, track, sample_num, 0, i+1, &b[1], &prio_b, &b[2], &disc_b);
+		CHECK((a[1]==b[1]) && (a[2]==b[2]) && (prio_a==prio_b) && (disc_a==disc_b), "subsample")
+	}
+
+	if (gf_isom_is_cenc_media(ref, track, 1)) {
+		GF_CENCSampleAuxInfo *sai_a=NULL, *sai_b=NULL;
+		iv_a = iv_b = 0;
+		e_a = gf_isom_get_sample_cenc_info(ref, track, sample_num, &a[0], &iv_a, &kid_a, NULL, NULL, NULL, NULL);
+		e_b = gf_isom_get_sample_cenc_info(lazy, track, sample_num, &b[0], &iv_b, &kid_b, NULL, NULL, NULL, NULL);
+		CHECK((e_a==e_b) && (a[0]==b[0]) && (iv_a==iv_b) && !memcmp(kid_a, kid_b, 16), "CENC info")
+
+		e_a = gf_isom_cenc_get_sample_aux_info(ref, track, sample_num, 1, &sai_a, NULL);
+		e_b = gf_isom_cenc_get_sample_aux_info(lazy, track, sample_num, 1, &sai_b, NULL);
+		CHECK((e_a==e_b) && (!sai_a == !sai_b), "CENC aux info")
+		if (sai_a && sai_b) {
+			CHECK(!memcmp(sai_a->IV, sai_b->IV, 16) && (sai_a->subsample_count==sai_b->subsample_count), "CENC IV")
+		}
+		if (sai_a) gf_isom_cenc_samp_aux_info_del(sai_a);
+		if (sai_b) gf_isom_cenc_samp_aux_info_del(sai_b);
+	}
+}
+
+static void check_time(GF_ISOFile *ref, GF_ISOFile *lazy, u32 track, u64 time)
+{
+	u32 i, sample_num;
+	u8 modes[] = {GF_ISOM_SEARCH_FORWARD, GF_ISOM_SEARCH_BACKWARD, GF_ISOM_SEARCH_SYNC_FORWARD, GF_ISOM_SEARCH_SYNC_BACKWARD, GF_ISOM_SEARCH_SYNC_SHADOW};
+
+	for (i=0; i<sizeof(modes); i++) {
+		u32 di, num_a=0, num_b=0;
+		GF_ISOSample *s_a=NULL, *s_b=NULL;
+		GF_Err e_a = gf_isom_get_sample_for_media_time(ref, track, time, &di, modes[i], &s_a, &num_a);
+		GF_Err e_b = gf_isom_get_sample_for_media_time(lazy, track, time, &di, modes[i], &s_b, &num_b);
+		sample_num = num_a;
+		CHECK((e_a==e_b) && (num_a==num_b) && same_sample(s_a, s_b), "media time search")
+		if (s_a) gf_isom_sample_del(&s_a);
+		if (s_b) gf_isom_sample_del(&s_b);
+	}
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: lazyread [-win N] [-n N] file.mp4\n"
+	        "\t-win N: number of fragments kept parsed in lazy mode (default 4)\n"
+	        "\t-n N: number of random samples and times checked per track (default 2000)\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, track, sample_num, nb_rand, win;
+	char *src = NULL;
+	GF_ISOFile *ref, *lazy;
+
+	win = 0;
+	nb_rand = 2000;
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (i+1 == (u32) argc) src = arg;
+		else if (!strcmp(arg, "-win")) win = atoi(argv[++i]);
+		else if (!strcmp(arg, "-n")) nb_rand = atoi(argv[++i]);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (!src) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+
+	ref = gf_isom_open(src, GF_ISOM_OPEN_READ, NULL);
+	lazy = gf_isom_open(src, GF_ISOM_OPEN_READ_LAZY, NULL);
+	if (!ref || !lazy) {
+		fprintf(stderr, "Cannot open %s\n", src);
+		if (ref) gf_isom_close(ref);
+		if (lazy) gf_isom_close(lazy);
+		gf_sys_close();
+		return 1;
+	}
+	if (win && (gf_isom_set_lazy_fragment_window(lazy, win) != GF_OK)) {
+		fprintf(stderr, "%s is not read in lazy fragment mode\n", src);
+	}
+
+	track = sample_num = 0;
+	CHECK(gf_isom_get_duration(ref) == gf_isom_get_duration(lazy), "movie duration")
+
+	for (track=1; track<=gf_isom_get_track_count(ref); track++) {
+		u32 count = gf_isom_get_sample_count(ref, track);
+		u64 media_dur = gf_isom_get_media_duration(ref, track);
+
+		sample_num = 0;
+		CHECK(count == gf_isom_get_sample_count(lazy, track), "sample count")
+		CHECK(media_dur == gf_isom_get_media_duration(lazy, track), "media duration")
+		CHECK(gf_isom_get_track_duration(ref, track) == gf_isom_get_track_duration(lazy, track), "track duration")
+
+		for (sample_num=1; sample_num<=count; sample_num++) {
+			check_sample(ref, lazy, track, sample_num);
+		}
+		for (i=0; count && (i<nb_rand); i++) {
+			sample_num = 1 + ((rnd() << 15) | rnd()) % count;
+			check_sample(ref, lazy, track, sample_num);
+			check_time(ref, lazy, track, (((u64) rnd() << 30) | (rnd() << 15) | rnd()) % (media_dur+1));
+		}
+		fprintf(stderr, "track %d: %d samples checked\n", track, count);
+	}
+
+	gf_isom_close(ref);
+	gf_isom_close(lazy);
+	gf_sys_close();
+
+	if (nb_errors) {
+		fprintf(stderr, "FAILED - %d differences\n", nb_errors);
+		return 1;
+	}
+	fprintf(stderr, "OK\n");
+	return 0;
+}
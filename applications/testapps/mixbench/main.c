@@ -0,0 +1,217 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - audio mixer benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/internal/compositor_dev.h>
+#include <math.h>
+
+/*headless audio mixer benchmark: mixes N synthetic sources through gf_mixer_get_output and reports the mixing speed*/
+
+typedef struct
+{
+	GF_AudioInterface ifce;
+	/*one second of interleaved samples, looped*/
+	char *data;
+	u32 size, pos;
+	u32 sr, nb_ch, bps;
+	Fixed volume;
+} BenchSource;
+
+static char *bs_fetch_frame(void *callback, u32 *size, u32 audio_delay_ms)
+{
+	BenchSource *bs = (BenchSource *)callback;
+	*size = bs->size - bs->pos;
+	return bs->data + bs->pos;
+}
+
+static void bs_release_frame(void *callback, u32 nb_bytes)
+{
+	BenchSource *bs = (BenchSource *)callback;
+	bs->pos += nb_bytes;
+	if (bs->pos >= bs->size) bs->pos = 0;
+}
+
+static Fixed bs_get_speed(void *callback)
+{
+	return FIX_ONE;
+}
+
+static Bool bs_get_channel_volume(void *callback, Fixed *vol)
+{
+	u32 i;
+	BenchSource *bs = (BenchSource *)callback;
+	for (i=0; i<6; i++) vol[i] = bs->volume;
+	return (bs->volume != FIX_ONE) ? GF_TRUE : GF_FALSE;
+}
+
+static Bool bs_is_muted(void *callback)
+{
+	return GF_FALSE;
+}
+
+static Bool bs_get_config(GF_AudioInterface *ai, Bool for_reconf)
+{
+	BenchSource *bs = (BenchSource *)ai->callback;
+	ai->samplerate = bs->sr;
+	ai->chan = bs->nb_ch;
+	ai->bps = bs->bps;
+	ai->ch_cfg = GF_AUDIO_CH_FRONT_LEFT;
+	if (bs->nb_ch>1) ai->ch_cfg |= GF_AUDIO_CH_FRONT_RIGHT;
+	ai->forced_layout = GF_FALSE;
+	return GF_TRUE;
+}
+
+static BenchSource *bs_new(u32 sr, u32 nb_ch, u32 bps, Fixed volume, u32 idx)
+{
+	u32 i, j;
+	BenchSource *bs;
+	GF_SAFEALLOC(bs, BenchSource);
+	if (!bs) return NULL;
+	bs->sr = sr;
+	bs->nb_ch = nb_ch;
+	bs->bps = bps;
+	bs->volume = volume;
+	bs->size = sr * nb_ch * bps / 8;
+	bs->data = (char*)gf_malloc(bs->size);
+	for (i=0; i<sr; i++) {
+		Double v = sin(2 * GF_PI * (220 + 110*idx) * i / sr) * 0.25;
+		for (j=0; j<nb_ch; j++) {
+			if (bps==16) {
+				((s16 *)bs->data)[i*nb_ch + j] = (s16) (v * 32767);
+			} else {
+				bs->data[i*nb_ch + j] = (s8) (v * 127);
+			}
+		}
+	}
+	bs->ifce.callback = bs;
+	bs->ifce.FetchFrame = bs_fetch_frame;
+	bs->ifce.ReleaseFrame = bs_release_frame;
+	bs->ifce.GetSpeed = bs_get_speed;
+	bs->ifce.GetChannelVolume = bs_get_channel_volume;
+	bs->ifce.IsMuted = bs_is_muted;
+	bs->ifce.GetConfig = bs_get_config;
+	return bs;
+}
+
+static void bs_del(BenchSource *bs)
+{
+	gf_free(bs->data);
+	gf_free(bs);
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: mixbench [options]\n"
+	        "\t-n N:     number of sources to mix (default 4)\n"
+	        "\t-sr SR:   source sample rate (default 44100)\n"
+	        "\t-rsr SR:  sample rate of odd sources, to benchmark resampling (default same as -sr)\n"
+	        "\t-ch N:    number of channels per source (default 2)\n"
+	        "\t-bps N:   bits per sample of sources, 8 or 16 (default 16)\n"
+	        "\t-vol V:   volume of sources, to benchmark gain (default 1.0)\n"
+	        "\t-dur D:   duration of audio to mix in seconds (default 600)\n"
+	        "\t-block B: output block size in ms (default 20)\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, nb_src, sr, rsr, nb_ch, bps, dur, block_ms, out_sr, out_ch, out_bps, out_cfg, block_size;
+	u64 nb_frames, start, run_time;
+	Double vol;
+	char *buffer;
+	GF_AudioMixer *am;
+	BenchSource *srcs[64];
+
+	nb_src = 4;
+	sr = rsr = 44100;
+	nb_ch = 2;
+	bps = 16;
+	vol = 1.0;
+	dur = 600;
+	block_ms = 20;
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (i+1 == (u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(arg, "-n")) nb_src = atoi(argv[++i]);
+		else if (!strcmp(arg, "-sr")) sr = rsr = atoi(argv[++i]);
+		else if (!strcmp(arg, "-rsr")) rsr = atoi(argv[++i]);
+		else if (!strcmp(arg, "-ch")) nb_ch = atoi(argv[++i]);
+		else if (!strcmp(arg, "-bps")) bps = atoi(argv[++i]);
+		else if (!strcmp(arg, "-vol")) vol = atof(argv[++i]);
+		else if (!strcmp(arg, "-dur")) dur = atoi(argv[++i]);
+		else if (!strcmp(arg, "-block")) block_ms = atoi(argv[++i]);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (!nb_src || (nb_src>64) || !nb_ch || (nb_ch>6) || ((bps!=8) && (bps!=16)) || !block_ms) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+
+	am = gf_mixer_new(NULL);
+	for (i=0; i<nb_src; i++) {
+		srcs[i] = bs_new((i%2) ? rsr : sr, nb_ch, bps, FLT2FIX(vol), i);
+		gf_mixer_add_input(am, &srcs[i]->ifce);
+	}
+	/*configure the mixer on the source formats*/
+	gf_mixer_reconfig(am);
+	gf_mixer_get_config(am, &out_sr, &out_ch, &out_bps, &out_cfg);
+
+	block_size = out_sr * block_ms / 1000 * out_ch * out_bps / 8;
+	buffer = (char*)gf_malloc(block_size);
+
+	fprintf(stderr, "Mixing %d sources (%d Hz - odd sources %d Hz) %d channels %d bits - output %d Hz %d channels %d bits - %d ms blocks\n", nb_src, sr, rsr, nb_ch, bps, out_sr, out_ch, out_bps, block_ms);
+
+	nb_frames = 0;
+	start = gf_sys_clock_high_res();
+	while (nb_frames < (u64) dur * out_sr) {
+		u32 done = gf_mixer_get_output(am, buffer, block_size, 0);
+		if (!done) {
+			fprintf(stderr, "Mixer produced no output, aborting\n");
+			break;
+		}
+		nb_frames += done / (out_ch * out_bps / 8);
+	}
+	run_time = gf_sys_clock_high_res() - start;
+	if (!run_time) run_time = 1;
+
+	fprintf(stderr, "Mixed "LLU" frames in "LLU" ms: %.2f Msamples/s output - %.2f Msamples/s input - x%.1f realtime\n",
+	        nb_frames, run_time/1000,
+	        ((Double) (s64) nb_frames) * out_ch / (s64) run_time,
+	        ((Double) (s64) nb_frames) * out_ch * nb_src / (s64) run_time,
+	        ((Double) (s64) nb_frames) * 1000000 / out_sr / (s64) run_time);
+
+	gf_free(buffer);
+	gf_mixer_del(am);
+	for (i=0; i<nb_src; i++) bs_del(srcs[i]);
+	gf_sys_close();
+	return 0;
+}
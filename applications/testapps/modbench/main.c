@@ -0,0 +1,176 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - module manager startup benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/module.h>
+#include <gpac/config_file.h>
+#include <gpac/constants.h>
+#include <gpac/modules/codec.h>
+#include <gpac/modules/service.h>
+
+/*measures the time needed to create the module manager and to resolve the input service and decoders of a typical
+session, with and without a valid module manifest. Resolution follows what the terminal does: modules not handling
+the interface or the stream type according to the modules cache are skipped without being loaded*/
+
+static u32 nb_loads;
+
+static Bool may_handle(GF_ModuleManager *mm, u32 i, u32 ifce_type, u32 stream_type)
+{
+	char szST[10];
+	const char *caps = gf_modules_get_capabilities(mm, i, ifce_type);
+	/*"*": the decoder does not reply to the stream type query and must be probed*/
+	if (!caps || !strcmp(caps, "*")) return GF_TRUE;
+	sprintf(szST, " %02X ", stream_type);
+	return strstr(caps, szST) ? GF_TRUE : GF_FALSE;
+}
+
+static void build_caps(GF_ModuleManager *mm, u32 i, u32 ifce_type, GF_BaseDecoder *ifce)
+{
+	u32 st;
+	char caps[3*256 + 2];
+	if (!ifce->CanHandleStream || gf_modules_get_capabilities(mm, i, ifce_type)) return;
+	strcpy(caps, " ");
+	for (st=1; st<256; st++) {
+		if (ifce->CanHandleStream(ifce, st, NULL, 0) != GF_CODEC_NOT_SUPPORTED)
+			sprintf(caps + strlen(caps), "%02X ", st);
+	}
+	if (!caps[1]) strcpy(caps, "*");
+	gf_modules_set_capabilities(mm, i, ifce_type, caps);
+}
+
+/*returns the number of decoder modules able to handle the stream type*/
+static u32 resolve_decoders(GF_ModuleManager *mm, u32 ifce_type, u32 stream_type)
+{
+	u32 i, count, nb_found = 0;
+	count = gf_modules_get_count(mm);
+	for (i=0; i<count; i++) {
+		GF_BaseDecoder *ifce;
+		if (!may_handle(mm, i, ifce_type, stream_type)) continue;
+		ifce = (GF_BaseDecoder *) gf_modules_load_interface(mm, i, ifce_type);
+		if (!ifce) continue;
+		nb_loads++;
+		build_caps(mm, i, ifce_type, ifce);
+		if (ifce->CanHandleStream && (ifce->CanHandleStream(ifce, stream_type, NULL, 0) != GF_CODEC_NOT_SUPPORTED))
+			nb_found++;
+		gf_modules_close_interface((GF_BaseInterface *) ifce);
+	}
+	return nb_found;
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: modbench [options]\n"
+	        "\t-cfg file:  GPAC config file to use (default is the user config file, left unmodified)\n"
+	        "\t-mod-dir D: modules directory (default from config file)\n"
+	        "\t-n N:       number of startups to simulate (default 20)\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, run, nb_iter, nb_mods;
+	const char *cfg_path, *mod_dir;
+	GF_Config *cfg;
+
+	cfg_path = mod_dir = NULL;
+	nb_iter = 20;
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (i+1 == (u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(arg, "-cfg")) cfg_path = argv[++i];
+		else if (!strcmp(arg, "-mod-dir")) mod_dir = argv[++i];
+		else if (!strcmp(arg, "-n")) nb_iter = atoi(argv[++i]);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (!nb_iter) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+	cfg = gf_cfg_init(cfg_path, NULL);
+	if (!cfg) {
+		fprintf(stderr, "Cannot load GPAC config file\n");
+		gf_sys_close();
+		return 1;
+	}
+	if (mod_dir) gf_cfg_set_key(cfg, "General", "ModulesDirectory", mod_dir);
+
+	nb_mods = 0;
+	/*run 0 flushes the manifest before each startup, run 1 keeps it*/
+	for (run=0; run<2; run++) {
+		u64 start, init_time, resolve_time;
+		u32 nb_dec = 0;
+		init_time = resolve_time = 0;
+		nb_loads = 0;
+		for (i=0; i<nb_iter; i++) {
+			u64 now;
+			GF_ModuleManager *mm;
+			GF_BaseInterface *ifce;
+			if (!run) {
+				gf_cfg_del_section(cfg, "PluginsManifest");
+				gf_cfg_del_section(cfg, "PluginsCache");
+			}
+			start = gf_sys_clock_high_res();
+			mm = gf_modules_new(NULL, cfg);
+			now = gf_sys_clock_high_res();
+			init_time += now - start;
+			if (!mm) {
+				fprintf(stderr, "Cannot create module manager\n");
+				break;
+			}
+			nb_mods = gf_modules_get_count(mm);
+
+			start = now;
+			/*input service for an MP4 file, then decoders for its streams*/
+			ifce = gf_modules_load_interface_by_name(mm, "GPAC IsoMedia Reader", GF_NET_CLIENT_INTERFACE);
+			if (ifce) {
+				nb_loads++;
+				gf_modules_close_interface(ifce);
+			}
+			nb_dec = resolve_decoders(mm, GF_SCENE_DECODER_INTERFACE, GF_STREAM_OD);
+			nb_dec += resolve_decoders(mm, GF_SCENE_DECODER_INTERFACE, GF_STREAM_SCENE);
+			nb_dec += resolve_decoders(mm, GF_MEDIA_DECODER_INTERFACE, GF_STREAM_VISUAL);
+			nb_dec += resolve_decoders(mm, GF_MEDIA_DECODER_INTERFACE, GF_STREAM_AUDIO);
+			nb_dec += resolve_decoders(mm, GF_MEDIA_DECODER_INTERFACE, GF_STREAM_TEXT);
+			resolve_time += gf_sys_clock_high_res() - start;
+
+			gf_modules_del(mm);
+		}
+		fprintf(stderr, "%s manifest: %d modules - %d decoder candidates - startup "LLU" us - resolution "LLU" us - %.1f interfaces loaded per run\n",
+		        run ? "Valid" : "No", nb_mods, nb_dec, init_time / nb_iter, resolve_time / nb_iter, ((Double) nb_loads) / nb_iter);
+	}
+
+	/*leave the user config untouched*/
+	gf_cfg_discard_changes(cfg);
+	gf_cfg_del(cfg);
+	gf_sys_close();
+	return 0;
+}
@@ -0,0 +1,456 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - PBO texture upload check
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/terminal.h>
+#include <gpac/options.h>
+/*for gf_term_step_clocks*/
+#include <gpac/internal/terminal_dev.h>
+#include <gpac/isomedia.h>
+#include <gpac/avparse.h>
+#include <gpac/constants.h>
+#include <gpac/modules/video_out.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+/*plays a generated video in OpenGL mode, once with synchronous texture uploads and once with [Compositor] EnablePBO,
+and checks that every frame read back from the GL output is the same in both modes. The GL context is an EGL pbuffer
+provided by a video output registered by this program, so that the check runs without display, for instance with
+Mesa llvmpipe*/
+
+#define VOUT_NAME	"PBO Check Video Output"
+
+typedef struct
+{
+	EGLDisplay display;
+	EGLConfig config;
+	EGLContext context;
+	EGLSurface surface;
+	u32 width, height;
+} EGLOutput;
+
+static GF_Err egl_setup(GF_VideoOutput *dr, void *os_handle, void *os_display, u32 init_flags)
+{
+	EGLint nb_configs;
+	EGLint attribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_DEPTH_SIZE, 16, EGL_NONE};
+	EGLOutput *egl = (EGLOutput *)dr->opaque;
+
+	egl->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+	/*no display server, try rendering without any*/
+	if ((egl->display == EGL_NO_DISPLAY) || !eglInitialize(egl->display, NULL, NULL)) {
+		PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (get_platform_display) egl->display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+#endif
+	if ((egl->display == EGL_NO_DISPLAY) || !eglInitialize(egl->display, NULL, NULL)) {
+		fprintf(stderr, "Cannot initialize EGL\n");
+		return GF_IO_ERR;
+	}
+	if (!eglChooseConfig(egl->display, attribs, &egl->config, 1, &nb_configs) || !nb_configs || !eglBindAPI(EGL_OPENGL_API)) {
+		fprintf(stderr, "No EGL pbuffer configuration for OpenGL\n");
+		return GF_IO_ERR;
+	}
+	egl->context = eglCreateContext(egl->display, egl->config, EGL_NO_CONTEXT, NULL);
+	if (egl->context == EGL_NO_CONTEXT) {
+		fprintf(stderr, "Cannot create EGL context\n");
+		return GF_IO_ERR;
+	}
+	return GF_OK;
+}
+
+static void egl_shutdown(GF_VideoOutput *dr)
+{
+	EGLOutput *egl = (EGLOutput *)dr->opaque;
+	if (egl->display == EGL_NO_DISPLAY) return;
+	eglMakeCurrent(egl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (egl->surface != EGL_NO_SURFACE) eglDestroySurface(egl->display, egl->surface);
+	if (egl->context != EGL_NO_CONTEXT) eglDestroyContext(egl->display, egl->context);
+	eglTerminate(egl->display);
+	egl->display = EGL_NO_DISPLAY;
+	egl->surface = EGL_NO_SURFACE;
+	egl->context = EGL_NO_CONTEXT;
+}
+
+static GF_Err egl_flush(GF_VideoOutput *dr, GF_Window *dest)
+{
+	EGLOutput *egl = (EGLOutput *)dr->opaque;
+	eglSwapBuffers(egl->display, egl->surface);
+	return GF_OK;
+}
+
+static GF_Err egl_set_fullscreen(GF_VideoOutput *dr, Bool fs_on, u32 *new_disp_width, u32 *new_disp_height)
+{
+	return GF_OK;
+}
+
+static GF_Err egl_lock_back_buffer(GF_VideoOutput *dr, GF_VideoSurface *vi, Bool do_lock)
+{
+	/*GL output, the compositor reads the frame back itself*/
+	return GF_NOT_SUPPORTED;
+}
+
+static GF_Err egl_process_event(GF_VideoOutput *dr, GF_Event *evt)
+{
+	GF_Event setup;
+	EGLint attribs[] = {EGL_WIDTH, 0, EGL_HEIGHT, 0, EGL_NONE};
+	EGLOutput *egl = (EGLOutput *)dr->opaque;
+
+	if (!evt || (evt->type != GF_EVENT_VIDEO_SETUP)) return GF_OK;
+	if (!evt->setup.opengl_mode) return GF_NOT_SUPPORTED;
+
+	memset(&setup, 0, sizeof(GF_Event));
+	setup.type = GF_EVENT_VIDEO_SETUP;
+	if ((egl->surface == EGL_NO_SURFACE) || (egl->width != evt->setup.width) || (egl->height != evt->setup.height)) {
+		eglMakeCurrent(egl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (egl->surface != EGL_NO_SURFACE) eglDestroySurface(egl->display, egl->surface);
+		else setup.setup.hw_reset = 1;
+
+		egl->width = evt->setup.width;
+		egl->height = evt->setup.height;
+		attribs[1] = egl->width;
+		attribs[3] = egl->height;
+		egl->surface = eglCreatePbufferSurface(egl->display, egl->config, attribs);
+		if (egl->surface == EGL_NO_SURFACE) return GF_IO_ERR;
+	}
+	if (!eglMakeCurrent(egl->display, egl->surface, egl->surface, egl->context)) return GF_IO_ERR;
+
+	dr->on_event(dr->evt_cbk_hdl, &setup);
+	return GF_OK;
+}
+
+static const u32 *egl_query_interfaces()
+{
+	static u32 si [] = {
+		GF_VIDEO_OUTPUT_INTERFACE,
+		0
+	};
+	return si;
+}
+
+static GF_BaseInterface *egl_load_interface(u32 InterfaceType)
+{
+	EGLOutput *egl;
+	GF_VideoOutput *driv;
+	if (InterfaceType != GF_VIDEO_OUTPUT_INTERFACE) return NULL;
+
+	GF_SAFEALLOC(driv, GF_VideoOutput);
+	GF_SAFEALLOC(egl, EGLOutput);
+	if (!driv || !egl) {
+		if (driv) gf_free(driv);
+		if (egl) gf_free(egl);
+		return NULL;
+	}
+	GF_REGISTER_MODULE_INTERFACE(driv, GF_VIDEO_OUTPUT_INTERFACE, VOUT_NAME, "gpac distribution")
+	egl->display = EGL_NO_DISPLAY;
+	egl->context = EGL_NO_CONTEXT;
+	egl->surface = EGL_NO_SURFACE;
+	driv->opaque = egl;
+	driv->Setup = egl_setup;
+	driv->Shutdown = egl_shutdown;
+	driv->Flush = egl_flush;
+	driv->SetFullScreen = egl_set_fullscreen;
+	driv->LockBackBuffer = egl_lock_back_buffer;
+	driv->ProcessEvent = egl_process_event;
+	driv->hw_caps = GF_VIDEO_HW_OPENGL;
+	driv->max_screen_width = driv->max_screen_height = 4096;
+	driv->max_screen_bpp = 24;
+	return (GF_BaseInterface *) driv;
+}
+
+static void egl_shutdown_interface(GF_BaseInterface *ifce)
+{
+	GF_VideoOutput *driv = (GF_VideoOutput *) ifce;
+	gf_free(driv->opaque);
+	gf_free(driv);
+}
+
+static GF_InterfaceRegister *egl_register()
+{
+	GF_InterfaceRegister *reg;
+	GF_SAFEALLOC(reg, GF_InterfaceRegister);
+	if (!reg) return NULL;
+	reg->name = "pbocheck_egl_out";
+	reg->QueryInterfaces = egl_query_interfaces;
+	reg->LoadInterface = egl_load_interface;
+	reg->ShutdownInterface = egl_shutdown_interface;
+	return reg;
+}
+
+/*writes an MP4 file with one PNG image per frame*/
+static GF_Err make_video(const char *name, u32 width, u32 height, u32 nb_frames)
+{
+	u32 i, x, y, track, di, size;
+	char *rgb, *png;
+	GF_Err e;
+	GF_ESD *esd;
+	GF_ISOSample *samp;
+	GF_ISOFile *file = gf_isom_open(name, GF_ISOM_OPEN_WRITE, NULL);
+	if (!file) return gf_isom_last_error(NULL);
+
+	track = gf_isom_new_track(file, 1, GF_ISOM_MEDIA_VISUAL, 25);
+	gf_isom_set_track_enabled(file, track, 1);
+	esd = gf_odf_desc_esd_new(0);
+	esd->ESID = 1;
+	esd->decoderConfig->streamType = GF_STREAM_VISUAL;
+	esd->decoderConfig->objectTypeIndication = GPAC_OTI_IMAGE_PNG;
+	e = gf_isom_new_mpeg4_description(file, track, esd, NULL, NULL, &di);
+	gf_odf_desc_del((GF_Descriptor *)esd);
+	if (!e) e = gf_isom_set_visual_info(file, track, di, width, height);
+	if (e) {
+		gf_isom_delete(file);
+		return e;
+	}
+
+	rgb = gf_malloc(sizeof(char) * 3 * width * height);
+	png = gf_malloc(sizeof(char) * (3 * width * height + 1024));
+	samp = gf_isom_sample_new();
+	for (i=0; !e && (i<nb_frames); i++) {
+		/*gradients moving with the frame number, so that each frame differs and no pixel is uniform*/
+		for (y=0; y<height; y++) {
+			for (x=0; x<width; x++) {
+				u8 *p = (u8 *) rgb + 3*(y*width + x);
+				p[0] = (u8) (x + 3*i);
+				p[1] = (u8) (y + 5*i);
+				p[2] = (u8) ((x ^ y) + 7*i);
+			}
+		}
+		size = 3 * width * height + 1024;
+		e = gf_img_png_enc(rgb, width, height, 3*width, GF_PIXEL_RGB_24, png, &size);
+		if (e) break;
+		samp->data = png;
+		samp->dataLength = size;
+		samp->DTS = i;
+		samp->IsRAP = RAP;
+		e = gf_isom_add_sample(file, track, di, samp);
+	}
+	samp->data = NULL;
+	gf_isom_sample_del(&samp);
+	gf_free(rgb);
+	gf_free(png);
+	if (e) {
+		gf_isom_delete(file);
+		return e;
+	}
+	return gf_isom_close(file);
+}
+
+static u32 nb_pbo_frames = 0;
+static gf_log_cbk prev_log = NULL;
+
+/*counts the frames the GL texture reports as pushed from a PBO*/
+static void on_log(void *cbk, GF_LOG_Level level, GF_LOG_Tool tool, const char *fmt, va_list vlist)
+{
+	char szMsg[2048];
+	if (tool != GF_LOG_MEDIA) {
+		if ((level <= GF_LOG_WARNING) && prev_log) prev_log(cbk, level, tool, fmt, vlist);
+		return;
+	}
+	vsnprintf(szMsg, 2048, fmt, vlist);
+	szMsg[2047] = 0;
+	if (strstr(szMsg, "[GL Texture]") && strstr(szMsg, "PBO enabled yes")) nb_pbo_frames++;
+}
+
+static Bool connected = GF_FALSE;
+
+static Bool event_proc(void *ptr, GF_Event *evt)
+{
+	if (evt->type == GF_EVENT_CONNECT) connected = evt->connect.is_connected;
+	return GF_FALSE;
+}
+
+/*plays the video and stores the SHA-1 of each frame read back from the GL output*/
+static Bool play_video(GF_User *user, const char *name, u32 nb_frames, u8 (*sha)[GF_SHA1_DIGEST_SIZE], u32 *upload_time, u32 *draw_time)
+{
+	u32 i, start;
+	Bool ok = GF_TRUE;
+	GF_Terminal *term = gf_term_new(user);
+	if (!term) {
+		fprintf(stderr, "Cannot create terminal\n");
+		return GF_FALSE;
+	}
+	gf_term_set_simulation_frame_rate(term, 25.0);
+	connected = GF_FALSE;
+	gf_term_connect_from_time(term, name, 0, 2);
+
+	for (i=0; ok && (i<nb_frames); i++) {
+		GF_VideoSurface fb;
+		start = gf_sys_clock();
+		while (!connected || (gf_term_get_option(term, GF_OPT_PLAY_STATE) == GF_STATE_STEP_PAUSE)) {
+			gf_term_process_flush(term);
+			if (gf_sys_clock() - start > 10000) {
+				fprintf(stderr, "Could not draw frame %d\n", i+1);
+				ok = GF_FALSE;
+				break;
+			}
+		}
+		if (!ok) break;
+
+		if (gf_term_get_screen_buffer(term, &fb) != GF_OK) {
+			fprintf(stderr, "Cannot read frame %d back\n", i+1);
+			ok = GF_FALSE;
+			break;
+		}
+		gf_sha1_csum((u8 *) fb.video_buffer, fb.pitch_y * fb.height, sha[i]);
+		gf_term_release_screen_buffer(term, &fb);
+		gf_term_step_clocks(term, 40);
+	}
+	*upload_time = gf_term_get_option(term, GF_OPT_TEXTURE_UPLOAD_TIME);
+	*draw_time = gf_term_get_option(term, GF_OPT_FRAME_DRAW_TIME);
+
+	gf_term_disconnect(term);
+	gf_term_del(term);
+	return ok;
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: pbocheck [-n N] [-size WxH]\n"
+	        "\t-n N: number of frames played (default 50)\n"
+	        "\t-size WxH: video size (default 1024x512). RGB frames not sized in powers of 2 may use rectangle textures, always uploaded synchronously\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, nb_frames, width, height, nb_diff, up_sync, draw_sync, up_pbo, draw_pbo;
+	u8 (*sha_sync)[GF_SHA1_DIGEST_SIZE];
+	u8 (*sha_pbo)[GF_SHA1_DIGEST_SIZE];
+	Bool ok = GF_TRUE;
+	GF_Err e;
+	GF_User user;
+	const char *name = "pbocheck.mp4";
+	const char *keys[][2] = {{"Video", "DriverName"}, {"Audio", "DriverName"}, {"Compositor", "OpenGLMode"}, {"Compositor", "EnablePBO"}};
+	char *prev[4];
+
+	nb_frames = 50;
+	width = 1024;
+	height = 512;
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (!strcmp(arg, "-n") && (i+1<(u32) argc)) nb_frames = atoi(argv[++i]);
+		else if (!strcmp(arg, "-size") && (i+1<(u32) argc)) sscanf(argv[++i], "%ux%u", &width, &height);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (!nb_frames || !width || !height) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_MemTrackerNone);
+	gf_log_set_tool_level(GF_LOG_ALL, GF_LOG_WARNING);
+	gf_log_set_tool_level(GF_LOG_MEDIA, GF_LOG_DEBUG);
+	prev_log = gf_log_set_callback(NULL, on_log);
+
+	e = make_video(name, width, height, nb_frames);
+	if (e) {
+		fprintf(stderr, "Cannot create %s: %s\n", name, gf_error_to_string(e));
+		gf_sys_close();
+		return 1;
+	}
+
+	memset(&user, 0, sizeof(GF_User));
+	user.config = gf_cfg_init(NULL, NULL);
+	if (!user.config) {
+		fprintf(stderr, "Cannot load GPAC configuration\n");
+		gf_delete_file(name);
+		gf_sys_close();
+		return 1;
+	}
+	user.modules = gf_modules_new(NULL, user.config);
+	gf_module_load_static(user.modules, egl_register);
+	gf_modules_refresh(user.modules);
+	user.EventProc = event_proc;
+	user.opaque = &user;
+	user.init_flags = GF_TERM_NO_DECODER_THREAD | GF_TERM_NO_COMPOSITOR_THREAD | GF_TERM_NO_REGULATION | GF_TERM_NO_AUDIO | GF_TERM_INIT_HIDE;
+
+	/*restore the user settings when done*/
+	for (i=0; i<4; i++) {
+		const char *opt = gf_cfg_get_key(user.config, keys[i][0], keys[i][1]);
+		prev[i] = opt ? gf_strdup(opt) : NULL;
+	}
+	gf_cfg_set_key(user.config, "Video", "DriverName", VOUT_NAME);
+	gf_cfg_set_key(user.config, "Audio", "DriverName", "Raw Audio Output");
+	gf_cfg_set_key(user.config, "Compositor", "OpenGLMode", "always");
+
+	sha_sync = gf_malloc(sizeof(u8) * GF_SHA1_DIGEST_SIZE * nb_frames);
+	sha_pbo = gf_malloc(sizeof(u8) * GF_SHA1_DIGEST_SIZE * nb_frames);
+
+	gf_cfg_set_key(user.config, "Compositor", "EnablePBO", "no");
+	if (!play_video(&user, name, nb_frames, sha_sync, &up_sync, &draw_sync)) ok = GF_FALSE;
+	if (ok && nb_pbo_frames) {
+		fprintf(stderr, "PBOs used while disabled\n");
+		ok = GF_FALSE;
+	}
+
+	nb_pbo_frames = 0;
+	gf_cfg_set_key(user.config, "Compositor", "EnablePBO", "yes");
+	if (ok && !play_video(&user, name, nb_frames, sha_pbo, &up_pbo, &draw_pbo)) ok = GF_FALSE;
+
+	if (ok) {
+		nb_diff = 0;
+		for (i=0; i<nb_frames; i++) {
+			if (memcmp(sha_sync[i], sha_pbo[i], GF_SHA1_DIGEST_SIZE)) nb_diff++;
+		}
+		fprintf(stderr, "%dx%d - %d frames - %d frames uploaded from PBOs\n", width, height, nb_frames, nb_pbo_frames);
+		fprintf(stderr, "synchronous upload: %d us upload - %d us draw per frame\n", up_sync, draw_sync);
+		fprintf(stderr, "PBO upload: %d us upload - %d us draw per frame\n", up_pbo, draw_pbo);
+		if (!nb_pbo_frames) {
+			fprintf(stderr, "PBOs not used - check the GL driver supports GL_ARB_pixel_buffer_object and the video size\n");
+			ok = GF_FALSE;
+		}
+		if (nb_diff) {
+			fprintf(stderr, "%d frames differ between synchronous and PBO upload\n", nb_diff);
+			ok = GF_FALSE;
+		}
+		for (i=1; i<nb_frames; i++) {
+			if (!memcmp(sha_sync[i], sha_sync[i-1], GF_SHA1_DIGEST_SIZE)) break;
+		}
+		if (i<nb_frames) {
+			fprintf(stderr, "frame %d is the same as frame %d, video not updated\n", i+1, i);
+			ok = GF_FALSE;
+		}
+	}
+	gf_free(sha_sync);
+	gf_free(sha_pbo);
+
+	for (i=0; i<4; i++) {
+		gf_cfg_set_key(user.config, keys[i][0], keys[i][1], prev[i]);
+		if (prev[i]) gf_free(prev[i]);
+	}
+	gf_cfg_set_key(user.config, "PluginsCache", VOUT_NAME, NULL);
+
+	gf_modules_del(user.modules);
+	gf_cfg_del(user.config);
+	gf_delete_file(name);
+	gf_log_set_callback(NULL, prev_log);
+	gf_sys_close();
+
+	fprintf(stderr, ok ? "OK\n" : "FAILED\n");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - band rasterization benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include "rast_soft.h"
+
+/*draws a synthetic full HD scene of large antialiased shapes with solid and gradient brushes, rasterizing each fill
+in 1, 2, 4 ... horizontal bands, and reports the frame rate for each band count. Frames drawn in bands are checked
+against the frame drawn on a single thread*/
+
+#define NB_BRUSHES	4
+
+static GF_Path **paths = NULL;
+static u32 nb_paths = 0;
+static GF_STENCIL brushes[NB_BRUSHES];
+
+static u32 seed = 0x12345678;
+static u32 rnd()
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7FFF;
+}
+
+static void setup_scene(u32 width, u32 height, u32 nb_shapes)
+{
+	u32 i, j;
+	Fixed pos[3];
+	GF_Color cols[3];
+	GF_Matrix2D mx;
+
+	nb_paths = nb_shapes;
+	paths = (GF_Path **)gf_malloc(sizeof(GF_Path *) * nb_paths);
+	for (i=0; i<nb_paths; i++) {
+		Fixed cx = INT2FIX(rnd() % width);
+		Fixed cy = INT2FIX(rnd() % height);
+		Fixed w = INT2FIX(width/8 + rnd() % (width/2));
+		Fixed h = INT2FIX(height/8 + rnd() % (height/2));
+		paths[i] = gf_path_new();
+		switch (i % 3) {
+		case 0:
+			gf_path_add_ellipse(paths[i], cx, cy, w, h);
+			break;
+		case 1:
+			gf_path_add_rect_center(paths[i], cx + FIX_ONE/3, cy + FIX_ONE/5, w, h);
+			break;
+		default:
+			/*random polygon with self intersections*/
+			gf_path_add_move_to(paths[i], cx, cy);
+			for (j=0; j<8; j++) {
+				gf_path_add_line_to(paths[i], cx - w/2 + w * (s32) (rnd() % 100) / 100, cy - h/2 + h * (s32) (rnd() % 100) / 100);
+			}
+			gf_path_close(paths[i]);
+			break;
+		}
+	}
+
+	brushes[0] = evg_stencil_new(NULL, GF_STENCIL_SOLID);
+	evg_stencil_set_brush_color(brushes[0], GF_COL_ARGB(0xFF, 0x20, 0xC0, 0x7F));
+	brushes[1] = evg_stencil_new(NULL, GF_STENCIL_SOLID);
+	evg_stencil_set_brush_color(brushes[1], GF_COL_ARGB(0x80, 0xF0, 0x30, 0xA5));
+
+	pos[0] = 0;
+	pos[1] = FIX_ONE/2;
+	pos[2] = FIX_ONE;
+	cols[0] = GF_COL_ARGB(0xFF, 0xFF, 0x00, 0x00);
+	cols[1] = GF_COL_ARGB(0x80, 0x00, 0xFF, 0x00);
+	cols[2] = GF_COL_ARGB(0xFF, 0x00, 0x00, 0xFF);
+	/*gradients are expressed in the unit square, mapped to the frame*/
+	gf_mx2d_init(mx);
+	gf_mx2d_add_scale(&mx, INT2FIX(width), INT2FIX(height));
+
+	brushes[2] = evg_stencil_new(NULL, GF_STENCIL_LINEAR_GRADIENT);
+	evg_stencil_set_linear_gradient(brushes[2], 0, 0, FIX_ONE, FIX_ONE);
+	evg_stencil_set_gradient_interpolation(brushes[2], pos, cols, 3);
+	evg_stencil_set_matrix(brushes[2], &mx);
+
+	brushes[3] = evg_stencil_new(NULL, GF_STENCIL_RADIAL_GRADIENT);
+	evg_stencil_set_radial_gradient(brushes[3], FIX_ONE/2, FIX_ONE/2, FIX_ONE/3, FIX_ONE/2, FIX_ONE/2, FIX_ONE/2);
+	evg_stencil_set_gradient_interpolation(brushes[3], pos, cols, 3);
+	evg_stencil_set_matrix(brushes[3], &mx);
+}
+
+static void del_scene()
+{
+	u32 i;
+	for (i=0; i<nb_paths; i++) gf_path_del(paths[i]);
+	gf_free(paths);
+	for (i=0; i<NB_BRUSHES; i++) evg_stencil_delete(brushes[i]);
+}
+
+static void draw_frame(GF_SURFACE surf)
+{
+	u32 i;
+	evg_surface_clear(surf, NULL, GF_COL_ARGB(0xFF, 0x40, 0x40, 0x40));
+	for (i=0; i<nb_paths; i++) {
+		evg_surface_set_path(surf, paths[i]);
+		evg_surface_fill(surf, brushes[i % NB_BRUSHES]);
+	}
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: rasterbench [options]\n"
+	        "\t-w W:       frame width (default 1920)\n"
+	        "\t-h H:       frame height (default 1080)\n"
+	        "\t-shapes N:  number of shapes per frame (default 60)\n"
+	        "\t-frames N:  number of frames drawn for each band count (default 50)\n"
+	        "\t-threads N: max number of bands, 0 for the number of CPU cores (default 0)\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, width, height, nb_shapes, nb_frames, max_threads, nb_threads, size, nb_failed;
+	u8 *ref, *test;
+	Double ref_fps = 0;
+	EVGSurface *surf;
+
+	width = 1920;
+	height = 1080;
+	nb_shapes = 60;
+	nb_frames = 50;
+	max_threads = 0;
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (i+1 == (u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(arg, "-w")) width = atoi(argv[++i]);
+		else if (!strcmp(arg, "-h")) height = atoi(argv[++i]);
+		else if (!strcmp(arg, "-shapes")) nb_shapes = atoi(argv[++i]);
+		else if (!strcmp(arg, "-frames")) nb_frames = atoi(argv[++i]);
+		else if (!strcmp(arg, "-threads")) max_threads = atoi(argv[++i]);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if ((width<8) || (height<8) || !nb_shapes || !nb_frames) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+	if (!max_threads) {
+		GF_SystemRTInfo rti;
+		memset(&rti, 0, sizeof(GF_SystemRTInfo));
+		gf_sys_get_rti(0xFFFFFFFF, &rti, 0);
+		max_threads = rti.nb_cores ? rti.nb_cores : 1;
+	}
+	setup_scene(width, height, nb_shapes);
+
+	size = 4 * width * height;
+	ref = (u8*)gf_malloc(size);
+	test = (u8*)gf_malloc(size);
+	surf = (EVGSurface *) evg_surface_new(NULL, GF_FALSE);
+
+	nb_failed = 0;
+	nb_threads = 1;
+	while (1) {
+		u64 start, now;
+		Double fps;
+		u8 *buf = (nb_threads==1) ? ref : test;
+		Bool res = GF_TRUE;
+
+		/*a NULL pool draws on the calling thread only*/
+		surf->bands = evg_band_pool_new(nb_threads);
+		evg_surface_attach_to_buffer(surf, (char *) buf, width, height, 4, 4*width, GF_PIXEL_ARGB);
+
+		start = gf_sys_clock_high_res();
+		for (i=0; i<nb_frames; i++) draw_frame(surf);
+		now = gf_sys_clock_high_res();
+		fps = ((Double) nb_frames) * 1000000 / (s64) (now - start ? now - start : 1);
+		if (nb_threads==1) ref_fps = fps;
+
+		if ((nb_threads>1) && memcmp(ref, test, size)) {
+			for (i=0; i<size; i++) {
+				if (ref[i] != test[i]) break;
+			}
+			fprintf(stderr, "%d bands: mismatch at pixel %d x %d\n", nb_threads, (i / 4) % width, i / 4 / width);
+			res = GF_FALSE;
+			nb_failed++;
+		}
+		fprintf(stderr, "%d bands: %s - %.2f fps (x%.2f)\n", nb_threads, res ? "OK" : "FAILED", fps, ref_fps ? fps / ref_fps : 0.0);
+
+		evg_band_pool_del(surf->bands);
+		surf->bands = NULL;
+		if (nb_threads == max_threads) break;
+		nb_threads = MIN(2*nb_threads, max_threads);
+	}
+
+	evg_surface_delete(surf);
+	gf_free(ref);
+	gf_free(test);
+	del_scene();
+	gf_sys_close();
+	return nb_failed ? 1 : 0;
+}
@@ -0,0 +1,253 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - software rasterizer span fillers check
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include "rast_soft.h"
+
+/*rasterizes a set of reference paths with solid, semi-transparent and gradient brushes on each pixel format supported
+by the soft_raster module, once with the SIMD span fillers and once with the scalar ones, and checks both results are identical*/
+
+typedef struct
+{
+	GF_PixelFormat pf;
+	const char *name;
+	u32 bpp;
+} FormatDesc;
+
+static const FormatDesc formats[] =
+{
+	{GF_PIXEL_ARGB, "ARGB", 4},
+	{GF_PIXEL_RGBA, "RGBA", 4},
+	{GF_PIXEL_RGB_32, "RGB32", 4},
+	{GF_PIXEL_BGR_32, "BGR32", 4},
+	{GF_PIXEL_RGB_24, "RGB24", 3},
+	{GF_PIXEL_BGR_24, "BGR24", 3},
+	{GF_PIXEL_RGB_565, "RGB565", 2},
+};
+
+#define NB_PATHS	6
+
+static GF_Path *paths[NB_PATHS];
+static GF_STENCIL solid, solid_alpha, linear, radial;
+
+static void setup_scene(u32 width, u32 height)
+{
+	u32 i;
+	Fixed w = INT2FIX(width);
+	Fixed h = INT2FIX(height);
+	Fixed pos[4];
+	GF_Color cols[4];
+
+	for (i=0; i<NB_PATHS; i++) paths[i] = gf_path_new();
+	/*pixel-aligned rectangle, mostly full coverage spans*/
+	gf_path_add_rect_center(paths[0], w/2, h/2, w - INT2FIX(10), h - INT2FIX(10));
+	/*antialiased ellipse*/
+	gf_path_add_ellipse(paths[1], w/2, h/2, w*3/4, h*3/4);
+	/*star, non-zero winding with self intersections*/
+	gf_path_add_move_to(paths[2], w/2, 0);
+	gf_path_add_line_to(paths[2], w*4/5, h);
+	gf_path_add_line_to(paths[2], 0, h*2/5);
+	gf_path_add_line_to(paths[2], w, h*2/5);
+	gf_path_add_line_to(paths[2], w/5, h);
+	gf_path_close(paths[2]);
+	/*thin slanted shapes, short spans of any length and alignment*/
+	for (i=0; i<20; i++) {
+		Fixed x = INT2FIX(7*i + 3) + FIX_ONE/3;
+		gf_path_add_move_to(paths[3], x, 0);
+		gf_path_add_line_to(paths[3], x + INT2FIX(1+i) + FIX_ONE/7, 0);
+		gf_path_add_line_to(paths[3], x + w/3, h);
+		gf_path_add_line_to(paths[3], x + w/3 - INT2FIX(2), h);
+		gf_path_close(paths[3]);
+	}
+	/*rectangle with fractional edges*/
+	gf_path_add_rect_center(paths[4], w/3 + FIX_ONE/4, h/3 + FIX_ONE/3, w/2 + FIX_ONE/5, h/2 + FIX_ONE/2);
+	/*small ellipses, tails only*/
+	for (i=0; i<10; i++) {
+		gf_path_add_ellipse(paths[5], INT2FIX(10 + 23*i), INT2FIX(10 + 17*i), INT2FIX(3 + i), INT2FIX(2 + 2*i));
+	}
+
+	solid = evg_stencil_new(NULL, GF_STENCIL_SOLID);
+	evg_stencil_set_brush_color(solid, GF_COL_ARGB(0xFF, 0x20, 0xC0, 0x7F));
+	solid_alpha = evg_stencil_new(NULL, GF_STENCIL_SOLID);
+	evg_stencil_set_brush_color(solid_alpha, GF_COL_ARGB(0x80, 0xF0, 0x30, 0xA5));
+
+	/*gradients go through fully transparent, opaque and semi-transparent colors*/
+	pos[0] = 0;
+	pos[1] = FIX_ONE/3;
+	pos[2] = 2*FIX_ONE/3;
+	pos[3] = FIX_ONE;
+	cols[0] = GF_COL_ARGB(0x00, 0xFF, 0x00, 0x00);
+	cols[1] = GF_COL_ARGB(0xFF, 0x00, 0xFF, 0x00);
+	cols[2] = GF_COL_ARGB(0x40, 0x00, 0x00, 0xFF);
+	cols[3] = GF_COL_ARGB(0xFF, 0xFF, 0xFF, 0x00);
+
+	linear = evg_stencil_new(NULL, GF_STENCIL_LINEAR_GRADIENT);
+	evg_stencil_set_linear_gradient(linear, 0, 0, FIX_ONE, FIX_ONE/2);
+	evg_stencil_set_gradient_interpolation(linear, pos, cols, 4);
+	evg_stencil_set_gradient_mode(linear, GF_GRADIENT_MODE_REPEAT);
+
+	radial = evg_stencil_new(NULL, GF_STENCIL_RADIAL_GRADIENT);
+	evg_stencil_set_radial_gradient(radial, FIX_ONE/2, FIX_ONE/2, FIX_ONE/3, FIX_ONE/2, FIX_ONE/2, FIX_ONE/2);
+	evg_stencil_set_gradient_interpolation(radial, pos, cols, 4);
+}
+
+static void del_scene()
+{
+	u32 i;
+	for (i=0; i<NB_PATHS; i++) gf_path_del(paths[i]);
+	evg_stencil_delete(solid);
+	evg_stencil_delete(solid_alpha);
+	evg_stencil_delete(linear);
+	evg_stencil_delete(radial);
+}
+
+/*fills the background with pseudo-random pixels, with a band of zero-alpha pixels for formats with alpha*/
+static void fill_background(u8 *data, u32 size, u32 pitch)
+{
+	u32 i, seed = 0x12345678;
+	for (i=0; i<size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (u8) (seed >> 16);
+	}
+	for (i=0; i+3<size; i+=4) {
+		if ((i / pitch) % 16 < 4) data[i+3] = 0;
+	}
+}
+
+static void draw_scene(GF_SURFACE surf)
+{
+	u32 i;
+	GF_STENCIL stencils[4];
+	stencils[0] = solid;
+	stencils[1] = solid_alpha;
+	stencils[2] = linear;
+	stencils[3] = radial;
+
+	for (i=0; i<NB_PATHS*4; i++) {
+		evg_surface_set_path(surf, paths[i % NB_PATHS]);
+		evg_surface_fill(surf, stencils[(i / NB_PATHS + i) % 4]);
+	}
+}
+
+static Bool check_format(const FormatDesc *fmt, u32 width, u32 height, u32 nb_loops)
+{
+	u32 i, pitch, size;
+	u8 *ref, *test;
+	u64 ref_time, simd_time;
+	Bool res = GF_TRUE;
+	EVGSurface *surf = (EVGSurface *) evg_surface_new(NULL, GF_FALSE);
+
+	pitch = width * fmt->bpp;
+	size = pitch * height;
+	ref = (u8*)gf_malloc(size);
+	test = (u8*)gf_malloc(size);
+	fill_background(ref, size, pitch);
+	memcpy(test, ref, size);
+
+	evg_surface_attach_to_buffer(surf, (char *) ref, width, height, fmt->bpp, pitch, fmt->pf);
+	surf->disable_simd = GF_TRUE;
+	draw_scene(surf);
+
+	evg_surface_attach_to_buffer(surf, (char *) test, width, height, fmt->bpp, pitch, fmt->pf);
+	surf->disable_simd = GF_FALSE;
+	draw_scene(surf);
+
+	if (memcmp(ref, test, size)) {
+		for (i=0; i<size; i++) {
+			if (ref[i] != test[i]) break;
+		}
+		fprintf(stderr, "%s: mismatch at pixel %d x %d byte %d - scalar %02X SIMD %02X\n", fmt->name, (i % pitch) / fmt->bpp, i / pitch, i % fmt->bpp, ref[i], test[i]);
+		res = GF_FALSE;
+	}
+
+	/*benchmark*/
+	ref_time = simd_time = 0;
+	if (nb_loops) {
+		u64 start;
+		surf->disable_simd = GF_TRUE;
+		start = gf_sys_clock_high_res();
+		for (i=0; i<nb_loops; i++) draw_scene(surf);
+		ref_time = gf_sys_clock_high_res() - start;
+
+		surf->disable_simd = GF_FALSE;
+		start = gf_sys_clock_high_res();
+		for (i=0; i<nb_loops; i++) draw_scene(surf);
+		simd_time = gf_sys_clock_high_res() - start;
+		if (!simd_time) simd_time = 1;
+	}
+	fprintf(stderr, "%s: %s - scalar "LLU" us SIMD "LLU" us (x%.2f)\n", fmt->name, res ? "OK" : "FAILED", ref_time, simd_time, nb_loops ? ((Double) (s64) ref_time) / (s64) simd_time : 0.0);
+
+	evg_surface_delete(surf);
+	gf_free(ref);
+	gf_free(test);
+	return res;
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: rastercheck [options]\n"
+	        "\t-w W:     surface width (default 643)\n"
+	        "\t-h H:     surface height (default 481)\n"
+	        "\t-loops N: number of scene redraws for the benchmark, 0 to disable (default 50)\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, width, height, nb_loops, nb_failed;
+
+	width = 643;
+	height = 481;
+	nb_loops = 50;
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (i+1 == (u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(arg, "-w")) width = atoi(argv[++i]);
+		else if (!strcmp(arg, "-h")) height = atoi(argv[++i]);
+		else if (!strcmp(arg, "-loops")) nb_loops = atoi(argv[++i]);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (!width || !height) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+	setup_scene(width, height);
+
+	nb_failed = 0;
+	for (i=0; i<sizeof(formats)/sizeof(FormatDesc); i++) {
+		if (!check_format(&formats[i], width, height, nb_loops)) nb_failed++;
+	}
+
+	del_scene();
+	gf_sys_close();
+	return nb_failed ? 1 : 0;
+}
@@ -0,0 +1,286 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - RTP reception benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/internal/ietf_dev.h>
+#include <gpac/network.h>
+
+/*checks the RTP packet reorderer on a sequence with reordering, losses, duplicates and sequence number wrapping and
+reports its speed, then compares single and batched datagram reception on the loopback interface*/
+
+#define PCK_SIZE	1328
+
+static u32 seed = 0x12345678;
+static u32 rnd()
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7FFF;
+}
+
+static void make_packet(char *pck, u16 sn)
+{
+	memset(pck, 0, PCK_SIZE);
+	pck[0] = (char) 0x80;
+	pck[1] = 33;
+	pck[2] = (sn>>8) & 0xFF;
+	pck[3] = sn & 0xFF;
+}
+
+static Bool check_reorderer(u32 nb_pck, u32 max_shuffle, u32 loss_pct, u32 dup_pct)
+{
+	u32 i, nb_out, nb_sent, nb_dup_sent, nb_dropped, start_sn;
+	u32 *order;
+	u16 last_out = 0;
+	u64 start, now;
+	Bool res = GF_TRUE;
+	char pck[PCK_SIZE];
+	GF_RTPReorder *po = gf_rtp_reorderer_new(100, 200);
+
+	/*start close to the wrapping point*/
+	start_sn = 0x10000 - nb_pck/3;
+	order = (u32*)gf_malloc(sizeof(u32) * nb_pck);
+	for (i=0; i<nb_pck; i++) order[i] = i;
+	/*shuffle blocks of max_shuffle packets, the first block is kept in order so that the queue starts at the expected position*/
+	for (i=max_shuffle; max_shuffle && (i<nb_pck); i++) {
+		u32 block_start = i - i % max_shuffle;
+		u32 block_size = MIN(max_shuffle, nb_pck - block_start);
+		u32 j = block_start + rnd() % block_size;
+		u32 t = order[i];
+		order[i] = order[j];
+		order[j] = t;
+	}
+
+	nb_out = nb_sent = nb_dup_sent = nb_dropped = 0;
+	start = gf_sys_clock_high_res();
+	for (i=0; i<nb_pck; i++) {
+		const char *out;
+		u32 size;
+		/*first packet is never lost, so that the queue starts at the expected position*/
+		if (i && (rnd() % 100 < loss_pct)) {
+			nb_dropped++;
+			continue;
+		}
+		make_packet(pck, (u16) (start_sn + order[i]));
+		gf_rtp_reorderer_add(po, pck, PCK_SIZE, (start_sn + order[i]) & 0xFFFF);
+		nb_sent++;
+		if (rnd() % 100 < dup_pct) {
+			gf_rtp_reorderer_add(po, pck, PCK_SIZE, (start_sn + order[i]) & 0xFFFF);
+			nb_dup_sent++;
+		}
+
+		while ((out = gf_rtp_reorderer_get_packet(po, &size, NULL)) != NULL) {
+			u16 sn = ((u8) out[2]) << 8 | (u8) out[3];
+			/*sequence numbers must increase, modulo 2^16*/
+			if ((size != PCK_SIZE) || (nb_out && ((s16) (sn - last_out) <= 0))) {
+				fprintf(stderr, "Reorderer: packet %d output after %d\n", sn, last_out);
+				res = GF_FALSE;
+			}
+			last_out = sn;
+			nb_out++;
+		}
+	}
+	now = gf_sys_clock_high_res();
+	/*flush*/
+	po->MaxDelay = 1;
+	while (po->Count) {
+		const char *out;
+		u32 size;
+		gf_sleep(2);
+		while ((out = gf_rtp_reorderer_get_packet(po, &size, NULL)) != NULL) {
+			u16 sn = ((u8) out[2]) << 8 | (u8) out[3];
+			if ((s16) (sn - last_out) <= 0) res = GF_FALSE;
+			last_out = sn;
+			nb_out++;
+		}
+	}
+	/*late packets are the only ones allowed to be missing, and there are none if packets are not shuffled beyond the queue size
+	duplicates of packets already output are counted as late*/
+	if (nb_out + po->nb_late + po->nb_duplicated != nb_sent + nb_dup_sent) res = GF_FALSE;
+	if ((max_shuffle < po->MaxCount) && po->nb_late) res = GF_FALSE;
+
+	fprintf(stderr, "Reorderer (shuffle %d loss %d%% dup %d%%): %s - %d sent %d output - %d lost %d late %d duplicated %d reordered - %.1f ns per packet\n",
+	        max_shuffle, loss_pct, dup_pct, res ? "OK" : "FAILED", nb_sent, nb_out, po->nb_lost, po->nb_late, po->nb_duplicated, po->nb_reordered,
+	        ((Double) (s64) (now-start)) * 1000 / nb_pck);
+
+	gf_rtp_reorderer_del(po);
+	gf_free(order);
+	return res;
+}
+
+/*checks the reorderer resyncs on a sender restart with a lower sequence number once packets have been output*/
+static Bool check_restart(u32 nb_pck)
+{
+	u32 i, nb_out = 0;
+	Bool res;
+	char pck[PCK_SIZE];
+	GF_RTPReorder *po = gf_rtp_reorderer_new(100, 200);
+
+	for (i=0; i<10; i++) {
+		const char *out;
+		u32 size;
+		u32 sn = (i<5) ? 40005 + i : 30000 + i - 5;
+		make_packet(pck, (u16) sn);
+		gf_rtp_reorderer_add(po, pck, PCK_SIZE, sn);
+		while ((out = gf_rtp_reorderer_get_packet(po, &size, NULL)) != NULL) nb_out++;
+	}
+	for (i=5; i<nb_pck; i++) {
+		const char *out;
+		u32 size;
+		make_packet(pck, (u16) (30000 + i));
+		gf_rtp_reorderer_add(po, pck, PCK_SIZE, 30000 + i);
+		while ((out = gf_rtp_reorderer_get_packet(po, &size, NULL)) != NULL) nb_out++;
+	}
+	/*all packets after the restart but the ones still queued must be output*/
+	res = (nb_out + po->Count >= nb_pck) ? GF_TRUE : GF_FALSE;
+	fprintf(stderr, "Reorderer (restart): %s - %d sent %d output %d late\n", res ? "OK" : "FAILED", nb_pck+5, nb_out, po->nb_late);
+	gf_rtp_reorderer_del(po);
+	return res;
+}
+
+static void bench_socket(u32 nb_pck, u32 burst, u16 port)
+{
+	u32 i, j, run;
+	char *buffers[GF_RTP_RECV_BATCH];
+	u32 sizes[GF_RTP_RECV_BATCH];
+	u64 ntp[GF_RTP_RECV_BATCH];
+	char pck[PCK_SIZE];
+	GF_Socket *rx = gf_sk_new(GF_SOCK_TYPE_UDP);
+	GF_Socket *tx = gf_sk_new(GF_SOCK_TYPE_UDP);
+
+	if (gf_sk_bind(rx, "127.0.0.1", port, NULL, 0, GF_SOCK_REUSE_PORT) || gf_sk_bind(tx, "127.0.0.1", port+2, "127.0.0.1", port, GF_SOCK_REUSE_PORT)) {
+		fprintf(stderr, "Cannot setup loopback sockets on port %d\n", port);
+		gf_sk_del(rx);
+		gf_sk_del(tx);
+		return;
+	}
+	gf_sk_set_buffer_size(rx, GF_FALSE, 0x800000);
+	for (i=0; i<GF_RTP_RECV_BATCH; i++) buffers[i] = (char*)gf_malloc(GF_RTP_RECV_MAX_SIZE);
+
+	/*run 0 receives datagrams one by one, run 1 by batches*/
+	for (run=0; run<2; run++) {
+		u64 recv_time = 0;
+		u32 nb_recv = 0, nb_calls = 0, nb_ts_errors = 0;
+		for (i=0; i<nb_pck; i+=burst) {
+			u64 start, last_ntp = 0;
+			u32 nb_burst = 0;
+			for (j=0; j<burst; j++) {
+				make_packet(pck, (u16) (i+j));
+				gf_sk_send(tx, pck, PCK_SIZE);
+			}
+			start = gf_sys_clock_high_res();
+			while (nb_burst<burst) {
+				u32 nb_read = 0;
+				if (run) {
+					if (gf_sk_receive_batch(rx, buffers, GF_RTP_RECV_MAX_SIZE, sizes, ntp, GF_RTP_RECV_BATCH, &nb_read)) break;
+					for (j=0; j<nb_read; j++) {
+						if (!ntp[j] || (ntp[j] < last_ntp)) nb_ts_errors++;
+						last_ntp = ntp[j];
+					}
+				} else {
+					if (gf_sk_receive(rx, buffers[0], GF_RTP_RECV_MAX_SIZE, 0, &sizes[0])) break;
+					nb_read = 1;
+				}
+				nb_calls++;
+				nb_burst += nb_read;
+			}
+			recv_time += gf_sys_clock_high_res() - start;
+			nb_recv += nb_burst;
+		}
+		fprintf(stderr, "%s reception: %d/%d datagrams in %d calls - %.2f us per datagram%s\n", run ? "Batched" : "Single", nb_recv, nb_pck, nb_calls,
+		        nb_recv ? ((Double) (s64) recv_time) / nb_recv : 0.0, (run && nb_ts_errors) ? " - invalid arrival times" : "");
+	}
+
+	/*datagrams larger than the reception buffers must be dropped, not passed up truncated*/
+	{
+		u32 nb_read = 0, nb_bad = 0;
+		char *big = (char*)gf_malloc(GF_RTP_RECV_MAX_SIZE + 100);
+		make_packet(pck, 1);
+		gf_sk_send(tx, pck, PCK_SIZE);
+		memset(big, 0, GF_RTP_RECV_MAX_SIZE + 100);
+		gf_sk_send(tx, big, GF_RTP_RECV_MAX_SIZE + 100);
+		gf_sk_send(tx, pck, PCK_SIZE);
+		gf_free(big);
+		gf_sleep(10);
+		if (!gf_sk_receive_batch(rx, buffers, GF_RTP_RECV_MAX_SIZE, sizes, ntp, GF_RTP_RECV_BATCH, &nb_read)) {
+			for (i=0; i<nb_read; i++) {
+				if (sizes[i] != PCK_SIZE) nb_bad++;
+			}
+		}
+		fprintf(stderr, "Oversized datagram: %d datagrams received, %d truncated\n", nb_read, nb_bad);
+	}
+
+	for (i=0; i<GF_RTP_RECV_BATCH; i++) gf_free(buffers[i]);
+	gf_sk_del(rx);
+	gf_sk_del(tx);
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: rtpbench [options]\n"
+	        "\t-n N:     number of packets (default 200000)\n"
+	        "\t-burst N: number of packets sent before reception in the socket test (default 64)\n"
+	        "\t-port P:  loopback port for the socket test, 0 to disable (default 9000)\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, nb_pck, burst, port, nb_failed;
+
+	nb_pck = 200000;
+	burst = 64;
+	port = 9000;
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (i+1 == (u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(arg, "-n")) nb_pck = atoi(argv[++i]);
+		else if (!strcmp(arg, "-burst")) burst = atoi(argv[++i]);
+		else if (!strcmp(arg, "-port")) port = atoi(argv[++i]);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if ((nb_pck<100) || !burst) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+
+	nb_failed = 0;
+	if (!check_reorderer(nb_pck, 0, 0, 0)) nb_failed++;
+	if (!check_reorderer(nb_pck, 8, 0, 0)) nb_failed++;
+	if (!check_reorderer(nb_pck, 40, 2, 1)) nb_failed++;
+	if (!check_reorderer(nb_pck, 150, 5, 5)) nb_failed++;
+	if (!check_restart(5000)) nb_failed++;
+
+	if (port) bench_socket(nb_pck, burst, (u16) port);
+
+	gf_sys_close();
+	return nb_failed ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - RTP streamer engine benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/rtp_streamer.h>
+#include <gpac/constants.h>
+#include <time.h>
+
+/*streams synthetic video sessions to the loopback interface through the RTP streamer engine, once sending packets
+one by one and once by batches, and reports the CPU load and how late AUs are sent compared to their schedule*/
+
+typedef struct
+{
+	GF_RTPStreamer *streamer;
+	char *au;
+	u32 au_size, fps, nb_au, au_idx;
+	/*clock at session addition, in microseconds*/
+	u64 start;
+	u64 last_send_time;
+	u64 total_late, max_late;
+} BenchSession;
+
+static Bool fetch_au(void *udta, char **data, u32 *size, u64 *cts, u64 *dts, Bool *is_rap, u64 *send_time)
+{
+	BenchSession *bs = (BenchSession *)udta;
+	if (bs->au_idx) {
+		u64 late, now = gf_sys_clock_high_res() - bs->start;
+		late = (now > bs->last_send_time) ? now - bs->last_send_time : 0;
+		bs->total_late += late;
+		if (late > bs->max_late) bs->max_late = late;
+	}
+	if (bs->au_idx == bs->nb_au) return GF_FALSE;
+
+	*data = bs->au;
+	/*one large AU per second, the others a quarter of it*/
+	*size = (bs->au_idx % bs->fps) ? bs->au_size/4 : bs->au_size;
+	*cts = *dts = bs->au_idx * 1000 / bs->fps;
+	*is_rap = (bs->au_idx % bs->fps) ? GF_FALSE : GF_TRUE;
+	*send_time = bs->last_send_time = ((u64) bs->au_idx) * 1000000 / bs->fps;
+	bs->au_idx++;
+	return GF_TRUE;
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: rtpstreamer [options]\n"
+	        "\t-n N:       number of sessions (default 200)\n"
+	        "\t-threads N: number of engine threads (default 2)\n"
+	        "\t-dur D:     duration of each run in seconds (default 5)\n"
+	        "\t-fps F:     AU rate of each session (default 25)\n"
+	        "\t-size S:    size of the random access AUs (default 40000)\n"
+	        "\t-port P:    first destination port on the loopback interface (default 10000)\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, run, nb_sess, nb_threads, dur, fps, au_size, port;
+	BenchSession *sessions;
+	char *au;
+
+	nb_sess = 200;
+	nb_threads = 2;
+	dur = 5;
+	fps = 25;
+	au_size = 40000;
+	port = 10000;
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (i+1 == (u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(arg, "-n")) nb_sess = atoi(argv[++i]);
+		else if (!strcmp(arg, "-threads")) nb_threads = atoi(argv[++i]);
+		else if (!strcmp(arg, "-dur")) dur = atoi(argv[++i]);
+		else if (!strcmp(arg, "-fps")) fps = atoi(argv[++i]);
+		else if (!strcmp(arg, "-size")) au_size = atoi(argv[++i]);
+		else if (!strcmp(arg, "-port")) port = atoi(argv[++i]);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (!nb_sess || !dur || !fps || (au_size<4) || (port + 2*nb_sess > 0xFFFF)) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+
+	au = (char*)gf_malloc(au_size);
+	memset(au, 0x5A, au_size);
+	sessions = (BenchSession*)gf_malloc(sizeof(BenchSession) * nb_sess);
+
+	/*run 0 sends packets one by one, run 1 by batches*/
+	for (run=0; run<2; run++) {
+		u64 start, total_late, max_late, nb_au;
+		clock_t cpu;
+		GF_RTPStreamerEngine *engine;
+		u32 nb_failed = 0;
+
+		memset(sessions, 0, sizeof(BenchSession) * nb_sess);
+		engine = gf_rtp_streamer_engine_new(nb_threads, 1000, run ? 64 : 0);
+		cpu = clock();
+		start = gf_sys_clock_high_res();
+		for (i=0; i<nb_sess; i++) {
+			BenchSession *bs = &sessions[i];
+			bs->streamer = gf_rtp_streamer_new(GF_STREAM_VISUAL, GPAC_OTI_VIDEO_MPEG4_PART2, 1000, "127.0.0.1", (u16) (port + 2*i), 1450, 1, NULL, 0, NULL, 0);
+			if (!bs->streamer) {
+				nb_failed++;
+				continue;
+			}
+			bs->au = au;
+			bs->au_size = au_size;
+			bs->fps = fps;
+			bs->nb_au = dur * fps;
+			bs->start = gf_sys_clock_high_res();
+			gf_rtp_streamer_engine_add(engine, bs->streamer, fetch_au, bs);
+		}
+		while (gf_rtp_streamer_engine_get_session_count(engine, GF_TRUE)) gf_sleep(50);
+
+		total_late = max_late = nb_au = 0;
+		for (i=0; i<nb_sess; i++) {
+			BenchSession *bs = &sessions[i];
+			if (!bs->streamer) continue;
+			gf_rtp_streamer_engine_remove(engine, bs->streamer);
+			gf_rtp_streamer_del(bs->streamer);
+			total_late += bs->total_late;
+			if (bs->max_late > max_late) max_late = bs->max_late;
+			nb_au += bs->au_idx;
+		}
+		cpu = clock() - cpu;
+		gf_rtp_streamer_engine_del(engine);
+
+		fprintf(stderr, "%s sending: %d sessions (%d failed) - "LLU" AUs in "LLU" ms - CPU %.1f%% - AU lateness avg %.0f us max "LLU" us\n",
+		        run ? "Batched" : "Single", nb_sess, nb_failed, nb_au, (gf_sys_clock_high_res() - start) / 1000,
+		        ((Double) cpu) * 100 / CLOCKS_PER_SEC / dur,
+		        nb_au ? ((Double) (s64) total_late) / (s64) nb_au : 0.0, max_late);
+	}
+
+	gf_free(sessions);
+	gf_free(au);
+	gf_sys_close();
+	return 0;
+}
@@ -0,0 +1,203 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - socket group benchmark
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/network.h>
+
+#ifdef WIN32
+#include <winsock2.h>
+#else
+#include <sys/select.h>
+#endif
+
+/*registers many idle and a few active UDP sockets on the loopback interface in a socket group, sends datagrams to a
+random subset of the active sockets and measures the time needed to wait for and dispatch them. The same loop is run
+with a plain select() on all sockets, as the socket group used to do, when all descriptors fit in an fd_set*/
+
+static u32 seed = 0x12345678;
+static u32 rnd()
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7FFF;
+}
+
+static Bool select_wait(GF_Socket **socks, u32 nb_socks, fd_set *group)
+{
+	u32 i, max_fd = 0;
+	struct timeval timeout;
+	FD_ZERO(group);
+	for (i=0; i<nb_socks; i++) {
+		s32 fd = gf_sk_get_handle(socks[i]);
+		FD_SET(fd, group);
+		if (max_fd < (u32) fd) max_fd = fd;
+	}
+	timeout.tv_sec = 0;
+	timeout.tv_usec = 1000;
+	return (select(max_fd+1, group, NULL, NULL, &timeout) > 0) ? GF_TRUE : GF_FALSE;
+}
+
+/*returns the number of received datagrams*/
+static u32 run_test(GF_Socket **socks, u32 nb_socks, GF_Socket **tx, u32 nb_active, u32 nb_rounds, u32 burst, Bool use_select, u64 *wait_time, u32 *nb_waits)
+{
+	u32 i, r, nb_recv = 0, nb_sent = 0;
+	GF_SockGroup *sg = NULL;
+	fd_set group;
+	char buf[1500];
+	/*active sockets are the last ones*/
+	GF_Socket **active = socks + nb_socks - nb_active;
+
+	if (!use_select) {
+		sg = gf_sk_group_new();
+		for (i=0; i<nb_socks; i++) gf_sk_group_register(sg, socks[i]);
+	}
+	*wait_time = 0;
+	*nb_waits = 0;
+	memset(buf, 0, sizeof(buf));
+	for (r=0; r<nb_rounds; r++) {
+		u32 round_recv = 0;
+		for (i=0; i<burst; i++) {
+			if (!gf_sk_send(tx[rnd() % nb_active], buf, 200)) nb_sent++;
+		}
+		/*wait and dispatch until all datagrams of the round are received*/
+		while (nb_recv + round_recv < nb_sent) {
+			u64 start = gf_sys_clock_high_res();
+			Bool ok;
+			if (use_select) {
+				ok = select_wait(socks, nb_socks, &group);
+			} else {
+				ok = gf_sk_group_select(sg, 1000) ? GF_FALSE : GF_TRUE;
+			}
+			(*nb_waits)++;
+			if (!ok) {
+				*wait_time += gf_sys_clock_high_res() - start;
+				break;
+			}
+			for (i=0; i<nb_active; i++) {
+				u32 read;
+				Bool is_set = use_select ? FD_ISSET(gf_sk_get_handle(active[i]), &group) : gf_sk_group_sock_is_set(sg, active[i]);
+				if (!is_set) continue;
+				/*one datagram per wakeup, as the RTSP server and multicast receivers do*/
+				if (gf_sk_receive_no_select(active[i], buf, sizeof(buf), 0, &read) == GF_OK) round_recv++;
+			}
+			*wait_time += gf_sys_clock_high_res() - start;
+		}
+		nb_recv += round_recv;
+	}
+	if (sg) gf_sk_group_del(sg);
+	return nb_recv;
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: sockgroup [options]\n"
+	        "\t-idle N:   number of idle sockets (default 5000)\n"
+	        "\t-active N: number of active sockets (default 100)\n"
+	        "\t-rounds N: number of send rounds (default 2000)\n"
+	        "\t-burst N:  number of datagrams sent per round (default 20)\n"
+	        "\t-port P:   first port used on the loopback interface (default 20000)\n"
+	       );
+}
+
+int main(int argc, char **argv)
+{
+	u32 i, nb_idle, nb_active, nb_socks, nb_rounds, burst, port, run, nb_failed;
+	GF_Socket **socks, **tx;
+	Bool fits_fdset = GF_TRUE;
+
+	nb_idle = 5000;
+	nb_active = 100;
+	nb_rounds = 2000;
+	burst = 20;
+	port = 20000;
+	for (i=1; i<(u32) argc; i++) {
+		char *arg = argv[i];
+		if (i+1 == (u32) argc) {
+			usage();
+			return 1;
+		}
+		if (!strcmp(arg, "-idle")) nb_idle = atoi(argv[++i]);
+		else if (!strcmp(arg, "-active")) nb_active = atoi(argv[++i]);
+		else if (!strcmp(arg, "-rounds")) nb_rounds = atoi(argv[++i]);
+		else if (!strcmp(arg, "-burst")) burst = atoi(argv[++i]);
+		else if (!strcmp(arg, "-port")) port = atoi(argv[++i]);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	nb_socks = nb_idle + nb_active;
+	if (!nb_active || !nb_rounds || !burst || (port + nb_socks + nb_active > 0xFFFF)) {
+		usage();
+		return 1;
+	}
+
+	gf_sys_init(GF_FALSE);
+
+	socks = (GF_Socket **)gf_malloc(sizeof(GF_Socket *) * nb_socks);
+	tx = (GF_Socket **)gf_malloc(sizeof(GF_Socket *) * nb_active);
+	memset(tx, 0, sizeof(GF_Socket *) * nb_active);
+	nb_failed = 0;
+	for (i=0; i<nb_socks; i++) {
+		socks[i] = gf_sk_new(GF_SOCK_TYPE_UDP);
+		if (!socks[i] || gf_sk_bind(socks[i], "127.0.0.1", (u16) (port + i), NULL, 0, 0)) {
+			fprintf(stderr, "Cannot create socket %d on port %d - check the max number of open files\n", i, port + i);
+			nb_socks = i + (socks[i] ? 1 : 0);
+			nb_failed++;
+			break;
+		}
+		gf_sk_set_buffer_size(socks[i], GF_FALSE, 0x40000);
+		if (gf_sk_get_handle(socks[i]) >= FD_SETSIZE) fits_fdset = GF_FALSE;
+	}
+	for (i=0; !nb_failed && (i<nb_active); i++) {
+		tx[i] = gf_sk_new(GF_SOCK_TYPE_UDP);
+		if (gf_sk_bind(tx[i], "127.0.0.1", (u16) (port + nb_socks + i), "127.0.0.1", (u16) (port + nb_idle + i), 0)) {
+			fprintf(stderr, "Cannot create sending socket %d\n", i);
+			nb_failed++;
+		}
+	}
+
+	fprintf(stderr, "%d idle sockets - %d active sockets - %d rounds of %d datagrams\n", nb_idle, nb_active, nb_rounds, burst);
+	/*run 0 uses the socket group, run 1 a plain select*/
+	for (run=0; !nb_failed && (run<2); run++) {
+		u64 wait_time;
+		u32 nb_waits, nb_recv;
+		if (run && !fits_fdset) {
+			fprintf(stderr, "select: not possible, socket descriptors exceed FD_SETSIZE (%d)\n", FD_SETSIZE);
+			break;
+		}
+		nb_recv = run_test(socks, nb_socks, tx, nb_active, nb_rounds, burst, run ? GF_TRUE : GF_FALSE, &wait_time, &nb_waits);
+		fprintf(stderr, "%s: %d/%d datagrams received - %d wakeups - %.2f us per wakeup - %.2f us per datagram\n", run ? "select" : "socket group",
+		        nb_recv, nb_rounds*burst, nb_waits, nb_waits ? ((Double) (s64) wait_time) / nb_waits : 0.0, nb_recv ? ((Double) (s64) wait_time) / nb_recv : 0.0);
+		if (nb_recv != nb_rounds*burst) nb_failed++;
+	}
+
+	for (i=0; i<nb_socks; i++) gf_sk_del(socks[i]);
+	for (i=0; i<nb_active; i++) {
+		if (tx[i]) gf_sk_del(tx[i]);
+	}
+	gf_free(socks);
+	gf_free(tx);
+	gf_sys_close();
+	return nb_failed ? 1 : 0;
+}
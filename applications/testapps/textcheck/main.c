@@ -0,0 +1,222 @@
+/*
+ *			GPAC - Multimedia Framework C SDK
+ *
+ *			Authors: Jean Le Feuvre
+ *			Copyright (c) Telecom ParisTech 2016
+ *					All rights reserved
+ *
+ *  This file is part of GPAC - glyph cache text rendering check
+ *
+ *  GPAC is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  GPAC is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ */
+
+#include <gpac/terminal.h>
+#include <gpac/options.h>
+
+/*renders 2D text scenes in memory with [FontEngine] GlyphCache2D enabled, once drawing text from the glyph cache and once
+from the text outline (TextureTextMode "Never"), and checks both frames match. Text is placed on the pixel grid, so the
+only expected differences are antialiasing ones; a glyph texture misplaced by one pixel shows up as large differences*/
+
+/*MPEG-4 scene, y axis up - text drawn from the glyph cache*/
+static const char *bt_scene =
+    "InitialObjectDescriptor { objectDescriptorID 1 }\n"
+    "OrderedGroup { children [\n"
+    " Shape { geometry Rectangle { size 400 300 } appearance Appearance { material Material2D { emissiveColor 1 1 1 filled TRUE } } }\n"
+    " Transform2D { translation -140 60 children [ Shape { appearance Appearance { material Material2D { emissiveColor 0 0 0 filled TRUE } } geometry Text { string [\"IHIl gAy\"] fontStyle FontStyle { family [\"SANS\"] size 40 justify [\"BEGIN\" \"FIRST\"] } } } ] }\n"
+    " Transform2D { translation -137 -17 children [ Shape { appearance Appearance { material Material2D { emissiveColor 0 0 1 filled TRUE } } geometry Text { string [\"Hello World\" \"jump quickly\"] fontStyle FontStyle { family [\"SANS\"] size 24 justify [\"BEGIN\" \"FIRST\"] } } } ] }\n"
+    " Transform2D { translation -20 -90 children [ Shape { appearance Appearance { material Material2D { emissiveColor 0.5 0 0 filled TRUE } } geometry Text { string [\"small text 123\"] fontStyle FontStyle { family [\"SANS\"] size 12 justify [\"BEGIN\" \"FIRST\"] } } } ] }\n"
+    "]}\n";
+
+/*SVG scene, y axis down - text shall never be drawn from the glyph cache*/
+static const char *svg_scene =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"320\" height=\"240\" viewBox=\"0 0 320 240\">\n"
+    "<rect width=\"320\" height=\"240\" fill=\"white\"/>\n"
+    "<text x=\"20\" y=\"100\" font-size=\"40\" font-family=\"SANS\" fill=\"black\">IHIl gAy</text>\n"
+    "<text x=\"10\" y=\"180\" font-size=\"24\" font-family=\"SANS\" fill=\"blue\">Hello World</text>\n"
+    "</svg>\n";
+
+static Bool connected = GF_FALSE;
+
+static Bool event_proc(void *ptr, GF_Event *evt)
+{
+	if (evt->type == GF_EVENT_CONNECT) connected = evt->connect.is_connected;
+	return GF_FALSE;
+}
+
+static u32 get_bpp(GF_VideoSurface *fb)
+{
+	if (fb->pitch_x) return ABS(fb->pitch_x);
+	switch (fb->pixel_format) {
+	case GF_PIXEL_RGB_24:
+	case GF_PIXEL_BGR_24:
+		return 3;
+	case GF_PIXEL_RGB_565:
+	case GF_PIXEL_RGB_555:
+		return 2;
+	default:
+		return 4;
+	}
+}
+
+/*draws a frame in the given texture text mode and returns a copy of the frame*/
+static char *grab_frame(GF_Terminal *term, u32 text_mode, u32 *width, u32 *height, u32 *stride)
+{
+	u32 i, bpp;
+	char *data;
+	GF_VideoSurface fb;
+
+	gf_term_set_option(term, GF_OPT_TEXTURE_TEXT, text_mode);
+	/*changing the text mode does not invalidate the drawn areas, force a full redraw*/
+	gf_term_set_option(term, GF_OPT_REFRESH, 0);
+	for (i=0; i<5; i++) gf_term_process_flush(term);
+
+	if (gf_term_get_screen_buffer(term, &fb) != GF_OK) return NULL;
+	bpp = get_bpp(&fb);
+	*width = fb.width;
+	*height = fb.height;
+	*stride = fb.width*bpp;
+	data = gf_malloc(sizeof(char) * (*stride) * fb.height);
+	for (i=0; i<fb.height; i++) {
+		memcpy(data + i*(*stride), fb.video_buffer + i*fb.pitch_y, *stride);
+	}
+	gf_term_release_screen_buffer(term, &fb);
+	return data;
+}
+
+static Bool check_scene(GF_User *user, const char *name, const char *scene, Bool expect_cache)
+{
+	u32 i, w, h, stride, max_diff, nb_diff, nb_ink, hit_rate;
+	char *cached, *outline;
+	Bool ok = GF_TRUE, was_connected;
+	GF_Terminal *term;
+	FILE *f;
+
+	f = gf_fopen(name, "wt");
+	if (!f) {
+		fprintf(stderr, "Cannot create %s\n", name);
+		return GF_FALSE;
+	}
+	fputs(scene, f);
+	gf_fclose(f);
+
+	term = gf_term_new(user);
+	if (!term) {
+		fprintf(stderr, "Cannot create terminal\n");
+		gf_delete_file(name);
+		return GF_FALSE;
+	}
+	connected = GF_FALSE;
+	gf_term_connect(term, name);
+	for (i=0; (i<1000) && !connected; i++) gf_term_process_flush(term);
+
+	cached = grab_frame(term, GF_TEXTURE_TEXT_DEFAULT, &w, &h, &stride);
+	hit_rate = gf_term_get_option(term, GF_OPT_GLYPH_CACHE_HIT_RATE);
+	outline = grab_frame(term, GF_TEXTURE_TEXT_NEVER, &w, &h, &stride);
+
+	/*disconnecting resets the connection flag*/
+	was_connected = connected;
+	gf_term_disconnect(term);
+	gf_term_del(term);
+	gf_delete_file(name);
+
+	if (!was_connected || !cached || !outline) {
+		fprintf(stderr, "%s: failed to render scene\n", name);
+		if (cached) gf_free(cached);
+		if (outline) gf_free(outline);
+		return GF_FALSE;
+	}
+
+	max_diff = nb_diff = nb_ink = 0;
+	for (i=0; i<stride*h; i++) {
+		u32 diff = ABS((s32) (u8) cached[i] - (s32) (u8) outline[i]);
+		if (diff) nb_diff++;
+		if (diff > max_diff) max_diff = diff;
+		if ((u8) outline[i] < 128) nb_ink++;
+	}
+	gf_free(cached);
+	gf_free(outline);
+
+	fprintf(stderr, "%s: %dx%d - glyph cache hit rate %d %% - %d components differ - max difference %d\n", name, w, h, hit_rate, nb_diff, max_diff);
+	if (!nb_ink) {
+		fprintf(stderr, "%s: no text drawn, check the [FontEngine] settings\n", name);
+		ok = GF_FALSE;
+	}
+	if (expect_cache && !hit_rate) {
+		fprintf(stderr, "%s: glyph cache not used\n", name);
+		ok = GF_FALSE;
+	}
+	/*antialiasing differences only*/
+	if (max_diff > 64) {
+		fprintf(stderr, "%s: text drawn from the glyph cache differs from outline text\n", name);
+		ok = GF_FALSE;
+	}
+	/*text not eligible to the glyph cache must be drawn as before*/
+	if (!expect_cache && nb_diff) {
+		fprintf(stderr, "%s: text drawn differently while glyph cache shall not be used\n", name);
+		ok = GF_FALSE;
+	}
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	GF_User user;
+	Bool ok = GF_TRUE;
+	char *opt, *prev_video, *prev_audio, *prev_cache;
+
+	gf_sys_init(GF_MemTrackerNone);
+	gf_log_set_tool_level(GF_LOG_ALL, GF_LOG_WARNING);
+
+	memset(&user, 0, sizeof(GF_User));
+	user.config = gf_cfg_init(NULL, NULL);
+	if (!user.config) {
+		fprintf(stderr, "Cannot load GPAC configuration\n");
+		gf_sys_close();
+		return 1;
+	}
+	user.modules = gf_modules_new(NULL, user.config);
+	user.EventProc = event_proc;
+	user.opaque = &user;
+	user.init_flags = GF_TERM_NO_DECODER_THREAD | GF_TERM_NO_COMPOSITOR_THREAD | GF_TERM_NO_REGULATION | GF_TERM_NO_AUDIO | GF_TERM_INIT_HIDE;
+
+	/*render in memory, restore the user settings when done*/
+	opt = (char *) gf_cfg_get_key(user.config, "Video", "DriverName");
+	prev_video = opt ? gf_strdup(opt) : NULL;
+	opt = (char *) gf_cfg_get_key(user.config, "Audio", "DriverName");
+	prev_audio = opt ? gf_strdup(opt) : NULL;
+	opt = (char *) gf_cfg_get_key(user.config, "FontEngine", "GlyphCache2D");
+	prev_cache = opt ? gf_strdup(opt) : NULL;
+	gf_cfg_set_key(user.config, "Video", "DriverName", "Raw Video Output");
+	gf_cfg_set_key(user.config, "Audio", "DriverName", "Raw Audio Output");
+	gf_cfg_set_key(user.config, "FontEngine", "GlyphCache2D", "yes");
+
+	if (!check_scene(&user, "textcheck.bt", bt_scene, GF_TRUE)) ok = GF_FALSE;
+	if (!check_scene(&user, "textcheck.svg", svg_scene, GF_FALSE)) ok = GF_FALSE;
+
+	gf_cfg_set_key(user.config, "Video", "DriverName", prev_video);
+	gf_cfg_set_key(user.config, "Audio", "DriverName", prev_audio);
+	gf_cfg_set_key(user.config, "FontEngine", "GlyphCache2D", prev_cache);
+	if (prev_video) gf_free(prev_video);
+	if (prev_audio) gf_free(prev_audio);
+	if (prev_cache) gf_free(prev_cache);
+
+	gf_modules_del(user.modules);
+	gf_cfg_del(user.config);
+	gf_sys_close();
+
+	fprintf(stderr, ok ? "OK\n" : "FAILED\n");
+	return ok ? 0 : 1;
+}
@@ -554,6 +554,18 @@ u64 gf_bs_get_refreshed_size(GF_BitStream *bs);
 GF_Err gf_bs_transfer(GF_BitStream *dst, GF_BitStream *src);
 
 
+/*!
+ *\brief copies a range of a file in the bitstream
+ *
+ *Writes a byte range of a source file at the current bitstream position. For file-based bitstreams, the copy is done by the kernel when possible (copy_file_range or sendfile on Linux), without going through user memory.
+ *\param bs the target bitstream
+ *\param src the source file
+ *\param src_offset the start of the range in the source file
+ *\param size the size of the range in bytes
+ *\return the number of bytes written
+ */
+u64 gf_bs_write_file_range(GF_BitStream *bs, FILE *src, u64 src_offset, u64 size);
+
 /*!
  *\brief Flushes bitstream content to disk
  *
@@ -262,6 +262,40 @@ typedef struct
  */
 GF_Err gf_stretch_bits(GF_VideoSurface *dst, GF_VideoSurface *src, GF_Window *dst_wnd, GF_Window *src_wnd, u8 alpha, Bool flip, GF_ColorKey *colorKey, GF_ColorMatrix * cmat);
 
+/*!software stretch thread pool*/
+typedef struct _stretch_pool GF_StretchPool;
+
+/*!\brief creates a software stretch thread pool
+ *
+ * Creates a pool of threads used by \ref gf_stretch_bits_ex. Large stretches are split in bands of destination rows, each band being processed by one thread. A pool splits one stretch at a time, concurrent stretches on the same pool are not split.
+ *\param nb_threads number of threads, including the calling one. 0 uses as many threads as CPU cores
+ *\return the new pool, or NULL if nb_threads is 1 or if the pool could not be created
+ */
+GF_StretchPool *gf_stretch_pool_new(u32 nb_threads);
+
+/*!\brief destroys a software stretch thread pool
+ *
+ * Destroys a pool of stretch threads. The pool shall not be used by any stretch in progress.
+ *\param pool the pool to destroy
+ */
+void gf_stretch_pool_del(GF_StretchPool *pool);
+
+/*!\brief stretches two video surfaces using a thread pool
+ *
+ * Same as \ref gf_stretch_bits, splitting large stretches on the threads of the given pool.
+ *\param pool stretch thread pool. If null the stretch runs on the calling thread
+ *\param dst destination surface
+ *\param src source surface
+ *\param dst_wnd destination rectangle. If null the entire destination surface is used
+ *\param src_wnd source rectangle. If null the entire source surface is used
+ *\param alpha blend factor of source over alpha
+ *\param flip flips the source
+ *\param colorKey makes source pixel matching the color key transparent
+ *\param cmat applies color matrix to the source
+ *\return error code if any
+ */
+GF_Err gf_stretch_bits_ex(GF_StretchPool *pool, GF_VideoSurface *dst, GF_VideoSurface *src, GF_Window *dst_wnd, GF_Window *src_wnd, u8 alpha, Bool flip, GF_ColorKey *colorKey, GF_ColorMatrix * cmat);
+
 
 /*!\brief copies YUV 420 10 bits to YUV destination (only YUV420 8 bits supported)
  *
@@ -133,6 +133,18 @@ const char *gf_cfg_get_ikey(GF_Config *cfgFile, const char *secName, const char
  *\note this will also create both section and key if they are not found in the configuration file
  */
 GF_Err gf_cfg_set_key(GF_Config *cfgFile, const char *secName, const char *keyName, const char *keyValue);
+/*!
+ *	\brief multiple key values update
+ *
+ *Sets several key values of a section in one call. The section is looked up once, and removed keys are purged from the section in a single pass, which makes this faster than successive calls to \ref gf_cfg_set_key on large sections.
+ *\param cfgFile the target configuration file
+ *\param secName the desired keys parent section name
+ *\param nb_keys the number of keys to update
+ *\param keyNames the desired key names
+ *\param keyValues the desired key values - a NULL value removes the key
+ *\note this will also create both section and keys if they are not found in the configuration file
+ */
+GF_Err gf_cfg_set_keys(GF_Config *cfgFile, const char *secName, u32 nb_keys, const char **keyNames, const char **keyValues);
 /*!
  *	\brief section count query
  *
@@ -169,6 +181,16 @@ u32 gf_cfg_get_key_count(GF_Config *cfgFile, const char *secName);
  *\return the key name if found, NULL otherwise
  */
 const char *gf_cfg_get_key_name(GF_Config *cfgFile, const char *secName, u32 keyIndex);
+/*!
+ *	\brief key value query by index
+ *
+ *Gets the value of a key in a section of the configuration file based on its index, avoiding a lookup by name when enumerating a section
+ *\param cfgFile the target configuration file
+ *\param secName the target section
+ *\param keyIndex 0-based index of the key in the section
+ *\return the key value if found, NULL otherwise
+ */
+const char *gf_cfg_get_key_value(GF_Config *cfgFile, const char *secName, u32 keyIndex);
 
 /*!
  *	\brief key insertion
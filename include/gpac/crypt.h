@@ -67,9 +67,19 @@ typedef enum {
 	GF_AES_128 = 0
 } GF_CRYPTO_ALGO;
 
+typedef enum {
+	/*AES-NI when supported by the CPU, OpenSSL or built-in AES otherwise*/
+	GF_CRYPTO_BACKEND_AUTO = 0,
+	/*OpenSSL if available, built-in AES otherwise*/
+	GF_CRYPTO_BACKEND_SOFT,
+	/*AES-NI (and VAES if available) - fails if the CPU does not support it*/
+	GF_CRYPTO_BACKEND_AESNI
+} GF_CRYPTO_BACKEND;
 
 /*opens crypto context*/
 GF_Crypt *gf_crypt_open(GF_CRYPTO_ALGO algorithm, GF_CRYPTO_MODE mode);
+/*opens crypto context using the given backend, returns NULL if not available*/
+GF_Crypt *gf_crypt_open_ex(GF_CRYPTO_ALGO algorithm, GF_CRYPTO_MODE mode, GF_CRYPTO_BACKEND backend);
 /*close crypto context*/
 void gf_crypt_close(GF_Crypt *gfc);
 
@@ -103,6 +113,24 @@ GF_Err gf_crypt_encrypt(GF_Crypt *gfc, void *plaintext, u32 len);
 /*decryption function. It is almost the same with gf_crypt_generic.*/
 GF_Err gf_crypt_decrypt(GF_Crypt *gfc, void *ciphertext, u32 len);
 
+/*range of data encrypted with its own IV, independently of other ranges*/
+typedef struct
+{
+	u8 *data;
+	u32 size;
+	/*IV (CBC) or initial counter block (CTR) of the range*/
+	u8 IV[16];
+} GF_CryptRange;
+
+/*
+encrypts several independent ranges in a single call, typically the samples or subsamples of a fragment. Depending on
+the backend, ranges are processed in parallel, which is much faster than successive calls for CBC. In CBC mode, only
+the complete blocks of each range are encrypted. The IV state of the context is not modified.
+*/
+GF_Err gf_crypt_encrypt_ranges(GF_Crypt *gfc, GF_CryptRange *ranges, u32 nb_ranges);
+/*decrypts several independent ranges in a single call, see gf_crypt_encrypt_ranges*/
+GF_Err gf_crypt_decrypt_ranges(GF_Crypt *gfc, GF_CryptRange *ranges, u32 nb_ranges);
+
 
 /*! @} */
 
@@ -644,6 +644,14 @@ GF_Err gf_rtp_send_bye(GF_RTPChannel *ch,
 write the header in place*/
 GF_Err gf_rtp_send_packet(GF_RTPChannel *ch, GF_RTPHeader *rtp_hdr, char *pck, u32 pck_size, Bool fast_send);
 
+/*sets the number of RTP packets queued by gf_rtp_send_packet before being sent in one go, using as few
+system calls as possible. Queued packets are sent when the queue is full or when gf_rtp_flush_packets is called.
+0 (default) sends packets right away. The channel must be initialized as a source*/
+GF_Err gf_rtp_set_send_batch(GF_RTPChannel *ch, u32 nb_packets);
+
+/*sends the RTP packets queued on the channel*/
+GF_Err gf_rtp_flush_packets(GF_RTPChannel *ch);
+
 enum
 {
 	GF_RTCP_INFO_NAME = 0,
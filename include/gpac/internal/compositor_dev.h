@@ -53,8 +53,8 @@ extern "C" {
 //#define GF_SR_EVENT_QUEUE
 
 
-/*use 2D caching for groups*/
-//#define GF_SR_USE_VIDEO_CACHE
+/*use 2D caching for groups - caching is only active when [Compositor] VideoCacheSize is not 0*/
+#define GF_SR_USE_VIDEO_CACHE
 
 //#define GPAC_USE_TINYGL
 
@@ -518,6 +518,8 @@ struct __tag_compositor
 	Bool disable_yuvgl;
 	//use PBO to start pushing textures at the beginning of the render pass
 	Bool enable_pbo;
+	/*number of PBOs cycled for each texture plane when PBOs are enabled*/
+	u32 pbo_count;
 
 	u32 default_navigation_mode;
 
@@ -565,6 +567,11 @@ struct __tag_compositor
 
 	Bool texture_from_decoder_memory;
 
+	/*software stretch threads of this compositor, NULL if stretches run on the calling thread*/
+	GF_StretchPool *stretch_pool;
+	/*StretchThreads setting plus one, 0 if not loaded*/
+	u32 stretch_threads;
+
 	u32 networks_time;
 	u32 decoders_time;
 
@@ -572,11 +579,21 @@ struct __tag_compositor
 	u32 traverse_setup_time;
 	u32 traverse_and_direct_draw_time;
 	u32 indirect_draw_time;
+	/*time in microseconds spent uploading textures to the GPU during the current cycle*/
+	u32 texture_upload_time;
+	/*cumulated texture upload time and frame draw time (without texture upload) in microseconds, and number of frames
+	drawn since the compositor creation*/
+	u64 texture_upload_total, frame_draw_total;
+	u32 nb_timed_frames;
 
 #ifdef GF_SR_USE_VIDEO_CACHE
-	/*video cache size / max size in kbytes*/
+	/*video cache size / max size in bytes, for caches drawn in 2D and for caches used as OpenGL textures*/
 	u32 video_cache_current_size, video_cache_max_size;
+	u32 video_cache_gl_current_size, video_cache_gl_max_size;
 	u32 cache_scale, cache_tolerance;
+	/*number of frames a cached group is drawn from its cache, number of cache (re)builds and number of caches evicted
+	because of memory constraints since the compositor creation*/
+	u32 video_cache_hits, video_cache_misses, video_cache_evictions;
 	/*sorted list (by cache priority) of cached groups - permanent for the lifetime of the scene/cache object*/
 	GF_List *cached_groups;
 	/*list of groups being cached in one frame */
@@ -1442,6 +1459,8 @@ GF_Err gf_font_manager_register_font(GF_FontManager *fm, GF_Font *font);
 GF_Err gf_font_manager_unregister_font(GF_FontManager *fm, GF_Font *font);
 
 void gf_font_manager_refresh_span_bounds(GF_TextSpan *span);
+/*gets the number of glyph lookups served from and missing in the glyph cache since the font manager creation*/
+void gf_font_manager_get_glyph_cache_stats(GF_FontManager *fm, u32 *nb_hits, u32 *nb_misses);
 GF_Path *gf_font_span_create_path(GF_TextSpan *span);
 
 
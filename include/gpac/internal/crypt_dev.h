@@ -50,14 +50,26 @@ struct _gf_crypt_context
 	GF_Err(*_decrypt) (GF_Crypt*, u8 *buffer, u32 size);
 	GF_Err(*_set_state) (GF_Crypt*, const u8 *IV, u32 IV_size);
 	GF_Err(*_get_state) (GF_Crypt*, u8 *IV, u32 *IV_size);
+	//optional, encrypts or decrypts several ranges at once - if NULL, ranges are processed one by one
+	GF_Err(*_crypt_ranges) (GF_Crypt*, GF_CryptRange *ranges, u32 nb_ranges, Bool encrypt);
 };
 
+/*AES-NI backend, available on x86 CPUs and selected at run time*/
+#if (defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))) || (defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64)))
+#define GPAC_HAS_AESNI
+#endif
+
 #ifdef GPAC_HAS_SSL
 GF_Err gf_crypt_open_open_openssl(GF_Crypt* td, GF_CRYPTO_MODE mode);
 #else
 GF_Err gf_crypt_open_open_tinyaes(GF_Crypt* td, GF_CRYPTO_MODE mode);
 #endif
 
+#ifdef GPAC_HAS_AESNI
+Bool gf_crypt_aesni_supported();
+GF_Err gf_crypt_open_open_aesni(GF_Crypt* td, GF_CRYPTO_MODE mode);
+#endif
+
 
 #ifdef __cplusplus
 }
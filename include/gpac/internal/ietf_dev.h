@@ -53,22 +53,33 @@ typedef struct
 } GF_RTCPHeader;
 
 
-typedef struct __PRO_item
+/*slot of the RTP packet reorderer*/
+typedef struct
 {
-	struct __PRO_item *next;
-	u32 pck_seq_num;
-	void *pck;
-	u32 size;
-} GF_POItem;
+	char *pck;
+	u32 size, alloc_size;
+	/*arrival time of the packet in NTP format, 0 if unknown*/
+	u64 ntp;
+	u16 pck_seq_num;
+	Bool used;
+} GF_POSlot;
 
 typedef struct __PO
 {
-	struct __PRO_item *in;
-	u32 head_seqnum;
+	/*ring of nb_slots slots (power of 2) indexed by sequence number - slot buffers are kept across packets*/
+	GF_POSlot *slots;
+	u32 nb_slots;
+	/*sequence number of the next packet to output*/
+	u16 head_seqnum;
+	/*offset from head_seqnum of the last packet in the queue*/
+	u32 max_offset;
 	u32 Count;
 	u32 MaxCount;
 	u32 IsInit;
+	Bool has_output;
 	u32 MaxDelay, LastTime;
+	/*reception statistics*/
+	u32 nb_received, nb_duplicated, nb_late, nb_lost, nb_reordered;
 } GF_RTPReorder;
 
 /* creates new RTP reorderer
@@ -82,9 +93,18 @@ void gf_rtp_reorderer_reset(GF_RTPReorder *po);
 
 /*Adds a packet to the queue. Packet Data is memcopied*/
 GF_Err gf_rtp_reorderer_add(GF_RTPReorder *po, const void * pck, u32 pck_size, u32 pck_seqnum);
+/*same as above with the arrival time of the packet in NTP format, 0 if unknown*/
+GF_Err gf_rtp_reorderer_add_packet(GF_RTPReorder *po, const void * pck, u32 pck_size, u32 pck_seqnum, u64 arrival_ntp);
 /*gets the output of the queue. Packet Data IS YOURS to delete*/
 void *gf_rtp_reorderer_get(GF_RTPReorder *po, u32 *pck_size);
+/*gets the output of the queue without copy. Packet data belongs to the queue and is valid until the next call to the reorderer.
+@arrival_ntp: optional, set to the arrival time of the packet as given to gf_rtp_reorderer_add_packet*/
+const char *gf_rtp_reorderer_get_packet(GF_RTPReorder *po, u32 *pck_size, u64 *arrival_ntp);
 
+/*max number of RTP packets fetched from the network in one call*/
+#define GF_RTP_RECV_BATCH		16
+/*max size of a received RTP packet, larger datagrams are dropped*/
+#define GF_RTP_RECV_MAX_SIZE	9216
 
 /*the RTP channel with both RTP and RTCP sockets and buffers
 each channel is identified by a control string given in RTSP Describe
@@ -104,6 +124,14 @@ struct __tag_rtp_channel
 	max latency at the reordering queue*/
 	GF_RTPReorder *po;
 
+	/*packets received from the network but not yet handed to the reorderer or the user*/
+	char *rcv_buffers[GF_RTP_RECV_BATCH];
+	u32 rcv_sizes[GF_RTP_RECV_BATCH];
+	u64 rcv_ntp[GF_RTP_RECV_BATCH];
+	u32 rcv_count, rcv_pos;
+	/*arrival time in NTP format of the last packet returned by gf_rtp_read_rtp, 0 if unknown*/
+	u64 last_pck_arrival;
+
 	/*RTCP report times*/
 	u32 last_report_time;
 	u32 next_report_time;
@@ -129,6 +157,11 @@ struct __tag_rtp_channel
 	/*static buffer for RTP sending*/
 	char *send_buffer;
 	u32 send_buffer_size;
+	/*packets queued by gf_rtp_send_packet until gf_rtp_flush_packets, in a block of snd_batch_max buffers of send_buffer_size bytes*/
+	char *snd_batch;
+	const char **snd_batch_bufs;
+	u32 *snd_batch_sizes;
+	u32 snd_batch_max, snd_batch_count;
 	u32 pck_sent_since_last_sr;
 	u32 last_pck_ts;
 	u32 last_pck_ntp_sec, last_pck_ntp_frac;
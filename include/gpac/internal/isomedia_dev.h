@@ -837,6 +837,8 @@ typedef struct
 	u32 sample_count_at_seg_start;
 	Bool first_traf_merged;
 	Bool present_in_scalable_segment;
+	/*lazy fragment mode: samples of the track in each indexed movie fragment*/
+	struct __tag_fragment_range *frag_ranges;
 #endif
 } GF_TrackBox;
 
@@ -1399,6 +1401,8 @@ static const u8 GF_ISOM_IPOD_EXT[][16] = { { 0x6B, 0x68, 0x40, 0xF2, 0x5F, 0x24,
 
 Bool gf_isom_is_nalu_based_entry(GF_MediaBox *mdia, GF_SampleEntryBox *_entry);
 GF_Err gf_isom_nalu_sample_rewrite(GF_MediaBox *mdia, GF_ISOSample *sample, u32 sampleNumber, GF_MPEGVisualSampleEntryBox *entry);
+/*refines the RAP status of a sample (fetched without data at the given offset) as gf_isom_nalu_sample_rewrite would in inspect mode, only reading NAL unit headers*/
+GF_Err gf_isom_nalu_sample_refine_sap(GF_MediaBox *mdia, GF_ISOSample *sample, u64 offset, GF_MPEGVisualSampleEntryBox *entry);
 
 /*this is the default visual sdst (to handle unknown media)*/
 typedef struct
@@ -1762,6 +1766,8 @@ typedef struct
 	GF_List *sai_offsets;
 
 	u32 MaxSamplePerChunk, MaxChunkSize;
+	/*max chunk duration in media timescale for flat storage*/
+	u32 MaxChunkDur;
 	u16 groupID;
 	u16 trackPriority;
 	u32 currentEntryIndex;
@@ -2263,6 +2269,13 @@ typedef struct
 	u32 sequence_number;
 } GF_MovieFragmentHeaderBox;
 
+/*byte range of a source file to be copied in the mdat of a fragment*/
+typedef struct
+{
+	u64 offset;
+	u64 size;
+} GF_FragmentDataRef;
+
 /*MovieFragment is a container IN THE FILE, contains 1 fragment*/
 typedef struct
 {
@@ -2275,6 +2288,12 @@ typedef struct
 	u32 mdat_size;
 	char *mdat;
 
+	/*sample data added by reference, copied from data_refs_src at the end of the mdat when storing the fragment*/
+	GF_FragmentDataRef *data_refs;
+	u32 nb_data_refs, alloc_data_refs;
+	u64 data_refs_size;
+	FILE *data_refs_src;
+
 	//temp storage of prft box
 	u32 reference_track_ID;
 	u64 ntp, timestamp;
@@ -3437,6 +3456,8 @@ u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, char *buffer, u32 bufferLen
 #ifndef GPAC_DISABLE_ISOM_WRITE
 u64 gf_isom_datamap_get_offset(GF_DataMap *map);
 GF_Err gf_isom_datamap_add_data(GF_DataMap *ptr, char *data, u32 dataSize);
+/*appends a byte range of a source file to the data map*/
+GF_Err gf_isom_datamap_add_file_range(GF_DataMap *ptr, FILE *src, u64 src_offset, u64 size);
 #endif
 
 void gf_isom_datamap_flush(GF_DataMap *map);
@@ -3492,6 +3513,11 @@ struct __tag_isom {
 	GF_DataMap *editFileMap;
 	/*the interleaving time for dummy mode (in movie TimeScale)*/
 	u32 interleavingTime;
+	/*size of the free box reserved for the moov before the media data in capture mode, and its position once written*/
+	u32 moov_reserve_size;
+	u64 moov_reserve_offset;
+	/*estimated size of the moov in capture mode, updated as samples are added*/
+	u64 moov_size_estimate;
 #endif
 
 	u8 openMode;
@@ -3547,6 +3573,14 @@ struct __tag_isom {
 	u32 sidx_pts_store_alloc, sidx_pts_store_count;
 	u64 *sidx_pts_store, *sidx_pts_next_store;
 
+	/*lazy fragment mode: max number of movie fragments merged in the sample tables, 0 if disabled*/
+	u32 lazy_max_frags;
+	/*offsets of all movie fragments in the file*/
+	u64 *lazy_moof_offsets;
+	u32 nb_lazy_frags, alloc_lazy_frags;
+	/*range of movie fragments currently merged in the sample tables, end excluded*/
+	u32 lazy_frag_start, lazy_frag_end;
+
 #endif
 	GF_ProducerReferenceTimeBox *last_producer_ref_time;
 
@@ -3559,6 +3593,30 @@ struct __tag_isom {
 	Bool is_smooth;
 };
 
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+/*default max number of movie fragments merged in the sample tables in lazy fragment mode*/
+#define GF_ISOM_LAZY_FRAGMENT_WINDOW	4
+
+/*lazy fragment mode: samples of a track in a movie fragment*/
+typedef struct __tag_fragment_range
+{
+	/*number of samples of the track before this fragment*/
+	u32 first_sample;
+	u32 nb_samples;
+	/*decode time and duration of the samples of the track in this fragment*/
+	u64 first_dts;
+	u64 duration;
+	/*first and last sync samples of the track in this fragment (1-based in the fragment), 0 if none*/
+	u32 first_sync, last_sync;
+} GF_TrackFragmentRange;
+
+/*lazy fragment mode: merges the fragment containing the given sample (1-based) or decode time in the sample tables*/
+GF_Err gf_isom_lazy_load_sample(GF_ISOFile *mov, GF_TrackBox *trak, u32 sampleNumber);
+GF_Err gf_isom_lazy_load_time(GF_ISOFile *mov, GF_TrackBox *trak, u64 dts);
+/*lazy fragment mode: returns the closest sync sample before or after the given loaded sample, browsing the fragment index if needed, 0 if none*/
+u32 gf_isom_lazy_find_sync(GF_ISOFile *mov, GF_TrackBox *trak, u32 sampleNumber, u8 SearchMode);
+#endif
+
 /*time function*/
 u64 gf_isom_get_mp4time();
 /*set the last error of the file. if file is NULL, set the static error (used for IO errors*/
@@ -3686,6 +3744,9 @@ GF_Err stbl_SetPaddingBits(GF_SampleTableBox *stbl, u32 SampleNumber, u8 bits);
 GF_Err stbl_SampleSizeAppend(GF_SampleSizeBox *stsz, u32 data_size);
 /*writing of the final chunk info in edit mode*/
 GF_Err stbl_SetChunkAndOffset(GF_SampleTableBox *stbl, u32 sampleNumber, u32 StreamDescIndex, GF_SampleToChunkBox *the_stsc, GF_Box **the_stco, u64 data_offset, Bool forceNewChunk, u32 nb_samp);
+/*merges redundant stts, ctts and stsz entries, switching to stz2 if use_compact_size is set and sizes fit on 16 bits*/
+GF_Err stbl_CompactTables(GF_SampleTableBox *stbl, Bool use_compact_size);
+void stbl_CompactSampleToChunk(GF_SampleToChunkBox *stsc);
 /*EDIT LIST functions*/
 GF_EdtsEntry *CreateEditEntry(u64 EditDuration, u64 MediaTime, u8 EditMode);
 
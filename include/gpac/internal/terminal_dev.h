@@ -419,6 +419,8 @@ struct _tag_terminal
 	u32 cumulated_priority;
 	/*frame duration*/
 	u32 frame_duration;
+	/*decoder thread pool used in multi-threaded mode, created upon first use*/
+	struct __dec_pool *dec_pool;
 
 	/*net services*/
 	GF_List *net_services;
@@ -677,6 +679,8 @@ struct _es_channel
 	struct _decoding_buffer * AU_buffer_first, * AU_buffer_last;
 	/*static decoding buffer for pull mode*/
 	struct _decoding_buffer * AU_buffer_pull;
+	/*recycles decoding buffer units and payloads of push mode*/
+	struct _db_unit_pool *db_pool;
 	char *pull_reaggregated_buffer;
 	/*channel buffer flag*/
 	Bool BufferOn;
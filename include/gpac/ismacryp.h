@@ -156,6 +156,9 @@ typedef struct
 	*/
 	u32 force_clear_stsd_idx;
 
+	/*number of threads used for CENC sample encryption: 0 uses one thread per core, 1 encrypts in the calling thread*/
+	u32 nb_threads;
+
 	char metadata[5000];
 	u32 metadata_len;
 
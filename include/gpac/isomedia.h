@@ -81,6 +81,9 @@ enum
 	GF_ISOM_WRITE_EDIT,
 	/*Opens an existing file for fragment concatenation*/
 	GF_ISOM_OPEN_CAT_FRAGMENTS,
+	/*Opens a file in READ ONLY mode. Movie fragments are only indexed when opening the file, and are parsed
+	when their samples are accessed. Files with samples in the moov are read as in GF_ISOM_OPEN_READ*/
+	GF_ISOM_OPEN_READ_LAZY,
 };
 
 /*Movie Options for file writing*/
@@ -540,6 +543,8 @@ typedef struct
 	/*number of packed samples in this sample. If 0 or 1, only 1 sample is present
 	only used for constant size and constant duration samples*/
 	u32 nb_pack;
+	/*size of the allocated data buffer when the sample is reused across calls to gf_isom_get_sample_ex, 0 otherwise*/
+	u32 alloc_size;
 } GF_ISOSample;
 
 
@@ -659,6 +664,10 @@ u32 gf_isom_segment_get_track_fragment_decode_time(GF_ISOFile *file, u32 moof_in
    in order to proceed to next moof, call gf_isom_reset_data_offset
 */
 void gf_isom_set_single_moof_mode(GF_ISOFile *file, Bool mode);
+
+/*sets the max number of movie fragments kept parsed in the sample tables for files opened with GF_ISOM_OPEN_READ_LAZY (4 by default)
+returns GF_NOT_SUPPORTED if the file does not use lazy fragment parsing*/
+GF_Err gf_isom_set_lazy_fragment_window(GF_ISOFile *file, u32 nb_frags);
 /********************************************************************
 				READING API FUNCTIONS
 ********************************************************************/
@@ -771,6 +780,12 @@ this index allows to retrieve the stream description if needed (2 media in 1 tra
 return NULL if error*/
 GF_ISOSample *gf_isom_get_sample(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *StreamDescriptionIndex);
 
+/*same as gf_isom_get_sample but fetches the sample in static_sample if not NULL, reusing its data buffer and growing it
+if needed rather than allocating a new buffer for each sample. The size of the data buffer is kept in static_sample->alloc_size,
+the buffer is destroyed by gf_isom_sample_del
+return static_sample (or a new sample if static_sample is NULL), NULL if error*/
+GF_ISOSample *gf_isom_get_sample_ex(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *StreamDescriptionIndex, GF_ISOSample *static_sample);
+
 /*same as gf_isom_get_sample but doesn't fetch media data
 @StreamDescriptionIndex (optional): set to stream description index
 @data_offset (optional): set to sample start offset in file.
@@ -780,6 +795,15 @@ retrieved (faster)
 */
 GF_ISOSample *gf_isom_get_sample_info(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *StreamDescriptionIndex, u64 *data_offset);
 
+/*same as gf_isom_get_sample_info, but the sample properties are the ones gf_isom_get_sample would return in the
+current NALU extraction mode: for NAL-based tracks in GF_ISOM_NALU_EXTRACT_INSPECT mode, the RAP status is refined by
+reading the NAL unit headers of the sample. Returns NULL with last error GF_NOT_SUPPORTED if the sample data would be
+modified when fetched (OD tracks, text conversion, sample packing or NAL rewriting)
+@StreamDescriptionIndex (optional): set to stream description index
+@data_offset: set to sample start offset in the data reference
+*/
+GF_ISOSample *gf_isom_get_sample_ref(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *StreamDescriptionIndex, u64 *data_offset);
+
 /*retrieves given sample DTS*/
 u64 gf_isom_get_sample_dts(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber);
 
@@ -1161,6 +1185,15 @@ you MUST have created a StreamDescription with URL or URN specifying your refere
 Use streamDescriptionIndex to specify the desired stream (if several)*/
 GF_Err gf_isom_add_sample_reference(GF_ISOFile *the_file, u32 trackNumber, u32 StreamDescriptionIndex, GF_ISOSample *sample, u64 dataOffset);
 
+/*appends size bytes read at src_offset in src to the media data of the track, without adding any sample. The data is
+copied by the kernel when possible. data_offset is set to the offset of the copied data, to be used with
+gf_isom_add_sample_at_offset. The sample description must be self-contained*/
+GF_Err gf_isom_add_sample_data_from_file(GF_ISOFile *the_file, u32 trackNumber, u32 StreamDescriptionIndex, FILE *src, u64 src_offset, u64 size, u64 *data_offset);
+
+/*adds a sample whose data has already been written in the media data of the track at data_offset (see
+gf_isom_add_sample_data_from_file). The sample data field is ignored*/
+GF_Err gf_isom_add_sample_at_offset(GF_ISOFile *the_file, u32 trackNumber, u32 StreamDescriptionIndex, const GF_ISOSample *sample, u64 data_offset);
+
 /*set the duration of the last media sample. If not set, the duration of the last sample is the
 duration of the previous one if any, or media TimeScale (default value). This does not modify the edit list if any,
 you must modify this using gf_isom_set_edit_segment*/
@@ -1216,6 +1249,12 @@ GF_Err gf_isom_set_final_name(GF_ISOFile *the_file, char *filename);
 GF_Err gf_isom_set_storage_mode(GF_ISOFile *the_file, u8 storageMode);
 u8 gf_isom_get_storage_mode(GF_ISOFile *the_file);
 
+/*reserves nb_bytes for the moov box before the media data, as a free box. This is only possible in WRITE (capture) mode
+and must be called before any sample is added.
+When the file is stored in STREAMABLE mode, the moov is written in the reserved space if it fits, avoiding to rewrite
+all media data to move the moov to the beginning of the file. Otherwise the file is rewritten as usual.*/
+GF_Err gf_isom_reserve_moov_space(GF_ISOFile *the_file, u32 nb_bytes);
+
 /*set the interleaving time of media data (INTERLEAVED mode only)
 InterleaveTime is in MovieTimeScale*/
 GF_Err gf_isom_set_interleave_time(GF_ISOFile *the_file, u32 InterleaveTime);
@@ -1686,6 +1725,15 @@ GF_Err gf_isom_fragment_add_sample(GF_ISOFile *the_file, u32 TrackID, const GF_I
                                    u32 StreamDescriptionIndex,
                                    u32 Duration, u8 PaddingBits, u16 DegradationPriority, Bool redundantCoding);
 
+/*same as gf_isom_fragment_add_sample, but the sample data is not provided: it is copied from the given source file
+(sample->dataLength bytes at src_offset) right after the moof when the fragment is stored, using kernel-side copy
+when available. The source file must stay open until the fragment is stored. Only supported for moof-first fragments
+without segments or data caching, and samples with data cannot be added in the same fragment once samples
+were added by reference*/
+GF_Err gf_isom_fragment_add_sample_ref(GF_ISOFile *the_file, u32 TrackID, const GF_ISOSample *sample,
+                                   u32 StreamDescriptionIndex,
+                                   u32 Duration, u8 PaddingBits, u16 DegradationPriority, Bool redundantCoding, FILE *src, u64 src_offset);
+
 /*appends data into last sample of track for video fragments/other media
 CANNOT be used with OD tracks*/
 GF_Err gf_isom_fragment_append_data(GF_ISOFile *the_file, u32 TrackID, char *data, u32 data_size, u8 PaddingBits);
@@ -1739,6 +1787,14 @@ be written first*/
 GF_Err gf_isom_set_track_priority_in_group(GF_ISOFile *the_file, u32 trackNumber, u32 InversePriority);
 
 GF_Err gf_isom_hint_max_chunk_size(GF_ISOFile *the_file, u32 trackNumber, u32 maxChunkSize);
+/*sets the max chunk duration in media timescale when storing the file in flat mode, 0 means no limit.
+In interleaved mode, chunks are built according to the interleaving time*/
+GF_Err gf_isom_hint_max_chunk_duration(GF_ISOFile *the_file, u32 trackNumber, u32 maxChunkDur);
+/*merges redundant entries of the time-to-sample, composition offset and sample size tables of the track,
+or of all tracks if trackNumber is 0. If use_compact_size is set, the compact sample size table is used when
+all sizes fit on 16 bits. Tables are always compacted when the file is written, and the sample-to-chunk table
+is rebuilt at that time*/
+GF_Err gf_isom_compact_sample_tables(GF_ISOFile *the_file, u32 trackNumber, Bool use_compact_size);
 
 /*associate a given SL config with a given ESD while extracting the OD information
 all the SL params must be fixed by the calling app!
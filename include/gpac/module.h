@@ -300,6 +300,42 @@ const char *gf_modules_get_file_name(GF_ModuleManager *pm, u32 index);
  */
 const char *gf_module_get_file_name(GF_BaseInterface *ifce);
 
+/*!
+ *\brief get module capabilities
+ *
+ *Gets the capabilities cached for an interface of a module. Capabilities are an opaque string defined by the users of the
+ *interface, and allow selecting modules without loading them. They are kept in the module cache of the configuration file
+ *and discarded whenever a module file is added, removed or modified.
+ *\param pm the module manager
+ *\param index the 0-based index of the module to query
+ *\param InterfaceFamily type of the interface to query
+ *\return the capabilities string if known, NULL otherwise
+ */
+const char *gf_modules_get_capabilities(GF_ModuleManager *pm, u32 index, u32 InterfaceFamily);
+
+/*!
+ *\brief set module capabilities
+ *
+ *Sets the capabilities cached for an interface of a module, see \ref gf_modules_get_capabilities
+ *\param pm the module manager
+ *\param index the 0-based index of the module
+ *\param InterfaceFamily type of the interface
+ *\param caps the capabilities string, or NULL to remove them
+ *\return error if any
+ */
+GF_Err gf_modules_set_capabilities(GF_ModuleManager *pm, u32 index, u32 InterfaceFamily, const char *caps);
+
+/*!
+ *\brief module changes query
+ *
+ *Checks if module files were added, removed or modified since the last run, in which case the module cache has been
+ *flushed and information derived from the modules (such as MIME types) should be refreshed. The change is only reported
+ *once: the flag is cleared by this call, and recomputed at each \ref gf_modules_refresh.
+ *\param pm the module manager
+ *\return GF_TRUE if modules changed since last run
+ */
+Bool gf_modules_manifest_changed(GF_ModuleManager *pm);
+
 /*!
  *\brief loads an interface
  *
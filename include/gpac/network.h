@@ -302,6 +302,17 @@ GF_Err gf_sk_connect(GF_Socket *sock, const char *peer_name, u16 port, const cha
  *\param length the data length to send
  */
 GF_Err gf_sk_send(GF_Socket *sock, const char *buffer, u32 length);
+/*!
+ *\brief multiple datagrams emission
+ *
+ *Sends several datagrams on a UDP socket, using as few system calls as possible (UDP segmentation offload or sendmmsg on Linux). The socket must be in a bound or connected mode. On TCP sockets, buffers are sent one after the other.
+ *\param sock the socket object
+ *\param buffers the datagrams to send
+ *\param sizes the size of each datagram
+ *\param nb_buffers the number of datagrams
+ *\return error if any
+ */
+GF_Err gf_sk_send_batch(GF_Socket *sock, const char **buffers, const u32 *sizes, u32 nb_buffers);
 /*!
  *\brief data reception
  *
@@ -314,6 +325,20 @@ GF_Err gf_sk_send(GF_Socket *sock, const char *buffer, u32 length);
  *\return error if any, GF_IP_NETWORK_EMPTY if nothing to read
  */
 GF_Err gf_sk_receive(GF_Socket *sock, char *buffer, u32 length, u32 start_from, u32 *read);
+/*!
+ *\brief multiple datagrams reception
+ *
+ *Fetches several datagrams on a UDP socket in one call, using a single system call where supported (recvmmsg on Linux). The socket must be in a bound or connected state. The call only waits for the first datagram, as \ref gf_sk_receive does.
+ *\param sock the socket object
+ *\param buffers the reception buffers, one per datagram
+ *\param buffer_size the allocated size of each reception buffer. Datagrams truncated to this size are dropped when the platform reports truncation (recvmmsg)
+ *\param sizes set to the size of each received datagram
+ *\param ntp_times set to the arrival time of each datagram in NTP format, taken from the kernel reception timestamp when available. May be NULL
+ *\param nb_buffers the number of reception buffers
+ *\param nb_read set to the number of received datagrams
+ *\return error if any, GF_IP_NETWORK_EMPTY if nothing to read
+ */
+GF_Err gf_sk_receive_batch(GF_Socket *sock, char **buffers, u32 buffer_size, u32 *sizes, u64 *ntp_times, u32 nb_buffers, u32 *nb_read);
 
 /*!
  *\brief socket listening
@@ -451,7 +476,8 @@ s32 gf_sk_get_handle(GF_Socket *sock);
 void gf_sk_set_usec_wait(GF_Socket *sock, u32 usec_wait);
 
 /*!
- *Creates a new socket group
+ *Creates a new socket group. On Linux, the group uses an edge-triggered epoll set and is not limited to FD_SETSIZE sockets; the cost of a select only depends on the number of readable sockets.
+ *A socket can only be registered in one group at a time, and is automatically unregistered when destroyed
  *\return socket group object
  */
 GF_SockGroup *gf_sk_group_new();
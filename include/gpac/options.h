@@ -324,6 +324,16 @@ enum
 	GF_OPT_MULTIVIEW_MODE,
 	/*get orientation sensors flag, true if sensors are activated false if not*/
 	GF_OPT_ORIENTATION_SENSORS_ACTIVE,
+	/*get only: percentage of glyphs drawn from the glyph cache since the compositor creation (value: 0-100)*/
+	GF_OPT_GLYPH_CACHE_HIT_RATE,
+	/*get only: percentage of frames where cached groups were drawn from their offscreen cache rather than rebuilt, since the compositor creation (value: 0-100)*/
+	GF_OPT_VIDEO_CACHE_HIT_RATE,
+	/*get only: number of offscreen group caches evicted because of memory constraints since the compositor creation*/
+	GF_OPT_VIDEO_CACHE_EVICTIONS,
+	/*get only: average time in microseconds spent uploading textures to the GPU per drawn frame, since the compositor creation*/
+	GF_OPT_TEXTURE_UPLOAD_TIME,
+	/*get only: average time in microseconds spent drawing a frame, texture uploads excluded, since the compositor creation*/
+	GF_OPT_FRAME_DRAW_TIME,
 };
 
 /*! @} */
@@ -150,6 +150,76 @@ GF_Err gf_rtp_streamer_send_rtcp(GF_RTPStreamer *streamer, Bool force_ts, u32 rt
 
 u8 gf_rtp_streamer_get_payload_type(GF_RTPStreamer *streamer);
 
+
+typedef struct __rtp_streamer_engine GF_RTPStreamerEngine;
+
+/*!
+ *	\brief AU fetch callback of the RTP streamer engine
+ *
+ *	Called by the engine threads to get the next access unit of a session, right after the previous one has been sent.
+ *\param udta user data passed to \ref gf_rtp_streamer_engine_add
+ *\param data set to the AU data. The data must stay valid until the next call for this session or the session removal
+ *\param size set to the AU size
+ *\param cts set to the AU composition timestamp, in the streamer timescale
+ *\param dts set to the AU decoding timestamp, in the streamer timescale
+ *\param is_rap set to GF_TRUE if the AU is a random access point
+ *\param send_time set to the time at which the AU shall be sent, in microseconds from the session addition
+ *\return GF_FALSE at the end of the session, GF_TRUE otherwise
+ */
+typedef Bool (*gf_rtp_streamer_fetch_au)(void *udta, char **data, u32 *size, u64 *cts, u64 *dts, Bool *is_rap, u64 *send_time);
+
+/*!
+ *	\brief RTP streamer engine constructor
+ *
+ *	Constructs an engine sending the access units of many RTP streamers from a few threads. Each session is assigned to one thread, and
+ *	each thread schedules its sessions on a timer wheel: all AUs due in the same tick are sent together, and the packets of a session are
+ *	sent with as few system calls as possible. RTCP sender reports are sent by each session channel at its own pace.
+ *\param nb_threads number of sending threads, 0 for one
+ *\param tick_us duration of a scheduling tick in microseconds, 0 for 1000
+ *\param batch_size max number of RTP packets of a session queued before being sent in one go, 0 or 1 to send packets one by one
+ *\return new engine object, running
+ */
+GF_RTPStreamerEngine *gf_rtp_streamer_engine_new(u32 nb_threads, u32 tick_us, u32 batch_size);
+
+/*!
+ *	\brief RTP streamer engine destructor
+ *
+ *	Stops the engine threads and destructs the engine. The streamers of the remaining sessions are not destroyed
+ *\param engine the target engine
+ */
+void gf_rtp_streamer_engine_del(GF_RTPStreamerEngine *engine);
+
+/*!
+ *	\brief adds a session to the RTP streamer engine
+ *
+ *	Adds a streamer to the engine. The streamer shall not be used by the caller until removed from the engine.
+ *\param engine the target engine
+ *\param streamer the streamer of the session
+ *\param fetch_au callback used to get the AUs of the session, called from an engine thread
+ *\param udta user data passed to the callback
+ *\return error if any
+ */
+GF_Err gf_rtp_streamer_engine_add(GF_RTPStreamerEngine *engine, GF_RTPStreamer *streamer, gf_rtp_streamer_fetch_au fetch_au, void *udta);
+
+/*!
+ *	\brief removes a session from the RTP streamer engine
+ *
+ *	Removes a streamer from the engine. Once the call returns, the fetch callback of the session is no longer called.
+ *\param engine the target engine
+ *\param streamer the streamer of the session
+ *\return error if any
+ */
+GF_Err gf_rtp_streamer_engine_remove(GF_RTPStreamerEngine *engine, GF_RTPStreamer *streamer);
+
+/*!
+ *	\brief gets the number of sessions of the RTP streamer engine
+ *
+ *\param engine the target engine
+ *\param active_only if set, sessions whose fetch callback signaled the end of the session are not counted
+ *\return number of sessions
+ */
+u32 gf_rtp_streamer_engine_get_session_count(GF_RTPStreamerEngine *engine, Bool active_only);
+
 /*! @} */
 
 #ifdef __cplusplus
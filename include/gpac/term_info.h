@@ -116,8 +116,15 @@ typedef struct
 	u32 min_buffer, max_buffer;
 	/*number of AUs in DB (cumulated on all input channels)*/
 	u32 db_unit_count;
+	/*number of AU header and payload allocations served / not served by the decoding buffer pools (cumulated on all input channels)*/
+	u32 db_pool_hits, db_pool_misses;
 	/*number of CUs in composition memory (if any) and CM capacity*/
 	u16 cb_unit_count, cb_max_count;
+	/*decoder to compositor frame hand-off latency in us (average and max), measured between the unit publication in the
+	composition memory and its first fetch by the compositor*/
+	u32 avg_handoff_time, max_handoff_time;
+	/*set if the composition memory is shared between decoder and compositor without locking*/
+	Bool lock_free_cb;
 	/*inidciate that thye composition memory is bypassed for this decoder (video only) */
 	Bool direct_video_memory;
 	/*clock drift in ms of object clock: this is the delay set by the audio renderer to keep AV in sync*/
@@ -172,6 +179,23 @@ Bool gf_term_get_channel_net_info(GF_Terminal *term, GF_ObjectManager *odm, u32
 typedef struct __netinfocom NetInfoCommand;
 GF_Err gf_term_get_service_info(GF_Terminal *term, GF_ObjectManager *odm, NetInfoCommand *netcom);
 
+typedef struct
+{
+	/*number of worker threads in the decoder pool. 0 if no pool is used (threading policy is not "Multi")*/
+	u32 nb_threads;
+	/*number of decoders scheduled on the pool*/
+	u32 nb_decoders;
+	/*number of decoding steps performed by the pool, and number of these steps stolen from another worker*/
+	u64 nb_tasks, nb_steals;
+	/*time in microseconds spent decoding, cumulated on all workers, and time elapsed since pool creation*/
+	u64 busy_time, run_time;
+	/*pool utilization in percent (busy time over run time, averaged on all workers)*/
+	u32 usage;
+} GF_DecoderPoolInfo;
+
+/*fills the GF_DecoderPoolInfo structure describing the decoder thread pool*/
+GF_Err gf_term_get_decoder_pool_info(GF_Terminal *term, GF_DecoderPoolInfo *info);
+
 /*retrieves world info of the scene @od belongs to.
 If @odm is or points to an inlined OD the world info of the inlined content is retrieved
 If @odm is NULL the world info of the main scene is retrieved
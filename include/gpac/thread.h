@@ -280,6 +280,31 @@ void gf_sema_wait(GF_Semaphore *sm);
 Bool gf_sema_wait_for(GF_Semaphore *sm, u32 time_out);
 
 
+/*********************************************************************
+					Atomic Operations
+**********************************************************************/
+/*!
+ *\brief atomic integer operations
+ *
+ *These macros perform the operation on the 32 bit integer pointed to by __v atomically, with full memory barrier semantics.
+ *They can be used to share counters or indexes between two threads without locking any mutex.
+*/
+#if defined(WIN32) && !defined(__GNUC__)
+#include <windows.h>
+#define safe_int_inc(__v) InterlockedIncrement((long *) (__v))
+#define safe_int_dec(__v) InterlockedDecrement((long *) (__v))
+#define safe_int_add(__v, inc_val) InterlockedExchangeAdd((long *) (__v), inc_val)
+#define safe_int_sub(__v, dec_val) InterlockedExchangeAdd((long *) (__v), -(long) (dec_val))
+#define gf_memory_barrier()	MemoryBarrier()
+#else
+#define safe_int_inc(__v) __sync_add_and_fetch((int *) (__v), 1)
+#define safe_int_dec(__v) __sync_sub_and_fetch((int *) (__v), 1)
+#define safe_int_add(__v, inc_val) __sync_add_and_fetch((int *) (__v), inc_val)
+#define safe_int_sub(__v, dec_val) __sync_sub_and_fetch((int *) (__v), dec_val)
+#define gf_memory_barrier()	__sync_synchronize()
+#endif
+
+
 /*! @} */
 
 #ifdef __cplusplus
@@ -35,6 +35,16 @@ extern "C" {
 #endif
 
 
+#if defined(WIN32) && !defined(__GNUC__)
+# include <intrin.h>
+# define GPAC_HAS_SSE2
+#else
+# ifdef __SSE2__
+#  include <emmintrin.h>
+#  define GPAC_HAS_SSE2
+# endif
+#endif
+
 /*RGB 555 support is disabled by default*/
 //#define GF_RGB_555_SUPORT
 
@@ -46,6 +56,9 @@ extern "C" {
 
 typedef struct _evg_surface EVGSurface;
 
+/*pool of threads rasterizing large fills in horizontal bands, shared by all surfaces of the rasterizer*/
+typedef struct _evg_band_pool EVGBandPool;
+
 /*base stencil stack*/
 #define EVGBASESTENCIL	\
 	u32 type;	\
@@ -150,6 +163,9 @@ struct _evg_surface
 	void (*raster_fill_rectangle)(void *cbk, u32 x, u32 y, u32 width, u32 height, GF_Color color);
 
 
+	/*disables the SIMD span fillers, used to check them against the scalar ones*/
+	Bool disable_simd;
+
 	/*in solid color mode to speed things*/
 	u32 fill_col;
 	u32 fill_565;
@@ -169,6 +185,9 @@ struct _evg_surface
 	EVG_Outline ftoutline;
 	EVG_Raster_Params ftparams;
 
+	/*band rasterization threads, NULL if fills are rasterized on the calling thread only*/
+	EVGBandPool *bands;
+
 #ifndef INLINE_POINT_CONVERSION
 	/*transformed point list*/
 	u32 pointlen;
@@ -299,6 +318,56 @@ GF_Err evg_surface_fill(GF_SURFACE surf, GF_STENCIL stencil);
 GF_Err evg_surface_clear(GF_SURFACE surf, GF_IRect *rc, u32 color);
 
 
+#ifdef GPAC_HAS_SSE2
+/*SIMD span fillers work on packed lines only*/
+#define EVG_USE_SIMD(_surf, _bpp)	(!(_surf)->disable_simd && ((_surf)->pitch_x == (_bpp)))
+
+/*blends 16 bit channel values: (a1*s + (256-a1)*d) >> 8 with a1 in [1, 256]. This is the exact equivalent of
+mul255(a, s-d) + d for a1 = a+1*/
+static GFINLINE __m128i evg_sse2_blend(__m128i s, __m128i d, __m128i a1)
+{
+	__m128i inva = _mm_sub_epi16(_mm_set1_epi16(256), a1);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a1), _mm_mullo_epi16(d, inva)), 8);
+}
+
+/*broadcasts the low 16 bits of each 32 bit lane of the low (resp. high) half of v to the 4 channels of the pixel*/
+static GFINLINE __m128i evg_sse2_expand_lo(__m128i v)
+{
+	v = _mm_unpacklo_epi32(v, v);
+	return _mm_or_si128(v, _mm_slli_epi32(v, 16));
+}
+static GFINLINE __m128i evg_sse2_expand_hi(__m128i v)
+{
+	v = _mm_unpackhi_epi32(v, v);
+	return _mm_or_si128(v, _mm_slli_epi32(v, 16));
+}
+
+/*selects a where mask is set, b otherwise*/
+#define EVG_SSE2_SELECT(_mask, _a, _b)	_mm_or_si128(_mm_and_si128(_mask, _a), _mm_andnot_si128(_mask, _b))
+
+static GFINLINE void evg_sse2_fill_u32(u32 *dst, u32 val, u32 count)
+{
+	__m128i v = _mm_set1_epi32(val);
+	while (count>=4) {
+		_mm_storeu_si128((__m128i *)dst, v);
+		dst += 4;
+		count -= 4;
+	}
+	while (count--) *dst++ = val;
+}
+
+static GFINLINE void evg_sse2_fill_u16(u16 *dst, u16 val, u32 count)
+{
+	__m128i v = _mm_set1_epi16(val);
+	while (count>=8) {
+		_mm_storeu_si128((__m128i *)dst, v);
+		dst += 8;
+		count -= 8;
+	}
+	while (count--) *dst++ = val;
+}
+#endif
+
 /*FT raster callbacks */
 void evg_bgra_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf);
 void evg_bgra_fill_const_a(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf);
@@ -353,6 +422,10 @@ void evg_user_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf);
 void evg_user_fill_const_a(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf);
 void evg_user_fill_var(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf);
 
+/*creates a band pool rasterizing fills with nb_threads threads, including the calling one*/
+EVGBandPool *evg_band_pool_new(u32 nb_threads);
+void evg_band_pool_del(EVGBandPool *pool);
+
 
 
 
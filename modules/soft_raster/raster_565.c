@@ -87,6 +87,86 @@ void overmask_565_const_run(u32 src, u16 *dst, s32 dst_pitch_x, u32 count)
 	}
 }
 
+#ifdef GPAC_HAS_SSE2
+/*unpacks 8 565 pixels to 16 bit channel values*/
+#define EVG_565_UNPACK(_v, _r, _g, _b)	\
+	_r = _mm_and_si128(_mm_srli_epi16(_v, 8), _mm_set1_epi16(0xf8));	\
+	_g = _mm_and_si128(_mm_srli_epi16(_v, 3), _mm_set1_epi16(0xfc));	\
+	_b = _mm_and_si128(_mm_slli_epi16(_v, 3), _mm_set1_epi16(0xf8));
+
+/*packs 16 bit channel values to 8 565 pixels, as done by GF_COL_565*/
+static GFINLINE __m128i evg_565_pack(__m128i r, __m128i g, __m128i b)
+{
+	r = _mm_slli_epi16(_mm_and_si128(r, _mm_set1_epi16(0xf8)), 8);
+	g = _mm_slli_epi16(_mm_and_si128(g, _mm_set1_epi16(0xfc)), 3);
+	b = _mm_srli_epi16(b, 3);
+	return _mm_or_si128(_mm_or_si128(r, g), b);
+}
+
+/*SSE2 version of overmask_565_const_run for packed lines, 8 pixels at a time*/
+static void overmask_565_const_run_sse2(u32 src, u16 *dst, u32 count)
+{
+	__m128i a1 = _mm_set1_epi16(((src >> 24) & 0xff) + 1);
+	__m128i sr = _mm_set1_epi16((src >> 16) & 0xff);
+	__m128i sg = _mm_set1_epi16((src >> 8) & 0xff);
+	__m128i sb = _mm_set1_epi16(src & 0xff);
+
+	while (count>=8) {
+		__m128i v = _mm_loadu_si128((__m128i *)dst);
+		__m128i r, g, b;
+		EVG_565_UNPACK(v, r, g, b)
+		r = evg_sse2_blend(sr, r, a1);
+		g = evg_sse2_blend(sg, g, a1);
+		b = evg_sse2_blend(sb, b, a1);
+		_mm_storeu_si128((__m128i *)dst, evg_565_pack(r, g, b));
+		dst += 8;
+		count -= 8;
+	}
+	if (count) overmask_565_const_run(src, dst, 2, count);
+}
+
+/*SSE2 version of the overmask_565 loop of evg_565_fill_var for packed lines, 8 pixels at a time*/
+static void overmask_565_var_run_sse2(u32 *cols, u16 *dst, u8 spanalpha, u32 count)
+{
+	__m128i ff = _mm_set1_epi32(0xFF);
+	__m128i one = _mm_set1_epi32(1);
+	__m128i span = _mm_set1_epi32(spanalpha);
+
+	while (count>=8) {
+		__m128i c0 = _mm_loadu_si128((__m128i *)cols);
+		__m128i c1 = _mm_loadu_si128((__m128i *)(cols+4));
+		__m128i ca0 = _mm_srli_epi32(c0, 24);
+		__m128i ca1 = _mm_srli_epi32(c1, 24);
+		/*a1 = mul255(col_a, spanalpha) + 1, packed to 16 bits*/
+		__m128i a1 = _mm_packs_epi32(
+		                 _mm_add_epi32(_mm_srli_epi32(_mm_mullo_epi16(_mm_add_epi32(ca0, one), span), 8), one),
+		                 _mm_add_epi32(_mm_srli_epi32(_mm_mullo_epi16(_mm_add_epi32(ca1, one), span), 8), one));
+		__m128i skip = _mm_packs_epi32(_mm_cmpeq_epi32(ca0, _mm_setzero_si128()), _mm_cmpeq_epi32(ca1, _mm_setzero_si128()));
+		__m128i sr = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(c0, 16), ff), _mm_and_si128(_mm_srli_epi32(c1, 16), ff));
+		__m128i sg = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(c0, 8), ff), _mm_and_si128(_mm_srli_epi32(c1, 8), ff));
+		__m128i sb = _mm_packs_epi32(_mm_and_si128(c0, ff), _mm_and_si128(c1, ff));
+		__m128i v = _mm_loadu_si128((__m128i *)dst);
+		__m128i r, g, b, res;
+		EVG_565_UNPACK(v, r, g, b)
+		r = evg_sse2_blend(sr, r, a1);
+		g = evg_sse2_blend(sg, g, a1);
+		b = evg_sse2_blend(sb, b, a1);
+		res = evg_565_pack(r, g, b);
+		/*transparent colors are not drawn*/
+		_mm_storeu_si128((__m128i *)dst, EVG_SSE2_SELECT(skip, v, res));
+		cols += 8;
+		dst += 8;
+		count -= 8;
+	}
+	while (count) {
+		if (GF_COL_A(*cols)) *dst = overmask_565(*cols, *dst, spanalpha);
+		cols++;
+		dst++;
+		count--;
+	}
+}
+#endif
+
 void evg_565_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 {
 	u16 col565 = surf->fill_565;
@@ -99,6 +179,20 @@ void evg_565_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 
 	col_no_a = col&0x00FFFFFF;
 
+#ifdef GPAC_HAS_SSE2
+	if (EVG_USE_SIMD(surf, 2)) {
+		for (i=0; i<count; i++) {
+			x = spans[i].x * 2;
+			if (spans[i].coverage != 0xFF) {
+				a = mul255(0xFF, spans[i].coverage);
+				overmask_565_const_run_sse2((a<<24) | col_no_a, (u16*) (dst+x), spans[i].len);
+			} else {
+				evg_sse2_fill_u16((u16*) (dst+x), col565, spans[i].len);
+			}
+		}
+		return;
+	}
+#endif
 	for (i=0; i<count; i++) {
 		x = spans[i].x * surf->pitch_x;
 		len = spans[i].len;
@@ -127,6 +221,12 @@ void evg_565_fill_const_a(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 	for (i=0; i<count; i++) {
 		fin = mul255(a, spans[i].coverage);
 		fin = (fin<<24) | col_no_a;
+#ifdef GPAC_HAS_SSE2
+		if (EVG_USE_SIMD(surf, 2)) {
+			overmask_565_const_run_sse2(fin, (u16*) (dst + spans[i].x * 2), spans[i].len);
+			continue;
+		}
+#endif
 		overmask_565_const_run(fin, (u16*) (dst + spans[i].x * surf->pitch_x), surf->pitch_x, spans[i].len);
 	}
 }
@@ -146,6 +246,12 @@ void evg_565_fill_var(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 		surf->sten->fill_run(surf->sten, surf, spans[i].x, y, len);
 		col = surf->stencil_pix_run;
 		x = spans[i].x * surf->pitch_x;
+#ifdef GPAC_HAS_SSE2
+		if (EVG_USE_SIMD(surf, 2)) {
+			overmask_565_var_run_sse2(col, (u16*) (dst+x), spanalpha, len);
+			continue;
+		}
+#endif
 		while (len--) {
 			col_a = GF_COL_A(*col);
 			if (col_a) {
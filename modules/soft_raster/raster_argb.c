@@ -46,7 +46,7 @@ static void overmask_bgra(u32 src, u8 *dst, u32 alpha)
 	s32 dsta = dst[3];
 	srca = mul255(srca, alpha);
 	if (dsta) {
-		s32 dstr = dst[1];
+		s32 dstr = dst[2];
 		s32 dstg = dst[1];
 		s32 dstb = dst[0];
 		dst[0] = mul255(srca, srcb - dstb) + dstb;
@@ -82,7 +82,7 @@ static void overmask_bgra_const_run(u32 src, u8 *dst, s32 dst_pitch_x, u32 count
 			dst[2] = mul255(srca, srcr - dstr) + dstr;
 			dst[3] = mul255(srca, srca) + mul255(255-srca, dsta);
 		} else {
-			dst[0] = srcr;
+			dst[0] = srcb;
 			dst[1] = srcg;
 			dst[2] = srcr;
 			dst[3] = srca;
@@ -92,6 +92,95 @@ static void overmask_bgra_const_run(u32 src, u8 *dst, s32 dst_pitch_x, u32 count
 	}
 }
 
+#ifdef GPAC_HAS_SSE2
+
+/*16 bit lanes of the 4th byte of each pixel once unpacked*/
+#define EVG_SSE2_ALPHA_LANES	_mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0)
+
+/*SSE2 version of overmask_bgra_const_run for packed lines, 4 pixels at a time*/
+static void overmask_bgra_const_run_sse2(u32 src, u8 *dst, u32 count)
+{
+	s32 srca = (src >> 24) & 0xff;
+	__m128i zero = _mm_setzero_si128();
+	__m128i alpha_lanes = EVG_SSE2_ALPHA_LANES;
+	__m128i col = _mm_set1_epi32(src);
+	__m128i s = _mm_unpacklo_epi8(col, zero);
+	__m128i a1 = _mm_set1_epi16(srca + 1);
+	__m128i inva = _mm_set1_epi16(256 - srca);
+	__m128i ka = _mm_set1_epi16(mul255(srca, srca));
+
+	while (count>=4) {
+		__m128i d = _mm_loadu_si128((__m128i *)dst);
+		__m128i dlo = _mm_unpacklo_epi8(d, zero);
+		__m128i dhi = _mm_unpackhi_epi8(d, zero);
+		__m128i rlo = evg_sse2_blend(s, dlo, a1);
+		__m128i rhi = evg_sse2_blend(s, dhi, a1);
+		/*alpha is mul255(srca, srca) + mul255(255-srca, dsta)*/
+		__m128i alo = _mm_add_epi16(ka, _mm_srli_epi16(_mm_mullo_epi16(dlo, inva), 8));
+		__m128i ahi = _mm_add_epi16(ka, _mm_srli_epi16(_mm_mullo_epi16(dhi, inva), 8));
+		__m128i res, empty;
+		rlo = EVG_SSE2_SELECT(alpha_lanes, alo, rlo);
+		rhi = EVG_SSE2_SELECT(alpha_lanes, ahi, rhi);
+		res = _mm_packus_epi16(rlo, rhi);
+		/*if dst alpha is 0, consider the surface is empty and copy pixel*/
+		empty = _mm_cmpeq_epi32(_mm_srli_epi32(d, 24), zero);
+		res = EVG_SSE2_SELECT(empty, col, res);
+		_mm_storeu_si128((__m128i *)dst, res);
+		dst += 16;
+		count -= 4;
+	}
+	if (count) overmask_bgra_const_run(src, dst, 4, count);
+}
+
+/*SSE2 version of the overmask_bgra loop of evg_bgra_fill_var for packed lines, 4 pixels at a time*/
+static void overmask_bgra_var_run_sse2(u32 *cols, u8 *dst, u8 spanalpha, u32 count)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i one = _mm_set1_epi16(1);
+	__m128i c256 = _mm_set1_epi16(256);
+	__m128i alpha_lanes = EVG_SSE2_ALPHA_LANES;
+	__m128i span = _mm_set1_epi32(spanalpha);
+	__m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+
+	while (count>=4) {
+		__m128i c = _mm_loadu_si128((__m128i *)cols);
+		__m128i d = _mm_loadu_si128((__m128i *)dst);
+		__m128i ca = _mm_srli_epi32(c, 24);
+		/*srca = mul255(col_a, spanalpha), fits in the low 16 bits of each lane*/
+		__m128i e = _mm_srli_epi32(_mm_mullo_epi16(_mm_add_epi32(ca, _mm_set1_epi32(1)), span), 8);
+		__m128i elo = evg_sse2_expand_lo(e);
+		__m128i ehi = evg_sse2_expand_hi(e);
+		__m128i dlo = _mm_unpacklo_epi8(d, zero);
+		__m128i dhi = _mm_unpackhi_epi8(d, zero);
+		__m128i rlo = evg_sse2_blend(_mm_unpacklo_epi8(c, zero), dlo, _mm_add_epi16(elo, one));
+		__m128i rhi = evg_sse2_blend(_mm_unpackhi_epi8(c, zero), dhi, _mm_add_epi16(ehi, one));
+		/*alpha is mul255(srca, srca) + mul255(255-srca, dsta)*/
+		__m128i alo = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_add_epi16(elo, one), elo), 8), _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(c256, elo), dlo), 8));
+		__m128i ahi = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_add_epi16(ehi, one), ehi), 8), _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(c256, ehi), dhi), 8));
+		__m128i res, mask;
+		rlo = EVG_SSE2_SELECT(alpha_lanes, alo, rlo);
+		rhi = EVG_SSE2_SELECT(alpha_lanes, ahi, rhi);
+		res = _mm_packus_epi16(rlo, rhi);
+		/*empty destination: copy color with modulated alpha*/
+		mask = _mm_cmpeq_epi32(_mm_srli_epi32(d, 24), _mm_setzero_si128());
+		res = EVG_SSE2_SELECT(mask, _mm_or_si128(_mm_and_si128(c, rgb_mask), _mm_slli_epi32(e, 24)), res);
+		/*transparent colors are not drawn*/
+		mask = _mm_cmpeq_epi32(ca, _mm_setzero_si128());
+		res = EVG_SSE2_SELECT(mask, d, res);
+		_mm_storeu_si128((__m128i *)dst, res);
+		cols += 4;
+		dst += 16;
+		count -= 4;
+	}
+	while (count) {
+		if (GF_COL_A(*cols)) overmask_bgra(*cols, dst, spanalpha);
+		cols++;
+		dst += 4;
+		count--;
+	}
+}
+#endif
+
 void evg_bgra_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 {
 	u32 col = surf->fill_col;
@@ -106,6 +195,20 @@ void evg_bgra_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 	col_g = GF_COL_G(col);
 	col_b = GF_COL_B(col);
 	col_no_a = col & 0x00FFFFFF;
+#ifdef GPAC_HAS_SSE2
+	if (EVG_USE_SIMD(surf, 4)) {
+		for (i=0; i<count; i++) {
+			x = spans[i].x * 4;
+			if (spans[i].coverage != 0xFF) {
+				a = mul255(0xFF, spans[i].coverage);
+				overmask_bgra_const_run_sse2((a<<24) | col_no_a, dst + x, spans[i].len);
+			} else {
+				evg_sse2_fill_u32((u32 *) (dst + x), col, spans[i].len);
+			}
+		}
+		return;
+	}
+#endif
 	for (i=0; i<count; i++) {
 		x = spans[i].x * surf->pitch_x;
 		len = spans[i].len;
@@ -135,6 +238,15 @@ void evg_bgra_fill_const_a(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 
 	a = (col>>24)&0xFF;
 	col_no_a = col & 0x00FFFFFF;
+#ifdef GPAC_HAS_SSE2
+	if (EVG_USE_SIMD(surf, 4)) {
+		for (i=0; i<count; i++) {
+			fin = mul255(a, spans[i].coverage);
+			overmask_bgra_const_run_sse2((fin<<24) | col_no_a, dst + 4*spans[i].x, spans[i].len);
+		}
+		return;
+	}
+#endif
 	for (i=0; i<count; i++) {
 		fin = mul255(a, spans[i].coverage);
 		fin = (fin<<24) | col_no_a;
@@ -157,6 +269,12 @@ void evg_bgra_fill_var(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 		surf->sten->fill_run(surf->sten, surf, spans[i].x, y, len);
 		x = spans[i].x * surf->pitch_x;
 		col = surf->stencil_pix_run;
+#ifdef GPAC_HAS_SSE2
+		if (EVG_USE_SIMD(surf, 4)) {
+			overmask_bgra_var_run_sse2(col, dst + x, spanalpha, len);
+			continue;
+		}
+#endif
 		while (len--) {
 			_col = *col;
 			col_a = GF_COL_A(_col);
@@ -262,6 +380,78 @@ GFINLINE static void overmask_bgrx_const_run(u32 src, u8 *dst, s32 dst_pitch_x,
 	}
 }
 
+#ifdef GPAC_HAS_SSE2
+/*SSE2 version of overmask_bgrx_const_run / overmask_rgbx_const_run for packed lines. srcp holds the
+premultiplied color in memory order, the 4th byte is set to 0xFF or kept depending on keep_x.
+Returns the number of pixels processed, always a multiple of 4*/
+static u32 overmask_32_premul_run_sse2(u32 srcp, s32 srca, u8 *dst, u32 count, Bool keep_x)
+{
+	u32 done = 0;
+	__m128i zero = _mm_setzero_si128();
+	__m128i s = _mm_unpacklo_epi8(_mm_set1_epi32(srcp & 0x00FFFFFF), zero);
+	__m128i inva = _mm_set1_epi16(256 - srca);
+	__m128i x_mask = _mm_set1_epi32(0xFF000000);
+
+	while (count>=4) {
+		__m128i d = _mm_loadu_si128((__m128i *)dst);
+		__m128i rlo = _mm_add_epi16(s, _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inva), 8));
+		__m128i rhi = _mm_add_epi16(s, _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inva), 8));
+		__m128i res = _mm_packus_epi16(rlo, rhi);
+		if (keep_x) res = EVG_SSE2_SELECT(x_mask, d, res);
+		else res = _mm_or_si128(res, x_mask);
+		_mm_storeu_si128((__m128i *)dst, res);
+		dst += 16;
+		count -= 4;
+		done += 4;
+	}
+	return done;
+}
+
+/*SSE2 version of the overmask_bgrx / overmask_rgbx loops for packed lines. If swap_rb is set, colors are
+written in RGB order. Returns the number of pixels processed, always a multiple of 4*/
+static u32 overmask_32_var_run_sse2(u32 *cols, u8 *dst, u8 spanalpha, u32 count, Bool swap_rb)
+{
+	u32 done = 0;
+	__m128i zero = _mm_setzero_si128();
+	__m128i span = _mm_set1_epi32(spanalpha);
+	__m128i x_mask = _mm_set1_epi32(0xFF000000);
+	__m128i ga_mask = _mm_set1_epi32(0xFF00FF00);
+	__m128i b_mask = _mm_set1_epi32(0xFF);
+
+	while (count>=4) {
+		__m128i c = _mm_loadu_si128((__m128i *)cols);
+		__m128i d = _mm_loadu_si128((__m128i *)dst);
+		__m128i ca = _mm_srli_epi32(c, 24);
+		__m128i a1 = _mm_add_epi32(_mm_srli_epi32(_mm_mullo_epi16(_mm_add_epi32(ca, _mm_set1_epi32(1)), span), 8), _mm_set1_epi32(1));
+		__m128i rlo, rhi, res;
+		if (swap_rb) {
+			c = _mm_or_si128(_mm_and_si128(c, ga_mask), _mm_or_si128(_mm_and_si128(_mm_srli_epi32(c, 16), b_mask), _mm_slli_epi32(_mm_and_si128(c, b_mask), 16)));
+		}
+		rlo = evg_sse2_blend(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero), evg_sse2_expand_lo(a1));
+		rhi = evg_sse2_blend(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero), evg_sse2_expand_hi(a1));
+		res = _mm_or_si128(_mm_packus_epi16(rlo, rhi), x_mask);
+		/*transparent colors are not drawn*/
+		res = EVG_SSE2_SELECT(_mm_cmpeq_epi32(ca, zero), d, res);
+		_mm_storeu_si128((__m128i *)dst, res);
+		cols += 4;
+		dst += 16;
+		count -= 4;
+		done += 4;
+	}
+	return done;
+}
+#endif
+
+#ifdef GPAC_HAS_SSE2
+static void overmask_bgrx_const_run_sse2(u32 src, u8 *dst, u32 count)
+{
+	s32 srca = (src>>24) & 0xff;
+	u32 srcp = mul255(srca, ((src >> 16) & 0xff))<<16 | mul255(srca, ((src >> 8) & 0xff))<<8 | mul255(srca, (src & 0xff));
+	u32 done = overmask_32_premul_run_sse2(srcp, srca, dst, count, GF_FALSE);
+	if (done<count) overmask_bgrx_const_run(src, dst + 4*done, 4, count - done);
+}
+#endif
+
 void evg_bgrx_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 {
 	u32 col = surf->fill_col;
@@ -275,6 +465,19 @@ void evg_bgrx_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 	col_r = GF_COL_R(col);
 	col_g = GF_COL_G(col);
 	col_b = GF_COL_B(col);
+#ifdef GPAC_HAS_SSE2
+	if (EVG_USE_SIMD(surf, 4)) {
+		for (i=0; i<count; i++) {
+			x = spans[i].x * 4;
+			if (spans[i].coverage != 0xFF) {
+				overmask_bgrx_const_run_sse2((spans[i].coverage<<24) | col_no_a, dst + x, spans[i].len);
+			} else {
+				evg_sse2_fill_u32((u32 *) (dst + x), col | 0xFF000000, spans[i].len);
+			}
+		}
+		return;
+	}
+#endif
 	for (i=0; i<count; i++) {
 		spana = spans[i].coverage;
 		x = spans[i].x * surf->pitch_x;
@@ -304,6 +507,15 @@ void evg_bgrx_fill_const_a(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 
 	a = (col>>24)&0xFF;
 	col_no_a = col & 0x00FFFFFF;
+#ifdef GPAC_HAS_SSE2
+	if (EVG_USE_SIMD(surf, 4)) {
+		for (i=0; i<count; i++) {
+			fin = mul255(a, spans[i].coverage);
+			overmask_bgrx_const_run_sse2((fin<<24) | col_no_a, dst + 4*spans[i].x, spans[i].len);
+		}
+		return;
+	}
+#endif
 	for (i=0; i<count; i++) {
 		fin = mul255(a, spans[i].coverage);
 		fin = (fin<<24) | col_no_a;
@@ -326,6 +538,14 @@ void evg_bgrx_fill_var(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 		surf->sten->fill_run(surf->sten, surf, spans[i].x, y, len);
 		col = surf->stencil_pix_run;
 		x = spans[i].x * surf->pitch_x;
+#ifdef GPAC_HAS_SSE2
+		if (EVG_USE_SIMD(surf, 4)) {
+			u32 done = overmask_32_var_run_sse2(col, dst + x, spanalpha, len, GF_FALSE);
+			col += done;
+			x += 4*done;
+			len -= done;
+		}
+#endif
 		while (len--) {
 			u32 _col = *col;
 			col_a = GF_COL_A(_col);
@@ -384,6 +604,16 @@ GFINLINE static void overmask_rgbx_const_run(u32 src, u8 *dst, s32 dst_pitch_x,
 	}
 }
 
+#ifdef GPAC_HAS_SSE2
+static void overmask_rgbx_const_run_sse2(u32 src, u8 *dst, u32 count)
+{
+	s32 srca = (src>>24) & 0xff;
+	u32 srcp = mul255(srca, (src & 0xff))<<16 | mul255(srca, ((src >> 8) & 0xff))<<8 | mul255(srca, ((src >> 16) & 0xff));
+	u32 done = overmask_32_premul_run_sse2(srcp, srca, dst, count, GF_TRUE);
+	if (done<count) overmask_rgbx_const_run(src, dst + 4*done, 4, count - done);
+}
+#endif
+
 void evg_rgbx_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 {
 	u32 col = surf->fill_col;
@@ -398,6 +628,20 @@ void evg_rgbx_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 	g = GF_COL_G(col);
 	b = GF_COL_B(col);
 
+#ifdef GPAC_HAS_SSE2
+	if (EVG_USE_SIMD(surf, 4)) {
+		u32 fill = 0xFF000000 | (b<<16) | (g<<8) | r;
+		for (i=0; i<count; i++) {
+			x = spans[i].x * 4;
+			if (spans[i].coverage != 0xFF) {
+				overmask_rgbx_const_run_sse2((spans[i].coverage<<24) | col_no_a, dst + x, spans[i].len);
+			} else {
+				evg_sse2_fill_u32((u32 *) (dst + x), fill, spans[i].len);
+			}
+		}
+		return;
+	}
+#endif
 	for (i=0; i<count; i++) {
 		spana = spans[i].coverage;
 		x = spans[i].x * surf->pitch_x;
@@ -427,6 +671,15 @@ void evg_rgbx_fill_const_a(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 
 	a = (col>>24)&0xFF;
 	col_no_a = col & 0x00FFFFFF;
+#ifdef GPAC_HAS_SSE2
+	if (EVG_USE_SIMD(surf, 4)) {
+		for (i=0; i<count; i++) {
+			fin = mul255(a, spans[i].coverage);
+			overmask_rgbx_const_run_sse2((fin<<24) | col_no_a, dst + 4*spans[i].x, spans[i].len);
+		}
+		return;
+	}
+#endif
 	for (i=0; i<count; i++) {
 		fin = mul255(a, spans[i].coverage);
 		fin = (fin<<24) | col_no_a;
@@ -449,6 +702,14 @@ void evg_rgbx_fill_var(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 		surf->sten->fill_run(surf->sten, surf, spans[i].x, y, len);
 		col = surf->stencil_pix_run;
 		x = spans[i].x * surf->pitch_x;
+#ifdef GPAC_HAS_SSE2
+		if (EVG_USE_SIMD(surf, 4)) {
+			u32 done = overmask_32_var_run_sse2(col, dst + x, spanalpha, len, GF_TRUE);
+			col += done;
+			x += 4*done;
+			len -= done;
+		}
+#endif
 		while (len--) {
 			_col = *col;
 			col_a = GF_COL_A(_col);
@@ -587,6 +848,71 @@ GFINLINE static void overmask_rgba_const_run(u32 src, u8 *dst, s32 dst_pitch_x,
 }
 
 
+#ifdef GPAC_HAS_SSE2
+/*SSE2 version of overmask_rgba for 4 pixels. c holds the ARGB colors and sa the blend alpha of each pixel.
+The division by the final alpha is done in single precision, which gives the same truncated result as the integer
+division for these ranges*/
+static GFINLINE __m128i overmask_rgba_sse2(__m128i c, __m128i sa, __m128i d)
+{
+	__m128i ff = _mm_set1_epi32(0xFF);
+	__m128i da = _mm_srli_epi32(d, 24);
+	__m128i fa = _mm_and_si128(_mm_sub_epi32(_mm_add_epi32(da, sa), _mm_srli_epi32(_mm_mullo_epi16(_mm_add_epi32(da, _mm_set1_epi32(1)), sa), 8)), ff);
+	__m128 fsa = _mm_cvtepi32_ps(sa);
+	__m128 fdiff = _mm_cvtepi32_ps(_mm_sub_epi32(da, sa));
+	__m128 ffa = _mm_cvtepi32_ps(fa);
+	__m128i sr = _mm_and_si128(_mm_srli_epi32(c, 16), ff);
+	__m128i sg = _mm_and_si128(_mm_srli_epi32(c, 8), ff);
+	__m128i sb = _mm_and_si128(c, ff);
+	__m128i r, g, b, res, copy, mask;
+
+#define EVG_RGBA_DIV(_s, _d)	_mm_and_si128(_mm_cvttps_epi32(_mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_s), fsa), _mm_mul_ps(_mm_cvtepi32_ps(_d), fdiff)), ffa)), ff)
+	r = EVG_RGBA_DIV(sr, _mm_and_si128(d, ff));
+	g = EVG_RGBA_DIV(sg, _mm_and_si128(_mm_srli_epi32(d, 8), ff));
+	b = EVG_RGBA_DIV(sb, _mm_and_si128(_mm_srli_epi32(d, 16), ff));
+#undef EVG_RGBA_DIV
+
+	res = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(fa, 24)));
+	copy = _mm_or_si128(_mm_or_si128(sr, _mm_slli_epi32(sg, 8)), _mm_or_si128(_mm_slli_epi32(sb, 16), _mm_slli_epi32(sa, 24)));
+	/*if dst alpha is 0 or source alpha is 0xFF, copy pixel*/
+	mask = _mm_or_si128(_mm_cmpeq_epi32(da, _mm_setzero_si128()), _mm_cmpeq_epi32(sa, ff));
+	return EVG_SSE2_SELECT(mask, copy, res);
+}
+
+static void overmask_rgba_const_run_sse2(u32 src, u8 *dst, u32 count)
+{
+	__m128i c = _mm_set1_epi32(src);
+	__m128i sa = _mm_set1_epi32(GF_COL_A(src));
+	while (count>=4) {
+		__m128i d = _mm_loadu_si128((__m128i *)dst);
+		_mm_storeu_si128((__m128i *)dst, overmask_rgba_sse2(c, sa, d));
+		dst += 16;
+		count -= 4;
+	}
+	if (count) overmask_rgba_const_run(src, dst, 4, count);
+}
+
+static void overmask_rgba_var_run_sse2(u32 *cols, u8 *dst, u8 spanalpha, u32 count)
+{
+	__m128i span = _mm_set1_epi32(spanalpha);
+	while (count>=4) {
+		__m128i c = _mm_loadu_si128((__m128i *)cols);
+		__m128i d = _mm_loadu_si128((__m128i *)dst);
+		/*srca = mul255(col_a, spanalpha)*/
+		__m128i sa = _mm_srli_epi32(_mm_mullo_epi16(_mm_add_epi32(_mm_srli_epi32(c, 24), _mm_set1_epi32(1)), span), 8);
+		_mm_storeu_si128((__m128i *)dst, overmask_rgba_sse2(c, sa, d));
+		cols += 4;
+		dst += 16;
+		count -= 4;
+	}
+	while (count) {
+		overmask_rgba(*cols, dst, spanalpha);
+		cols++;
+		dst += 4;
+		count--;
+	}
+}
+#endif
+
 void evg_rgba_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 {
 	u32 col = surf->fill_col;
@@ -605,6 +931,12 @@ void evg_rgba_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 		new_a = spans[i].coverage;
 		fin = (new_a<<24) | col_no_a;
 		//we must blend in all cases since we have to merge with the dst alpha
+#ifdef GPAC_HAS_SSE2
+		if (EVG_USE_SIMD(surf, 4)) {
+			overmask_rgba_const_run_sse2(fin, p, len);
+			continue;
+		}
+#endif
 		overmask_rgba_const_run(fin, p, surf->pitch_x, len);
 	}
 }
@@ -621,6 +953,12 @@ void evg_rgba_fill_const_a(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 	for (i=0; i<count; i++) {
 		fin = mul255(a, spans[i].coverage);
 		fin = (fin<<24) | col_no_a;
+#ifdef GPAC_HAS_SSE2
+		if (EVG_USE_SIMD(surf, 4)) {
+			overmask_rgba_const_run_sse2(fin, dst + spans[i].x*4, spans[i].len);
+			continue;
+		}
+#endif
 		overmask_rgba_const_run(fin, dst + spans[i].x*surf->pitch_x, surf->pitch_x, spans[i].len);
 	}
 }
@@ -640,6 +978,12 @@ void evg_rgba_fill_var(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 		spanalpha = spans[i].coverage;
 		surf->sten->fill_run(surf->sten, surf, spans[i].x, y, len);
 		col = surf->stencil_pix_run;
+#ifdef GPAC_HAS_SSE2
+		if (EVG_USE_SIMD(surf, 4)) {
+			overmask_rgba_var_run_sse2(col, p, spanalpha, len);
+			continue;
+		}
+#endif
 		while (len--) {
 			//we must blend in all cases since we have to merge with the dst alpha
 			overmask_rgba(*col, p, spanalpha);
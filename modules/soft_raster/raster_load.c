@@ -69,6 +69,7 @@ GF_Raster2D *EVG_LoadRenderer()
 
 void EVG_ShutdownRenderer(GF_Raster2D *dr)
 {
+	evg_band_pool_del((EVGBandPool *) dr->internal);
 	gf_free(dr);
 }
 
@@ -34,6 +34,69 @@ mul255(s32 a, s32 b)
 }
 
 
+#ifdef GPAC_HAS_SSE2
+/*24 bit SSE2 span fillers work on 16 pixels (3 registers) at a time, using the color repeated 16 times as a
+48 bytes pattern. They return the number of pixels processed, always a multiple of 16*/
+static void evg_24_pattern(u8 *pattern, u8 c0, u8 c1, u8 c2)
+{
+	u32 i;
+	for (i=0; i<16; i++) {
+		pattern[3*i] = c0;
+		pattern[3*i+1] = c1;
+		pattern[3*i+2] = c2;
+	}
+}
+
+static u32 evg_24_fill_sse2(u8 c0, u8 c1, u8 c2, char *dst, u32 count)
+{
+	u32 done = 0;
+	u8 pattern[48];
+	__m128i v0, v1, v2;
+	if (count<16) return 0;
+	evg_24_pattern(pattern, c0, c1, c2);
+	v0 = _mm_loadu_si128((__m128i *)pattern);
+	v1 = _mm_loadu_si128((__m128i *)(pattern+16));
+	v2 = _mm_loadu_si128((__m128i *)(pattern+32));
+	while (count>=16) {
+		_mm_storeu_si128((__m128i *)dst, v0);
+		_mm_storeu_si128((__m128i *)(dst+16), v1);
+		_mm_storeu_si128((__m128i *)(dst+32), v2);
+		dst += 48;
+		count -= 16;
+		done += 16;
+	}
+	return done;
+}
+
+static u32 overmask_24_const_run_sse2(u8 c0, u8 c1, u8 c2, u8 srca, char *dst, u32 count)
+{
+	u32 i, done = 0;
+	u8 pattern[48];
+	__m128i zero = _mm_setzero_si128();
+	__m128i a1 = _mm_set1_epi16(srca + 1);
+	__m128i s[6];
+	if (count<16) return 0;
+	evg_24_pattern(pattern, c0, c1, c2);
+	for (i=0; i<3; i++) {
+		__m128i v = _mm_loadu_si128((__m128i *)(pattern + 16*i));
+		s[2*i] = _mm_unpacklo_epi8(v, zero);
+		s[2*i+1] = _mm_unpackhi_epi8(v, zero);
+	}
+	while (count>=16) {
+		for (i=0; i<3; i++) {
+			__m128i d = _mm_loadu_si128((__m128i *)(dst + 16*i));
+			__m128i rlo = evg_sse2_blend(s[2*i], _mm_unpacklo_epi8(d, zero), a1);
+			__m128i rhi = evg_sse2_blend(s[2*i+1], _mm_unpackhi_epi8(d, zero), a1);
+			_mm_storeu_si128((__m128i *)(dst + 16*i), _mm_packus_epi16(rlo, rhi));
+		}
+		dst += 48;
+		count -= 16;
+		done += 16;
+	}
+	return done;
+}
+#endif
+
 /*
 			RGB part
 */
@@ -95,8 +158,22 @@ void evg_rgb_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 		if (spans[i].coverage != 0xFF) {
 			a = mul255(0xFF, spans[i].coverage);
 			fin = (a<<24) | col_no_a;
+#ifdef GPAC_HAS_SSE2
+			if (EVG_USE_SIMD(surf, 3)) {
+				u32 done = overmask_24_const_run_sse2(r, g, b, a, p, len);
+				p += 3*done;
+				len -= done;
+			}
+#endif
 			overmask_rgb_const_run(fin, p, surf->pitch_x, len);
 		} else {
+#ifdef GPAC_HAS_SSE2
+			if (EVG_USE_SIMD(surf, 3)) {
+				u32 done = evg_24_fill_sse2(r, g, b, p, len);
+				p += 3*done;
+				len -= done;
+			}
+#endif
 			while (len--) {
 				*(p) = r;
 				*(p + 1) = g;
@@ -116,9 +193,18 @@ void evg_rgb_fill_const_a(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 
 	a = (col>>24)&0xFF;
 	for (i=0; i<count; i++) {
+		char *p = dst + surf->pitch_x * spans[i].x;
+		u32 len = spans[i].len;
 		fin = mul255(a, spans[i].coverage);
+#ifdef GPAC_HAS_SSE2
+		if (EVG_USE_SIMD(surf, 3)) {
+			u32 done = overmask_24_const_run_sse2(GF_COL_R(col), GF_COL_G(col), GF_COL_B(col), fin, p, len);
+			p += 3*done;
+			len -= done;
+		}
+#endif
 		fin = (fin<<24) | (col&0x00FFFFFF);
-		overmask_rgb_const_run(fin, dst + surf->pitch_x * spans[i].x, surf->pitch_x, spans[i].len);
+		overmask_rgb_const_run(fin, p, surf->pitch_x, len);
 	}
 }
 
@@ -247,8 +333,22 @@ void evg_bgr_fill_const(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 		if (spans[i].coverage != 0xFF) {
 			a = mul255(0xFF, spans[i].coverage);
 			fin = (a<<24) | col_no_a;
+#ifdef GPAC_HAS_SSE2
+			if (EVG_USE_SIMD(surf, 3)) {
+				u32 done = overmask_24_const_run_sse2(b, g, r, a, p, len);
+				p += 3*done;
+				len -= done;
+			}
+#endif
 			overmask_bgr_const_run(fin, p, surf->pitch_x, len);
 		} else {
+#ifdef GPAC_HAS_SSE2
+			if (EVG_USE_SIMD(surf, 3)) {
+				u32 done = evg_24_fill_sse2(b, g, r, p, len);
+				p += 3*done;
+				len -= done;
+			}
+#endif
 			while (len--) {
 				*(p) = b;
 				*(p + 1) = g;
@@ -269,9 +369,18 @@ void evg_bgr_fill_const_a(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf)
 	a = (col>>24)&0xFF;
 	col_no_a = col & 0x00FFFFFF;
 	for (i=0; i<count; i++) {
+		char *p = dst + surf->pitch_x * spans[i].x;
+		u32 len = spans[i].len;
 		fin = mul255(a, spans[i].coverage);
+#ifdef GPAC_HAS_SSE2
+		if (EVG_USE_SIMD(surf, 3)) {
+			u32 done = overmask_24_const_run_sse2(GF_COL_B(col), GF_COL_G(col), GF_COL_R(col), fin, p, len);
+			p += 3*done;
+			len -= done;
+		}
+#endif
 		fin = (fin<<24) | col_no_a;
-		overmask_bgr_const_run(fin, dst + surf->pitch_x * spans[i].x, surf->pitch_x, spans[i].len);
+		overmask_bgr_const_run(fin, p, surf->pitch_x, len);
 	}
 }
 
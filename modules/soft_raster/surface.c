@@ -26,6 +26,7 @@
 
 
 #include "rast_soft.h"
+#include <gpac/thread.h>
 
 static void get_surface_world_matrix(EVGSurface *_this, GF_Matrix2D *mat)
 {
@@ -46,6 +47,22 @@ GF_SURFACE evg_surface_new(GF_Raster2D *_dr, Bool center_coords)
 		_this->ftparams.source = &_this->ftoutline;
 		_this->ftparams.user = _this;
 		_this->raster = evg_raster_new();
+#ifndef GPAC_STANDALONE_RENDER_2D
+		if (_dr && !_dr->internal) {
+			u32 nb_threads = 1;
+			const char *opt = gf_modules_get_option((GF_BaseInterface *)_dr, "Compositor", "RasterThreads");
+			if (opt) nb_threads = atoi(opt);
+			else gf_modules_set_option((GF_BaseInterface *)_dr, "Compositor", "RasterThreads", "1");
+			if (!nb_threads) {
+				GF_SystemRTInfo rti;
+				memset(&rti, 0, sizeof(GF_SystemRTInfo));
+				gf_sys_get_rti(0xFFFFFFFF, &rti, 0);
+				nb_threads = rti.nb_cores;
+			}
+			_dr->internal = evg_band_pool_new(nb_threads);
+		}
+#endif
+		if (_dr) _this->bands = (EVGBandPool *) _dr->internal;
 	}
 	return _this;
 }
@@ -553,6 +570,166 @@ GF_Err evg_surface_set_path(GF_SURFACE _this, GF_Path *gp)
 
 /* static void gray_spans_stub(s32 y, s32 count, EVG_Span *spans, EVGSurface *surf){} */
 
+/*fills covering less pixels than this are rasterized on the calling thread*/
+#define EVG_BAND_MIN_AREA	(128*128)
+/*min height of a band*/
+#define EVG_BAND_MIN_HEIGHT	16
+
+typedef struct
+{
+	EVGBandPool *pool;
+	GF_Thread *th;
+	GF_Semaphore *start;
+	/*copy of the surface being filled, clipped to the band, with its own raster and stencil buffer*/
+	EVGSurface surf;
+	EVG_Raster raster;
+	u32 *pix_run;
+	u32 pix_run_size;
+} EVGBand;
+
+struct _evg_band_pool
+{
+	/*band 0 is rasterized by the calling thread*/
+	u32 nb_bands;
+	EVGBand *bands;
+	GF_Semaphore *done;
+	/*a pool is used by one fill at a time, fills from other threads are not split*/
+	GF_Mutex *mx;
+	Bool exit;
+};
+
+static u32 evg_band_run(void *par)
+{
+	EVGBand *band = (EVGBand *)par;
+	while (1) {
+		gf_sema_wait(band->start);
+		if (band->pool->exit) break;
+		evg_raster_render(band->raster, &band->surf.ftparams);
+		gf_sema_notify(band->pool->done, 1);
+	}
+	return 0;
+}
+
+EVGBandPool *evg_band_pool_new(u32 nb_threads)
+{
+	u32 i;
+	EVGBandPool *pool;
+	if (nb_threads<2) return NULL;
+	GF_SAFEALLOC(pool, EVGBandPool);
+	if (!pool) return NULL;
+	pool->bands = (EVGBand *) gf_malloc(sizeof(EVGBand) * nb_threads);
+	if (!pool->bands) {
+		gf_free(pool);
+		return NULL;
+	}
+	memset(pool->bands, 0, sizeof(EVGBand) * nb_threads);
+	pool->done = gf_sema_new(nb_threads, 0);
+	pool->mx = gf_mx_new("EVGBands");
+	pool->nb_bands = 1;
+	for (i=1; i<nb_threads; i++) {
+		EVGBand *band = &pool->bands[i];
+		band->pool = pool;
+		band->raster = evg_raster_new();
+		band->start = gf_sema_new(1, 0);
+		band->th = gf_th_new("EVGBand");
+		if (gf_th_run(band->th, evg_band_run, band) != GF_OK) {
+			gf_th_del(band->th);
+			gf_sema_del(band->start);
+			evg_raster_del(band->raster);
+			break;
+		}
+		pool->nb_bands++;
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_COMPOSE, ("[Raster2D] Rasterizing large fills in %d bands\n", pool->nb_bands));
+	return pool;
+}
+
+void evg_band_pool_del(EVGBandPool *pool)
+{
+	u32 i;
+	if (!pool) return;
+	pool->exit = GF_TRUE;
+	for (i=1; i<pool->nb_bands; i++) {
+		EVGBand *band = &pool->bands[i];
+		gf_sema_notify(band->start, 1);
+		gf_th_stop(band->th);
+		gf_th_del(band->th);
+		gf_sema_del(band->start);
+		evg_raster_del(band->raster);
+		if (band->pix_run) gf_free(band->pix_run);
+	}
+	gf_sema_del(pool->done);
+	gf_mx_del(pool->mx);
+	gf_free(pool->bands);
+	gf_free(pool);
+}
+
+/*rasterizes the fill in horizontal bands, one per pool thread. Each scanline only depends on the outline, so the result is
+the same as rasterizing the whole fill at once. Returns GF_FALSE if the fill is not worth splitting or cannot be split*/
+static Bool evg_surface_fill_bands(EVGSurface *surf)
+{
+	GF_Rect rc;
+	s32 y_min, y_max, height, clip_y_min, clip_y_max;
+	u32 i, nb_bands;
+	EVGBandPool *pool = surf->bands;
+
+	/*user callbacks may not be thread-safe*/
+	if (surf->raster_cbk) return GF_FALSE;
+
+	/*rows covered by the path, only used to balance the bands: the first and last bands always extend to the clipper*/
+	rc = surf->path_bounds;
+	rc.y += rc.height;
+	gf_mx2d_apply_rect(&surf->mat, &rc);
+	clip_y_min = surf->ftparams.clip_yMin;
+	clip_y_max = surf->ftparams.clip_yMax;
+	y_min = MAX(FIX2INT(gf_floor(rc.y - rc.height)), clip_y_min);
+	y_max = MIN(FIX2INT(gf_ceil(rc.y)), clip_y_max);
+	height = y_max - y_min;
+	if (height < 2*EVG_BAND_MIN_HEIGHT) return GF_FALSE;
+	if ((u32) height * (u32) MIN(FIX2INT(gf_ceil(rc.width)), surf->ftparams.clip_xMax - surf->ftparams.clip_xMin) < EVG_BAND_MIN_AREA) return GF_FALSE;
+
+	if (!gf_mx_try_lock(pool->mx)) return GF_FALSE;
+
+	nb_bands = MIN(pool->nb_bands, (u32) height / EVG_BAND_MIN_HEIGHT);
+	/*allocate the stencil runs of the bands, use fewer bands on failure*/
+	for (i=1; i<nb_bands; i++) {
+		EVGBand *band = &pool->bands[i];
+		if (band->pix_run_size < surf->width+2) {
+			u32 *pix_run = (u32 *) gf_realloc(band->pix_run, sizeof(u32) * (surf->width+2));
+			if (!pix_run) {
+				nb_bands = i;
+				break;
+			}
+			band->pix_run = pix_run;
+			band->pix_run_size = surf->width+2;
+		}
+	}
+	if (nb_bands<2) {
+		gf_mx_v(pool->mx);
+		return GF_FALSE;
+	}
+	for (i=1; i<nb_bands; i++) {
+		EVGBand *band = &pool->bands[i];
+		memcpy(&band->surf, surf, sizeof(EVGSurface));
+		band->surf.raster = band->raster;
+		band->surf.stencil_pix_run = band->pix_run;
+		band->surf.ftparams.user = &band->surf;
+		band->surf.ftparams.clip_yMin = y_min + height * i / nb_bands;
+		band->surf.ftparams.clip_yMax = (i+1==nb_bands) ? clip_y_max : y_min + height * (i+1) / nb_bands;
+		gf_sema_notify(band->start, 1);
+	}
+	/*first band on the calling thread*/
+	surf->ftparams.clip_yMax = y_min + height / nb_bands;
+	evg_raster_render(surf->raster, &surf->ftparams);
+	surf->ftparams.clip_yMax = clip_y_max;
+
+	for (i=1; i<nb_bands; i++) {
+		gf_sema_wait(pool->done);
+	}
+	gf_mx_v(pool->mx);
+	return GF_TRUE;
+}
+
 GF_Err evg_surface_fill(GF_SURFACE _this, GF_STENCIL stencil)
 {
 	GF_Rect rc;
@@ -647,7 +824,8 @@ GF_Err evg_surface_fill(GF_SURFACE _this, GF_STENCIL stencil)
 	}
 
 	/*and call the raster*/
-	evg_raster_render(surf->raster, &surf->ftparams);
+	if (!surf->bands || !evg_surface_fill_bands(surf))
+		evg_raster_render(surf->raster, &surf->ftparams);
 
 	/*restore stencil matrix*/
 	if (sten->type != GF_STENCIL_SOLID) {
@@ -25,6 +25,16 @@
 
 #include <gpac/internal/compositor_dev.h>
 
+#if defined(WIN32) && !defined(__GNUC__)
+# include <intrin.h>
+# define GPAC_HAS_SSE2
+#else
+# ifdef __SSE2__
+#  include <emmintrin.h>
+#  define GPAC_HAS_SSE2
+# endif
+#endif
+
 /*max number of channels we support in mixer*/
 #define GF_SR_MAX_CHANNELS	24
 
@@ -498,6 +508,174 @@ static GFINLINE s32 make_s24_int(u8 *ptr)
 	return (((s32)res) << 8 ) | ptr[0];
 }
 
+/*
+	mixing kernels: SSE2 versions are used for the common mono and stereo cases, other layouts use the scalar loops
+*/
+
+/*deinterleaves nb_samp frames of s16 samples in the channel buffers, starting at sample offset*/
+static void gf_mixer_deinterleave_s16(s32 **ch_buf, u32 offset, s16 *src, u32 nb_samp, u32 nb_ch)
+{
+	u32 i, j;
+	s32 *l, *r;
+	i = 0;
+	if (nb_ch==1) {
+		l = ch_buf[0] + offset;
+#ifdef GPAC_HAS_SSE2
+		for (; i+8<=nb_samp; i+=8) {
+			__m128i v = _mm_loadu_si128((__m128i *) (src+i));
+			_mm_storeu_si128((__m128i *) (l+i), _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+			_mm_storeu_si128((__m128i *) (l+i+4), _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+		}
+#endif
+		for (; i<nb_samp; i++) l[i] = src[i];
+		return;
+	}
+	if (nb_ch==2) {
+		l = ch_buf[0] + offset;
+		r = ch_buf[1] + offset;
+#ifdef GPAC_HAS_SSE2
+		for (; i+4<=nb_samp; i+=4) {
+			__m128i v = _mm_loadu_si128((__m128i *) (src+2*i));
+			/*sign extend and reorder as L0 L1 R0 R1 / L2 L3 R2 R3*/
+			__m128i lo = _mm_shuffle_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), _MM_SHUFFLE(3,1,2,0));
+			__m128i hi = _mm_shuffle_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16), _MM_SHUFFLE(3,1,2,0));
+			_mm_storeu_si128((__m128i *) (l+i), _mm_unpacklo_epi64(lo, hi));
+			_mm_storeu_si128((__m128i *) (r+i), _mm_unpackhi_epi64(lo, hi));
+		}
+#endif
+		for (; i<nb_samp; i++) {
+			l[i] = src[2*i];
+			r[i] = src[2*i+1];
+		}
+		return;
+	}
+	for (i=0; i<nb_samp; i++) {
+		for (j=0; j<nb_ch; j++) {
+			ch_buf[j][offset+i] = src[nb_ch*i + j];
+		}
+	}
+}
+
+static void gf_mixer_deinterleave(s32 **ch_buf, u32 offset, s8 *src, u32 bps, u32 nb_samp, u32 nb_ch)
+{
+	u32 i, j;
+	switch (bps) {
+	case 16:
+		gf_mixer_deinterleave_s16(ch_buf, offset, (s16 *) src, nb_samp, nb_ch);
+		return;
+	case 32:
+		for (i=0; i<nb_samp; i++) {
+			for (j=0; j<nb_ch; j++) ch_buf[j][offset+i] = ((s32 *)src)[nb_ch*i + j];
+		}
+		return;
+	case 24:
+		for (i=0; i<nb_samp; i++) {
+			for (j=0; j<nb_ch; j++) ch_buf[j][offset+i] = make_s24_int((u8 *) &src[3*(nb_ch*i + j)]);
+		}
+		return;
+	default:
+		for (i=0; i<nb_samp; i++) {
+			for (j=0; j<nb_ch; j++) ch_buf[j][offset+i] = src[nb_ch*i + j];
+		}
+		return;
+	}
+}
+
+/*applies a volume in percent to a channel buffer*/
+static void gf_mixer_apply_gain(s32 *buf, u32 nb_samp, s32 gain)
+{
+	u32 i = 0;
+	if (gain==100) return;
+	if (!gain) {
+		memset(buf, 0, sizeof(s32)*nb_samp);
+		return;
+	}
+#ifdef GPAC_HAS_SSE2
+	{
+		/*SSE2 has no 32 bit integer multiply, go through double: the product is exact and the truncated quotient
+		is the same as the integer division of the scalar code*/
+		__m128d g = _mm_set1_pd((Double) gain);
+		__m128d d = _mm_set1_pd(100.0);
+		for (; i+4<=nb_samp; i+=4) {
+			__m128i v = _mm_loadu_si128((__m128i *) (buf+i));
+			__m128d lo = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(v), g), d);
+			__m128d hi = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(v, 8)), g), d);
+			_mm_storeu_si128((__m128i *) (buf+i), _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi)));
+		}
+	}
+#endif
+	for (; i<nb_samp; i++) buf[i] = buf[i] * gain / 100;
+}
+
+/*adds nb_samp frames of the channel buffers to the interleaved mix buffer, shifting the samples by shift bits (left shift if positive)*/
+static void gf_mixer_accumulate(s32 *out_mix, s32 **ch_buf, u32 nb_samp, u32 nb_ch, s32 shift)
+{
+	u32 i, k;
+	i = 0;
+#ifdef GPAC_HAS_SSE2
+	if (nb_ch<=2) {
+		__m128i lsh = _mm_cvtsi32_si128( (shift>0) ? shift : 0);
+		__m128i rsh = _mm_cvtsi32_si128( (shift<0) ? -shift : 0);
+		if (nb_ch==1) {
+			for (; i+4<=nb_samp; i+=4) {
+				__m128i v = _mm_sra_epi32(_mm_sll_epi32(_mm_loadu_si128((__m128i *) (ch_buf[0]+i)), lsh), rsh);
+				_mm_storeu_si128((__m128i *) (out_mix+i), _mm_add_epi32(_mm_loadu_si128((__m128i *) (out_mix+i)), v));
+			}
+		} else {
+			for (; i+4<=nb_samp; i+=4) {
+				__m128i l = _mm_sra_epi32(_mm_sll_epi32(_mm_loadu_si128((__m128i *) (ch_buf[0]+i)), lsh), rsh);
+				__m128i r = _mm_sra_epi32(_mm_sll_epi32(_mm_loadu_si128((__m128i *) (ch_buf[1]+i)), lsh), rsh);
+				__m128i *dst = (__m128i *) (out_mix + 2*i);
+				_mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), _mm_unpacklo_epi32(l, r)));
+				_mm_storeu_si128(dst+1, _mm_add_epi32(_mm_loadu_si128(dst+1), _mm_unpackhi_epi32(l, r)));
+			}
+		}
+	}
+#endif
+	out_mix += i*nb_ch;
+	if (shift>0) {
+		for (; i<nb_samp; i++) {
+			for (k=0; k<nb_ch; k++) {
+				(*out_mix) += ch_buf[k][i] << shift;
+				out_mix++;
+			}
+		}
+	} else if (shift<0) {
+		for (; i<nb_samp; i++) {
+			for (k=0; k<nb_ch; k++) {
+				(*out_mix) += ch_buf[k][i] >> (-shift);
+				out_mix++;
+			}
+		}
+	} else {
+		for (; i<nb_samp; i++) {
+			for (k=0; k<nb_ch; k++) {
+				(*out_mix) += ch_buf[k][i];
+				out_mix++;
+			}
+		}
+	}
+}
+
+/*converts the mix buffer to s16 with saturation*/
+static void gf_mixer_output_s16(s16 *out_s16, s32 *out_mix, u32 nb_samp)
+{
+	u32 i = 0;
+#ifdef GPAC_HAS_SSE2
+	for (; i+8<=nb_samp; i+=8) {
+		__m128i a = _mm_loadu_si128((__m128i *) (out_mix+i));
+		__m128i b = _mm_loadu_si128((__m128i *) (out_mix+i+4));
+		_mm_storeu_si128((__m128i *) (out_s16+i), _mm_packs_epi32(a, b));
+	}
+#endif
+	for (; i<nb_samp; i++) {
+		s32 samp = out_mix[i];
+		if (samp > GF_SHORT_MAX) samp = GF_SHORT_MAX;
+		else if (samp < GF_SHORT_MIN) samp = GF_SHORT_MIN;
+		out_s16[i] = samp;
+	}
+}
+
 static void gf_mixer_fetch_input(GF_AudioMixer *am, MixerInput *in, u32 audio_delay)
 {
 	u32 i, j, in_ch, out_ch, prev, next, src_samp, ratio, src_size;
@@ -506,7 +684,8 @@ static void gf_mixer_fetch_input(GF_AudioMixer *am, MixerInput *in, u32 audio_de
 	s16 *in_s16 = NULL;
 	s8 *in_s24 = NULL;
 	s8 *in_s8 = NULL;
-	s32 frac, inChan[GF_SR_MAX_CHANNELS], inChanNext[GF_SR_MAX_CHANNELS];
+	s32 frac, inChan[GF_SR_MAX_CHANNELS], inChanNext[GF_SR_MAX_CHANNELS], gains[GF_SR_MAX_CHANNELS];
+	Bool use_gain, use_map;
 	
 	in_s8 = (s8 *) in->src->FetchFrame(in->src->callback, &src_size, audio_delay);
 	if (!in_s8 || !src_size) {
@@ -541,6 +720,30 @@ static void gf_mixer_fetch_input(GF_AudioMixer *am, MixerInput *in, u32 audio_de
 		return;
 	}
 
+	/*volume in percent for each output channel - don't apply pan when forced layout is used*/
+	use_gain = GF_FALSE;
+	for (j=0; j<out_ch; j++) {
+		gains[j] = (j<6) ? FIX2INT(100*in->pan[j]) : 100;
+		if (gains[j] != 100) use_gain = GF_TRUE;
+	}
+	if (in->src->forced_layout) use_gain = GF_FALSE;
+	use_map = (in_ch != out_ch) ? GF_TRUE : GF_FALSE;
+
+	/*no resampling nor channel mapping: deinterleave the input straight into the channel buffers*/
+	if ((ratio==255) && !in->has_prev && !use_map) {
+		u32 nb_samp = MIN(src_samp, in->out_samples_to_write - in->out_samples_written);
+		gf_mixer_deinterleave(in->ch_buf, in->out_samples_written, in_s32 ? (s8 *)in_s32 : (in_s24 ? in_s24 : (in_s16 ? (s8 *)in_s16 : in_s8)), in->src->bps, nb_samp, in_ch);
+		if (use_gain) {
+			for (j=0; j<out_ch; j++)
+				gf_mixer_apply_gain(in->ch_buf[j] + in->out_samples_written, nb_samp, gains[j]);
+		}
+		in->out_samples_written += nb_samp;
+		in->in_bytes_used = nb_samp * in->src->bps * in_ch / 8;
+		/*cf below, make sure we call release*/
+		in->in_bytes_used += 1;
+		return;
+	}
+
 	/*while space to fill and input data, convert*/
 	use_prev = in->has_prev;
 	memset(inChan, 0, sizeof(s32)*GF_SR_MAX_CHANNELS);
@@ -583,11 +786,12 @@ static void gf_mixer_fetch_input(GF_AudioMixer *am, MixerInput *in, u32 audio_de
 			}
 		}
 		//map inChannel to the output channel config
-		gf_mixer_map_channels(inChan, in_ch, in->src->ch_cfg, in->src->forced_layout, out_ch, am->channel_cfg);
-		//don't apply pan when forced layout is used
-		if (!in->src->forced_layout) {
+		if (use_map)
+			gf_mixer_map_channels(inChan, in_ch, in->src->ch_cfg, in->src->forced_layout, out_ch, am->channel_cfg);
+
+		if (use_gain) {
 			for (j=0; j<out_ch ; j++) {
-				*(in->ch_buf[j] + in->out_samples_written) = (s32) (inChan[j] * FIX2INT(100*in->pan[j]) / 100 );
+				*(in->ch_buf[j] + in->out_samples_written) = (s32) (inChan[j] * gains[j] / 100 );
 			}
 		} else {
 			for (j=0; j<out_ch ; j++) {
@@ -820,40 +1024,11 @@ do_mix:
 
 	nb_written = 0;
 	for (i=0; i<count; i++) {
-		u32 k;
-		out_mix = am->output;
 		in = (MixerInput *)gf_list_get(am->sources, i);
 		if (!in->out_samples_to_write) continue;
 		/*only write what has been filled in the source buffer (may be less than output size)*/
-		if (am->bits_per_sample > in->src->bps) {
-			s32 mul = am->bits_per_sample - in->src->bps;
-			for (j = 0; j < in->out_samples_written; j++) {
-				for (k = 0; k < am->nb_channels; k++) {
-					s32 res = *(in->ch_buf[k] + j);
-					res <<= mul;
-					(*out_mix) += res;
-					out_mix += 1;
-				}
-			}
-		}
-		else if (am->bits_per_sample < in->src->bps) {
-			s32 div = in->src->bps - am->bits_per_sample;
-			for (j = 0; j < in->out_samples_written; j++) {
-				for (k = 0; k < am->nb_channels; k++) {
-					s32 res = *(in->ch_buf[k] + j);
-					res >>= div;
-					(*out_mix) += res;
-					out_mix += 1;
-				}
-			}
-		} else {
-			for (j = 0; j < in->out_samples_written; j++) {
-				for (k = 0; k < am->nb_channels; k++) {
-					(*out_mix) += *(in->ch_buf[k] + j);
-					out_mix += 1;
-				}
-			}
-		}
+		gf_mixer_accumulate(am->output, in->ch_buf, in->out_samples_written, am->nb_channels, (s32) am->bits_per_sample - (s32) in->src->bps);
+
 		if (nb_written < in->out_samples_written) nb_written = in->out_samples_written;
 	}
 
@@ -896,17 +1071,7 @@ do_mix:
 			}
 		}
 	} else if (am->bits_per_sample == 16) {
-		s16 *out_s16 = (s16 *)buffer;
-		for (i = 0; i<nb_written; i++) {
-			for (j = 0; j<am->nb_channels; j++) {
-				s32 samp = (*out_mix);
-				if (samp > GF_SHORT_MAX) samp = GF_SHORT_MAX;
-				else if (samp < GF_SHORT_MIN) samp = GF_SHORT_MIN;
-				(*out_s16) = samp;
-				out_s16 += 1;
-				out_mix += 1;
-			}
-		}
+		gf_mixer_output_s16((s16 *)buffer, out_mix, nb_written * am->nb_channels);
 	}
 	else {
 		s8 *out_s8 = (s8 *) buffer;
@@ -648,7 +648,7 @@ GF_Compositor *gf_sc_new(GF_User *user, Bool self_threaded, GF_Terminal *term)
 	if ((tmp->user->init_flags & GF_TERM_NO_REGULATION) || !tmp->VisualThread)
 		tmp->no_regulation = GF_TRUE;
 	
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_RTI, ("[RTI]\tCompositor Cycle Log\tNetworks\tDecoders\tFrame\tDirect Draw\tVisual Config\tEvent\tRoute\tSMIL Timing\tTime node\tTexture\tSMIL Anim\tTraverse setup\tTraverse (and direct Draw)\tTraverse (and direct Draw) without anim\tIndirect Draw\tTraverse And Draw (Indirect or Not)\tFlush\tCycle\n"));
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_RTI, ("[RTI]\tCompositor Cycle Log\tNetworks\tDecoders\tFrame\tDirect Draw\tVisual Config\tEvent\tRoute\tSMIL Timing\tTime node\tTexture\tSMIL Anim\tTraverse setup\tTraverse (and direct Draw)\tTraverse (and direct Draw) without anim\tIndirect Draw\tTraverse And Draw (Indirect or Not)\tFlush\tCycle\tGlyph Cache Hits\tGlyph Cache Misses\tGroup Cache Hits\tGroup Cache Misses\tGroup Cache Evictions\tTexture Upload (us)\n"));
 	return tmp;
 }
 
@@ -692,6 +692,10 @@ void gf_sc_del(GF_Compositor *compositor)
 	if (compositor->selected_text) gf_free(compositor->selected_text);
 	if (compositor->sel_buffer) gf_free(compositor->sel_buffer);
 
+	/*stop software stretch threads*/
+	if (compositor->stretch_pool) gf_stretch_pool_del(compositor->stretch_pool);
+	compositor->stretch_pool = NULL;
+
 	if (compositor->visual) visual_del(compositor->visual);
 	if (compositor->sensors) gf_list_del(compositor->sensors);
 	if (compositor->previous_sensors) gf_list_del(compositor->previous_sensors);
@@ -965,7 +969,7 @@ static void gf_sc_reset(GF_Compositor *compositor, Bool has_scene)
 
 #ifdef GF_SR_USE_VIDEO_CACHE
 	gf_list_reset(compositor->cached_groups);
-	compositor->video_cache_current_size = 0;
+	compositor->video_cache_current_size = compositor->video_cache_gl_current_size = 0;
 	gf_list_reset(compositor->cached_groups_queue);
 #endif
 
@@ -1215,6 +1219,7 @@ GF_EXPORT
 void gf_sc_reload_config(GF_Compositor *compositor)
 {
 	const char *sOpt;
+	u32 nb_threads;
 
 
 	/*changing drivers needs exclusive access*/
@@ -1318,6 +1323,10 @@ void gf_sc_reload_config(GF_Compositor *compositor)
 	compositor->video_cache_max_size = sOpt ? atoi(sOpt) : 0;
 	compositor->video_cache_max_size *= 1024;
 
+	/*caches used as OpenGL textures, same budget as 2D caches by default*/
+	sOpt = gf_cfg_get_key(compositor->user->config, "Compositor", "VideoCacheSizeGL");
+	compositor->video_cache_gl_max_size = sOpt ? 1024*atoi(sOpt) : compositor->video_cache_max_size;
+
 	sOpt = gf_cfg_get_key(compositor->user->config, "Compositor", "CacheScale");
 	compositor->cache_scale = sOpt ? atoi(sOpt) : 100;
 	if (!compositor->cache_scale) compositor->cache_scale = 100;
@@ -1331,6 +1340,19 @@ void gf_sc_reload_config(GF_Compositor *compositor)
 	if (!sOpt)
 		gf_cfg_set_key(compositor->user->config, "Compositor", "TextureFromDecoderMemory", "no");
 
+	sOpt = gf_cfg_get_key(compositor->user->config, "Compositor", "StretchThreads");
+	if (!sOpt) {
+		sOpt = "1";
+		gf_cfg_set_key(compositor->user->config, "Compositor", "StretchThreads", "1");
+	}
+	/*the compositor is locked, no stretch of this compositor is in progress*/
+	nb_threads = atoi(sOpt);
+	if (compositor->stretch_threads != nb_threads + 1) {
+		if (compositor->stretch_pool) gf_stretch_pool_del(compositor->stretch_pool);
+		compositor->stretch_pool = gf_stretch_pool_new(nb_threads);
+		compositor->stretch_threads = nb_threads + 1;
+	}
+
 #ifndef GPAC_DISABLE_3D
 
 	sOpt = gf_cfg_get_key(compositor->user->config, "Compositor", "OpenGLMode");
@@ -1360,6 +1382,11 @@ void gf_sc_reload_config(GF_Compositor *compositor)
 	if (!sOpt) gf_cfg_set_key(compositor->user->config, "Compositor", "EnablePBO", "no");
 	compositor->enable_pbo = (sOpt && !strcmp(sOpt, "yes")) ? 1 : 0;
 
+	sOpt = gf_cfg_get_key(compositor->user->config, "Compositor", "PBOCount");
+	if (!sOpt) gf_cfg_set_key(compositor->user->config, "Compositor", "PBOCount", "2");
+	compositor->pbo_count = sOpt ? atoi(sOpt) : 2;
+	if (!compositor->pbo_count) compositor->pbo_count = 1;
+
 	sOpt = gf_cfg_get_key(compositor->user->config, "Compositor", "DefaultNavigationMode");
 	if (sOpt && !strcmp(sOpt, "Walk")) compositor->default_navigation_mode = GF_NAVIGATE_WALK;
 	else if (sOpt && !strcmp(sOpt, "Examine")) compositor->default_navigation_mode = GF_NAVIGATE_EXAMINE;
@@ -1965,6 +1992,33 @@ u32 gf_sc_get_option(GF_Compositor *compositor, u32 type)
 #endif
 		return 1;
 
+	case GF_OPT_VIDEO_CACHE_HIT_RATE:
+#ifdef GF_SR_USE_VIDEO_CACHE
+		if (!(compositor->video_cache_hits + compositor->video_cache_misses)) return 0;
+		return (u32) ((u64) compositor->video_cache_hits * 100 / (compositor->video_cache_hits + compositor->video_cache_misses));
+#else
+		return 0;
+#endif
+	case GF_OPT_VIDEO_CACHE_EVICTIONS:
+#ifdef GF_SR_USE_VIDEO_CACHE
+		return compositor->video_cache_evictions;
+#else
+		return 0;
+#endif
+
+	case GF_OPT_TEXTURE_UPLOAD_TIME:
+		return compositor->nb_timed_frames ? (u32) (compositor->texture_upload_total / compositor->nb_timed_frames) : 0;
+	case GF_OPT_FRAME_DRAW_TIME:
+		return compositor->nb_timed_frames ? (u32) (compositor->frame_draw_total / compositor->nb_timed_frames) : 0;
+
+	case GF_OPT_GLYPH_CACHE_HIT_RATE:
+	{
+		u32 nb_hits, nb_misses;
+		if (!compositor->font_manager) return 0;
+		gf_font_manager_get_glyph_cache_stats(compositor->font_manager, &nb_hits, &nb_misses);
+		return (nb_hits + nb_misses) ? (u32) ((u64) nb_hits * 100 / (nb_hits + nb_misses)) : 0;
+	}
+
 	default:
 		return 0;
 	}
@@ -2325,7 +2379,7 @@ static void gf_sc_draw_scene(GF_Compositor *compositor)
 	}
 
 #ifdef GF_SR_USE_VIDEO_CACHE
-	if (!compositor->video_cache_max_size)
+	if (!compositor->video_cache_max_size && !compositor->video_cache_gl_max_size)
 		compositor->traverse_state->in_group_cache = 1;
 #endif
 
@@ -2402,9 +2456,11 @@ void gf_sc_render_frame(GF_Compositor *compositor)
 #endif
 	GF_List *temp_queue;
 	u32 in_time, end_time, i, count, frame_duration;
+	u64 in_time_hr;
 	Bool frame_drawn, has_timed_nodes=GF_FALSE, all_tx_done=GF_TRUE;
 #ifndef GPAC_DISABLE_LOG
 	s32 event_time, route_time, smil_timing_time=0, time_node_time, texture_time, traverse_time, flush_time, txtime;
+	u32 glyph_hits=0, glyph_misses=0, group_hits=0, group_misses=0, group_evictions=0;
 #endif
 
 	/*lock compositor for the whole cycle*/
@@ -2412,6 +2468,8 @@ void gf_sc_render_frame(GF_Compositor *compositor)
 //	GF_LOG(GF_LOG_DEBUG, GF_LOG_COMPOSE, ("[Compositor] Entering render_frame \n"));
 
 	in_time = gf_sys_clock();
+	in_time_hr = gf_sys_clock_high_res();
+	compositor->texture_upload_time = 0;
 
 	gf_sc_texture_cleanup_hw(compositor);
 
@@ -2781,7 +2839,17 @@ void gf_sc_render_frame(GF_Compositor *compositor)
 	compositor->last_frame_time = gf_sys_clock();
 	end_time = compositor->last_frame_time - in_time;
 
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_RTI, ("[RTI]\tCompositor Cycle Log\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\n",
+#ifndef GPAC_DISABLE_LOG
+	if (compositor->font_manager && gf_log_tool_level_on(GF_LOG_RTI, GF_LOG_DEBUG))
+		gf_font_manager_get_glyph_cache_stats(compositor->font_manager, &glyph_hits, &glyph_misses);
+#ifdef GF_SR_USE_VIDEO_CACHE
+	group_hits = compositor->video_cache_hits;
+	group_misses = compositor->video_cache_misses;
+	group_evictions = compositor->video_cache_evictions;
+#endif
+#endif
+
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_RTI, ("[RTI]\tCompositor Cycle Log\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\n",
 	                                  compositor->networks_time,
 	                                  compositor->decoders_time,
 	                                  compositor->frame_number,
@@ -2799,13 +2867,22 @@ void gf_sc_render_frame(GF_Compositor *compositor)
 	                                  compositor->indirect_draw_time,
 	                                  traverse_time,
 	                                  flush_time,
-	                                  end_time));
+	                                  end_time,
+	                                  glyph_hits,
+	                                  glyph_misses,
+	                                  group_hits,
+	                                  group_misses,
+	                                  group_evictions,
+	                                  compositor->texture_upload_time));
 
 	if (frame_drawn) {
 		compositor->current_frame = (compositor->current_frame+1) % GF_SR_FPS_COMPUTE_SIZE;
 		compositor->frame_dur[compositor->current_frame] = end_time;
 		compositor->frame_time[compositor->current_frame] = compositor->last_frame_time;
 		compositor->frame_number++;
+		compositor->texture_upload_total += compositor->texture_upload_time;
+		compositor->frame_draw_total += gf_sys_clock_high_res() - in_time_hr - compositor->texture_upload_time;
+		compositor->nb_timed_frames++;
 	}
 	if (compositor->bench_mode && (frame_drawn || (has_timed_nodes&&all_tx_done) )) {
 		//in bench mode we always increase the clock of the fixed target simulation rate - this needs refinement if video is used ...
@@ -30,6 +30,46 @@
 #include "nodes_stacks.h"
 #include "texturing.h"
 
+/*glyph cache: glyphs are rasterized once per font and pixel size into the fixed size cells of an alpha atlas,
+and span textures are built by copying glyphs from the atlas rather than by rasterizing the span outline*/
+
+/*number of horizontal subpixel positions a glyph is cached at*/
+#define GLYPH_SUBPIXEL	4
+/*max number of font sizes cached at once*/
+#define GLYPH_CACHE_MAX_ATLAS	8
+/*max memory of one atlas*/
+#define GLYPH_CACHE_MAX_ATLAS_SIZE	(4*1024*1024)
+/*glyphs with a larger em size in pixels are not cached*/
+#define GLYPH_CACHE_MAX_EM_SIZE	128
+#define GLYPH_CACHE_HASH_SIZE	64
+
+typedef struct _glyph_cache_entry
+{
+	u32 glyph_id, subpixel;
+	/*bitmap position relative to the glyph origin, in pixels - top is counted upwards*/
+	s32 left, top;
+	u32 width, height;
+	/*LRU list, most recently used first*/
+	struct _glyph_cache_entry *prev, *next;
+	struct _glyph_cache_entry *hash_next;
+} GF_GlyphCacheEntry;
+
+typedef struct
+{
+	GF_Font *font;
+	/*em size in quarter of pixels, horizontally and vertically*/
+	u32 em_x, em_y;
+	/*pixels per font unit*/
+	Fixed scale_x, scale_y;
+	/*cells are stored one after the other, with a stride of cell_w*/
+	u32 cell_w, cell_h, nb_cells, nb_used;
+	u8 *cells;
+	GF_GlyphCacheEntry *entries;
+	GF_GlyphCacheEntry *lru_first, *lru_last;
+	GF_GlyphCacheEntry *hash[GLYPH_CACHE_HASH_SIZE];
+	u32 last_used;
+} GF_GlyphAtlas;
+
 struct _gf_ft_mgr
 {
 	GF_FontReader *reader;
@@ -41,6 +81,19 @@ struct _gf_ft_mgr
 	u32 id_buffer_size;
 
 	Bool wait_font_load;
+
+	/*glyph cache: one atlas per font and pixel size, NULL if disabled*/
+	GF_List *glyph_atlases;
+	/*max number of glyphs cached per atlas*/
+	u32 glyph_cache_size;
+	/*draw plain 2D text from the glyph cache*/
+	Bool glyph_cache_2d;
+	u32 glyph_cache_hits, glyph_cache_misses;
+	/*incremented at each atlas use, for atlas eviction*/
+	u32 glyph_cache_tick;
+	/*RGBA buffer used to rasterize one glyph*/
+	char *glyph_raster;
+	u32 glyph_raster_size;
 };
 
 GF_EXPORT
@@ -100,11 +153,48 @@ GF_FontManager *gf_font_manager_new(GF_User *user)
 	if (!opt) gf_cfg_set_key(user->config, "FontEngine", "WaitForFontLoad", "no");
 	if (opt && !strcmp(opt, "yes")) font_mgr->wait_font_load = 1;
 
+	opt = gf_cfg_get_key(user->config, "FontEngine", "GlyphCacheSize");
+	if (!opt) gf_cfg_set_key(user->config, "FontEngine", "GlyphCacheSize", "256");
+	font_mgr->glyph_cache_size = opt ? atoi(opt) : 256;
+	if (font_mgr->glyph_cache_size) font_mgr->glyph_atlases = gf_list_new();
+
+	opt = gf_cfg_get_key(user->config, "FontEngine", "GlyphCache2D");
+	if (!opt) gf_cfg_set_key(user->config, "FontEngine", "GlyphCache2D", "no");
+	if (opt && !strcmp(opt, "yes")) font_mgr->glyph_cache_2d = 1;
+
 	return font_mgr;
 }
 
+static void glyph_atlas_del(GF_GlyphAtlas *atlas)
+{
+	gf_free(atlas->cells);
+	gf_free(atlas->entries);
+	gf_free(atlas);
+}
+
+/*removes all cached glyphs of the font, or of all fonts if NULL*/
+static void gf_font_manager_reset_glyph_cache(GF_FontManager *fm, GF_Font *font)
+{
+	u32 i;
+	if (!fm->glyph_atlases) return;
+	for (i=0; i<gf_list_count(fm->glyph_atlases); i++) {
+		GF_GlyphAtlas *atlas = gf_list_get(fm->glyph_atlases, i);
+		if (font && (atlas->font != font)) continue;
+		gf_list_rem(fm->glyph_atlases, i);
+		i--;
+		glyph_atlas_del(atlas);
+	}
+}
+
+void gf_font_manager_get_glyph_cache_stats(GF_FontManager *fm, u32 *nb_hits, u32 *nb_misses)
+{
+	if (nb_hits) *nb_hits = fm->glyph_cache_hits;
+	if (nb_misses) *nb_misses = fm->glyph_cache_misses;
+}
+
 void gf_font_predestroy(GF_Font *font)
 {
+	if (font->ft_mgr) gf_font_manager_reset_glyph_cache(font->ft_mgr, font);
 	if (font->spans) {
 		while (gf_list_count(font->spans)) {
 			GF_TextSpan *ts = gf_list_get(font->spans, 0);
@@ -138,6 +228,7 @@ void gf_font_del(GF_Font *font)
 void gf_font_manager_del(GF_FontManager *fm)
 {
 	GF_Font *font;
+	gf_font_manager_reset_glyph_cache(fm, NULL);
 	if (fm->reader) {
 		fm->reader->shutdown_font_engine(fm->reader);
 		gf_modules_close_interface((GF_BaseInterface *)fm->reader);
@@ -149,6 +240,8 @@ void gf_font_manager_del(GF_FontManager *fm)
 		gf_font_del(font);
 		font = next;
 	}
+	if (fm->glyph_atlases) gf_list_del(fm->glyph_atlases);
+	if (fm->glyph_raster) gf_free(fm->glyph_raster);
 	gf_free(fm->id_buffer);
 	gf_path_del(fm->line_path);
 	gf_free(fm);
@@ -467,6 +560,10 @@ typedef struct _span_internal
 	GF_TextureHandler *txh;
 	/*texture path (rectangle)*/
 	GF_Path *path;
+	/*rectangle the texture is mapped to - larger than the span bounds when the texture is built from the glyph cache*/
+	GF_Rect tx_bounds;
+	/*scale when texture was built from the glyph cache, 0 if texture was rasterized from the span outline*/
+	Fixed cache_scale;
 
 #ifndef GPAC_DISABLE_3D
 	/*span mesh (built out of the # glyphs)*/
@@ -646,12 +743,18 @@ static void span_alloc_extensions(GF_TextSpan *span)
 #ifndef GPAC_DISABLE_3D
 static void span_build_mesh(GF_TextSpan *span)
 {
+	Fixed u, v;
+	GF_Rect rc;
 	span_alloc_extensions(span);
+	/*the mesh covers the textured path, starting at the texture origin - the texture may cover more than the path*/
+	gf_path_get_bounds(span->ext->path, &rc);
+	u = gf_divfix(rc.width, span->ext->tx_bounds.width);
+	v = gf_divfix(rc.height, span->ext->tx_bounds.height);
 	span->ext->tx_mesh = new_mesh();
-	mesh_set_vertex(span->ext->tx_mesh, span->bounds.x, span->bounds.y-span->bounds.height, 0, 0, 0, FIX_ONE, 0, FIX_ONE);
-	mesh_set_vertex(span->ext->tx_mesh, span->bounds.x+span->bounds.width, span->bounds.y-span->bounds.height, 0, 0, 0, FIX_ONE, FIX_ONE, FIX_ONE);
-	mesh_set_vertex(span->ext->tx_mesh, span->bounds.x+span->bounds.width, span->bounds.y, 0, 0, 0, FIX_ONE, FIX_ONE, 0);
-	mesh_set_vertex(span->ext->tx_mesh, span->bounds.x, span->bounds.y, 0, 0, 0, FIX_ONE, 0, 0);
+	mesh_set_vertex(span->ext->tx_mesh, rc.x, rc.y-rc.height, 0, 0, 0, FIX_ONE, 0, v);
+	mesh_set_vertex(span->ext->tx_mesh, rc.x+rc.width, rc.y-rc.height, 0, 0, 0, FIX_ONE, u, v);
+	mesh_set_vertex(span->ext->tx_mesh, rc.x+rc.width, rc.y, 0, 0, 0, FIX_ONE, u, 0);
+	mesh_set_vertex(span->ext->tx_mesh, rc.x, rc.y, 0, 0, 0, FIX_ONE, 0, 0);
 	mesh_set_triangle(span->ext->tx_mesh, 0, 1, 2);
 	mesh_set_triangle(span->ext->tx_mesh, 0, 2, 3);
 	span->ext->tx_mesh->flags |= MESH_IS_2D;
@@ -665,6 +768,400 @@ static void span_build_mesh(GF_TextSpan *span)
 /*and don't build too small ones otherwise result is as crap as non-textured*/
 #define MIN_TX_SIZE		32
 
+/*max size of span textures built from the glyph cache*/
+#define MAX_CACHED_TX_SIZE	2048
+/*empty texels around span textures built from the glyph cache*/
+#define GLYPH_TX_MARGIN	1
+
+static GF_GlyphAtlas *glyph_atlas_get(GF_FontManager *fm, GF_Font *font, Fixed scale_x, Fixed scale_y)
+{
+	u32 i, count, em_x, em_y, max_cells;
+	s32 w, h;
+	GF_GlyphAtlas *atlas, *oldest;
+
+	/*em size is rounded to a quarter of pixel*/
+	em_x = FIX2INT( gf_floor(4 * gf_mulfix(INT2FIX(font->em_size), scale_x) + FIX_ONE/2) );
+	em_y = FIX2INT( gf_floor(4 * gf_mulfix(INT2FIX(font->em_size), scale_y) + FIX_ONE/2) );
+	if (!em_x || !em_y || (em_x > 4*GLYPH_CACHE_MAX_EM_SIZE) || (em_y > 4*GLYPH_CACHE_MAX_EM_SIZE)) return NULL;
+
+	oldest = NULL;
+	count = gf_list_count(fm->glyph_atlases);
+	for (i=0; i<count; i++) {
+		atlas = gf_list_get(fm->glyph_atlases, i);
+		if ((atlas->font==font) && (atlas->em_x==em_x) && (atlas->em_y==em_y)) {
+			atlas->last_used = ++fm->glyph_cache_tick;
+			return atlas;
+		}
+		if (!oldest || (atlas->last_used < oldest->last_used)) oldest = atlas;
+	}
+	if (count >= GLYPH_CACHE_MAX_ATLAS) {
+		gf_list_del_item(fm->glyph_atlases, oldest);
+		glyph_atlas_del(oldest);
+	}
+
+	GF_SAFEALLOC(atlas, GF_GlyphAtlas);
+	if (!atlas) return NULL;
+	atlas->font = font;
+	atlas->em_x = em_x;
+	atlas->em_y = em_y;
+	atlas->scale_x = gf_divfix(INT2FIX(em_x), INT2FIX(4*font->em_size));
+	atlas->scale_y = gf_divfix(INT2FIX(em_y), INT2FIX(4*font->em_size));
+
+	/*cells are sized after the font metrics, with some room for glyphs going beyond them*/
+	w = MAX(font->max_advance_h, (s32) font->em_size);
+	h = MAX(font->ascent - font->descent, (s32) font->em_size);
+	atlas->cell_w = FIX2INT( gf_ceil(gf_mulfix(INT2FIX(w), atlas->scale_x)) );
+	atlas->cell_h = FIX2INT( gf_ceil(gf_mulfix(INT2FIX(h), atlas->scale_y)) );
+	atlas->cell_w += atlas->cell_w/4 + 4;
+	atlas->cell_h += atlas->cell_h/4 + 4;
+
+	max_cells = GLYPH_CACHE_MAX_ATLAS_SIZE / (atlas->cell_w * atlas->cell_h);
+	atlas->nb_cells = MIN(fm->glyph_cache_size, max_cells);
+	if (atlas->nb_cells) {
+		atlas->cells = (u8 *) gf_malloc(sizeof(u8) * atlas->cell_w * atlas->cell_h * atlas->nb_cells);
+		atlas->entries = (GF_GlyphCacheEntry *) gf_malloc(sizeof(GF_GlyphCacheEntry) * atlas->nb_cells);
+	}
+	if (!atlas->cells || !atlas->entries) {
+		if (atlas->cells) gf_free(atlas->cells);
+		if (atlas->entries) gf_free(atlas->entries);
+		gf_free(atlas);
+		return NULL;
+	}
+	memset(atlas->entries, 0, sizeof(GF_GlyphCacheEntry) * atlas->nb_cells);
+	atlas->last_used = ++fm->glyph_cache_tick;
+	gf_list_add(fm->glyph_atlases, atlas);
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_COMPOSE, ("[Font] New glyph atlas for font %s size %gx%g px: %d cells of %dx%d pixels\n", font->name, ((Double)em_x)/4, ((Double)em_y)/4, atlas->nb_cells, atlas->cell_w, atlas->cell_h));
+	return atlas;
+}
+
+static void glyph_atlas_lru_remove(GF_GlyphAtlas *atlas, GF_GlyphCacheEntry *ent)
+{
+	if (ent->prev) ent->prev->next = ent->next;
+	else atlas->lru_first = ent->next;
+	if (ent->next) ent->next->prev = ent->prev;
+	else atlas->lru_last = ent->prev;
+	ent->prev = ent->next = NULL;
+}
+
+static void glyph_atlas_lru_push(GF_GlyphAtlas *atlas, GF_GlyphCacheEntry *ent)
+{
+	ent->prev = NULL;
+	ent->next = atlas->lru_first;
+	if (atlas->lru_first) atlas->lru_first->prev = ent;
+	else atlas->lru_last = ent;
+	atlas->lru_first = ent;
+}
+
+static void glyph_atlas_raster(GF_FontManager *fm, GF_Raster2D *raster, GF_GlyphAtlas *atlas, GF_GlyphCacheEntry *ent, GF_Glyph *glyph)
+{
+	u32 i, j, size;
+	GF_Matrix2D mx;
+	GF_STENCIL stencil, brush;
+	GF_SURFACE surface;
+	u8 *cell = atlas->cells + (ent - atlas->entries) * atlas->cell_w * atlas->cell_h;
+
+	memset(cell, 0, sizeof(u8) * atlas->cell_w * atlas->cell_h);
+	if (!ent->width || !ent->height) return;
+
+	size = 4 * ent->width * ent->height;
+	if (fm->glyph_raster_size < size) {
+		fm->glyph_raster = (char *) gf_realloc(fm->glyph_raster, sizeof(char) * size);
+		fm->glyph_raster_size = fm->glyph_raster ? size : 0;
+		if (!fm->glyph_raster) return;
+	}
+	memset(fm->glyph_raster, 0, sizeof(char) * size);
+
+	stencil = raster->stencil_new(raster, GF_STENCIL_TEXTURE);
+	brush = raster->stencil_new(raster, GF_STENCIL_SOLID);
+	surface = raster->surface_new(raster, 1);
+	if (stencil && brush && surface) {
+		raster->stencil_set_texture(stencil, fm->glyph_raster, ent->width, ent->height, 4*ent->width, GF_PIXEL_RGBA, GF_PIXEL_RGBA, 1);
+		raster->surface_attach_to_texture(surface, stencil);
+		raster->stencil_set_brush_color(brush, 0xFF000000);
+
+		/*the glyph origin is at (-left + subpixel offset, top) from the top-left corner of the bitmap, and the surface origin
+		is at its center*/
+		gf_mx2d_init(mx);
+		gf_mx2d_add_scale(&mx, atlas->scale_x, atlas->scale_y);
+		gf_mx2d_add_translation(&mx, INT2FIX(ent->subpixel) / GLYPH_SUBPIXEL - INT2FIX(ent->left + (s32) ent->width/2), INT2FIX((s32) ent->height/2 - ent->top));
+		raster->surface_set_matrix(surface, &mx);
+		raster->surface_set_raster_level(surface, GF_RASTER_HIGH_QUALITY);
+		raster->surface_set_path(surface, glyph->path);
+		raster->surface_fill(surface, brush);
+
+		/*only keep the alpha channel*/
+		for (j=0; j<ent->height; j++) {
+			u8 *src = (u8 *) fm->glyph_raster + 4*j*ent->width + 3;
+			u8 *dst = cell + j*atlas->cell_w;
+			for (i=0; i<ent->width; i++) {
+				dst[i] = *src;
+				src += 4;
+			}
+		}
+	}
+	if (surface) raster->surface_delete(surface);
+	if (brush) raster->stencil_delete(brush);
+	if (stencil) raster->stencil_delete(stencil);
+}
+
+/*returns the cached glyph bitmap, rasterizing it if needed, or NULL if the glyph doesn't fit in a cell*/
+static GF_GlyphCacheEntry *glyph_atlas_get_glyph(GF_FontManager *fm, GF_Raster2D *raster, GF_GlyphAtlas *atlas, GF_Glyph *glyph, u32 subpixel)
+{
+	s32 left, right, top, bottom;
+	GF_Rect bbox;
+	GF_GlyphCacheEntry *ent, **prev;
+	u32 hash = (glyph->ID * GLYPH_SUBPIXEL + subpixel) % GLYPH_CACHE_HASH_SIZE;
+
+	ent = atlas->hash[hash];
+	while (ent) {
+		if ((ent->glyph_id==glyph->ID) && (ent->subpixel==subpixel)) {
+			fm->glyph_cache_hits++;
+			if (ent != atlas->lru_first) {
+				glyph_atlas_lru_remove(atlas, ent);
+				glyph_atlas_lru_push(atlas, ent);
+			}
+			return ent;
+		}
+		ent = ent->hash_next;
+	}
+	fm->glyph_cache_misses++;
+
+	/*bitmap bounds in pixels, with one pixel margin for antialiasing*/
+	gf_path_get_bounds(glyph->path, &bbox);
+	left = FIX2INT( gf_floor(gf_mulfix(bbox.x, atlas->scale_x) + INT2FIX(subpixel) / GLYPH_SUBPIXEL) ) - 1;
+	right = FIX2INT( gf_ceil(gf_mulfix(bbox.x + bbox.width, atlas->scale_x) + INT2FIX(subpixel) / GLYPH_SUBPIXEL) ) + 1;
+	top = FIX2INT( gf_ceil(gf_mulfix(bbox.y, atlas->scale_y)) ) + 1;
+	bottom = FIX2INT( gf_floor(gf_mulfix(bbox.y - bbox.height, atlas->scale_y)) ) - 1;
+	if ((right - left > (s32) atlas->cell_w) || (top - bottom > (s32) atlas->cell_h)) return NULL;
+
+	/*get a free cell or recycle the least recently used one*/
+	if (atlas->nb_used < atlas->nb_cells) {
+		ent = &atlas->entries[atlas->nb_used];
+		atlas->nb_used++;
+	} else {
+		ent = atlas->lru_last;
+		glyph_atlas_lru_remove(atlas, ent);
+		prev = &atlas->hash[(ent->glyph_id * GLYPH_SUBPIXEL + ent->subpixel) % GLYPH_CACHE_HASH_SIZE];
+		while (*prev != ent) prev = &(*prev)->hash_next;
+		*prev = ent->hash_next;
+	}
+	ent->glyph_id = glyph->ID;
+	ent->subpixel = subpixel;
+	ent->left = left;
+	ent->top = top;
+	ent->width = right - left;
+	ent->height = top - bottom;
+	/*empty glyph*/
+	if (!glyph->path->n_points) ent->width = ent->height = 0;
+
+	ent->hash_next = atlas->hash[hash];
+	atlas->hash[hash] = ent;
+	glyph_atlas_lru_push(atlas, ent);
+
+	glyph_atlas_raster(fm, raster, atlas, ent, glyph);
+	return ent;
+}
+
+/*blends the glyph bitmap in the alpha channel of the RGBA span texture, the glyph origin being at pixel (x, y)*/
+static void glyph_atlas_blit(GF_GlyphAtlas *atlas, GF_GlyphCacheEntry *ent, u8 *data, u32 width, u32 height, s32 x, s32 y, Bool flip)
+{
+	u32 i, j;
+	u8 *cell = atlas->cells + (ent - atlas->entries) * atlas->cell_w * atlas->cell_h;
+
+	x += ent->left;
+	for (j=0; j<ent->height; j++) {
+		u8 *src, *dst;
+		/*fliped spans are rasterized upside down*/
+		s32 row = flip ? y + ent->top - 1 - (s32) j : y - ent->top + (s32) j;
+		if ((row<0) || (row >= (s32) height)) continue;
+
+		src = cell + j*atlas->cell_w;
+		dst = data + 4*row*width + 3;
+		for (i=0; i<ent->width; i++) {
+			u32 a = src[i];
+			s32 col = x + (s32) i;
+			if (!a || (col<0) || (col >= (s32) width)) continue;
+			dst[4*col] = (u8) (a + dst[4*col] * (255 - a) / 255);
+		}
+	}
+}
+
+static void span_reset_texture(GF_TextSpan *span)
+{
+	if (span->ext->path) gf_path_del(span->ext->path);
+	span->ext->path = NULL;
+#ifndef GPAC_DISABLE_3D
+	if (span->ext->tx_mesh) mesh_free(span->ext->tx_mesh);
+	span->ext->tx_mesh = NULL;
+#endif
+
+	if (span->ext->txh) {
+		gf_sc_texture_destroy(span->ext->txh);
+		if (span->ext->txh->data) gf_free(span->ext->txh->data);
+		gf_free(span->ext->txh);
+		span->ext->txh = NULL;
+	}
+}
+
+/*allocates a new RGBA texture for the span and returns its stencil*/
+static GF_STENCIL span_new_texture(GF_Compositor *compositor, GF_TextSpan *span, u32 width, u32 height)
+{
+	GF_STENCIL stencil;
+	GF_Raster2D *raster = compositor->rasterizer;
+
+	span_reset_texture(span);
+	GF_SAFEALLOC(span->ext->txh, GF_TextureHandler);
+	if (!span->ext->txh) return NULL;
+	gf_sc_texture_setup(span->ext->txh, compositor, NULL);
+	gf_sc_texture_allocate(span->ext->txh);
+	stencil = gf_sc_texture_get_stencil(span->ext->txh);
+	if (!stencil) stencil = raster->stencil_new(raster, GF_STENCIL_TEXTURE);
+
+	/*FIXME - make it work with alphagrey...*/
+	span->ext->txh->width = width;
+	span->ext->txh->height = height;
+	span->ext->txh->stride = 4*width;
+	span->ext->txh->pixelformat = GF_PIXEL_RGBA;
+	span->ext->txh->transparent = 1;
+	span->ext->txh->flags |= GF_SR_TEXTURE_NO_GL_FLIP;
+	return stencil;
+}
+
+static void span_set_texture_path(GF_TextSpan *span, GF_Rect *bounds)
+{
+	span->ext->path = gf_path_new();
+	gf_path_add_move_to(span->ext->path, bounds->x, bounds->y-bounds->height);
+	gf_path_add_line_to(span->ext->path, bounds->x+bounds->width, bounds->y-bounds->height);
+	gf_path_add_line_to(span->ext->path, bounds->x+bounds->width, bounds->y);
+	gf_path_add_line_to(span->ext->path, bounds->x, bounds->y);
+	gf_path_close(span->ext->path);
+}
+
+/*builds the span texture from the glyph cache, scale being the number of texture pixels per local unit. Returns 0
+if the span cannot be drawn from the glyph cache*/
+static Bool span_setup_cached_texture(GF_Compositor *compositor, GF_TextSpan *span, Bool for_3d, Fixed scale, u32 max_size)
+{
+	u32 i, tw, th, width, height;
+	Fixed m0, m4, ox, oy;
+	GF_Rect rc;
+	Bool flip;
+	char *data;
+	GF_STENCIL stencil;
+	GF_GlyphAtlas *atlas;
+	GF_FontManager *fm = compositor->font_manager;
+	GF_Raster2D *raster = compositor->rasterizer;
+
+	/*per-glyph rotations are not supported, nor SVG font baselines, which move the span bounds*/
+	if (!fm->glyph_atlases || span->rot || span->font->baseline || !span->nb_glyphs) return 0;
+	if (!span->bounds.width || !span->bounds.height || (scale<=0)) return 0;
+
+	span_alloc_extensions(span);
+	if (span->ext->txh && span->ext->txh->data && (span->ext->cache_scale == scale)) {
+#ifndef GPAC_DISABLE_3D
+		if (for_3d && !span->ext->tx_mesh) span_build_mesh(span);
+#endif
+		return 1;
+	}
+
+	/*get closest pow2 sizes, keeping the same scale in both directions. Glyphs are placed with subpixel and pixel
+	rounding and may spill out of the span bounds, keep a margin around them*/
+	tw = FIX2INT( gf_ceil(gf_mulfix(scale, span->bounds.width)) ) + 2*GLYPH_TX_MARGIN;
+	th = FIX2INT( gf_ceil(gf_mulfix(scale, span->bounds.height)) ) + 2*GLYPH_TX_MARGIN;
+	if ((tw > max_size) || (th > max_size)) return 0;
+	width = MIN_TX_SIZE;
+	while (width < tw) width *= 2;
+	height = MIN_TX_SIZE;
+	while (height < th) height *= 2;
+
+	m0 = gf_mulfix(span->font_scale, span->x_scale);
+	m4 = gf_mulfix(span->font_scale, span->y_scale);
+	atlas = glyph_atlas_get(fm, span->font, gf_mulfix(m0, scale), gf_mulfix(m4, scale));
+	if (!atlas) return 0;
+
+	flip = (span->flags & GF_TEXT_SPAN_FLIP) ? 1 : 0;
+	if (flip) m4 = -m4;
+
+	data = (char *) gf_malloc(sizeof(char) * 4 * width * height);
+	if (!data) return 0;
+	memset(data, 0, sizeof(char) * 4 * width * height);
+
+	/*same glyph layout as gf_font_span_create_path*/
+	ox = span->off_x;
+	oy = span->off_y;
+	for (i=0; i<span->nb_glyphs; i++) {
+		GF_Glyph *glyph = span->glyphs[i];
+		if (!glyph) {
+			if (span->flags & GF_TEXT_SPAN_HORIZONTAL) {
+				ox += m0 * span->font->max_advance_h;
+			} else {
+				oy -= m4 * span->font->max_advance_v;
+			}
+			continue;
+		}
+		if (glyph->ID==GF_CARET_CHAR) {
+			gf_free(data);
+			return 0;
+		}
+		if (span->dx) ox = span->dx[i];
+		if (span->dy) oy = span->dy[i];
+
+		if (glyph->path && (glyph->utf_name != ' ')) {
+			GF_GlyphCacheEntry *ent;
+			Fixed x = gf_mulfix(ox - span->bounds.x, scale) + INT2FIX(GLYPH_TX_MARGIN);
+			Fixed y = gf_mulfix(span->bounds.y - oy, scale) + INT2FIX(GLYPH_TX_MARGIN);
+			s32 ix = FIX2INT( gf_floor(x) );
+			s32 iy = FIX2INT( gf_floor(y + FIX_ONE/2) );
+			u32 subpixel = FIX2INT( gf_floor(GLYPH_SUBPIXEL * (x - INT2FIX(ix)) + FIX_ONE/2) );
+			if (subpixel == GLYPH_SUBPIXEL) {
+				ix++;
+				subpixel = 0;
+			}
+			ent = glyph_atlas_get_glyph(fm, raster, atlas, glyph, subpixel);
+			if (!ent) {
+				gf_free(data);
+				return 0;
+			}
+			glyph_atlas_blit(atlas, ent, (u8 *) data, width, height, ix, iy, flip);
+		}
+
+		if (span->flags & GF_TEXT_SPAN_HORIZONTAL) {
+			ox += m0 * glyph->horiz_advance;
+		} else {
+			oy -= m4 * glyph->vert_advance;
+		}
+	}
+
+	stencil = span_new_texture(compositor, span, width, height);
+	if (!stencil) {
+		gf_free(data);
+		return 0;
+	}
+	span->ext->txh->data = data;
+	raster->stencil_set_texture(stencil, span->ext->txh->data, span->ext->txh->width, span->ext->txh->height, span->ext->txh->stride, span->ext->txh->pixelformat, span->ext->txh->pixelformat, 1);
+
+	span->ext->last_zoom = compositor->zoom;
+	span->ext->cache_scale = scale;
+	span->ext->tx_bounds.x = span->bounds.x - gf_divfix(INT2FIX(GLYPH_TX_MARGIN), scale);
+	span->ext->tx_bounds.y = span->bounds.y + gf_divfix(INT2FIX(GLYPH_TX_MARGIN), scale);
+	span->ext->tx_bounds.width = gf_divfix(INT2FIX(width), scale);
+	span->ext->tx_bounds.height = gf_divfix(INT2FIX(height), scale);
+	/*draw the margin as well*/
+	rc.x = span->ext->tx_bounds.x;
+	rc.y = span->ext->tx_bounds.y;
+	rc.width = gf_divfix(INT2FIX(tw), scale);
+	rc.height = gf_divfix(INT2FIX(th), scale);
+	span_set_texture_path(span, &rc);
+
+	gf_sc_texture_set_stencil(span->ext->txh, stencil);
+	gf_sc_texture_set_data(span->ext->txh);
+
+#ifndef GPAC_DISABLE_3D
+	gf_sc_texture_set_blend_mode(span->ext->txh, TX_BLEND);
+	if (for_3d) span_build_mesh(span);
+#endif
+	return 1;
+}
+
 static Bool span_setup_texture(GF_Compositor *compositor, GF_TextSpan *span, Bool for_3d, GF_TraverseState *tr_state)
 {
 	GF_Path *span_path;
@@ -711,6 +1208,8 @@ static Bool span_setup_texture(GF_Compositor *compositor, GF_TextSpan *span, Boo
 	}
 	if (scale<FIX_ONE) scale = FIX_ONE;
 
+	if (span_setup_cached_texture(compositor, span, for_3d, scale, MAX_TX_SIZE)) return 1;
+
 	/*get closest pow2 sizes*/
 	tw = FIX2INT( gf_ceil(gf_mulfix(scale, bounds.width)) );
 	width = MIN_TX_SIZE;
@@ -730,32 +1229,8 @@ static Bool span_setup_texture(GF_Compositor *compositor, GF_TextSpan *span, Boo
 
 	if (span->ext->txh && (width == span->ext->txh->width) && (height==span->ext->txh->height)) return 1;
 
-	if (span->ext->path) gf_path_del(span->ext->path);
-	span->ext->path = NULL;
-#ifndef GPAC_DISABLE_3D
-	if (span->ext->tx_mesh) mesh_free(span->ext->tx_mesh);
-	span->ext->tx_mesh = NULL;
-#endif
-
-	if (span->ext->txh) {
-		gf_sc_texture_destroy(span->ext->txh);
-		if (span->ext->txh->data) gf_free(span->ext->txh->data);
-		gf_free(span->ext->txh);
-	}
-	GF_SAFEALLOC(span->ext->txh, GF_TextureHandler);
-	if (!span->ext->txh) return 0;
-	gf_sc_texture_setup(span->ext->txh, compositor, NULL);
-	gf_sc_texture_allocate(span->ext->txh);
-	stencil = gf_sc_texture_get_stencil(span->ext->txh);
-	if (!stencil) stencil = raster->stencil_new(raster, GF_STENCIL_TEXTURE);
-
-	/*FIXME - make it work with alphagrey...*/
-	span->ext->txh->width = width;
-	span->ext->txh->height = height;
-	span->ext->txh->stride = 4*width;
-	span->ext->txh->pixelformat = GF_PIXEL_RGBA;
-	span->ext->txh->transparent = 1;
-	span->ext->txh->flags |= GF_SR_TEXTURE_NO_GL_FLIP;
+	stencil = span_new_texture(compositor, span, width, height);
+	if (!stencil) return 0;
 
 	surface = raster->surface_new(raster, 1);
 	if (!surface) {
@@ -794,12 +1269,9 @@ static Bool span_setup_texture(GF_Compositor *compositor, GF_TextSpan *span, Boo
 		bounds.y += dy;
 		span->bounds.y += dy;
 	}
-	span->ext->path = gf_path_new();
-	gf_path_add_move_to(span->ext->path, bounds.x, bounds.y-bounds.height);
-	gf_path_add_line_to(span->ext->path, bounds.x+bounds.width, bounds.y-bounds.height);
-	gf_path_add_line_to(span->ext->path, bounds.x+bounds.width, bounds.y);
-	gf_path_add_line_to(span->ext->path, bounds.x, bounds.y);
-	gf_path_close(span->ext->path);
+	span->ext->cache_scale = 0;
+	span->ext->tx_bounds = bounds;
+	span_set_texture_path(span, &bounds);
 
 	gf_sc_texture_set_stencil(span->ext->txh, stencil);
 	gf_sc_texture_set_data(span->ext->txh);
@@ -1298,17 +1770,25 @@ void gf_font_spans_get_selection(GF_Node *node, GF_List *spans, GF_TraverseState
 
 void gf_font_spans_draw_2d(GF_List *spans, GF_TraverseState *tr_state, u32 hl_color, Bool force_texture_text, GF_Rect *bounds)
 {
-	Bool use_texture_text, is_rv;
+	Bool use_texture_text, use_glyph_cache, is_rv;
 	GF_Compositor *compositor = tr_state->visual->compositor;
 	u32 i, count;
 	GF_TextSpan *span;
 	DrawableContext *ctx = tr_state->ctx;
 	GF_Rect rc;
 
-	use_texture_text = 0;
+	use_texture_text = use_glyph_cache = 0;
 	if (force_texture_text || (compositor->texture_text_mode==GF_TEXTURE_TEXT_ALWAYS) ) {
 		use_texture_text = !ctx->aspect.fill_texture && !ctx->aspect.pen_props.width;
 	}
+	/*otherwise draw plain text from the glyph cache if enabled, as long as the span texture is mapped pixel to pixel
+	and not flipped (glyph textures are built with the y axis up)*/
+	else if (compositor->font_manager->glyph_cache_2d && (compositor->texture_text_mode==GF_TEXTURE_TEXT_DEFAULT) && (compositor->antiAlias != GF_ANTIALIAS_NONE)
+	         && ((ctx->flags & CTX_FLIPED_COORDS) ? !tr_state->visual->center_coords : tr_state->visual->center_coords)
+	         && !ctx->aspect.fill_texture && !ctx->aspect.pen_props.width && GF_COL_A(ctx->aspect.fill_color)
+	         && !ctx->transform.m[1] && !ctx->transform.m[3] && (ABS(ctx->transform.m[0]) == ABS(ctx->transform.m[4])) ) {
+		use_glyph_cache = 1;
+	}
 
 	is_rv = 0;
 	if (hl_color) {
@@ -1342,7 +1822,19 @@ void gf_font_spans_draw_2d(GF_List *spans, GF_TraverseState *tr_state, u32 hl_co
 			visual_2d_fill_rect(tr_state->visual, ctx, &span->bounds, hl_color, 0, tr_state);
 
 		if (use_texture_text && span_setup_texture(compositor, span, 0, tr_state)) {
-			visual_2d_texture_path_text(tr_state->visual, ctx, span->ext->path, &span->bounds, span->ext->txh, tr_state);
+			visual_2d_texture_path_text(tr_state->visual, ctx, span->ext->path, &span->ext->tx_bounds, span->ext->txh, tr_state);
+		} else if (use_glyph_cache && span_setup_cached_texture(compositor, span, 0, ABS(ctx->transform.m[0]), MAX_CACHED_TX_SIZE)) {
+			Fixed v;
+			/*texture pixels are mapped to screen pixels without filtering, and the rasterizer samples the texture at the
+			top-left corner of each pixel: with the texture aligned on the pixel grid, samples fall on texel edges and rounding
+			may pick the neighbouring texel. Align the texture then move it half a pixel left and up, so that each sample
+			falls in the middle of a texel*/
+			rc = span->ext->tx_bounds;
+			v = gf_mulfix(ctx->transform.m[0], rc.x) + ctx->transform.m[2];
+			rc.x += gf_divfix(gf_floor(v + FIX_ONE/2) - v - FIX_ONE/2, ctx->transform.m[0]);
+			v = gf_mulfix(ctx->transform.m[4], rc.y) + ctx->transform.m[5];
+			rc.y += gf_divfix(gf_floor(v + FIX_ONE/2) - v + FIX_ONE/2, ctx->transform.m[4]);
+			visual_2d_texture_path_text(tr_state->visual, ctx, span->ext->path, &rc, span->ext->txh, tr_state);
 		} else {
 			gf_font_span_draw_2d(tr_state, span, ctx, bounds);
 		}
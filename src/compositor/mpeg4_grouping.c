@@ -155,7 +155,7 @@ void group_2d_traverse(GF_Node *node, GroupingNode2D *group, GF_TraverseState *t
 		DrawableContext *first_ctx = tr_state->visual->cur_context;
 		Bool skip_first_ctx = (first_ctx && first_ctx->drawable) ? 1 : 0;
 		u32 cache_too_small = 0;
-		u32 traverse_time = gf_sys_clock();
+		u64 traverse_time = gf_sys_clock_high_res();
 		u32 last_cache_idx = gf_list_count(tr_state->visual->compositor->cached_groups_queue);
 		tr_state->cache_too_small = 0;
 #endif
@@ -182,8 +182,8 @@ void group_2d_traverse(GF_Node *node, GroupingNode2D *group, GF_TraverseState *t
 			tr_state->cache_too_small = 1;
 		} else {
 			/*get the traversal time for each group*/
-			traverse_time = gf_sys_clock() - traverse_time;
-			group->traverse_time += traverse_time;
+			traverse_time = gf_sys_clock_high_res() - traverse_time;
+			group->traverse_time += (u32) traverse_time;
 			/*record the traversal information and turn cache on if possible*/
 			group_2d_cache_evaluate(node, group, tr_state, first_ctx, skip_first_ctx, last_cache_idx);
 		}
@@ -323,7 +323,7 @@ void group_2d_traverse_with_order(GF_Node *node, GroupingNode2D *group, GF_Trave
 		DrawableContext *first_ctx = tr_state->visual->cur_context;
 		u32 cache_too_small = 0;
 		Bool skip_first_ctx = (first_ctx && first_ctx->drawable) ? 1 : 0;
-		u32 traverse_time = gf_sys_clock();
+		u64 traverse_time = gf_sys_clock_high_res();
 		u32 last_cache_idx = gf_list_count(tr_state->visual->compositor->cached_groups_queue);
 		tr_state->cache_too_small = 0;
 #endif
@@ -350,8 +350,8 @@ void group_2d_traverse_with_order(GF_Node *node, GroupingNode2D *group, GF_Trave
 			tr_state->cache_too_small = 1;
 		} else {
 			/*get the traversal time for each group*/
-			traverse_time = gf_sys_clock() - traverse_time;
-			group->traverse_time += traverse_time;
+			traverse_time = gf_sys_clock_high_res() - traverse_time;
+			group->traverse_time += (u32) traverse_time;
 			/*record the traversal information and turn cache on if possible*/
 			group_2d_cache_evaluate(node, group, tr_state, first_ctx, skip_first_ctx, last_cache_idx);
 		}
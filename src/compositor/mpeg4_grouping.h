@@ -39,6 +39,8 @@ enum
 	/*set if group is cached*/
 	GROUP_IS_CACHED				=	1<<5,
 	GROUP_PERMANENT_CACHE		=	1<<6,
+	/*set if group cache has been evicted because of memory constraints, the group is not evaluated again until modified*/
+	GROUP_CACHE_EVICTED			=	1<<7,
 };
 
 /*this is only used for type-casting of the common 2D/3D stacks to get the flags*/
@@ -56,12 +58,17 @@ typedef struct
 	u32 flags;						\
 	GF_Rect bounds;					\
 	struct _group_cache *cache;		\
-	u16 traverse_time;		\
+	/*cumulated traversal time of the stats frames in microseconds*/		\
+	u32 traverse_time;		\
 	u8 changed;				\
 	u8 nb_stats_frame;		\
-	/*cache candidates are sorted by priority*/		\
-	Fixed priority;			\
-	/*size of offscreen cache in kbytes*/		\
+	/*set if the cache is used as an OpenGL texture*/		\
+	u8 cache_gl;			\
+	/*redraw time saved per frame by the cache, in microseconds per megabyte of cache*/		\
+	u32 priority;			\
+	/*frame number of the last use of the cache, used to age the priority*/		\
+	u32 last_used;			\
+	/*size of offscreen cache in bytes*/		\
 	u32 cached_size;		\
 	/*number of objects in cache - for debug purposes only*/		\
 	u32 nb_objects;		\
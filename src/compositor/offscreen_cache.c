@@ -31,6 +31,8 @@
 
 #define NUM_STATS_FRAMES		2
 #define MIN_OBJECTS_IN_CACHE	2
+/*number of frames after which the priority of an unused cache is halved*/
+#define CACHE_AGING_FRAMES		30
 
 
 //#define CACHE_DEBUG_ALPHA
@@ -418,11 +420,26 @@ Bool group_cache_traverse(GF_Node *node, GroupCache *cache, GF_TraverseState *tr
 
 #ifdef GF_SR_USE_VIDEO_CACHE
 
+/*memory used by the caches of the same type (2D or OpenGL) as the group*/
+static u32 *group_cache_used_size(GF_Compositor *compositor, GroupingNode2D *group)
+{
+	return group->cache_gl ? &compositor->video_cache_gl_current_size : &compositor->video_cache_current_size;
+}
+
+/*priority of the cache, halved every CACHE_AGING_FRAMES frames since its last use*/
+static u32 group_cache_get_priority(GF_Compositor *compositor, GroupingNode2D *group)
+{
+	u32 age = (compositor->frame_number - group->last_used) / CACHE_AGING_FRAMES;
+	if (age >= 32) return 0;
+	return group->priority >> age;
+}
+
 /*guarentee the tr_state->candidate has the lowest delta value*/
 static void group_cache_insert_entry(GF_Node *node, GroupingNode2D *group, GF_TraverseState *tr_state)
 {
 	u32 i, count;
-	GF_List *cache_candidates = tr_state->visual->compositor->cached_groups;
+	GF_Compositor *compositor = tr_state->visual->compositor;
+	GF_List *cache_candidates = compositor->cached_groups;
 	GroupingNode2D *current;
 
 	current = NULL;
@@ -438,19 +455,23 @@ static void group_cache_insert_entry(GF_Node *node, GroupingNode2D *group, GF_Tr
 	if (i==count)
 		gf_list_add(cache_candidates, group);
 
-	tr_state->visual->compositor->video_cache_current_size += group->cached_size;
+	group->last_used = compositor->frame_number;
+	*group_cache_used_size(compositor, group) += group->cached_size;
 	/*log the information*/
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE]\tAdding object %s\tObjects: %d\tSlope: %g\tSize: %d\tTime: %d\n",
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE]\tAdding object %s\tObjects: %d\tPriority: %d\tSize: %d\tTime: %d\tGL: %d\n",
 	                                    gf_node_get_log_name(node),
 	                                    group->nb_objects,
-	                                    FIX2FLT(group->priority),
+	                                    group->priority,
 	                                    group->cached_size,
-	                                    group->traverse_time));
+	                                    group->traverse_time,
+	                                    group->cache_gl));
 
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] Status (KB): Max: %d\tUsed: %d\tNb Groups: %d\n",
-	                                    tr_state->visual->compositor->video_cache_max_size,
-	                                    tr_state->visual->compositor->video_cache_current_size,
-	                                    gf_list_count(tr_state->visual->compositor->cached_groups)
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] Status (B): 2D Max: %d\tUsed: %d\tGL Max: %d\tUsed: %d\tNb Groups: %d\n",
+	                                    compositor->video_cache_max_size,
+	                                    compositor->video_cache_current_size,
+	                                    compositor->video_cache_gl_max_size,
+	                                    compositor->video_cache_gl_current_size,
+	                                    gf_list_count(compositor->cached_groups)
 	                                   ));
 }
 
@@ -458,20 +479,12 @@ static void group_cache_insert_entry(GF_Node *node, GroupingNode2D *group, GF_Tr
 static Bool gf_cache_remove_entry(GF_Compositor *compositor, GF_Node *node, GroupingNode2D *group)
 {
 	u32 bytes_remove = 0;
+	u32 *used_size;
 	GF_List *cache_candidates = compositor->cached_groups;
 
-	/*auto mode*/
-	if (!group) {
-		group = gf_list_get(cache_candidates, 0);
-		if (!group) return 0;
-		/*remove entry*/
-		gf_list_rem(cache_candidates, 0);
-		node = NULL;
-	} else {
-		/*remove entry if present*/
-		if (gf_list_del_item(cache_candidates, group)<0)
-			return 0;
-	}
+	/*remove entry if present*/
+	if (gf_list_del_item(cache_candidates, group)<0)
+		return 0;
 
 	/*disable the caching flag of the group if it was marked as such*/
 	if(group->flags & GROUP_IS_CACHABLE) {
@@ -489,24 +502,53 @@ static Bool gf_cache_remove_entry(GF_Compositor *compositor, GF_Node *node, Grou
 
 	if (bytes_remove == 0) return 0;
 
-	assert(compositor->video_cache_current_size >= bytes_remove);
-	compositor->video_cache_current_size -= bytes_remove;
+	used_size = group_cache_used_size(compositor, group);
+	assert(*used_size >= bytes_remove);
+	*used_size -= bytes_remove;
 
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] Removing cache %s:\t Objects: %d\tSlope: %g\tBytes: %d\tTime: %d\n",
-	                                    gf_node_get_log_name(node),
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] Removing cache %s:\t Objects: %d\tPriority: %d\tBytes: %d\tTime: %d\tGL: %d\n",
+	                                    node ? gf_node_get_log_name(node) : "",
 	                                    group->nb_objects,
-	                                    FIX2FLT(group->priority),
+	                                    group_cache_get_priority(compositor, group),
 	                                    group->cached_size,
-	                                    FIX2FLT(group->traverse_time)));
+	                                    group->traverse_time,
+	                                    group->cache_gl));
 
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] Status (B): Max: %d\tUsed: %d\tNb Groups: %d\n",
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] Status (B): 2D Max: %d\tUsed: %d\tGL Max: %d\tUsed: %d\tNb Groups: %d\n",
 	                                    compositor->video_cache_max_size,
 	                                    compositor->video_cache_current_size,
+	                                    compositor->video_cache_gl_max_size,
+	                                    compositor->video_cache_gl_current_size,
 	                                    gf_list_count(compositor->cached_groups)
 	                                   ));
 	return 1;
 }
 
+/*removes the cache of the given type with the lowest aged priority - returns 0 if no cache could be removed*/
+static Bool group_cache_evict(GF_Compositor *compositor, Bool for_gl)
+{
+	u32 i, count, min_priority = 0;
+	GroupingNode2D *victim = NULL;
+
+	count = gf_list_count(compositor->cached_groups);
+	for (i=0; i<count; i++) {
+		u32 priority;
+		GroupingNode2D *group = gf_list_get(compositor->cached_groups, i);
+		if (group->cache_gl != for_gl) continue;
+		priority = group_cache_get_priority(compositor, group);
+		if (!victim || (priority < min_priority)) {
+			victim = group;
+			min_priority = priority;
+		}
+	}
+	if (!victim || !gf_cache_remove_entry(compositor, NULL, victim))
+		return 0;
+	/*the group will be evaluated again once modified*/
+	victim->flags |= GROUP_CACHE_EVICTED;
+	compositor->video_cache_evictions++;
+	return 1;
+}
+
 
 /**/
 Bool group_2d_cache_traverse(GF_Node *node, GroupingNode2D *group, GF_TraverseState *tr_state)
@@ -545,7 +587,9 @@ Bool group_2d_cache_traverse(GF_Node *node, GroupingNode2D *group, GF_TraverseSt
 			group_cache_del(group->cache);
 			group->cache = NULL;
 			group->changed = is_dirty;
-			group->nb_stats_frame = 0;
+			/*don't collect stats again for evicted caches until the group is modified, otherwise the cache would be rebuilt and evicted in loop*/
+			if (!(group->flags & GROUP_CACHE_EVICTED))
+				group->nb_stats_frame = 0;
 			group->traverse_time = 0;
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] Turning group %s cache off\n", gf_node_get_log_name(node) ));
 			return 0;
@@ -560,16 +604,18 @@ Bool group_2d_cache_traverse(GF_Node *node, GroupingNode2D *group, GF_TraverseSt
 				group->changed = 0;
 				group->nb_stats_frame = 0;
 				group->traverse_time = 0;
+				group->flags &= ~GROUP_CACHE_EVICTED;
 			} else if (zoom_changed) {
 				group->nb_stats_frame = 0;
 				group->traverse_time = 0;
+				group->flags &= ~GROUP_CACHE_EVICTED;
 			}
 			if (is_dirty || (group->nb_stats_frame < NUM_STATS_FRAMES)) {
 				/*force direct draw mode*/
 				if (!is_dirty)
 					tr_state->visual->compositor->traverse_state->invalidate_all = 1;
 				/*force redraw*/
-				tr_state->visual->compositor->draw_next_frame = 1;
+				gf_sc_next_frame_state(tr_state->visual->compositor, GF_SC_DRAW_FRAME);
 			}
 			return 0;
 		}
@@ -636,8 +682,12 @@ Bool group_2d_cache_traverse(GF_Node *node, GroupingNode2D *group, GF_TraverseSt
 		needs_recompute = 1;
 	}
 
+	group->last_used = tr_state->visual->compositor->frame_number;
 	/*cache has been modified due to node changes, reset stats*/
-	group_cache_traverse(node, group->cache, tr_state, needs_recompute, 1, 0);
+	if (group_cache_traverse(node, group->cache, tr_state, needs_recompute, 1, 0))
+		tr_state->visual->compositor->video_cache_misses++;
+	else
+		tr_state->visual->compositor->video_cache_hits++;
 	return 1;
 }
 
@@ -647,19 +697,26 @@ Bool group_cache_compute_stats(GF_Node *node, GroupingNode2D *group, GF_Traverse
 	GF_Rect group_bounds;
 	DrawableContext *ctx;
 	u32 nb_segments, nb_objects;
-	u32 alpha_pixels, opaque_pixels, area_world;
+	u32 opaque_pixels, area_world;
 	u32 video_cache_max_size, cache_size, prev_cache_size;
 	u32 i;
+	Bool for_gl = GF_FALSE;
 	GF_RectArray ra;
+	GF_Compositor *compositor = tr_state->visual->compositor;
 
 	/*compute stats*/
 	nb_objects = 0;
 	nb_segments = 0;
-	alpha_pixels = opaque_pixels = 0;
+	opaque_pixels = 0;
 	prev_cache_size = group->cached_size;
 	/*reset bounds*/
 	group_bounds.width = group_bounds.height = 0;
-	video_cache_max_size = tr_state->visual->compositor->video_cache_max_size;
+
+	/*caches of groups drawn with OpenGL are stored as textures and use their own memory budget*/
+#ifndef GPAC_DISABLE_3D
+	if (tr_state->visual->type_3d || compositor->hybrid_opengl) for_gl = GF_TRUE;
+#endif
+	video_cache_max_size = for_gl ? compositor->video_cache_gl_max_size : compositor->video_cache_max_size;
 
 	/*never cache root node - this should be refined*/
 	if (gf_node_get_parent(node, 0) == NULL) goto group_reject;
@@ -712,7 +769,7 @@ Bool group_cache_compute_stats(GF_Node *node, GroupingNode2D *group, GF_Traverse
 	ra_refresh(&ra);
 	opaque_pixels = 0;
 	for (i=0; i<ra.count; i++) {
-		opaque_pixels += ra.list[i].width * ra.list[i].height;
+		opaque_pixels += ra.list[i].rect.width * ra.list[i].rect.height;
 	}
 	ra_del(&ra);
 
@@ -738,10 +795,9 @@ Bool group_cache_compute_stats(GF_Node *node, GroupingNode2D *group, GF_Traverse
 		goto group_reject;
 	}
 
-	/*compute the delta value for measuring the group importance for later discard
-		(avg_time - Tcache) / (size_cache - drawable_gain)
-	*/
-	group->priority = INT2FIX(nb_objects*1024*group->traverse_time) / cache_size / group->nb_stats_frame;
+	/*compute the priority of the group for later discard: redraw time saved per frame for each megabyte of cache
+	(the cache draw time is neglected)*/
+	group->priority = (u32) ( (((u64) group->traverse_time) << 20) / group->nb_stats_frame / cache_size);
 	/*OK, group is a good candidate for caching*/
 	group->nb_objects = nb_objects;
 	group->cached_size = cache_size;
@@ -750,19 +806,21 @@ Bool group_cache_compute_stats(GF_Node *node, GroupingNode2D *group, GF_Traverse
 	/*we're moving from non-cached to cached*/
 	if (!(group->flags & GROUP_IS_CACHABLE)) {
 		group->flags |= GROUP_IS_CACHABLE;
-		tr_state->visual->compositor->draw_next_frame = 1;
+		group->cache_gl = for_gl;
+		gf_sc_next_frame_state(compositor, GF_SC_DRAW_FRAME);
 
 		/*insert the candidate and then update the list in order*/
 		group_cache_insert_entry(node, group, tr_state);
 		/*keep track of this cache object for later removal*/
-		gf_list_add(tr_state->visual->compositor->cached_groups_queue, group);
+		gf_list_add(compositor->cached_groups_queue, group);
 
-		GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] Turning cache on during stat pass for node %s - %d kb used in all caches\n", gf_node_get_log_name(node), tr_state->visual->compositor->video_cache_current_size ));
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] Turning cache on during stat pass for node %s - %d bytes used in all %s caches\n", gf_node_get_log_name(node), *group_cache_used_size(compositor, group), for_gl ? "GL" : "2D"));
 	}
 	/*update memory occupation*/
 	else {
-		tr_state->visual->compositor->video_cache_current_size -= prev_cache_size;
-		tr_state->visual->compositor->video_cache_current_size += group->cached_size;
+		*group_cache_used_size(compositor, group) -= prev_cache_size;
+		group->cache_gl = for_gl;
+		*group_cache_used_size(compositor, group) += group->cached_size;
 
 		if (group->cache)
 			group->cache->force_recompute = 1;
@@ -781,15 +839,15 @@ group_reject:
 			group->cache = NULL;
 			group->flags &= ~GROUP_IS_CACHED;
 		}
-		gf_list_del_item(tr_state->visual->compositor->cached_groups, group);
-		tr_state->visual->compositor->video_cache_current_size -= cache_size;
+		if (gf_list_del_item(compositor->cached_groups, group)>=0)
+			*group_cache_used_size(compositor, group) -= prev_cache_size;
 	}
 
 #if 0
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] REJECT %s\tObjects: %d\tSlope: %g\tBytes: %d\tTime: %d\n",
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] REJECT %s\tObjects: %d\tPriority: %d\tBytes: %d\tTime: %d\n",
 	                                    gf_node_get_log_name(node),
 	                                    group->nb_objects,
-	                                    FIX2FLT(group->priority),
+	                                    group->priority,
 	                                    group->cached_size,
 	                                    group->traverse_time
 	                                   ));
@@ -807,19 +865,18 @@ group_reject:
 void group_2d_cache_evaluate(GF_Node *node, GroupingNode2D *group, GF_TraverseState *tr_state, DrawableContext *first_child, Bool skip_first_child, u32 last_cache_idx)
 {
 	u32 nb_cache_added, i;
-	Fixed priority;
 	GF_Compositor *compositor = tr_state->visual->compositor;
 
 	/*first frame is unusable for stats because lot of time is being spent building the path and allocating
 	the drawable contexts*/
-	if (!compositor->video_cache_max_size || !compositor->frame_number || group->changed || tr_state->in_group_cache) {
+	if ((!compositor->video_cache_max_size && !compositor->video_cache_gl_max_size) || !compositor->frame_number || group->changed || tr_state->in_group_cache) {
 		group->traverse_time = 0;
 		return;
 	}
 
 	if (group->nb_stats_frame < NUM_STATS_FRAMES) {
 		group->nb_stats_frame++;
-		tr_state->visual->compositor->draw_next_frame = 1;
+		gf_sc_next_frame_state(tr_state->visual->compositor, GF_SC_DRAW_FRAME);
 		return;
 	}
 	if (group->nb_stats_frame > NUM_STATS_FRAMES) return;
@@ -827,48 +884,54 @@ void group_2d_cache_evaluate(GF_Node *node, GroupingNode2D *group, GF_TraverseSt
 
 	/*the way to produce the result of memory-computation optimization*/
 	if (group_cache_compute_stats(node, group, tr_state, first_child, skip_first_child)) {
-		Fixed avg_time;
+		u64 avg_time;
+		u32 *used_size, max_size;
 		nb_cache_added = gf_list_count(compositor->cached_groups_queue) - last_cache_idx - 1;
 
 		/*force redraw*/
-		tr_state->visual->compositor->draw_next_frame = 1;
+		gf_sc_next_frame_state(tr_state->visual->compositor, GF_SC_DRAW_FRAME);
 
-		/*update priority by adding cache priorities */
-		avg_time = group->priority * group->cached_size / (1024*group->nb_objects);
+		/*average redraw time per frame, in microseconds*/
+		avg_time = group->traverse_time / group->nb_stats_frame;
 
 		/*remove all queued cached groups of this node's children*/
 		for (i=0; i<nb_cache_added; i++) {
-			Fixed cache_time;
 			GroupingNode2D *cache = gf_list_get(compositor->cached_groups_queue, last_cache_idx);
 			/*we have been computed the prioirity of the group using a cached subtree, update
 			the priority to reflect that the new cache won't use a cached subtree*/
 			if (cache->cache) {
 				/*fixme - this assumes cache draw time is 0*/
-				cache_time = cache->priority * cache->cached_size / (1024*group->nb_objects);
-				avg_time += cache_time;
+				avg_time += (((u64) cache->priority) * cache->cached_size) >> 20;
 			}
 			gf_cache_remove_entry(compositor, NULL, cache);
 			cache->nb_stats_frame = 0;
 			cache->traverse_time = 0;
 			gf_list_rem(compositor->cached_groups_queue, last_cache_idx);
 		}
-		priority = INT2FIX (group->nb_objects*1024*1024*avg_time) / group->cached_size;
-
-		/*when the memory exceeds the constraint, remove the subgroups that have the lowest deltas*/
-		while (compositor->video_cache_current_size > compositor->video_cache_max_size)	{
-			gf_cache_remove_entry(compositor, node, NULL);
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] Removing low priority cache - current total size %d\n", compositor->video_cache_current_size));
+		group->priority = (u32) ((avg_time << 20) / group->cached_size);
+
+		/*when the memory exceeds the constraint, remove the caches that save the least redraw time per byte,
+		starting with the ones not used for a while*/
+		used_size = group_cache_used_size(compositor, group);
+		max_size = group->cache_gl ? compositor->video_cache_gl_max_size : compositor->video_cache_max_size;
+		while (*used_size > max_size) {
+			if (!group_cache_evict(compositor, group->cache_gl)) break;
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_CACHE, ("[CACHE] Removing low priority cache - current total size %d\n", *used_size));
 		}
 	}
 }
 
 void compositor_set_cache_memory(GF_Compositor *compositor, u32 memory)
 {
-	/*when the memory exceeds the constraint, remove the subgroups that have the lowest deltas*/
-	while (compositor->video_cache_current_size) {
-		gf_cache_remove_entry(compositor, NULL, NULL);
+	/*the budget applies to both 2D and OpenGL caches*/
+	compositor->video_cache_max_size = compositor->video_cache_gl_max_size = memory;
+	/*when the memory exceeds the constraint, remove the caches with the lowest priorities*/
+	while (compositor->video_cache_current_size > memory) {
+		if (!group_cache_evict(compositor, GF_FALSE)) break;
+	}
+	while (compositor->video_cache_gl_current_size > memory) {
+		if (!group_cache_evict(compositor, GF_TRUE)) break;
 	}
-	compositor->video_cache_max_size = memory;
 	/*and force recompute*/
 	compositor->zoom_changed = 1;
 }
@@ -882,7 +945,7 @@ void group_2d_destroy_svg(GF_Node *node, GroupingNode2D *group)
 	if (gf_cache_remove_entry(compositor, node, group)) {
 		/*simulate a zoom changed for cache recompute*/
 		compositor->zoom_changed = 1;
-		compositor->draw_next_frame = 1;
+		gf_sc_next_frame_state(compositor, GF_SC_DRAW_FRAME);
 	}
 	if (group->cache) group_cache_del(group->cache);
 #endif
@@ -536,7 +536,7 @@ static void svg_traverse_g(GF_Node *node, void *rs, Bool is_destroy)
 	if (is_destroy) {
 		SVGgStack *group = gf_node_get_private(node);
 #ifdef GF_SR_USE_VIDEO_CACHE
-		group_2d_destroy_svg(node, group);
+		group_2d_destroy_svg(node, (GroupingNode2D *) group);
 #else
 		if (group->cache) group_cache_del(group->cache);
 #endif
@@ -623,7 +623,7 @@ static void svg_traverse_g(GF_Node *node, void *rs, Bool is_destroy)
 				group->cache->force_recompute = 1;
 			group->flags |= GROUP_IS_CACHED | GROUP_PERMANENT_CACHE;
 #ifdef GF_SR_USE_VIDEO_CACHE
-			group_2d_cache_traverse(node, group, tr_state);
+			group_2d_cache_traverse(node, (GroupingNode2D *) group, tr_state);
 #else
 			group_cache_traverse(node, group->cache, tr_state, group->cache->force_recompute, 0, 0);
 #endif
@@ -631,7 +631,7 @@ static void svg_traverse_g(GF_Node *node, void *rs, Bool is_destroy)
 #ifdef GF_SR_USE_VIDEO_CACHE
 			Bool group_cached;
 
-			group_cached = group_2d_cache_traverse(node, group, tr_state);
+			group_cached = group_2d_cache_traverse(node, (GroupingNode2D *) group, tr_state);
 			gf_node_dirty_clear(node, GF_SG_CHILD_DIRTY);
 			/*group is not cached, traverse the children*/
 			if (!group_cached) {
@@ -639,7 +639,7 @@ static void svg_traverse_g(GF_Node *node, void *rs, Bool is_destroy)
 				DrawableContext *first_ctx = tr_state->visual->cur_context;
 				u32 cache_too_small = 0;
 				Bool skip_first_ctx = (first_ctx && first_ctx->drawable) ? 1 : 0;
-				u32 traverse_time = gf_sys_clock();
+				u64 traverse_time = gf_sys_clock_high_res();
 				u32 last_cache_idx = gf_list_count(tr_state->visual->compositor->cached_groups_queue);
 				tr_state->cache_too_small = 0;
 
@@ -655,10 +655,10 @@ static void svg_traverse_g(GF_Node *node, void *rs, Bool is_destroy)
 					tr_state->cache_too_small = 1;
 				} else {
 					/*get the traversal time for each group*/
-					traverse_time = gf_sys_clock() - traverse_time;
-					group->traverse_time += traverse_time;
+					traverse_time = gf_sys_clock_high_res() - traverse_time;
+					group->traverse_time += (u32) traverse_time;
 					/*record the traversal information and turn cache on if possible*/
-					group_2d_cache_evaluate(node, group, tr_state, first_ctx, skip_first_ctx, last_cache_idx);
+					group_2d_cache_evaluate(node, (GroupingNode2D *) group, tr_state, first_ctx, skip_first_ctx, last_cache_idx);
 				}
 			}
 #else
@@ -64,6 +64,9 @@ enum
 	TX_IS_FLIPPED = (1<<15),
 };
 
+/*max number of PBOs cycled for each texture plane*/
+#define TX_MAX_PBO	4
+
 
 struct __texture_wrapper
 {
@@ -93,7 +96,10 @@ struct __texture_wrapper
 	u32 nb_comp, gl_format, gl_type, gl_dtype;
 	Bool yuv_shader;
 	u32 v_id, u_id;
-	u32 pbo_id, u_pbo_id, v_pbo_id;
+	/*PBOs for the Y (or packed), U and V planes: each new frame is copied in the next set of PBOs, while the
+	transfer of the previous frame from the previous set may still be pending*/
+	u32 pbo_ids[TX_MAX_PBO][3];
+	u32 nb_pbo, pbo_idx;
 	Bool pbo_pushed;
 #endif
 #ifdef GF_SR_USE_DEPTH
@@ -148,6 +154,138 @@ GF_Err gf_sc_texture_configure_conversion(GF_TextureHandler *txh)
 }
 
 
+#ifndef GPAC_DISABLE_3D
+static void tx_pbo_del(struct __texture_wrapper *tx_io)
+{
+	u32 i;
+	for (i=0; i<tx_io->nb_pbo; i++) {
+		glDeleteBuffers(3, tx_io->pbo_ids[i]);
+	}
+	memset(tx_io->pbo_ids, 0, sizeof(tx_io->pbo_ids));
+	tx_io->nb_pbo = tx_io->pbo_idx = 0;
+	tx_io->pbo_pushed = GF_FALSE;
+}
+#endif
+
+#if !defined(GPAC_DISABLE_3D) && !defined(GPAC_USE_TINYGL) && !defined(GPAC_USE_GLES1X) && !defined(GPAC_USE_GLES2)
+/*checks if the frame can be uploaded as is from a PBO: only video frames are, scaled, converted or multiview frames
+are pushed synchronously*/
+static Bool tx_pbo_can_push(GF_TextureHandler *txh)
+{
+	if (!txh->data || !txh->stream || !txh->tx_io->id) return GF_FALSE;
+	if (!txh->compositor->gl_caps.pbo || !txh->compositor->enable_pbo) return GF_FALSE;
+	if (txh->frame && txh->frame->GetGLTexture) return GF_FALSE;
+	if (txh->tx_io->flags & (TX_MUST_SCALE | TX_EMULE_POW2)) return GF_FALSE;
+	if (!txh->raw_memory) {
+		int nb_views = 1;
+		gf_mo_get_nb_views(txh->stream, &nb_views);
+		if (nb_views > 1) return GF_FALSE;
+	}
+	if (txh->tx_io->yuv_shader) return GF_TRUE;
+
+	switch (txh->pixelformat) {
+	case GF_PIXEL_GREYSCALE:
+	case GF_PIXEL_ALPHAGREY:
+	case GF_PIXEL_RGB_24:
+	case GF_PIXEL_RGB_32:
+	case GF_PIXEL_RGBA:
+	case GF_PIXEL_ARGB:
+		/*rectangle textures are flipped in a copy of the frame, see gf_sc_texture_convert*/
+		if ((txh->tx_io->flags & TX_IS_RECT) && !(txh->flags & GF_SR_TEXTURE_NO_GL_FLIP)) return GF_FALSE;
+		return GF_TRUE;
+	default:
+		return GF_FALSE;
+	}
+}
+
+/*gets the planes of the frame as uploaded by gf_sc_texture_push_image*/
+static void tx_pbo_get_planes(GF_TextureHandler *txh, u8 *planes[3], u32 sizes[3])
+{
+	u32 stride_chroma = txh->stride_chroma;
+
+	planes[0] = (u8 *) txh->data;
+	sizes[0] = txh->stride * txh->height;
+	planes[1] = planes[2] = NULL;
+	sizes[1] = sizes[2] = 0;
+	if (!txh->tx_io->yuv_shader) return;
+
+	if (txh->raw_memory) {
+		planes[1] = txh->pU;
+		planes[2] = txh->pV;
+	} else {
+		planes[1] = planes[0] + sizes[0];
+	}
+	switch (txh->pixelformat) {
+	case GF_PIXEL_YUV444_10:
+	case GF_PIXEL_YUV444:
+		if (!stride_chroma) stride_chroma = txh->stride;
+		sizes[1] = sizes[2] = stride_chroma * txh->height;
+		break;
+	case GF_PIXEL_YUV422_10:
+	case GF_PIXEL_YUV422:
+		if (!stride_chroma) stride_chroma = txh->stride/2;
+		sizes[1] = sizes[2] = stride_chroma * txh->height;
+		break;
+	case GF_PIXEL_YV12_10:
+	case GF_PIXEL_YV12:
+		if (!stride_chroma) stride_chroma = txh->stride/2;
+		sizes[1] = sizes[2] = stride_chroma * txh->height / 2;
+		break;
+	case GF_PIXEL_NV21:
+	case GF_PIXEL_NV12:
+	case GF_PIXEL_NV12_10:
+		/*interleaved UV plane*/
+		sizes[1] = txh->stride * txh->height / 2;
+		planes[2] = NULL;
+		return;
+	default:
+		planes[1] = planes[2] = NULL;
+		return;
+	}
+	if (!planes[2]) planes[2] = planes[1] + sizes[1];
+}
+
+/*copies the frame in the next set of PBOs - returns GF_FALSE if the frame must be uploaded synchronously*/
+static Bool tx_pbo_push(GF_TextureHandler *txh)
+{
+	u32 i, sizes[3];
+	u8 *planes[3];
+	struct __texture_wrapper *tx_io = txh->tx_io;
+
+	if (!tx_pbo_can_push(txh)) return GF_FALSE;
+
+	if (!tx_io->nb_pbo) {
+		tx_io->nb_pbo = MIN(txh->compositor->pbo_count, TX_MAX_PBO);
+		for (i=0; i<tx_io->nb_pbo; i++) {
+			glGenBuffers(3, tx_io->pbo_ids[i]);
+		}
+	}
+	tx_pbo_get_planes(txh, planes, sizes);
+	tx_io->pbo_idx = (tx_io->pbo_idx + 1) % tx_io->nb_pbo;
+
+	for (i=0; i<3; i++) {
+		u8 *ptr;
+		Bool res;
+		if (!planes[i] || !sizes[i]) continue;
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, tx_io->pbo_ids[tx_io->pbo_idx][i]);
+		/*orphan the buffer storage so that mapping does not wait for a transfer still using it*/
+		glBufferData(GL_PIXEL_UNPACK_BUFFER_ARB, sizes[i], NULL, GL_STREAM_DRAW_ARB);
+		ptr = (u8 *)glMapBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+		res = GF_FALSE;
+		if (ptr) {
+			memcpy(ptr, planes[i], sizes[i]);
+			res = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER_ARB) ? GF_TRUE : GF_FALSE;
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+		if (!res) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_COMPOSE, ("[Texturing] Failed to map PBO, using synchronous texture upload\n"));
+			return GF_FALSE;
+		}
+	}
+	return GF_TRUE;
+}
+#endif
 
 static void release_txio(struct __texture_wrapper *tx_io)
 {
@@ -158,9 +296,7 @@ static void release_txio(struct __texture_wrapper *tx_io)
 		if (tx_io->u_id) glDeleteTextures(1, &tx_io->u_id);
 		if (tx_io->v_id) glDeleteTextures(1, &tx_io->v_id);
 	}
-	if (tx_io->pbo_id) glDeleteBuffers(1, &tx_io->pbo_id);
-	if (tx_io->u_pbo_id) glDeleteBuffers(1, &tx_io->u_pbo_id);
-	if (tx_io->v_pbo_id) glDeleteBuffers(1, &tx_io->v_pbo_id);
+	tx_pbo_del(tx_io);
 
 	if (tx_io->scale_data) gf_free(tx_io->scale_data);
 #endif
@@ -262,39 +398,13 @@ GF_Err gf_sc_texture_set_data(GF_TextureHandler *txh)
 
 #if !defined(GPAC_DISABLE_3D) && !defined(GPAC_USE_TINYGL) && !defined(GPAC_USE_GLES1X) && !defined(GPAC_USE_GLES2)
 	//PBO mode: start pushing the texture
-	if (txh->data && txh->tx_io->pbo_id) {
-		u8 *ptr;
-		u32 size = txh->stride*txh->height;
-
-		glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, txh->tx_io->pbo_id);
-		ptr =(u8 *)glMapBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
-		if (ptr) memcpy(ptr, txh->data, size);
-		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER_ARB);
-		glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
-
-		if (txh->tx_io->u_pbo_id) {
-			u8 *pU = txh->pU;
-			u8 *pV = txh->pV;
-			if (!pU) pU = (u8 *) txh->data + size;
-			if (!pV) pV = (u8 *) txh->data + 5*size/4;
-
-			glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, txh->tx_io->u_pbo_id);
-			ptr =(u8 *)glMapBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
-			if (ptr) memcpy(ptr, pU, size/4);
-			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER_ARB);
-			glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
-
-			glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, txh->tx_io->v_pbo_id);
-			ptr =(u8 *)glMapBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
-			if (ptr) memcpy(ptr, pV, size/4);
-			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER_ARB);
-			glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
-		}
-
-		txh->tx_io->pbo_pushed = 1;
+	if (txh->data) {
+		u64 push_start = gf_sys_clock_high_res();
+		txh->tx_io->pbo_pushed = tx_pbo_push(txh);
+		txh->compositor->texture_upload_time += (u32) (gf_sys_clock_high_res() - push_start);
 
 		//we just pushed our texture to the GPU, release
-		if (txh->raw_memory) {
+		if (txh->tx_io->pbo_pushed && txh->raw_memory) {
 			gf_sc_texture_release_stream(txh);
 		}
 	}
@@ -303,7 +413,7 @@ GF_Err gf_sc_texture_set_data(GF_TextureHandler *txh)
 	//We do not have PBOs in ES2.0
 #elif !defined(GPAC_DISABLE_3D) && defined(GPAC_USE_GLES2)
 	//PBO mode: start pushing the texture
-	if (txh->tx_io->pbo_id) {
+	if (txh->compositor->enable_pbo) {
 		GF_LOG(GF_LOG_ERROR, GF_LOG_COMPOSE, ("[V3D:GLSL] PBOs are not implemented in GL ES 2.0\n"));
 	}
 	return GF_NOT_SUPPORTED;
@@ -327,10 +437,7 @@ void gf_sc_texture_reset(GF_TextureHandler *txh)
 		}
 		txh->tx_io->id = txh->tx_io->u_id = txh->tx_io->v_id = 0;
 		
-		if (txh->tx_io->pbo_id) glDeleteBuffers(1, &txh->tx_io->pbo_id);
-		if (txh->tx_io->u_pbo_id) glDeleteBuffers(1, &txh->tx_io->u_pbo_id);
-		if (txh->tx_io->v_pbo_id) glDeleteBuffers(1, &txh->tx_io->v_pbo_id);
-		txh->tx_io->pbo_id = txh->tx_io->u_pbo_id = txh->tx_io->v_pbo_id = 0;
+		tx_pbo_del(txh->tx_io);
 	}
 	txh->tx_io->flags |= TX_NEEDS_HW_LOAD;
 #endif
@@ -616,37 +723,6 @@ static Bool tx_setup_format(GF_TextureHandler *txh)
 	}
 #endif
 
-#if !defined(GPAC_USE_TINYGL) && !defined(GPAC_USE_GLES1X) && !defined(GPAC_USE_GLES2)
-	if (txh->compositor->gl_caps.pbo && txh->compositor->enable_pbo) {
-		u32 size = txh->stride*txh->height;
-
-		if (!txh->tx_io->pbo_id && txh->tx_io->id) {
-			glGenBuffers(1, &txh->tx_io->pbo_id);
-			if (txh->tx_io->pbo_id) {
-				glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, txh->tx_io->pbo_id);
-				glBufferData(GL_PIXEL_UNPACK_BUFFER_ARB, size, NULL, GL_DYNAMIC_DRAW_ARB);
-				glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
-			}
-		}
-		if (!txh->tx_io->u_pbo_id && txh->tx_io->u_id) {
-			glGenBuffers(1, &txh->tx_io->u_pbo_id);
-			if (txh->tx_io->u_pbo_id) {
-				glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, txh->tx_io->u_pbo_id);
-				glBufferData(GL_PIXEL_UNPACK_BUFFER_ARB, size/4, NULL, GL_DYNAMIC_DRAW_ARB);
-				glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
-			}
-		}
-		if (!txh->tx_io->v_pbo_id && txh->tx_io->v_id) {
-			glGenBuffers(1, &txh->tx_io->v_pbo_id);
-			if (txh->tx_io->v_pbo_id) {
-				glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, txh->tx_io->v_pbo_id);
-				glBufferData(GL_PIXEL_UNPACK_BUFFER_ARB, size/4, NULL, GL_DYNAMIC_DRAW_ARB);
-				glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
-			}
-		}
-	}
-#endif
-
 	if (use_yuv_shaders) {
 		//we use LUMINANCE because GL_RED is not defined on android ...
 		txh->tx_io->gl_format = GL_LUMINANCE;
@@ -918,7 +994,7 @@ common:
 	case GF_PIXEL_BGR_32:
 		txh->tx_io->conv_format = dst.pixel_format = GF_PIXEL_RGB_24;
 		/*stretch and flip*/
-		gf_stretch_bits(&dst, &src, NULL, NULL, 0xFF, !txh->is_flipped, NULL, NULL);
+		gf_stretch_bits_ex(txh->compositor->stretch_pool, &dst, &src, NULL, NULL, 0xFF, !txh->is_flipped, NULL, NULL);
 		if ( !txh->is_flipped)
 			txh->flags |= GF_SR_TEXTURE_NO_GL_FLIP;
 		break;
@@ -929,14 +1005,14 @@ common:
 			dst.pixel_format = GF_PIXEL_RGB_24;
 			dst.pitch_y = 3*txh->width;
 			/*stretch YUV->RGB*/
-			gf_stretch_bits(&dst, &src, NULL, NULL, 0xFF, 1, NULL, NULL);
+			gf_stretch_bits_ex(txh->compositor->stretch_pool, &dst, &src, NULL, NULL, 0xFF, 1, NULL, NULL);
 			/*copy over Depth plane*/
 			memcpy(dst.video_buffer + 3*txh->width*txh->height, txh->data + 3*txh->stride*txh->height/2, txh->width*txh->height);
 		} else {
 			txh->tx_io->conv_format = GF_PIXEL_RGBD;
 			dst.pixel_format = GF_PIXEL_RGBD;
 			/*stretch*/
-			gf_stretch_bits(&dst, &src, NULL, NULL, 0xFF, 0, NULL, NULL);
+			gf_stretch_bits_ex(txh->compositor->stretch_pool, &dst, &src, NULL, NULL, 0xFF, 0, NULL, NULL);
 		}
 		txh->flags |= GF_SR_TEXTURE_NO_GL_FLIP;
 		break;
@@ -970,7 +1046,7 @@ common:
 
 
 #ifndef GPAC_DISABLE_3D
-static void do_tex_image_2d(GF_TextureHandler *txh, GLint tx_mode, Bool first_load, u8 *data, u32 stride, u32 w, u32 h, u32 pbo_id)
+static void do_tex_image_2d(GF_TextureHandler *txh, GLint tx_mode, Bool first_load, u8 *data, u32 stride, u32 w, u32 h, u32 plane_idx)
 {
 	Bool needs_stride;
 	GL_CHECK_ERR
@@ -997,8 +1073,13 @@ static void do_tex_image_2d(GF_TextureHandler *txh, GLint tx_mode, Bool first_lo
 
 #if !defined(GPAC_USE_TINYGL) && !defined(GPAC_USE_GLES1X) && !defined(GPAC_USE_GLES2)
 	if (txh->tx_io->pbo_pushed) {
-		glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, pbo_id);
-		glTexImage2D(txh->tx_io->gl_type, 0, tx_mode, w, h, 0, txh->tx_io->gl_format, txh->tx_io->gl_dtype, NULL);
+		//the transfer from the PBO is asynchronous, the texture storage is only reallocated on first load
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, txh->tx_io->pbo_ids[txh->tx_io->pbo_idx][plane_idx]);
+		if (first_load) {
+			glTexImage2D(txh->tx_io->gl_type, 0, tx_mode, w, h, 0, txh->tx_io->gl_format, txh->tx_io->gl_dtype, NULL);
+		} else {
+			glTexSubImage2D(txh->tx_io->gl_type, 0, 0, 0, w, h, txh->tx_io->gl_format, txh->tx_io->gl_dtype, NULL);
+		}
 		glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
 	}
 	else
@@ -1049,6 +1130,8 @@ Bool gf_sc_texture_push_image(GF_TextureHandler *txh, Bool generate_mipmaps, Boo
 	u32 pixel_format, w, h;
 	int nb_views = 1, nb_layers = 1, nb_frames = 1;
 	u32 push_time;
+	u64 upload_start;
+	Bool pbo_used;
 
 	if (txh->stream) {
 		gf_mo_get_nb_views(txh->stream, &nb_views);
@@ -1129,6 +1212,8 @@ Bool gf_sc_texture_push_image(GF_TextureHandler *txh, Bool generate_mipmaps, Boo
 
 
 	push_time = gf_sys_clock();
+	upload_start = gf_sys_clock_high_res();
+	pbo_used = txh->tx_io->pbo_pushed;
 
 
 #ifdef GPAC_USE_TINYGL
@@ -1246,7 +1331,7 @@ Bool gf_sc_texture_push_image(GF_TextureHandler *txh, Bool generate_mipmaps, Boo
 			}
 #endif
 
-			do_tex_image_2d(txh, tx_mode, first_load, pY, stride_luma, w, h, txh->tx_io->pbo_id);
+			do_tex_image_2d(txh, tx_mode, first_load, pY, stride_luma, w, h, 0);
 			GL_CHECK_ERR
 
 			/*
@@ -1258,37 +1343,37 @@ Bool gf_sc_texture_push_image(GF_TextureHandler *txh, Bool generate_mipmaps, Boo
 				u32 fmt = txh->tx_io->gl_format;
 				txh->tx_io->gl_format = GL_LUMINANCE_ALPHA;
 				glBindTexture(txh->tx_io->gl_type, txh->tx_io->u_id);
-				do_tex_image_2d(txh, GL_LUMINANCE_ALPHA, first_load, pU, stride_chroma, w/2, h/2, txh->tx_io->u_pbo_id);
+				do_tex_image_2d(txh, GL_LUMINANCE_ALPHA, first_load, pU, stride_chroma, w/2, h/2, 1);
 				txh->tx_io->gl_format = fmt;
 				GL_CHECK_ERR
 			} 
 			else if (txh->pixelformat == GF_PIXEL_YV12_10 || txh->pixelformat == GF_PIXEL_YV12 ) {
 				glBindTexture(txh->tx_io->gl_type, txh->tx_io->u_id);
-				do_tex_image_2d(txh, tx_mode, first_load, pU, stride_chroma, w/2, h/2, txh->tx_io->u_pbo_id);
+				do_tex_image_2d(txh, tx_mode, first_load, pU, stride_chroma, w/2, h/2, 1);
 				GL_CHECK_ERR
 
 				glBindTexture(txh->tx_io->gl_type, txh->tx_io->v_id);
-				do_tex_image_2d(txh, tx_mode, first_load, pV, stride_chroma, w/2, h/2, txh->tx_io->v_pbo_id);
+				do_tex_image_2d(txh, tx_mode, first_load, pV, stride_chroma, w/2, h/2, 2);
 				GL_CHECK_ERR
 			}
 			else if (txh->pixelformat == GF_PIXEL_YUV422_10 || txh->pixelformat == GF_PIXEL_YUV422) {
 				
 				glBindTexture(txh->tx_io->gl_type, txh->tx_io->u_id);
-				do_tex_image_2d(txh, tx_mode, first_load, pU, stride_chroma, w/2 , h , txh->tx_io->u_pbo_id);
+				do_tex_image_2d(txh, tx_mode, first_load, pU, stride_chroma, w/2 , h , 1);
 				GL_CHECK_ERR
 
 				glBindTexture(txh->tx_io->gl_type, txh->tx_io->v_id);
-				do_tex_image_2d(txh, tx_mode, first_load, pV, stride_chroma, w/2 , h, txh->tx_io->v_pbo_id);
+				do_tex_image_2d(txh, tx_mode, first_load, pV, stride_chroma, w/2 , h, 2);
 				GL_CHECK_ERR
 			}
 			else if (txh->pixelformat == GF_PIXEL_YUV444_10 || txh->pixelformat == GF_PIXEL_YUV444) {
 				
 				glBindTexture(txh->tx_io->gl_type, txh->tx_io->u_id);
-		      	do_tex_image_2d(txh, tx_mode, first_load, pU, stride_chroma, w, h, txh->tx_io->u_pbo_id);
+		      	do_tex_image_2d(txh, tx_mode, first_load, pU, stride_chroma, w, h, 1);
 				GL_CHECK_ERR
  
 				glBindTexture(txh->tx_io->gl_type, txh->tx_io->v_id);
-				do_tex_image_2d(txh, tx_mode, first_load, pV, stride_chroma, w, h, txh->tx_io->v_pbo_id);
+				do_tex_image_2d(txh, tx_mode, first_load, pV, stride_chroma, w, h, 2);
 				GL_CHECK_ERR
 			}
 
@@ -1301,7 +1386,7 @@ Bool gf_sc_texture_push_image(GF_TextureHandler *txh, Bool generate_mipmaps, Boo
 
 			txh->tx_io->pbo_pushed = 0;
 		} else {
-			do_tex_image_2d(txh, tx_mode, first_load, (u8 *) data, txh->stride, w, h, txh->tx_io->pbo_id);
+			do_tex_image_2d(txh, tx_mode, first_load, (u8 *) data, txh->stride, w, h, 0);
 			txh->tx_io->pbo_pushed = 0;
 		}
 	} else {
@@ -1330,7 +1415,7 @@ Bool gf_sc_texture_push_image(GF_TextureHandler *txh, Bool generate_mipmaps, Boo
 			dst.pixel_format = txh->pixelformat;
 			dst.video_buffer = txh->tx_io->scale_data;
 
-			gf_stretch_bits(&dst, &src, NULL, NULL, 0xFF, 0, NULL, NULL);
+			gf_stretch_bits_ex(txh->compositor->stretch_pool, &dst, &src, NULL, NULL, 0xFF, 0, NULL, NULL);
 		}
 
 		if (first_load) {
@@ -1344,13 +1429,14 @@ Bool gf_sc_texture_push_image(GF_TextureHandler *txh, Bool generate_mipmaps, Boo
 push_exit:
 
 	push_time = gf_sys_clock() - push_time;
+	txh->compositor->texture_upload_time += (u32) (gf_sys_clock_high_res() - upload_start);
 
 	txh->nb_frames ++;
 	txh->upload_time += push_time;
 
 #ifndef GPAC_DISABLE_LOGS
 			gf_mo_get_object_time(txh->stream, &ck);
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_MEDIA, ("[GL Texture] Texture (CTS %u) %d ms after due date - Pushed %s in %d ms - average push time %d ms (PBO enabled %s)\n", txh->last_frame_time, ck - txh->last_frame_time, txh->tx_io->yuv_shader ? "YUV textures" : "texture", push_time, txh->upload_time / txh->nb_frames, txh->tx_io->pbo_pushed ? "yes" : "no"));
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_MEDIA, ("[GL Texture] Texture (CTS %u) %d ms after due date - Pushed %s in %d ms - average push time %d ms (PBO enabled %s)\n", txh->last_frame_time, ck - txh->last_frame_time, txh->tx_io->yuv_shader ? "YUV textures" : "texture", push_time, txh->upload_time / txh->nb_frames, pbo_used ? "yes" : "no"));
 #endif
 	return 1;
 
@@ -238,7 +238,13 @@ void gf_sc_load_opengl_extensions(GF_Compositor *compositor, Bool has_gl_context
 	if (CHECK_GL_EXT("GL_ARB_pixel_buffer_object")) {
 		GET_GLFUN(glMapBuffer);
 		GET_GLFUN(glUnmapBuffer);
-
+		/*PBO uploads also use the buffer functions, only loaded with VBO support*/
+		if (glGenBuffers && glDeleteBuffers && glBindBuffer && glBufferData && glMapBuffer && glUnmapBuffer)
+			compositor->gl_caps.pbo=1;
+	}
+#else
+	/*buffer functions are part of the GL headers*/
+	if (CHECK_GL_EXT("GL_ARB_pixel_buffer_object")) {
 		compositor->gl_caps.pbo=1;
 	}
 #endif
@@ -27,18 +27,31 @@
 
 GF_EXPORT
 GF_Crypt *gf_crypt_open(GF_CRYPTO_ALGO algorithm, GF_CRYPTO_MODE mode)
+{
+	return gf_crypt_open_ex(algorithm, mode, GF_CRYPTO_BACKEND_AUTO);
+}
+
+GF_EXPORT
+GF_Crypt *gf_crypt_open_ex(GF_CRYPTO_ALGO algorithm, GF_CRYPTO_MODE mode, GF_CRYPTO_BACKEND backend)
 {
 	GF_Crypt *td;
-	GF_Err e;
+	GF_Err e = GF_NOT_SUPPORTED;
 
 	GF_SAFEALLOC(td, GF_Crypt);
 	if (td == NULL) return NULL;
 
+#ifdef GPAC_HAS_AESNI
+	if ((backend != GF_CRYPTO_BACKEND_SOFT) && gf_crypt_aesni_supported()) {
+		e = gf_crypt_open_open_aesni(td, mode);
+	}
+#endif
+	if ((e != GF_OK) && (backend != GF_CRYPTO_BACKEND_AESNI)) {
 #ifdef GPAC_HAS_SSL
-	e = gf_crypt_open_open_openssl(td, mode);
+		e = gf_crypt_open_open_openssl(td, mode);
 #else
-	e = gf_crypt_open_open_tinyaes(td, mode);
+		e = gf_crypt_open_open_tinyaes(td, mode);
 #endif
+	}
 
 	if (e != GF_OK) {
 		gf_free(td);
@@ -70,6 +83,7 @@ GF_Err gf_crypt_set_IV(GF_Crypt *td, const void *iv, u32 size)
 	return td->_set_state(td, (void *)iv, size);
 }
 
+GF_EXPORT
 GF_Err gf_crypt_get_IV(GF_Crypt *td, void *iv, u32 *size)
 {
 	if (!td) return GF_BAD_PARAM;
@@ -103,3 +117,45 @@ GF_Err gf_crypt_decrypt(GF_Crypt *td, void *ciphertext, u32 len)
 	if (!len) return GF_OK;
 	return td->_decrypt(td, ciphertext, len);
 }
+
+/*processes ranges one by one, saving and restoring the IV state around them*/
+static GF_Err gf_crypt_ranges_generic(GF_Crypt *td, GF_CryptRange *ranges, u32 nb_ranges, Bool encrypt)
+{
+	u8 state[17], IV[17];
+	u32 i, state_size = 17;
+	GF_Err e = td->_get_state(td, state, &state_size);
+	if (e) return e;
+
+	for (i=0; i<nb_ranges; i++) {
+		u32 size = ranges[i].size;
+		if (td->mode == GF_CTR) {
+			/*CTR state is the number of bytes used in the current block followed by the counter*/
+			IV[0] = 0;
+			memcpy(IV+1, ranges[i].IV, 16);
+			e = td->_set_state(td, IV, 17);
+		} else {
+			size -= size % 16;
+			e = td->_set_state(td, ranges[i].IV, 16);
+		}
+		if (!e && size) e = encrypt ? td->_crypt(td, ranges[i].data, size) : td->_decrypt(td, ranges[i].data, size);
+		if (e) break;
+	}
+	td->_set_state(td, state, state_size);
+	return e;
+}
+
+GF_EXPORT
+GF_Err gf_crypt_encrypt_ranges(GF_Crypt *td, GF_CryptRange *ranges, u32 nb_ranges)
+{
+	if (!td || (nb_ranges && !ranges)) return GF_BAD_PARAM;
+	if (td->_crypt_ranges) return td->_crypt_ranges(td, ranges, nb_ranges, GF_TRUE);
+	return gf_crypt_ranges_generic(td, ranges, nb_ranges, GF_TRUE);
+}
+
+GF_EXPORT
+GF_Err gf_crypt_decrypt_ranges(GF_Crypt *td, GF_CryptRange *ranges, u32 nb_ranges)
+{
+	if (!td || (nb_ranges && !ranges)) return GF_BAD_PARAM;
+	if (td->_crypt_ranges) return td->_crypt_ranges(td, ranges, nb_ranges, GF_FALSE);
+	return gf_crypt_ranges_generic(td, ranges, nb_ranges, GF_FALSE);
+}
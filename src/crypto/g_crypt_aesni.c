@@ -0,0 +1,588 @@
+/*
+*			GPAC - Multimedia Framework C SDK
+*
+*			Authors: Jean Le Feuvre
+*			Copyright (c) Telecom ParisTech 2018
+*					All rights reserved
+*
+*  This file is part of GPAC / crypto lib sub-project
+*
+*  GPAC is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU Lesser General Public License as published by
+*  the Free Software Foundation; either version 2, or (at your option)
+*  any later version.
+*
+*  GPAC is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU Lesser General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; see the file COPYING.  If not, write to
+*  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+*
+*/
+
+#include <gpac/internal/crypt_dev.h>
+
+#ifdef GPAC_HAS_AESNI
+
+/*
+AES 128 using the AES-NI instructions of x86 CPUs, selected at run time when the CPU supports them. The code is built
+without any specific compiler flag: functions using AES-NI (or VAES) are compiled for these instruction sets through
+target attributes and are only called after checking the CPU.
+
+CTR keystream and CBC decryption process 8 blocks at once to hide the latency of the AES instructions; on CPUs with
+VAES and AVX2, the CTR keystream is computed on 256 bits registers (2 blocks per instruction). CBC encryption of a single
+range is serial by nature, but several ranges are encrypted in parallel by gf_crypt_encrypt_ranges.
+*/
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AESNI_TARGET
+#define VAES_TARGET
+#define AESNI_BSWAP64(_v)	_byteswap_uint64(_v)
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#define AESNI_TARGET	__attribute__((target("sse2,aes")))
+#define VAES_TARGET	__attribute__((target("sse2,aes,avx2,vaes")))
+#define AESNI_BSWAP64(_v)	__builtin_bswap64(_v)
+#endif
+
+#if (defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 8)) || (defined(__clang__) && (__clang_major__ >= 6)) || (defined(_MSC_VER) && (_MSC_VER >= 1920))
+#define GPAC_HAS_VAES
+#endif
+
+#define AESNI_BLOCK	16
+/*number of blocks processed at once*/
+#define AESNI_LANES	8
+
+enum
+{
+	AESNI_CAP_AES = 1,
+	AESNI_CAP_VAES = 1<<1,
+	AESNI_CAP_DETECTED = 1<<30,
+};
+static u32 aesni_caps = 0;
+
+typedef struct
+{
+	/*round keys for encryption and for decryption (equivalent inverse cipher)*/
+	u8 enc_keys[11*AESNI_BLOCK];
+	u8 dec_keys[11*AESNI_BLOCK];
+	/*CBC: last cipher block - CTR: next counter block*/
+	u8 iv[AESNI_BLOCK];
+	/*CTR only: keystream of the current block and number of bytes of it already used*/
+	u8 keystream[AESNI_BLOCK];
+	u32 counter_pos;
+	Bool use_vaes;
+} AESNI_ctx;
+
+
+static u32 aesni_get_caps()
+{
+	u32 caps = AESNI_CAP_DETECTED;
+	u32 ecx1, ebx7=0, ecx7=0;
+#if defined(_MSC_VER)
+	int regs[4];
+	__cpuid(regs, 0);
+	if (regs[0] < 1) return caps;
+	__cpuid(regs, 1);
+	ecx1 = regs[2];
+	if (regs[0] >= 7) {
+		__cpuidex(regs, 7, 0);
+		ebx7 = regs[1];
+		ecx7 = regs[2];
+	}
+#else
+	u32 eax, ebx, edx, max_leaf = __get_cpuid_max(0, NULL);
+	if (max_leaf < 1) return caps;
+	__cpuid(1, eax, ebx, ecx1, edx);
+	if (max_leaf >= 7) {
+		__cpuid_count(7, 0, eax, ebx7, ecx7, edx);
+	}
+#endif
+	/*AES-NI, SSE2 is always there with AES-NI*/
+	if (ecx1 & (1<<25)) caps |= AESNI_CAP_AES;
+
+	/*VAES needs AVX2 and the OS saving the YMM registers (OSXSAVE and XCR0 bits 1 and 2)*/
+	if ((caps & AESNI_CAP_AES) && (ecx1 & (1<<27)) && (ebx7 & (1<<5)) && (ecx7 & (1<<9))) {
+		u32 xcr0;
+#if defined(_MSC_VER)
+		xcr0 = (u32) _xgetbv(0);
+#else
+		u32 xcr0_hi;
+		__asm__ __volatile__ ("xgetbv" : "=a"(xcr0), "=d"(xcr0_hi) : "c"(0));
+#endif
+		if ((xcr0 & 6) == 6) caps |= AESNI_CAP_VAES;
+	}
+	return caps;
+}
+
+Bool gf_crypt_aesni_supported()
+{
+	if (!aesni_caps) aesni_caps = aesni_get_caps();
+	return (aesni_caps & AESNI_CAP_AES) ? GF_TRUE : GF_FALSE;
+}
+
+/*counter blocks are 128 bits big endian integers, kept as two 64 bits halves*/
+static void aesni_ctr_load(const u8 *iv, u64 *hi, u64 *lo)
+{
+	u32 i;
+	*hi = *lo = 0;
+	for (i=0; i<8; i++) {
+		*hi = (*hi << 8) | iv[i];
+		*lo = (*lo << 8) | iv[8+i];
+	}
+}
+
+static void aesni_ctr_store(u8 *iv, u64 hi, u64 lo)
+{
+	s32 i;
+	for (i=7; i>=0; i--) {
+		iv[i] = (u8) (hi & 0xFF);
+		iv[8+i] = (u8) (lo & 0xFF);
+		hi >>= 8;
+		lo >>= 8;
+	}
+}
+
+#define AESNI_CTR_INC(_hi, _lo)	{ (_lo)++; if (!(_lo)) (_hi)++; }
+
+
+AESNI_TARGET
+static __m128i aesni_key_exp(__m128i key, __m128i keygened)
+{
+	keygened = _mm_shuffle_epi32(keygened, _MM_SHUFFLE(3,3,3,3));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	return _mm_xor_si128(key, keygened);
+}
+
+/*the round constant of aeskeygenassist must be an immediate*/
+#define AESNI_KEY_EXP(_k, _rcon)	aesni_key_exp(_k, _mm_aeskeygenassist_si128(_k, _rcon))
+
+AESNI_TARGET
+static void aesni_set_key(AESNI_ctx *ctx, const u8 *key)
+{
+	u32 i;
+	__m128i k[11];
+	k[0] = _mm_loadu_si128((const __m128i *) key);
+	k[1] = AESNI_KEY_EXP(k[0], 0x01);
+	k[2] = AESNI_KEY_EXP(k[1], 0x02);
+	k[3] = AESNI_KEY_EXP(k[2], 0x04);
+	k[4] = AESNI_KEY_EXP(k[3], 0x08);
+	k[5] = AESNI_KEY_EXP(k[4], 0x10);
+	k[6] = AESNI_KEY_EXP(k[5], 0x20);
+	k[7] = AESNI_KEY_EXP(k[6], 0x40);
+	k[8] = AESNI_KEY_EXP(k[7], 0x80);
+	k[9] = AESNI_KEY_EXP(k[8], 0x1B);
+	k[10] = AESNI_KEY_EXP(k[9], 0x36);
+
+	for (i=0; i<11; i++) {
+		_mm_storeu_si128((__m128i *) (ctx->enc_keys + i*AESNI_BLOCK), k[i]);
+	}
+	/*decryption keys in reverse order, with InvMixColumns applied to the inner ones*/
+	_mm_storeu_si128((__m128i *) ctx->dec_keys, k[10]);
+	for (i=1; i<10; i++) {
+		_mm_storeu_si128((__m128i *) (ctx->dec_keys + i*AESNI_BLOCK), _mm_aesimc_si128(k[10-i]));
+	}
+	_mm_storeu_si128((__m128i *) (ctx->dec_keys + 10*AESNI_BLOCK), k[0]);
+}
+
+AESNI_TARGET
+static void aesni_load_keys(const u8 *src, __m128i *k)
+{
+	u32 i;
+	for (i=0; i<11; i++) k[i] = _mm_loadu_si128((const __m128i *) (src + i*AESNI_BLOCK));
+}
+
+AESNI_TARGET
+static __m128i aesni_encrypt_block(__m128i b, const __m128i *k)
+{
+	u32 r;
+	b = _mm_xor_si128(b, k[0]);
+	for (r=1; r<10; r++) b = _mm_aesenc_si128(b, k[r]);
+	return _mm_aesenclast_si128(b, k[10]);
+}
+
+AESNI_TARGET
+static __m128i aesni_ctr_block(u64 hi, u64 lo)
+{
+	return _mm_set_epi64x((s64) AESNI_BSWAP64(lo), (s64) AESNI_BSWAP64(hi));
+}
+
+/*xors nb_blocks blocks of keystream from counter hi/lo to buf, and returns the number of blocks processed (multiple of AESNI_LANES)*/
+AESNI_TARGET
+static u32 aesni_ctr_blocks(AESNI_ctx *ctx, u8 *buf, u32 nb_blocks, u64 *hi, u64 *lo)
+{
+	u32 i, r, done = 0;
+	__m128i k[11], b[AESNI_LANES];
+	aesni_load_keys(ctx->enc_keys, k);
+
+	while (nb_blocks - done >= AESNI_LANES) {
+		for (i=0; i<AESNI_LANES; i++) {
+			b[i] = _mm_xor_si128(aesni_ctr_block(*hi, *lo), k[0]);
+			AESNI_CTR_INC(*hi, *lo);
+		}
+		for (r=1; r<10; r++) {
+			for (i=0; i<AESNI_LANES; i++) b[i] = _mm_aesenc_si128(b[i], k[r]);
+		}
+		for (i=0; i<AESNI_LANES; i++) {
+			__m128i *p = (__m128i *) (buf + i*AESNI_BLOCK);
+			b[i] = _mm_aesenclast_si128(b[i], k[10]);
+			_mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), b[i]));
+		}
+		buf += AESNI_LANES*AESNI_BLOCK;
+		done += AESNI_LANES;
+	}
+	return done;
+}
+
+#ifdef GPAC_HAS_VAES
+VAES_TARGET
+static __m256i vaes_ctr_blocks2(u64 hi, u64 lo)
+{
+	u64 hi2 = hi, lo2 = lo;
+	AESNI_CTR_INC(hi2, lo2);
+	return _mm256_set_epi64x((s64) AESNI_BSWAP64(lo2), (s64) AESNI_BSWAP64(hi2), (s64) AESNI_BSWAP64(lo), (s64) AESNI_BSWAP64(hi));
+}
+
+/*same as aesni_ctr_blocks, two blocks per register*/
+VAES_TARGET
+static u32 vaes_ctr_blocks(AESNI_ctx *ctx, u8 *buf, u32 nb_blocks, u64 *hi, u64 *lo)
+{
+	u32 i, r, done = 0;
+	__m256i k[11], b[AESNI_LANES/2];
+	for (i=0; i<11; i++) {
+		k[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) (ctx->enc_keys + i*AESNI_BLOCK)));
+	}
+
+	while (nb_blocks - done >= AESNI_LANES) {
+		for (i=0; i<AESNI_LANES/2; i++) {
+			b[i] = _mm256_xor_si256(vaes_ctr_blocks2(*hi, *lo), k[0]);
+			AESNI_CTR_INC(*hi, *lo);
+			AESNI_CTR_INC(*hi, *lo);
+		}
+		for (r=1; r<10; r++) {
+			for (i=0; i<AESNI_LANES/2; i++) b[i] = _mm256_aesenc_epi128(b[i], k[r]);
+		}
+		for (i=0; i<AESNI_LANES/2; i++) {
+			__m256i *p = (__m256i *) (buf + 2*i*AESNI_BLOCK);
+			b[i] = _mm256_aesenclast_epi128(b[i], k[10]);
+			_mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), b[i]));
+		}
+		buf += AESNI_LANES*AESNI_BLOCK;
+		done += AESNI_LANES;
+	}
+	return done;
+}
+#endif
+
+AESNI_TARGET
+static void aesni_ctr_crypt(AESNI_ctx *ctx, u8 *buf, u32 len)
+{
+	u64 hi, lo;
+	u32 nb_blocks, done;
+	__m128i k[11], ks;
+
+	/*end of the current keystream block*/
+	while (ctx->counter_pos && len) {
+		*buf ^= ctx->keystream[ctx->counter_pos];
+		buf++;
+		len--;
+		ctx->counter_pos = (ctx->counter_pos + 1) % AESNI_BLOCK;
+	}
+	if (!len) return;
+
+	aesni_ctr_load(ctx->iv, &hi, &lo);
+	nb_blocks = len / AESNI_BLOCK;
+#ifdef GPAC_HAS_VAES
+	if (ctx->use_vaes)
+		done = vaes_ctr_blocks(ctx, buf, nb_blocks, &hi, &lo);
+	else
+#endif
+		done = aesni_ctr_blocks(ctx, buf, nb_blocks, &hi, &lo);
+	buf += done*AESNI_BLOCK;
+	len -= done*AESNI_BLOCK;
+
+	aesni_load_keys(ctx->enc_keys, k);
+	while (len >= AESNI_BLOCK) {
+		ks = aesni_encrypt_block(aesni_ctr_block(hi, lo), k);
+		AESNI_CTR_INC(hi, lo);
+		_mm_storeu_si128((__m128i *) buf, _mm_xor_si128(_mm_loadu_si128((const __m128i *) buf), ks));
+		buf += AESNI_BLOCK;
+		len -= AESNI_BLOCK;
+	}
+	/*last partial block, the rest of the keystream is kept for the next call*/
+	if (len) {
+		u32 i;
+		ks = aesni_encrypt_block(aesni_ctr_block(hi, lo), k);
+		AESNI_CTR_INC(hi, lo);
+		_mm_storeu_si128((__m128i *) ctx->keystream, ks);
+		for (i=0; i<len; i++) buf[i] ^= ctx->keystream[i];
+		ctx->counter_pos = len;
+	}
+	aesni_ctr_store(ctx->iv, hi, lo);
+}
+
+/*recomputes the keystream of the block preceding the current counter, used when restoring a CTR state in the middle of a block*/
+AESNI_TARGET
+static void aesni_ctr_restore_keystream(AESNI_ctx *ctx)
+{
+	u64 hi, lo;
+	__m128i k[11];
+	aesni_ctr_load(ctx->iv, &hi, &lo);
+	if (!lo) hi--;
+	lo--;
+	aesni_load_keys(ctx->enc_keys, k);
+	_mm_storeu_si128((__m128i *) ctx->keystream, aesni_encrypt_block(aesni_ctr_block(hi, lo), k));
+}
+
+/*only full blocks are processed, trailing bytes are left untouched*/
+AESNI_TARGET
+static void aesni_cbc_encrypt(AESNI_ctx *ctx, u8 *buf, u32 len)
+{
+	__m128i k[11], prev;
+	aesni_load_keys(ctx->enc_keys, k);
+	prev = _mm_loadu_si128((const __m128i *) ctx->iv);
+	while (len >= AESNI_BLOCK) {
+		prev = aesni_encrypt_block(_mm_xor_si128(_mm_loadu_si128((const __m128i *) buf), prev), k);
+		_mm_storeu_si128((__m128i *) buf, prev);
+		buf += AESNI_BLOCK;
+		len -= AESNI_BLOCK;
+	}
+	_mm_storeu_si128((__m128i *) ctx->iv, prev);
+}
+
+AESNI_TARGET
+static void aesni_cbc_decrypt(AESNI_ctx *ctx, u8 *buf, u32 len)
+{
+	u32 i, r;
+	__m128i k[11], prev, c[AESNI_LANES], b[AESNI_LANES];
+	aesni_load_keys(ctx->dec_keys, k);
+	prev = _mm_loadu_si128((const __m128i *) ctx->iv);
+
+	while (len >= AESNI_LANES*AESNI_BLOCK) {
+		for (i=0; i<AESNI_LANES; i++) {
+			c[i] = _mm_loadu_si128((const __m128i *) (buf + i*AESNI_BLOCK));
+			b[i] = _mm_xor_si128(c[i], k[0]);
+		}
+		for (r=1; r<10; r++) {
+			for (i=0; i<AESNI_LANES; i++) b[i] = _mm_aesdec_si128(b[i], k[r]);
+		}
+		for (i=0; i<AESNI_LANES; i++) {
+			b[i] = _mm_aesdeclast_si128(b[i], k[10]);
+			_mm_storeu_si128((__m128i *) (buf + i*AESNI_BLOCK), _mm_xor_si128(b[i], i ? c[i-1] : prev));
+		}
+		prev = c[AESNI_LANES-1];
+		buf += AESNI_LANES*AESNI_BLOCK;
+		len -= AESNI_LANES*AESNI_BLOCK;
+	}
+	while (len >= AESNI_BLOCK) {
+		__m128i cur = _mm_loadu_si128((const __m128i *) buf);
+		__m128i d = _mm_xor_si128(cur, k[0]);
+		for (r=1; r<10; r++) d = _mm_aesdec_si128(d, k[r]);
+		d = _mm_aesdeclast_si128(d, k[10]);
+		_mm_storeu_si128((__m128i *) buf, _mm_xor_si128(d, prev));
+		prev = cur;
+		buf += AESNI_BLOCK;
+		len -= AESNI_BLOCK;
+	}
+	_mm_storeu_si128((__m128i *) ctx->iv, prev);
+}
+
+/*CBC encryption of up to AESNI_LANES independent ranges at once, a new range taking the lane of a finished one*/
+AESNI_TARGET
+static void aesni_cbc_encrypt_ranges(AESNI_ctx *ctx, GF_CryptRange *ranges, u32 nb_ranges)
+{
+	u32 i, r, nb_lanes = 0, next = 0;
+	u8 *data[AESNI_LANES];
+	u32 nb_blocks[AESNI_LANES];
+	__m128i k[11], b[AESNI_LANES];
+	aesni_load_keys(ctx->enc_keys, k);
+
+	while (1) {
+		/*fill free lanes*/
+		while ((nb_lanes < AESNI_LANES) && (next < nb_ranges)) {
+			GF_CryptRange *range = &ranges[next];
+			next++;
+			if (range->size < AESNI_BLOCK) continue;
+			data[nb_lanes] = range->data;
+			nb_blocks[nb_lanes] = range->size / AESNI_BLOCK;
+			b[nb_lanes] = _mm_loadu_si128((const __m128i *) range->IV);
+			nb_lanes++;
+		}
+		if (!nb_lanes) break;
+
+		for (i=0; i<nb_lanes; i++) {
+			b[i] = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128((const __m128i *) data[i]), b[i]), k[0]);
+		}
+		for (r=1; r<10; r++) {
+			for (i=0; i<nb_lanes; i++) b[i] = _mm_aesenc_si128(b[i], k[r]);
+		}
+		for (i=0; i<nb_lanes; i++) {
+			b[i] = _mm_aesenclast_si128(b[i], k[10]);
+			_mm_storeu_si128((__m128i *) data[i], b[i]);
+			data[i] += AESNI_BLOCK;
+			nb_blocks[i]--;
+		}
+		/*remove finished lanes*/
+		for (i=0; i<nb_lanes; ) {
+			if (nb_blocks[i]) {
+				i++;
+				continue;
+			}
+			nb_lanes--;
+			data[i] = data[nb_lanes];
+			nb_blocks[i] = nb_blocks[nb_lanes];
+			b[i] = b[nb_lanes];
+		}
+	}
+}
+
+
+static void gf_set_key_aesni(GF_Crypt* td, void *key)
+{
+	AESNI_ctx *ctx = (AESNI_ctx *)td->context;
+	aesni_set_key(ctx, (const u8 *) key);
+}
+
+static GF_Err gf_crypt_init_aesni(GF_Crypt* td, void *key, const void *iv)
+{
+	AESNI_ctx *ctx;
+	GF_SAFEALLOC(ctx, AESNI_ctx);
+	if (!ctx) return GF_OUT_OF_MEM;
+	td->context = ctx;
+	ctx->use_vaes = (aesni_caps & AESNI_CAP_VAES) ? GF_TRUE : GF_FALSE;
+
+	if (iv) memcpy(ctx->iv, iv, AESNI_BLOCK);
+	return GF_OK;
+}
+
+static void gf_crypt_deinit_aesni(GF_Crypt* td)
+{
+}
+
+static GF_Err gf_crypt_set_IV_aesni_cbc(GF_Crypt* td, const u8 *iv, u32 iv_size)
+{
+	AESNI_ctx *ctx = (AESNI_ctx *)td->context;
+	if (iv_size>AESNI_BLOCK) return GF_BAD_PARAM;
+	memcpy(ctx->iv, iv, iv_size);
+	return GF_OK;
+}
+
+static GF_Err gf_crypt_get_IV_aesni_cbc(GF_Crypt* td, u8 *iv, u32 *iv_size)
+{
+	AESNI_ctx *ctx = (AESNI_ctx *)td->context;
+	*iv_size = AESNI_BLOCK;
+	memcpy(iv, ctx->iv, AESNI_BLOCK);
+	return GF_OK;
+}
+
+static GF_Err gf_crypt_encrypt_aesni_cbc(GF_Crypt* td, u8 *plaintext, u32 len)
+{
+	aesni_cbc_encrypt((AESNI_ctx *)td->context, plaintext, len);
+	return GF_OK;
+}
+
+static GF_Err gf_crypt_decrypt_aesni_cbc(GF_Crypt* td, u8 *ciphertext, u32 len)
+{
+	aesni_cbc_decrypt((AESNI_ctx *)td->context, ciphertext, len);
+	return GF_OK;
+}
+
+static GF_Err gf_crypt_ranges_aesni_cbc(GF_Crypt* td, GF_CryptRange *ranges, u32 nb_ranges, Bool encrypt)
+{
+	u32 i;
+	AESNI_ctx *ctx = (AESNI_ctx *)td->context;
+	if (encrypt) {
+		aesni_cbc_encrypt_ranges(ctx, ranges, nb_ranges);
+		return GF_OK;
+	}
+	/*decryption of a single range is already parallel*/
+	for (i=0; i<nb_ranges; i++) {
+		AESNI_ctx range_ctx = *ctx;
+		memcpy(range_ctx.iv, ranges[i].IV, AESNI_BLOCK);
+		aesni_cbc_decrypt(&range_ctx, ranges[i].data, ranges[i].size);
+	}
+	return GF_OK;
+}
+
+/*the state of CTR mode is the number of keystream bytes used in the current block followed by the next counter block*/
+static GF_Err gf_crypt_set_IV_aesni_ctr(GF_Crypt* td, const u8 *iv, u32 iv_size)
+{
+	AESNI_ctx *ctx = (AESNI_ctx *)td->context;
+	if (iv_size>AESNI_BLOCK) {
+		if (iv[0] >= AESNI_BLOCK) return GF_BAD_PARAM;
+		memcpy(ctx->iv, iv+1, AESNI_BLOCK);
+		ctx->counter_pos = iv[0];
+		if (ctx->counter_pos) aesni_ctr_restore_keystream(ctx);
+	} else {
+		memcpy(ctx->iv, iv, iv_size);
+		ctx->counter_pos = 0;
+	}
+	return GF_OK;
+}
+
+static GF_Err gf_crypt_get_IV_aesni_ctr(GF_Crypt* td, u8 *iv, u32 *iv_size)
+{
+	AESNI_ctx *ctx = (AESNI_ctx *)td->context;
+	*iv_size = AESNI_BLOCK + 1;
+	iv[0] = ctx->counter_pos;
+	memcpy(iv+1, ctx->iv, AESNI_BLOCK);
+	return GF_OK;
+}
+
+static GF_Err gf_crypt_crypt_aesni_ctr(GF_Crypt* td, u8 *buffer, u32 len)
+{
+	aesni_ctr_crypt((AESNI_ctx *)td->context, buffer, len);
+	return GF_OK;
+}
+
+static GF_Err gf_crypt_ranges_aesni_ctr(GF_Crypt* td, GF_CryptRange *ranges, u32 nb_ranges, Bool encrypt)
+{
+	u32 i;
+	AESNI_ctx *ctx = (AESNI_ctx *)td->context;
+	for (i=0; i<nb_ranges; i++) {
+		AESNI_ctx range_ctx = *ctx;
+		memcpy(range_ctx.iv, ranges[i].IV, AESNI_BLOCK);
+		range_ctx.counter_pos = 0;
+		aesni_ctr_crypt(&range_ctx, ranges[i].data, ranges[i].size);
+	}
+	return GF_OK;
+}
+
+GF_Err gf_crypt_open_open_aesni(GF_Crypt* td, GF_CRYPTO_MODE mode)
+{
+	if (!gf_crypt_aesni_supported()) return GF_NOT_SUPPORTED;
+
+	td->mode = mode;
+	td->_init_crypt = gf_crypt_init_aesni;
+	td->_deinit_crypt = gf_crypt_deinit_aesni;
+	td->_set_key = gf_set_key_aesni;
+	switch (td->mode) {
+	case GF_CBC:
+		td->_crypt = gf_crypt_encrypt_aesni_cbc;
+		td->_decrypt = gf_crypt_decrypt_aesni_cbc;
+		td->_crypt_ranges = gf_crypt_ranges_aesni_cbc;
+		td->_get_state = gf_crypt_get_IV_aesni_cbc;
+		td->_set_state = gf_crypt_set_IV_aesni_cbc;
+		break;
+	case GF_CTR:
+		td->_crypt = gf_crypt_crypt_aesni_ctr;
+		td->_decrypt = gf_crypt_crypt_aesni_ctr;
+		td->_crypt_ranges = gf_crypt_ranges_aesni_ctr;
+		td->_get_state = gf_crypt_get_IV_aesni_ctr;
+		td->_set_state = gf_crypt_set_IV_aesni_ctr;
+		break;
+	default:
+		return GF_BAD_PARAM;
+	}
+	td->algo = GF_AES_128;
+	return GF_OK;
+}
+
+#endif /*GPAC_HAS_AESNI*/
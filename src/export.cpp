@@ -224,6 +224,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_set_output_buffering) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_transfer) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_flush) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_bs_write_file_range) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_bits_available) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_get_bit_offset) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_bs_get_bit_position) )
@@ -285,6 +286,14 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_send_wait) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_receive_wait) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_sk_receive_no_select) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_receive_batch) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_send_batch) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_register) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_unregister) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_select) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_sk_group_sock_is_set) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_url_is_local) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_url_get_absolute_path) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_url_concatenate) )
@@ -330,10 +339,12 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_key) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_sub_key) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_set_key) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_cfg_set_keys) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_section_count) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_section_name) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_key_count) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_key_name) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_key_value) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_insert_key) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_del_section) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_cfg_get_filename) )
@@ -348,6 +359,9 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_modules_get_count) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_modules_get_module_directories) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_modules_get_file_name) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_modules_get_capabilities) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_modules_set_capabilities) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_modules_manifest_changed) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_module_get_file_name) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_module_load_static) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_modules_load_interface) )
@@ -574,6 +588,9 @@
 
 /*color.h exports*/
 #pragma comment (linker, EXPORT_SYMBOL(gf_stretch_bits) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_stretch_bits_ex) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_stretch_pool_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_stretch_pool_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_color_write_yv12_10_to_yuv) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_color_write_yuv422_10_to_yuv422) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_color_write_yuv444_10_to_yuv444) )
@@ -776,7 +793,9 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_sample_count) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_sample_padding) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_sample) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_sample_ex) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_sample_info) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_sample_ref) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_sample_flags) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_sample_for_media_time) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_sample_for_movie_time) )
@@ -807,6 +826,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_brand_info) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_alternate_brand) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_has_padding_bits) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_sample_padding_bits) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_visual_info) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_visual_info) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_visual_bit_depth) )
@@ -878,6 +898,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_next_alternate_group_id) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_meta_primary_item_id) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_is_JPEG2000) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_sample_has_subsamples) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_sample_get_subsample) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_rvc_config) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_sample_rap_roll_info) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_reset_fragment_info) )
@@ -948,6 +970,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_append_sample_data) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_refresh_size_info) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_add_sample_reference) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_add_sample_data_from_file) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_add_sample_at_offset) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_last_sample_duration) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_track_reference) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_remove_track_reference) )
@@ -957,6 +981,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_remove_sample) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_final_name) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_storage_mode) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_reserve_moov_space) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_force_64bit_chunk_offset) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_storage_mode) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_interleave_time) )
@@ -1027,6 +1052,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_track_interleaving_group) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_track_priority_in_group) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_hint_max_chunk_size) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_hint_max_chunk_duration) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_compact_sample_tables) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_extraction_slc) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_extraction_slc) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_track_group) )
@@ -1135,7 +1162,9 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_traf_mss_timeext) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_fragment_option) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_single_moof_mode) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_lazy_fragment_window) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_fragment_add_sample) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_fragment_add_sample_ref) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_fragment_append_data) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_fragment_add_sai) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_clone_pssh) )
@@ -1156,6 +1185,11 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_streamer_new) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_streamer_new_extended) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_streamer_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_rtp_streamer_engine_new) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_rtp_streamer_engine_del) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_rtp_streamer_engine_add) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_rtp_streamer_engine_remove) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_rtp_streamer_engine_get_session_count) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_streamer_append_sdp) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_streamer_append_sdp_extended) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_streamer_append_sdp_decoding_dependency) )
@@ -1335,6 +1369,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_send_rtcp_report) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_send_bye) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_send_packet) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_rtp_set_send_batch) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_rtp_flush_packets) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_set_info_rtcp) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_is_unicast) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_is_interleaved) )
@@ -1374,7 +1410,9 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_reorderer_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_reorderer_reset) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_reorderer_add) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_rtp_reorderer_add_packet) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_rtp_reorderer_get) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_rtp_reorderer_get_packet) )
 
 #endif /*GPAC_DISABLE_STREAMING*/
 
@@ -1470,12 +1508,16 @@
 /*crypto exports*/
 #ifndef GPAC_DISABLE_CRYPTO
 #pragma comment (linker, EXPORT_SYMBOL(gf_crypt_open) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_crypt_open_ex) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_crypt_close) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_crypt_init) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_crypt_decrypt) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_crypt_encrypt) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_crypt_set_key) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_crypt_set_IV) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_crypt_get_IV) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_crypt_encrypt_ranges) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_crypt_decrypt_ranges) )
 #endif GPAC_DISABLE_CRYPTO
 
 #pragma comment (linker, EXPORT_SYMBOL(gf_sha1_csum) )
@@ -1902,6 +1944,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_find_service) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_toggle_addons) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_get_object_info) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_term_get_decoder_pool_info) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_get_download_info) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_get_channel_net_info) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_term_get_world_info) )
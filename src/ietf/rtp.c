@@ -46,13 +46,20 @@ GF_EXPORT
 void gf_rtp_del(GF_RTPChannel *ch)
 {
 	if (!ch) return;
-	if (ch->rtp) gf_sk_del(ch->rtp);
+	if (ch->rtp) {
+		gf_rtp_flush_packets(ch);
+		gf_sk_del(ch->rtp);
+	}
 	if (ch->rtcp) gf_sk_del(ch->rtcp);
 	if (ch->net_info.source) gf_free(ch->net_info.source);
 	if (ch->net_info.destination) gf_free(ch->net_info.destination);
 	if (ch->net_info.Profile) gf_free(ch->net_info.Profile);
 	if (ch->po) gf_rtp_reorderer_del(ch->po);
+	if (ch->rcv_buffers[0]) gf_free(ch->rcv_buffers[0]);
 	if (ch->send_buffer) gf_free(ch->send_buffer);
+	if (ch->snd_batch) gf_free(ch->snd_batch);
+	if (ch->snd_batch_bufs) gf_free((void *) ch->snd_batch_bufs);
+	if (ch->snd_batch_sizes) gf_free(ch->snd_batch_sizes);
 
 	if (ch->CName) gf_free(ch->CName);
 	if (ch->s_name) gf_free(ch->s_name);
@@ -114,6 +121,7 @@ void gf_rtp_reset_buffers(GF_RTPChannel *ch)
 	if (ch->rtp) gf_sk_reset(ch->rtp);
 	if (ch->rtcp) gf_sk_reset(ch->rtcp);
 	if (ch->po) gf_rtp_reorderer_reset(ch->po);
+	ch->rcv_count = ch->rcv_pos = 0;
 	/*also reset ssrc*/
 	//ch->SenderSSRC = 0;
 	ch->first_SR = 1;
@@ -235,6 +243,12 @@ GF_Err gf_rtp_initialize(GF_RTPChannel *ch, u32 UDPBufferSize, Bool IsSource, u3
 			if (ch->send_buffer) gf_free(ch->send_buffer);
 			ch->send_buffer = (char *) gf_malloc(sizeof(char) * PathMTU);
 			ch->send_buffer_size = PathMTU;
+			//reallocate the send queue for the new MTU
+			if (ch->snd_batch_max) {
+				ch->snd_batch_count = 0;
+				e = gf_rtp_set_send_batch(ch, ch->snd_batch_max);
+				if (e) return e;
+			}
 		}
 
 
@@ -243,6 +257,14 @@ GF_Err gf_rtp_initialize(GF_RTPChannel *ch, u32 UDPBufferSize, Bool IsSource, u3
 			if (!MaxReorderDelay) MaxReorderDelay = 200;
 			ch->po = gf_rtp_reorderer_new(ReorederingSize, MaxReorderDelay);
 		}
+		//packets are fetched by batches on receivers
+		if (!IsSource && !ch->rcv_buffers[0]) {
+			u32 i;
+			ch->rcv_buffers[0] = (char *) gf_malloc(sizeof(char) * GF_RTP_RECV_BATCH * GF_RTP_RECV_MAX_SIZE);
+			if (!ch->rcv_buffers[0]) return GF_OUT_OF_MEM;
+			for (i=1; i<GF_RTP_RECV_BATCH; i++) ch->rcv_buffers[i] = ch->rcv_buffers[0] + i*GF_RTP_RECV_MAX_SIZE;
+		}
+		ch->rcv_count = ch->rcv_pos = 0;
 
 		//
 		//	RTCP
@@ -298,16 +320,23 @@ GF_Err gf_rtp_initialize(GF_RTPChannel *ch, u32 UDPBufferSize, Bool IsSource, u3
 	return GF_OK;
 }
 
-/*get the UTC time expressed in RTP timescale*/
-u32 gf_rtp_channel_time(GF_RTPChannel *ch)
+/*get an NTP time expressed in RTP timescale*/
+static u32 gf_rtp_channel_time_from_ntp(GF_RTPChannel *ch, u32 sec, u32 frac)
 {
-	u32 sec, frac, res;
-	gf_net_get_ntp(&sec, &frac);
+	u32 res;
 	res = ( (u32) ( (frac>>26)*ch->TimeScale) ) >> 6;
 	res += ch->TimeScale*(sec - ch->ntp_init);
 	return (u32) res;
 }
 
+/*get the UTC time expressed in RTP timescale*/
+u32 gf_rtp_channel_time(GF_RTPChannel *ch)
+{
+	u32 sec, frac;
+	gf_net_get_ntp(&sec, &frac);
+	return gf_rtp_channel_time_from_ntp(ch, sec, frac);
+}
+
 u32 gf_rtp_get_report_time()
 {
 	u32 sec, frac;
@@ -335,18 +364,51 @@ u32 gf_rtp_read_rtp(GF_RTPChannel *ch, char *buffer, u32 buffer_size)
 {
 	GF_Err e;
 	u32 seq_num, res;
-	char *pck;
+	const char *pck;
 
 	//only if the socket exist (otherwise RTSP interleaved channel)
 	if (!ch || !ch->rtp) return 0;
 
-	e = gf_sk_receive(ch->rtp, buffer, buffer_size, 0, &res);
-	if (!res || e || (res < 12)) res = 0;
-	if (res) {
-		ch->total_bytes+=res;
-		ch->total_pck++;
+	res = 0;
+	ch->last_pck_arrival = 0;
+	if (!ch->rcv_buffers[0]) {
+		e = gf_sk_receive(ch->rtp, buffer, buffer_size, 0, &res);
+		if (!res || e || (res < 12)) res = 0;
+		if (res) {
+			ch->total_bytes+=res;
+			ch->total_pck++;
+		}
+	} else {
+		//fetch a new batch of packets once the previous one is consumed
+		if (ch->rcv_pos == ch->rcv_count) {
+			ch->rcv_pos = ch->rcv_count = 0;
+			e = gf_sk_receive_batch(ch->rtp, ch->rcv_buffers, GF_RTP_RECV_MAX_SIZE, ch->rcv_sizes, ch->rcv_ntp, GF_RTP_RECV_BATCH, &ch->rcv_count);
+			if (e) ch->rcv_count = 0;
+		}
+		while (ch->rcv_pos < ch->rcv_count) {
+			u32 idx = ch->rcv_pos++;
+			u32 size = ch->rcv_sizes[idx];
+			char *data = ch->rcv_buffers[idx];
+			if (size < 12) continue;
+			ch->total_bytes += size;
+			ch->total_pck++;
+			//with a reordering queue, push all received packets to it
+			if (ch->po) {
+				seq_num = ((data[2] << 8) & 0xFF00) | (data[3] & 0xFF);
+				gf_rtp_reorderer_add_packet(ch->po, data, size, seq_num, ch->rcv_ntp[idx]);
+				continue;
+			}
+			if (size > buffer_size) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_RTP, ("[RTP] Packet size %d larger than read buffer (%d bytes), dropping\n", size, buffer_size));
+				continue;
+			}
+			memcpy(buffer, data, size);
+			ch->last_pck_arrival = ch->rcv_ntp[idx];
+			res = size;
+			break;
+		}
 	}
-	//add the packet to our Queue if any
+	//get the next packet out of our Queue if any
 	if (ch->po) {
 		if (res) {
 			seq_num = ((buffer[2] << 8) & 0xFF00) | (buffer[3] & 0xFF);
@@ -354,11 +416,13 @@ u32 gf_rtp_read_rtp(GF_RTPChannel *ch, char *buffer, u32 buffer_size)
 		}
 
 		//pck queue may need to be flushed
-		pck = (char *) gf_rtp_reorderer_get(ch->po, &res);
-		if (pck) {
-			memcpy(buffer, pck, res);
-			gf_free(pck);
+		pck = gf_rtp_reorderer_get_packet(ch->po, &res, &ch->last_pck_arrival);
+		if (pck && (res > buffer_size)) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_RTP, ("[RTP] Packet size %d larger than read buffer (%d bytes), dropping\n", res, buffer_size));
+			pck = NULL;
 		}
+		if (pck) memcpy(buffer, pck, res);
+		else res = 0;
 	}
 	/*monitor keep-alive period*/
 	if (ch->nat_keepalive_time_period) {
@@ -477,7 +541,13 @@ GF_Err gf_rtp_decode_rtp(GF_RTPChannel *ch, char *pck, u32 pck_size, GF_RTPHeade
 		rtp_hdr->recomputed_ntp_ts |= frac;
 	}
 
-	ntp = gf_rtp_channel_time(ch);
+	/*use the arrival time of the packet rather than the processing time, packets being fetched by batches*/
+	if (ch->last_pck_arrival) {
+		ntp = gf_rtp_channel_time_from_ntp(ch, (u32) (ch->last_pck_arrival>>32), (u32) (ch->last_pck_arrival & 0xFFFFFFFF));
+		ch->last_pck_arrival = 0;
+	} else {
+		ntp = gf_rtp_channel_time(ch);
+	}
 	deviance = ntp - rtp_hdr->TimeStamp;
 	delta = deviance - ch->last_deviance;
 	ch->last_deviance = deviance;
@@ -572,6 +642,7 @@ GF_Err gf_rtp_send_packet(GF_RTPChannel *ch, GF_RTPHeader *rtp_hdr, char *pck, u
 	GF_Err e;
 	u32 i, Start;
 	char *hdr = NULL;
+	char *dst;
 
 	GF_BitStream *bs;
 
@@ -584,11 +655,22 @@ GF_Err gf_rtp_send_packet(GF_RTPChannel *ch, GF_RTPHeader *rtp_hdr, char *pck, u
 
 	if (12 + pck_size + 4*rtp_hdr->CSRCCount > ch->send_buffer_size) return GF_IO_ERR;
 
+	dst = ch->send_buffer;
+	if (ch->snd_batch_max) {
+		if (ch->snd_batch_count == ch->snd_batch_max) {
+			e = gf_rtp_flush_packets(ch);
+			if (e) return e;
+		}
+		//the packet is copied in the queue, the caller buffer is reused as soon as we return
+		dst = ch->snd_batch + ch->snd_batch_count * ch->send_buffer_size;
+		fast_send = GF_FALSE;
+	}
+
 	if (fast_send) {
 		hdr = pck - 12;
 		bs = gf_bs_new(hdr, 12, GF_BITSTREAM_WRITE);
 	} else {
-		bs = gf_bs_new(ch->send_buffer, ch->send_buffer_size, GF_BITSTREAM_WRITE);
+		bs = gf_bs_new(dst, ch->send_buffer_size, GF_BITSTREAM_WRITE);
 	}
 	//write header
 	gf_bs_write_int(bs, rtp_hdr->Version, 2);
@@ -612,8 +694,14 @@ GF_Err gf_rtp_send_packet(GF_RTPChannel *ch, GF_RTPHeader *rtp_hdr, char *pck, u
 	if (fast_send) {
 		e = gf_sk_send(ch->rtp, hdr, pck_size+12);
 	} else {
-		memcpy(ch->send_buffer + Start, pck, pck_size);
-		e = gf_sk_send(ch->rtp, ch->send_buffer, Start + pck_size);
+		memcpy(dst + Start, pck, pck_size);
+		if (ch->snd_batch_max) {
+			ch->snd_batch_sizes[ch->snd_batch_count] = Start + pck_size;
+			ch->snd_batch_count++;
+			e = GF_OK;
+		} else {
+			e = gf_sk_send(ch->rtp, dst, Start + pck_size);
+		}
 	}
 	if (e) return e;
 
@@ -637,6 +725,44 @@ GF_Err gf_rtp_send_packet(GF_RTPChannel *ch, GF_RTPHeader *rtp_hdr, char *pck, u
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_rtp_set_send_batch(GF_RTPChannel *ch, u32 nb_packets)
+{
+	u32 i;
+	GF_Err e;
+	if (!ch || !ch->send_buffer) return GF_BAD_PARAM;
+
+	e = gf_rtp_flush_packets(ch);
+	if (e) return e;
+	if (ch->snd_batch) gf_free(ch->snd_batch);
+	if (ch->snd_batch_bufs) gf_free((void *) ch->snd_batch_bufs);
+	if (ch->snd_batch_sizes) gf_free(ch->snd_batch_sizes);
+	ch->snd_batch = NULL;
+	ch->snd_batch_bufs = NULL;
+	ch->snd_batch_sizes = NULL;
+	ch->snd_batch_max = 0;
+	if (nb_packets<2) return GF_OK;
+
+	ch->snd_batch = (char *) gf_malloc(sizeof(char) * nb_packets * ch->send_buffer_size);
+	ch->snd_batch_bufs = (const char **) gf_malloc(sizeof(char *) * nb_packets);
+	ch->snd_batch_sizes = (u32 *) gf_malloc(sizeof(u32) * nb_packets);
+	if (!ch->snd_batch || !ch->snd_batch_bufs || !ch->snd_batch_sizes) return GF_OUT_OF_MEM;
+	for (i=0; i<nb_packets; i++) ch->snd_batch_bufs[i] = ch->snd_batch + i*ch->send_buffer_size;
+	ch->snd_batch_max = nb_packets;
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_rtp_flush_packets(GF_RTPChannel *ch)
+{
+	GF_Err e;
+	if (!ch) return GF_BAD_PARAM;
+	if (!ch->snd_batch_count) return GF_OK;
+	e = gf_sk_send_batch(ch->rtp, ch->snd_batch_bufs, ch->snd_batch_sizes, ch->snd_batch_count);
+	ch->snd_batch_count = 0;
+	return e;
+}
+
 GF_EXPORT
 u32 gf_rtp_is_unicast(GF_RTPChannel *ch)
 {
@@ -783,8 +909,6 @@ void gf_rtp_get_ports(GF_RTPChannel *ch, u16 *rtp_port, u16 *rtcp_port)
 	RTP packet reorderer
 */
 
-#define SN_CHECK_OFFSET		0x0A
-
 GF_EXPORT
 GF_RTPReorder *gf_rtp_reorderer_new(u32 MaxCount, u32 MaxDelay)
 {
@@ -796,195 +920,206 @@ GF_RTPReorder *gf_rtp_reorderer_new(u32 MaxCount, u32 MaxDelay)
 	if (!tmp) return NULL;
 	tmp->MaxCount = MaxCount;
 	tmp->MaxDelay = MaxDelay;
-	return tmp;
-}
-
-static void DelItem(GF_POItem *it)
-{
-	if (it) {
-		if (it->next) DelItem(it->next);
-		gf_free(it->pck);
-		gf_free(it);
+	/*the ring covers twice the max queue size, packets further away trigger a resync*/
+	tmp->nb_slots = 32;
+	while ((tmp->nb_slots < 2*MaxCount) && (tmp->nb_slots < 0x8000)) tmp->nb_slots *= 2;
+	tmp->slots = (GF_POSlot *) gf_malloc(sizeof(GF_POSlot) * tmp->nb_slots);
+	if (!tmp->slots) {
+		gf_free(tmp);
+		return NULL;
 	}
+	memset(tmp->slots, 0, sizeof(GF_POSlot) * tmp->nb_slots);
+	return tmp;
 }
 
-
 GF_EXPORT
 void gf_rtp_reorderer_del(GF_RTPReorder *po)
 {
-	if (po->in) DelItem(po->in);
+	u32 i;
+	GF_LOG(GF_LOG_INFO, GF_LOG_RTP, ("[rtp] Packet Reorderer: %d packets received - %d lost %d late %d duplicated %d reordered\n", po->nb_received, po->nb_lost, po->nb_late, po->nb_duplicated, po->nb_reordered));
+	for (i=0; i<po->nb_slots; i++) {
+		if (po->slots[i].pck) gf_free(po->slots[i].pck);
+	}
+	gf_free(po->slots);
 	gf_free(po);
 }
 
 GF_EXPORT
 void gf_rtp_reorderer_reset(GF_RTPReorder *po)
 {
+	u32 i;
 	if (!po) return;
 
-	if (po->in) DelItem(po->in);
+	for (i=0; i<po->nb_slots; i++) po->slots[i].used = GF_FALSE;
 	po->head_seqnum = 0;
+	po->max_offset = 0;
 	po->Count = 0;
 	po->IsInit = 0;
-	po->in = NULL;
+	po->has_output = GF_FALSE;
+	po->LastTime = 0;
+}
+
+static void gf_rtp_reorderer_resync(GF_RTPReorder *po, u32 pck_seqnum)
+{
+	u32 i;
+	GF_LOG(GF_LOG_WARNING, GF_LOG_RTP, ("[rtp] Packet Reorderer: packet %d too far from expected %d - flushing %d packets\n", pck_seqnum, po->head_seqnum, po->Count));
+	for (i=0; i<po->nb_slots; i++) po->slots[i].used = GF_FALSE;
+	po->Count = 0;
+	po->max_offset = 0;
+	po->head_seqnum = pck_seqnum;
 }
 
 GF_EXPORT
-GF_Err gf_rtp_reorderer_add(GF_RTPReorder *po, const void * pck, u32 pck_size, u32 pck_seqnum)
+GF_Err gf_rtp_reorderer_add_packet(GF_RTPReorder *po, const void * pck, u32 pck_size, u32 pck_seqnum, u64 arrival_ntp)
 {
-	GF_POItem *it, *cur;
-	u32 bounds;
+	u32 offset;
+	GF_POSlot *slot;
 
-	if (!po) return GF_BAD_PARAM;
+	if (!po || !pck || !pck_size) return GF_BAD_PARAM;
 
-	it = (GF_POItem *) gf_malloc(sizeof(GF_POItem));
-	it->pck_seq_num = pck_seqnum;
-	it->next = NULL;
-	it->size = pck_size;
-	it->pck = gf_malloc(pck_size);
-	memcpy(it->pck, pck, pck_size);
+	//this is 16 bit seq num, as we work with RTP only for now
+	pck_seqnum &= 0xFFFF;
+	po->nb_received++;
 	/*reset timeout*/
 	po->LastTime = 0;
 
-	//no input, this packet will be the input
-	if (!po->in) {
-		//the seq num was not initialized
-		if (!po->head_seqnum) {
+	if (!po->IsInit) {
+		po->head_seqnum = pck_seqnum;
+		po->IsInit = 1;
+	}
+	offset = (u16) (pck_seqnum - po->head_seqnum);
+
+	//packet before the next one to output
+	if (offset >= 0x8000) {
+		u32 back = 0x10000 - offset;
+		//too far back to fit in the ring (sender restart), resync on this packet
+		if (back >= po->nb_slots) {
+			gf_rtp_reorderer_resync(po, pck_seqnum);
+		}
+		//too late, or too far back to fit in the ring with the queued packets
+		else if (po->has_output || (po->max_offset + back >= po->nb_slots)) {
+			po->nb_late++;
+			GF_LOG(GF_LOG_WARNING, GF_LOG_RTP, ("[rtp] Packet Reorderer: Dropping late packet %d (expecting %d)\n", pck_seqnum, po->head_seqnum));
+			return GF_OK;
+		} else {
+			//nothing output yet, move the start of the queue back
+			if (po->Count) po->max_offset += back;
 			po->head_seqnum = pck_seqnum;
-		} else if (!po->IsInit) {
-			//this is not in our current range for init
-			if (ABSDIFF(po->head_seqnum, pck_seqnum) > SN_CHECK_OFFSET) goto discard;
-			po->IsInit = 1;
 		}
-
-		po->in = it;
-		po->Count += 1;
-		return GF_OK;
+		offset = 0;
+	}
+	//too far ahead to fit in the ring (huge loss or sender restart), resync on this packet
+	else if (offset >= po->nb_slots) {
+		po->nb_lost += offset - po->Count;
+		gf_rtp_reorderer_resync(po, pck_seqnum);
+		offset = 0;
 	}
 
-	//this is 16 bitr seq num, as we work with RTP only for now
-	bounds = 0;
-	if ( (po->head_seqnum >= 0xf000 ) || (po->head_seqnum <= 0x1000) ) bounds = 0x2000;
-
-	//first check the head of the list
-	//same seq num, we drop
-	if (po->in->pck_seq_num == pck_seqnum) goto discard;
-
-	if ( ( (u16) (pck_seqnum + bounds) <= (u16) (po->in->pck_seq_num + bounds) ) ) {
-
-		it->next = po->in;
-		po->in = it;
-		po->Count += 1;
-
-		GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: inserting packet %d at head\n", pck_seqnum));
+	slot = &po->slots[pck_seqnum & (po->nb_slots-1)];
+	if (slot->used) {
+		po->nb_duplicated++;
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Dropping duplicated packet %d\n", pck_seqnum));
 		return GF_OK;
 	}
-
-	//no, insert at the right place
-	cur = po->in;
-
-	while (1) {
-		//same seq num, we drop
-		if (cur->pck_seq_num == pck_seqnum) goto discard;
-
-		//end of list
-		if (!cur->next) {
-			cur->next = it;
-			po->Count += 1;
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Appending packet %d (last %d)\n", pck_seqnum, cur->pck_seq_num));
-			return GF_OK;
+	if (slot->alloc_size < pck_size) {
+		slot->pck = (char *) gf_realloc(slot->pck, pck_size);
+		if (!slot->pck) {
+			slot->alloc_size = 0;
+			return GF_OUT_OF_MEM;
 		}
+		slot->alloc_size = pck_size;
+	}
+	memcpy(slot->pck, pck, pck_size);
+	slot->size = pck_size;
+	slot->ntp = arrival_ntp;
+	slot->pck_seq_num = pck_seqnum;
+	slot->used = GF_TRUE;
+
+	if (po->Count && (offset < po->max_offset)) {
+		po->nb_reordered++;
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Inserting packet %d\n", pck_seqnum));
+	}
+	if (offset > po->max_offset) po->max_offset = offset;
+	po->Count += 1;
+	return GF_OK;
+}
 
-		//are we in the bounds ??
-		if ( ( (u16) (cur->pck_seq_num + bounds) < (u16) (pck_seqnum + bounds) )
-		        && ( (u16) (pck_seqnum + bounds) < (u16) (cur->next->pck_seq_num + bounds)) ) {
+GF_EXPORT
+GF_Err gf_rtp_reorderer_add(GF_RTPReorder *po, const void * pck, u32 pck_size, u32 pck_seqnum)
+{
+	return gf_rtp_reorderer_add_packet(po, pck, pck_size, pck_seqnum, 0);
+}
 
-			//insert
-			it->next = cur->next;
-			cur->next = it;
-			po->Count += 1;
+//retrieve the first available packet slot, waiting for missing packets until the queue is full or the timeout expires
+static GF_POSlot *gf_rtp_reorderer_pop(GF_RTPReorder *po)
+{
+	GF_POSlot *slot;
 
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Inserting packet %d\n", pck_seqnum));
-			//done
-			return GF_OK;
+	//empty queue
+	if (!po->Count) return NULL;
+
+	slot = &po->slots[po->head_seqnum & (po->nb_slots-1)];
+	if (!slot->used) {
+		u32 nb_lost = 0;
+		if ((po->Count < po->MaxCount) && (po->max_offset < po->MaxCount)) {
+			if (!po->LastTime) {
+				po->LastTime = gf_sys_clock();
+				GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: starting timeout at %d\n", po->LastTime));
+				return NULL;
+			}
+			if (gf_sys_clock() - po->LastTime < po->MaxDelay) return NULL;
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Forcing output after %d ms wait (max allowed %d)\n", gf_sys_clock() - po->LastTime, po->MaxDelay));
 		}
-		cur = cur->next;
+		//skip missing packets
+		while (!slot->used) {
+			po->head_seqnum++;
+			po->max_offset--;
+			nb_lost++;
+			slot = &po->slots[po->head_seqnum & (po->nb_slots-1)];
+		}
+		po->nb_lost += nb_lost;
+		GF_LOG(GF_LOG_INFO, GF_LOG_RTP, ("[rtp] WARNING Packet Loss: %d packets missing before %d\n", nb_lost, slot->pck_seq_num));
 	}
 
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Fetching %d\n", slot->pck_seq_num));
+	slot->used = GF_FALSE;
+	po->head_seqnum++;
+	po->Count -= 1;
+	po->max_offset = po->Count ? po->max_offset-1 : 0;
+	po->has_output = GF_TRUE;
+	return slot;
+}
 
-discard:
-	gf_free(it->pck);
-	gf_free(it);
-	GF_LOG(GF_LOG_ERROR, GF_LOG_RTP, ("[rtp] Packet Reorderer: Dropping packet %d\n", pck_seqnum));
-	return GF_OK;
+GF_EXPORT
+const char *gf_rtp_reorderer_get_packet(GF_RTPReorder *po, u32 *pck_size, u64 *arrival_ntp)
+{
+	GF_POSlot *slot;
+	if (!po || !pck_size) return NULL;
+
+	*pck_size = 0;
+	slot = gf_rtp_reorderer_pop(po);
+	if (!slot) return NULL;
+	*pck_size = slot->size;
+	if (arrival_ntp) *arrival_ntp = slot->ntp;
+	return slot->pck;
 }
 
-//retrieve the first available packet. Note that the behavior will be undefined if the first
-//ever received packet if its SeqNum was unknown
 //the BUFFER is yours, you must delete it
 GF_EXPORT
 void *gf_rtp_reorderer_get(GF_RTPReorder *po, u32 *pck_size)
 {
-	GF_POItem *t;
-	u32 bounds;
+	GF_POSlot *slot;
 	void *ret;
-
 	if (!po || !pck_size) return NULL;
 
 	*pck_size = 0;
-
-	//empty queue
-	if (!po->in) return NULL;
-
-	//check we have received the first packet
-	if ( po->head_seqnum && po->MaxCount
-	        && (po->MaxCount > po->Count)
-	        && (po->in->pck_seq_num != po->head_seqnum))
-		return NULL;
-
-	//no entry
-	if (!po->in->next) goto check_timeout;
-
-	bounds = 0;
-	if ( (po->head_seqnum >= 0xf000 ) || (po->head_seqnum <= 0x1000) ) bounds = 0x2000;
-
-	//release the output if SN in order or maxCount reached
-	if (( (u16) (po->in->pck_seq_num + bounds + 1) == (u16) (po->in->next->pck_seq_num + bounds))
-	        || (po->MaxCount && (po->Count >= po->MaxCount)) ) {
-
-#ifndef GPAC_DISABLE_LOG
-		if (po->in->pck_seq_num + 1 != po->in->next->pck_seq_num)
-			GF_LOG(GF_LOG_INFO, GF_LOG_RTP, ("[rtp] WARNING Packet Loss: Sending %d out of the queue but next is %d\n", po->in->pck_seq_num, po->in->next->pck_seq_num ));
-#endif
-		goto send_it;
-	}
-	//update timing
-	else {
-check_timeout:
-		if (!po->LastTime) {
-			po->LastTime = gf_sys_clock();
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: starting timeout at %d\n", po->LastTime));
-			return NULL;
-		}
-		//if exceeding the delay send the head
-		if (gf_sys_clock() - po->LastTime >= po->MaxDelay) {
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Forcing output after %d ms wait (max allowed %d)\n", gf_sys_clock() - po->LastTime, po->MaxDelay));
-			goto send_it;
-		}
-	}
-	return NULL;
-
-
-send_it:
-	GF_LOG(GF_LOG_DEBUG, GF_LOG_RTP, ("[rtp] Packet Reorderer: Fetching %d\n", po->in->pck_seq_num));
-	*pck_size = po->in->size;
-	t = po->in;
-	po->in = po->in->next;
-	//no other output. reset the head seqnum
-	po->head_seqnum = po->in ? po->in->pck_seq_num : 0;
-	po->Count -= 1;
-	//release the item
-	ret = t->pck;
-	gf_free(t);
+	slot = gf_rtp_reorderer_pop(po);
+	if (!slot) return NULL;
+	*pck_size = slot->size;
+	//hand the slot buffer over, the slot will allocate a new one
+	ret = slot->pck;
+	slot->pck = NULL;
+	slot->alloc_size = 0;
 	return ret;
 }
 
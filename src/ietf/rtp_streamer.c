@@ -31,6 +31,7 @@
 #include <gpac/avparse.h>
 #endif
 #include <gpac/internal/ietf_dev.h>
+#include <gpac/thread.h>
 
 #if !defined(GPAC_DISABLE_STREAMING) && !defined(GPAC_DISABLE_ISOM)
 
@@ -861,5 +862,290 @@ u8 gf_rtp_streamer_get_payload_type(GF_RTPStreamer *streamer)
 	return streamer->packetizer->PayloadType;
 }
 
+
+/*number of ticks in the timer wheel of an engine thread*/
+#define RTP_ENGINE_WHEEL_SIZE	1024
+
+typedef struct __rtp_engine_session
+{
+	/*next session in the same wheel slot*/
+	struct __rtp_engine_session *next;
+
+	GF_RTPStreamer *streamer;
+	gf_rtp_streamer_fetch_au fetch_au;
+	void *udta;
+	u32 thread_idx;
+	/*engine time at which the session was added, in microseconds*/
+	u64 start_time;
+
+	/*AU fetched but not yet due*/
+	Bool has_au, is_rap;
+	char *data;
+	u32 size;
+	u64 cts, dts;
+	/*tick at which the pending AU is due*/
+	u64 deadline_tick;
+	/*set once fetch_au signaled the end of the session, the session is no longer in the wheel*/
+	Bool done;
+} RTPEngineSession;
+
+typedef struct
+{
+	GF_RTPStreamerEngine *engine;
+	GF_Thread *th;
+	/*protects the wheel against session addition/removal*/
+	GF_Mutex *mx;
+	/*sessions are linked in the slot of their deadline tick modulo the wheel size*/
+	RTPEngineSession *wheel[RTP_ENGINE_WHEEL_SIZE];
+	/*next tick to process*/
+	u64 tick;
+	u32 nb_sessions;
+} RTPEngineThread;
+
+struct __rtp_streamer_engine
+{
+	RTPEngineThread *threads;
+	u32 nb_threads, tick_us, batch_size;
+	/*clock origin of the engine, in microseconds*/
+	u64 origin;
+	volatile Bool run;
+
+	GF_Mutex *mx;
+	GF_List *sessions;
+};
+
+static void rtp_engine_link(RTPEngineThread *th, RTPEngineSession *sess)
+{
+	u32 slot = (u32) (sess->deadline_tick % RTP_ENGINE_WHEEL_SIZE);
+	sess->next = th->wheel[slot];
+	th->wheel[slot] = sess;
+}
+
+static void rtp_engine_unlink(RTPEngineThread *th, RTPEngineSession *sess)
+{
+	RTPEngineSession **prev = &th->wheel[sess->deadline_tick % RTP_ENGINE_WHEEL_SIZE];
+	while (*prev) {
+		if (*prev == sess) {
+			*prev = sess->next;
+			break;
+		}
+		prev = &(*prev)->next;
+	}
+	sess->next = NULL;
+}
+
+/*sends all AUs of the session due at the given tick, the packets are sent together once done*/
+static void rtp_engine_send_session(RTPEngineThread *th, RTPEngineSession *sess, u64 tick)
+{
+	GF_Err e;
+	u32 tick_us = th->engine->tick_us;
+
+	while (1) {
+		if (!sess->has_au) {
+			u64 send_time = 0;
+			if (!sess->fetch_au(sess->udta, &sess->data, &sess->size, &sess->cts, &sess->dts, &sess->is_rap, &send_time)) {
+				sess->done = GF_TRUE;
+				break;
+			}
+			sess->has_au = GF_TRUE;
+			sess->deadline_tick = (sess->start_time + send_time) / tick_us;
+		}
+		if (sess->deadline_tick > tick) break;
+
+		e = gf_rtp_streamer_send_au(sess->streamer, sess->data, sess->size, sess->cts, sess->dts, sess->is_rap);
+		if (e) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_RTP, ("[RTP] Engine failed to send AU DTS "LLU": %s\n", sess->dts, gf_error_to_string(e)));
+		}
+		sess->has_au = GF_FALSE;
+	}
+	e = gf_rtp_flush_packets(sess->streamer->channel);
+	if (e) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_RTP, ("[RTP] Engine failed to send RTP packets: %s\n", gf_error_to_string(e)));
+	}
+	if (!sess->done) rtp_engine_link(th, sess);
+}
+
+static u32 rtp_engine_thread_run(void *par)
+{
+	RTPEngineThread *th = (RTPEngineThread *)par;
+	GF_RTPStreamerEngine *engine = th->engine;
+
+	while (engine->run) {
+		u64 now, next;
+		u64 cur_tick = (gf_sys_clock_high_res() - engine->origin) / engine->tick_us;
+
+		gf_mx_p(th->mx);
+		while (th->tick <= cur_tick) {
+			u32 slot = (u32) (th->tick % RTP_ENGINE_WHEEL_SIZE);
+			RTPEngineSession *sess = th->wheel[slot];
+			th->wheel[slot] = NULL;
+			while (sess) {
+				RTPEngineSession *next_sess = sess->next;
+				//sessions due in a later revolution of the wheel stay in the slot
+				if (sess->deadline_tick > th->tick) {
+					rtp_engine_link(th, sess);
+				} else {
+					rtp_engine_send_session(th, sess, th->tick);
+				}
+				sess = next_sess;
+			}
+			th->tick++;
+		}
+		gf_mx_v(th->mx);
+
+		next = th->tick * engine->tick_us;
+		now = gf_sys_clock_high_res() - engine->origin;
+		if (next > now) gf_sleep((u32) MAX(1, (next - now) / 1000));
+	}
+	return 0;
+}
+
+GF_EXPORT
+GF_RTPStreamerEngine *gf_rtp_streamer_engine_new(u32 nb_threads, u32 tick_us, u32 batch_size)
+{
+	u32 i;
+	GF_RTPStreamerEngine *engine;
+	GF_SAFEALLOC(engine, GF_RTPStreamerEngine);
+	if (!engine) return NULL;
+
+	engine->nb_threads = nb_threads ? nb_threads : 1;
+	engine->tick_us = tick_us ? tick_us : 1000;
+	engine->batch_size = batch_size;
+	engine->mx = gf_mx_new("RTPEngine");
+	engine->sessions = gf_list_new();
+	engine->threads = (RTPEngineThread *) gf_malloc(sizeof(RTPEngineThread) * engine->nb_threads);
+	if (!engine->threads) {
+		gf_list_del(engine->sessions);
+		gf_mx_del(engine->mx);
+		gf_free(engine);
+		return NULL;
+	}
+	memset(engine->threads, 0, sizeof(RTPEngineThread) * engine->nb_threads);
+	engine->origin = gf_sys_clock_high_res();
+	engine->run = GF_TRUE;
+
+	for (i=0; i<engine->nb_threads; i++) {
+		RTPEngineThread *th = &engine->threads[i];
+		th->engine = engine;
+		th->mx = gf_mx_new("RTPEngineThread");
+		th->th = gf_th_new("RTPEngineThread");
+		gf_th_run(th->th, rtp_engine_thread_run, th);
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_RTP, ("[RTP] Streamer engine started - %d threads - %d us ticks - send batch %d packets\n", engine->nb_threads, engine->tick_us, batch_size));
+	return engine;
+}
+
+GF_EXPORT
+void gf_rtp_streamer_engine_del(GF_RTPStreamerEngine *engine)
+{
+	u32 i;
+	if (!engine) return;
+	engine->run = GF_FALSE;
+	for (i=0; i<engine->nb_threads; i++) {
+		gf_th_stop(engine->threads[i].th);
+		gf_th_del(engine->threads[i].th);
+		gf_mx_del(engine->threads[i].mx);
+	}
+	while (gf_list_count(engine->sessions)) {
+		RTPEngineSession *sess = (RTPEngineSession *)gf_list_pop_back(engine->sessions);
+		if (engine->batch_size) gf_rtp_set_send_batch(sess->streamer->channel, 0);
+		gf_free(sess);
+	}
+	gf_list_del(engine->sessions);
+	gf_mx_del(engine->mx);
+	gf_free(engine->threads);
+	gf_free(engine);
+}
+
+GF_EXPORT
+GF_Err gf_rtp_streamer_engine_add(GF_RTPStreamerEngine *engine, GF_RTPStreamer *streamer, gf_rtp_streamer_fetch_au fetch_au, void *udta)
+{
+	u32 i;
+	GF_Err e;
+	RTPEngineThread *th;
+	RTPEngineSession *sess;
+
+	if (!engine || !streamer || !fetch_au) return GF_BAD_PARAM;
+	if (engine->batch_size) {
+		e = gf_rtp_set_send_batch(streamer->channel, engine->batch_size);
+		if (e) return e;
+	}
+	GF_SAFEALLOC(sess, RTPEngineSession);
+	if (!sess) return GF_OUT_OF_MEM;
+	sess->streamer = streamer;
+	sess->fetch_au = fetch_au;
+	sess->udta = udta;
+
+	gf_mx_p(engine->mx);
+	//run the session on the least loaded thread
+	for (i=1; i<engine->nb_threads; i++) {
+		if (engine->threads[i].nb_sessions < engine->threads[sess->thread_idx].nb_sessions)
+			sess->thread_idx = i;
+	}
+	th = &engine->threads[sess->thread_idx];
+	th->nb_sessions++;
+	gf_list_add(engine->sessions, sess);
+	gf_mx_v(engine->mx);
+
+	gf_mx_p(th->mx);
+	sess->start_time = gf_sys_clock_high_res() - engine->origin;
+	//first AU is fetched at the next tick
+	sess->deadline_tick = th->tick;
+	rtp_engine_link(th, sess);
+	gf_mx_v(th->mx);
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_rtp_streamer_engine_remove(GF_RTPStreamerEngine *engine, GF_RTPStreamer *streamer)
+{
+	u32 i;
+	RTPEngineThread *th;
+	RTPEngineSession *sess = NULL;
+	if (!engine || !streamer) return GF_BAD_PARAM;
+
+	gf_mx_p(engine->mx);
+	for (i=0; i<gf_list_count(engine->sessions); i++) {
+		sess = (RTPEngineSession *)gf_list_get(engine->sessions, i);
+		if (sess->streamer == streamer) {
+			gf_list_rem(engine->sessions, i);
+			break;
+		}
+		sess = NULL;
+	}
+	if (!sess) {
+		gf_mx_v(engine->mx);
+		return GF_BAD_PARAM;
+	}
+	th = &engine->threads[sess->thread_idx];
+	th->nb_sessions--;
+	gf_mx_v(engine->mx);
+
+	gf_mx_p(th->mx);
+	if (!sess->done) rtp_engine_unlink(th, sess);
+	gf_mx_v(th->mx);
+
+	if (engine->batch_size) gf_rtp_set_send_batch(streamer->channel, 0);
+	gf_free(sess);
+	return GF_OK;
+}
+
+GF_EXPORT
+u32 gf_rtp_streamer_engine_get_session_count(GF_RTPStreamerEngine *engine, Bool active_only)
+{
+	u32 i, count;
+	if (!engine) return 0;
+	gf_mx_p(engine->mx);
+	count = gf_list_count(engine->sessions);
+	if (active_only) {
+		for (i=0; i<gf_list_count(engine->sessions); i++) {
+			RTPEngineSession *sess = (RTPEngineSession *)gf_list_get(engine->sessions, i);
+			if (sess->done) count--;
+		}
+	}
+	gf_mx_v(engine->mx);
+	return count;
+}
+
 #endif /*GPAC_DISABLE_STREAMING && GPAC_DISABLE_ISOM*/
 
@@ -274,89 +274,154 @@ static SAPType sap_type_from_nal_type(u8 nal_type) {
 }
 #endif
 
-static SAPType is_sample_idr(GF_ISOSample *sample, GF_MPEGVisualSampleEntryBox *entry)
+static u32 nalu_get_size_field(GF_MPEGVisualSampleEntryBox *entry, Bool *is_hevc)
 {
-	Bool is_hevc = GF_FALSE;
-	u32 nalu_size_field = 0;
-	GF_BitStream *bs;
-	if (entry->avc_config && entry->avc_config->config) nalu_size_field = entry->avc_config->config->nal_unit_size;
-	else if (entry->svc_config && entry->svc_config->config) nalu_size_field = entry->svc_config->config->nal_unit_size;
-	else if (entry->mvc_config && entry->mvc_config->config) nalu_size_field = entry->mvc_config->config->nal_unit_size;
-	else if (entry->hevc_config && entry->hevc_config->config) {
-		nalu_size_field = entry->hevc_config->config->nal_unit_size;
-		is_hevc = GF_TRUE;
+	*is_hevc = GF_FALSE;
+	if (entry->avc_config && entry->avc_config->config) return entry->avc_config->config->nal_unit_size;
+	if (entry->svc_config && entry->svc_config->config) return entry->svc_config->config->nal_unit_size;
+	if (entry->mvc_config && entry->mvc_config->config) return entry->mvc_config->config->nal_unit_size;
+	*is_hevc = GF_TRUE;
+	if (entry->hevc_config && entry->hevc_config->config) return entry->hevc_config->config->nal_unit_size;
+	if (entry->lhvc_config && entry->lhvc_config->config) return entry->lhvc_config->config->nal_unit_size;
+	return 0;
+}
+
+/*checks the SAP type of a NAL unit header (u16 for HEVC, u8 for AVC). Returns GF_TRUE if the NAL unit
+may precede the first slice of the sample, otherwise the sample SAP type is set*/
+static Bool nalu_check_sap_type(u32 nal_hdr, Bool is_hevc, SAPType *sap)
+{
+	*sap = RAP_NO;
+	if (is_hevc) {
+#ifndef GPAC_DISABLE_HEVC
+		switch ((nal_hdr&0x7E00) >> 9) {
+		case GF_HEVC_NALU_SLICE_CRA:
+			*sap = SAP_TYPE_3;
+			return GF_FALSE;
+		case GF_HEVC_NALU_SLICE_IDR_N_LP:
+		case GF_HEVC_NALU_SLICE_BLA_N_LP:
+			*sap = SAP_TYPE_1;
+			return GF_FALSE;
+		case GF_HEVC_NALU_SLICE_IDR_W_DLP:
+		case GF_HEVC_NALU_SLICE_BLA_W_DLP:
+		case GF_HEVC_NALU_SLICE_BLA_W_LP:
+			*sap = SAP_TYPE_2;
+			return GF_FALSE;
+		case GF_HEVC_NALU_ACCESS_UNIT:
+		case GF_HEVC_NALU_FILLER_DATA:
+		case GF_HEVC_NALU_SEI_PREFIX:
+		case GF_HEVC_NALU_VID_PARAM:
+		case GF_HEVC_NALU_SEQ_PARAM:
+		case GF_HEVC_NALU_PIC_PARAM:
+			return GF_TRUE;
+		default:
+			return GF_FALSE;
+		}
+#else
+		return GF_FALSE;
+#endif
 	}
-	else if (entry->lhvc_config && entry->lhvc_config->config) {
-		nalu_size_field = entry->lhvc_config->config->nal_unit_size;
-		is_hevc = GF_TRUE;
+
+	switch (nal_hdr & 0x1F) {
+	/*			case GF_AVC_NALU_SEQ_PARAM:
+				case GF_AVC_NALU_PIC_PARAM:
+				case GF_AVC_NALU_SEQ_PARAM_EXT:
+				case GF_AVC_NALU_SVC_SUBSEQ_PARAM:
+*/			case GF_AVC_NALU_IDR_SLICE:
+		*sap = SAP_TYPE_1;
+		return GF_FALSE;
+	case GF_AVC_NALU_ACCESS_UNIT:
+	case GF_AVC_NALU_FILLER_DATA:
+	case GF_AVC_NALU_SEI:
+		return GF_TRUE;
+	default:
+		return GF_FALSE;
 	}
+}
+
+static SAPType is_sample_idr(GF_ISOSample *sample, GF_MPEGVisualSampleEntryBox *entry)
+{
+	Bool is_hevc;
+	u32 nalu_size_field;
+	GF_BitStream *bs;
+	nalu_size_field = nalu_get_size_field(entry, &is_hevc);
 	if (!nalu_size_field) return RAP_NO;
 
 	bs = gf_bs_new(sample->data, sample->dataLength, GF_BITSTREAM_READ);
 	if (!bs) return RAP_NO;
 
 	while (gf_bs_available(bs)) {
-		u8 nal_type;
+		SAPType sap;
 		u32 size = gf_bs_read_int(bs, 8*nalu_size_field);
+		u32 nal_hdr = is_hevc ? gf_bs_read_u16(bs) : gf_bs_read_u8(bs);
 
-		if (is_hevc) {
-#ifndef GPAC_DISABLE_HEVC
-			u16 nal_hdr = gf_bs_read_u16(bs);
-			nal_type = (nal_hdr&0x7E00) >> 9;
-
-			switch (nal_type) {
-			case GF_HEVC_NALU_SLICE_CRA:
-				gf_bs_del(bs);
-				return SAP_TYPE_3;
-			case GF_HEVC_NALU_SLICE_IDR_N_LP:
-			case GF_HEVC_NALU_SLICE_BLA_N_LP:
-				gf_bs_del(bs);
-				return SAP_TYPE_1;
-			case GF_HEVC_NALU_SLICE_IDR_W_DLP:
-			case GF_HEVC_NALU_SLICE_BLA_W_DLP:
-			case GF_HEVC_NALU_SLICE_BLA_W_LP:
-				gf_bs_del(bs);
-				return SAP_TYPE_2;
-			case GF_HEVC_NALU_ACCESS_UNIT:
-			case GF_HEVC_NALU_FILLER_DATA:
-			case GF_HEVC_NALU_SEI_PREFIX:
-			case GF_HEVC_NALU_VID_PARAM:
-			case GF_HEVC_NALU_SEQ_PARAM:
-			case GF_HEVC_NALU_PIC_PARAM:
-				break;
-			default:
-				gf_bs_del(bs);
-				return RAP_NO;
-			}
-			gf_bs_skip_bytes(bs, size - 2);
-#endif
-		} else {
-			u8 nal_hdr = gf_bs_read_u8(bs);
-			nal_type = nal_hdr & 0x1F;
-
-			switch (nal_type) {
-			/*			case GF_AVC_NALU_SEQ_PARAM:
-						case GF_AVC_NALU_PIC_PARAM:
-						case GF_AVC_NALU_SEQ_PARAM_EXT:
-						case GF_AVC_NALU_SVC_SUBSEQ_PARAM:
-		*/			case GF_AVC_NALU_IDR_SLICE:
-				gf_bs_del(bs);
-				return SAP_TYPE_1;
-			case GF_AVC_NALU_ACCESS_UNIT:
-			case GF_AVC_NALU_FILLER_DATA:
-			case GF_AVC_NALU_SEI:
-				break;
-			default:
-				gf_bs_del(bs);
-				return RAP_NO;
-			}
-			gf_bs_skip_bytes(bs, size - 1);
+		if (!nalu_check_sap_type(nal_hdr, is_hevc, &sap)) {
+			gf_bs_del(bs);
+			return sap;
 		}
+		gf_bs_skip_bytes(bs, size - (is_hevc ? 2 : 1));
 	}
 	gf_bs_del(bs);
 	return RAP_NO;
 }
 
+/*same as is_sample_idr, reading only the NAL unit headers from the data map*/
+static SAPType is_sample_idr_in_map(GF_DataMap *map, u64 offset, u32 sample_size, GF_MPEGVisualSampleEntryBox *entry)
+{
+	Bool is_hevc;
+	u8 hdr[6];
+	u32 nalu_size_field, hdr_size;
+	u64 pos = 0;
+	nalu_size_field = nalu_get_size_field(entry, &is_hevc);
+	if (!nalu_size_field || (nalu_size_field>4)) return RAP_NO;
+	hdr_size = nalu_size_field + (is_hevc ? 2 : 1);
+
+	while (pos + hdr_size <= sample_size) {
+		SAPType sap;
+		u32 i, size = 0, nal_hdr;
+		if (gf_isom_datamap_get_data(map, (char *) hdr, hdr_size, offset + pos) < hdr_size)
+			break;
+		for (i=0; i<nalu_size_field; i++) size = (size<<8) | hdr[i];
+		nal_hdr = is_hevc ? ((hdr[nalu_size_field]<<8) | hdr[nalu_size_field+1]) : hdr[nalu_size_field];
+
+		if (!nalu_check_sap_type(nal_hdr, is_hevc, &sap))
+			return sap;
+		pos += nalu_size_field + size;
+	}
+	return RAP_NO;
+}
+
+static GF_MPEGVisualSampleEntryBox *nalu_get_base_entry(GF_MediaBox *mdia, GF_MPEGVisualSampleEntryBox *entry, u32 track_num)
+{
+	if ( gf_isom_get_reference_count(mdia->mediaTrack->moov->mov, track_num, GF_ISOM_REF_TBAS) >= 1) {
+		u32 ref_track;
+		u32 idx = gf_list_find(mdia->information->sampleTable->SampleDescription->other_boxes, entry);
+		GF_TrackBox *tbas;
+		gf_isom_get_reference(mdia->mediaTrack->moov->mov, track_num, GF_ISOM_REF_TBAS, 1, &ref_track);
+		tbas = (GF_TrackBox *)gf_list_get(mdia->mediaTrack->moov->trackList, ref_track-1);
+		entry = gf_list_get(tbas->Media->information->sampleTable->SampleDescription->other_boxes, idx);
+	}
+	return entry;
+}
+
+GF_Err gf_isom_nalu_sample_refine_sap(GF_MediaBox *mdia, GF_ISOSample *sample, u64 offset, GF_MPEGVisualSampleEntryBox *entry)
+{
+	u32 track_num;
+	if ((mdia->mediaTrack->extractor_mode&0x0000FFFF) != GF_ISOM_NALU_EXTRACT_INSPECT)
+		return GF_NOT_SUPPORTED;
+
+	track_num = 1 + gf_list_find(mdia->mediaTrack->moov->trackList, mdia->mediaTrack);
+	entry = nalu_get_base_entry(mdia, entry, track_num);
+	if (!entry) return GF_BAD_PARAM;
+
+	/*same logic as gf_isom_nalu_sample_rewrite*/
+	if (sample->IsRAP < SAP_TYPE_2) {
+		if (mdia->information->sampleTable->no_sync_found || !sample->IsRAP) {
+			sample->IsRAP = is_sample_idr_in_map(mdia->information->dataHandler, offset, sample->dataLength, entry);
+		}
+	}
+	return GF_OK;
+}
+
 static void nalu_merge_ps(GF_BitStream *ps_bs, Bool rewrite_start_codes, u32 nal_unit_size_field, GF_MPEGVisualSampleEntryBox *entry, Bool is_hevc)
 {
 	u32 i, count;
@@ -481,14 +546,7 @@ GF_Err gf_isom_nalu_sample_rewrite(GF_MediaBox *mdia, GF_ISOSample *sample, u32
 		}
 	}
 
-	if ( gf_isom_get_reference_count(mdia->mediaTrack->moov->mov, track_num, GF_ISOM_REF_TBAS) >= 1) {
-		u32 ref_track;
-		u32 idx = gf_list_find(mdia->information->sampleTable->SampleDescription->other_boxes, entry);
-		GF_TrackBox *tbas;
-		gf_isom_get_reference(mdia->mediaTrack->moov->mov, track_num, GF_ISOM_REF_TBAS, 1, &ref_track);
-		tbas = (GF_TrackBox *)gf_list_get(mdia->mediaTrack->moov->trackList, ref_track-1);
-		entry = gf_list_get(tbas->Media->information->sampleTable->SampleDescription->other_boxes, idx);
-	}
+	entry = nalu_get_base_entry(mdia, entry, track_num);
 
 
 	if (sample->IsRAP < SAP_TYPE_2) {
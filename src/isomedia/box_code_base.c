@@ -3602,6 +3602,7 @@ void moof_del(GF_Box *s)
 	if (ptr->mfhd) gf_isom_box_del((GF_Box *) ptr->mfhd);
 	gf_isom_box_array_del(ptr->TrackList);
 	if (ptr->mdat) gf_free(ptr->mdat);
+	if (ptr->data_refs) gf_free(ptr->data_refs);
 	gf_free(ptr);
 }
 
@@ -6191,18 +6192,17 @@ GF_Err stsz_Size(GF_Box *s)
 	size = ptr->sizes[0];
 
 	for (i=0; i < ptr->sampleCount; i++) {
-		if (ptr->sizes[i] <= 0xF) continue;
-		//switch to 8-bit table
-		else if (ptr->sizes[i] <= 0xFF) {
-			fieldSize = 8;
+		//switch to 32-bit table
+		if (ptr->sizes[i] > 0xFFFF) {
+			fieldSize = 32;
 		}
 		//switch to 16-bit table
-		else if (ptr->sizes[i] <= 0xFFFF) {
-			fieldSize = 16;
+		else if (ptr->sizes[i] > 0xFF) {
+			if (fieldSize < 16) fieldSize = 16;
 		}
-		//switch to 32-bit table
-		else {
-			fieldSize = 32;
+		//switch to 8-bit table
+		else if (ptr->sizes[i] > 0xF) {
+			if (fieldSize < 8) fieldSize = 8;
 		}
 
 		//check the size
@@ -6214,6 +6214,8 @@ GF_Err stsz_Size(GF_Box *s)
 		ptr->sampleSize = size;
 		gf_free(ptr->sizes);
 		ptr->sizes = NULL;
+		ptr->alloc_size = 0;
+		return GF_OK;
 	}
 
 	if (fieldSize == 32) {
@@ -6868,6 +6870,9 @@ void trak_del(GF_Box *s)
 	if (ptr->name) gf_free(ptr->name);
 	if (ptr->groups) gf_isom_box_del((GF_Box *)ptr->groups);
 	if (ptr->Aperture) gf_isom_box_del((GF_Box *)ptr->Aperture);
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	if (ptr->frag_ranges) gf_free(ptr->frag_ranges);
+#endif
 	gf_free(ptr);
 }
 
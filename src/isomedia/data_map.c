@@ -301,6 +301,7 @@ void gf_isom_datamap_flush(GF_DataMap *map)
 
 u64 FDM_GetTotalOffset(GF_FileDataMap *ptr);
 GF_Err FDM_AddData(GF_FileDataMap *ptr, char *data, u32 dataSize);
+GF_Err FDM_AddFileRange(GF_FileDataMap *ptr, FILE *src, u64 src_offset, u64 size);
 
 u64 gf_isom_datamap_get_offset(GF_DataMap *map)
 {
@@ -330,6 +331,19 @@ GF_Err gf_isom_datamap_add_data(GF_DataMap *ptr, char *data, u32 dataSize)
 	}
 }
 
+GF_Err gf_isom_datamap_add_file_range(GF_DataMap *ptr, FILE *src, u64 src_offset, u64 size)
+{
+	if (!ptr || !src || !size) return GF_BAD_PARAM;
+
+	switch (ptr->type) {
+	case GF_ISOM_DATA_FILE:
+	case GF_ISOM_DATA_MEM:
+		return FDM_AddFileRange((GF_FileDataMap *)ptr, src, src_offset, size);
+	default:
+		return GF_NOT_SUPPORTED;
+	}
+}
+
 GF_DataMap *gf_isom_fdm_new_temp(const char *sPath)
 {
 	GF_FileDataMap *tmp;
@@ -552,6 +566,29 @@ GF_Err FDM_AddData(GF_FileDataMap *ptr, char *data, u32 dataSize)
 	return GF_OK;
 }
 
+GF_Err FDM_AddFileRange(GF_FileDataMap *ptr, FILE *src, u64 src_offset, u64 size)
+{
+	u64 orig;
+	if (ptr->mode == GF_ISOM_DATA_MAP_READ) return GF_BAD_PARAM;
+
+	orig = gf_bs_get_size(ptr->bs);
+
+	/*last access was read, seek to end of file*/
+	if (ptr->last_acces_was_read) {
+		gf_bs_seek(ptr->bs, orig);
+		ptr->last_acces_was_read = 0;
+	}
+	//copied by the kernel when possible
+	if (gf_bs_write_file_range(ptr->bs, src, src_offset, size) != size) {
+		ptr->curPos = orig;
+		gf_bs_seek(ptr->bs, orig);
+		return GF_IO_ERR;
+	}
+	ptr->curPos = gf_bs_get_position(ptr->bs);
+	if (ptr->stream) fflush(ptr->stream);
+	return GF_OK;
+}
+
 #endif	/*GPAC_DISABLE_ISOM_WRITE*/
 
 
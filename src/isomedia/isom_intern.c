@@ -35,6 +35,28 @@ GF_Err gf_isom_parse_root_box(GF_Box **outBox, GF_BitStream *bs, u64 *bytesExpec
 
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
 GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, u64 moof_offset, u64 *cumulated_offset, Bool is_first_merge);
+void MergeTrackEditDuration(GF_TrackBox *trak, u64 traf_duration);
+
+static void FragmentCopyPSSH(GF_MovieFragmentBox *moof, GF_ISOFile *mov)
+{
+	GF_Box *a;
+	u32 i = 0;
+	while ((a = (GF_Box *)gf_list_enum(moof->other_boxes, &i))) {
+		if (a->type == GF_ISOM_BOX_TYPE_PSSH) {
+			GF_ProtectionSystemHeaderBox *pssh = (GF_ProtectionSystemHeaderBox *)gf_isom_box_new(GF_ISOM_BOX_TYPE_PSSH);
+			memmove(pssh->SystemID, ((GF_ProtectionSystemHeaderBox *)a)->SystemID, 16);
+			pssh->KID_count = ((GF_ProtectionSystemHeaderBox *)a)->KID_count;
+			pssh->KIDs = (bin128 *)gf_malloc(pssh->KID_count*sizeof(bin128));
+			memmove(pssh->KIDs, ((GF_ProtectionSystemHeaderBox *)a)->KIDs, pssh->KID_count*sizeof(bin128));
+			pssh->private_data_size = ((GF_ProtectionSystemHeaderBox *)a)->private_data_size;
+			pssh->private_data = (u8 *)gf_malloc(pssh->private_data_size*sizeof(char));
+			memmove(pssh->private_data, ((GF_ProtectionSystemHeaderBox *)a)->private_data, pssh->private_data_size);
+
+			if (!mov->moov->other_boxes) mov->moov->other_boxes = gf_list_new();
+			gf_list_add(mov->moov->other_boxes, pssh);
+		}
+	}
+}
 
 GF_Err MergeFragment(GF_MovieFragmentBox *moof, GF_ISOFile *mov)
 {
@@ -97,24 +119,9 @@ GF_Err MergeFragment(GF_MovieFragmentBox *moof, GF_ISOFile *mov)
 		trak->first_traf_merged = 1;
 	}
 
-	if (moof->other_boxes) {
-		GF_Box *a;
-		i = 0;
-		while ((a = (GF_Box *)gf_list_enum(moof->other_boxes, &i))) {
-			if (a->type == GF_ISOM_BOX_TYPE_PSSH) {
-				GF_ProtectionSystemHeaderBox *pssh = (GF_ProtectionSystemHeaderBox *)gf_isom_box_new(GF_ISOM_BOX_TYPE_PSSH);
-				memmove(pssh->SystemID, ((GF_ProtectionSystemHeaderBox *)a)->SystemID, 16);
-				pssh->KID_count = ((GF_ProtectionSystemHeaderBox *)a)->KID_count;
-				pssh->KIDs = (bin128 *)gf_malloc(pssh->KID_count*sizeof(bin128));
-				memmove(pssh->KIDs, ((GF_ProtectionSystemHeaderBox *)a)->KIDs, pssh->KID_count*sizeof(bin128));
-				pssh->private_data_size = ((GF_ProtectionSystemHeaderBox *)a)->private_data_size;
-				pssh->private_data = (u8 *)gf_malloc(pssh->private_data_size*sizeof(char));
-				memmove(pssh->private_data, ((GF_ProtectionSystemHeaderBox *)a)->private_data, pssh->private_data_size);
-
-				if (!mov->moov->other_boxes) mov->moov->other_boxes = gf_list_new();
-				gf_list_add(mov->moov->other_boxes, pssh);
-			}
-		}
+	//in lazy fragment mode, PSSH boxes are copied when indexing the fragment
+	if (moof->other_boxes && !mov->lazy_max_frags) {
+		FragmentCopyPSSH(moof, mov);
 	}
 
 	mov->NextMoofNumber = moof->mfhd->sequence_number;
@@ -176,6 +183,291 @@ static void FixSDTPInTRAF(GF_MovieFragmentBox *moof)
 	}
 }
 
+/*restores track and movie durations from the fragment index, the sample tables only describe the loaded fragments*/
+static void LazySetDurations(GF_ISOFile *mov)
+{
+	u32 i;
+	GF_TrackBox *trak;
+	if (!mov->nb_lazy_frags) return;
+
+	i=0;
+	while ((trak = (GF_TrackBox*)gf_list_enum(mov->moov->trackList, &i))) {
+		u64 dur;
+		GF_TrackFragmentRange *last;
+		if (!trak->frag_ranges) continue;
+		last = &trak->frag_ranges[mov->nb_lazy_frags-1];
+		trak->Media->mediaHeader->duration = last->first_dts + last->duration;
+
+		if (!mov->moov->mvhd->timeScale || !trak->Media->mediaHeader->timeScale) continue;
+		dur = 0;
+		if (trak->editBox && trak->editBox->editList) {
+			u32 j=0;
+			GF_EdtsEntry *ent;
+			while ((ent = (GF_EdtsEntry*)gf_list_enum(trak->editBox->editList->entryList, &j))) {
+				dur += ent->segmentDuration;
+			}
+		}
+		if (!dur) dur = (trak->Media->mediaHeader->duration * mov->moov->mvhd->timeScale) / trak->Media->mediaHeader->timeScale;
+		trak->Header->duration = dur;
+		if (mov->moov->mvhd->duration < dur) mov->moov->mvhd->duration = dur;
+	}
+}
+
+/*indexes a movie fragment without merging it: only its position and the number and duration of samples of each track are kept*/
+static GF_Err LazyIndexFragment(GF_MovieFragmentBox *moof, GF_ISOFile *mov)
+{
+	u32 i, j;
+	GF_TrackBox *trak;
+	GF_TrackFragmentBox *traf;
+
+	if (!mov->moov || !mov->moov->mvex) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Error: %s not received before indexing fragment\n", mov->moov ? "mvex" : "moov" ));
+		return GF_ISOM_INVALID_FILE;
+	}
+
+	if (mov->nb_lazy_frags == mov->alloc_lazy_frags) {
+		mov->alloc_lazy_frags = mov->alloc_lazy_frags ? 2*mov->alloc_lazy_frags : 64;
+		mov->lazy_moof_offsets = (u64*)gf_realloc(mov->lazy_moof_offsets, sizeof(u64) * mov->alloc_lazy_frags);
+		if (!mov->lazy_moof_offsets) return GF_OUT_OF_MEM;
+		i=0;
+		while ((trak = (GF_TrackBox*)gf_list_enum(mov->moov->trackList, &i))) {
+			trak->frag_ranges = (GF_TrackFragmentRange*)gf_realloc(trak->frag_ranges, sizeof(GF_TrackFragmentRange) * mov->alloc_lazy_frags);
+			if (!trak->frag_ranges) return GF_OUT_OF_MEM;
+		}
+	}
+	mov->lazy_moof_offsets[mov->nb_lazy_frags] = mov->current_top_box_start;
+
+	i=0;
+	while ((trak = (GF_TrackBox*)gf_list_enum(mov->moov->trackList, &i))) {
+		GF_TrackFragmentRange *range = &trak->frag_ranges[mov->nb_lazy_frags];
+		memset(range, 0, sizeof(GF_TrackFragmentRange));
+		if (mov->nb_lazy_frags) {
+			GF_TrackFragmentRange *prev = &trak->frag_ranges[mov->nb_lazy_frags-1];
+			range->first_sample = prev->first_sample + prev->nb_samples;
+			range->first_dts = prev->first_dts + prev->duration;
+		}
+	}
+
+	i=0;
+	while ((traf = (GF_TrackFragmentBox*)gf_list_enum(moof->TrackList, &i))) {
+		GF_TrackFragmentRunBox *trun;
+		GF_TrackExtendsBox *trex;
+		GF_TrackFragmentRange *range;
+		u32 def_duration, def_flags, k;
+		u64 traf_duration = 0;
+		if (!traf->tfhd) continue;
+
+		trak = gf_isom_get_track_from_id(mov->moov, traf->tfhd->trackID);
+		j=0;
+		while ((trex = (GF_TrackExtendsBox*)gf_list_enum(mov->moov->mvex->TrackExList, &j))) {
+			if (trex->trackID == traf->tfhd->trackID) break;
+			trex = NULL;
+		}
+		if (!trak || !trex) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Error: Cannot find fragment track with ID %d\n", traf->tfhd->trackID));
+			return GF_ISOM_INVALID_FILE;
+		}
+		range = &trak->frag_ranges[mov->nb_lazy_frags];
+
+		/*same as MergeTrack: tfdt is only used for the first merged fragment of the track*/
+		if (traf->tfdt && !trak->first_traf_merged)
+			range->first_dts = traf->tfdt->baseMediaDecodeTime;
+		trak->first_traf_merged = 1;
+
+		def_duration = (traf->tfhd->flags & GF_ISOM_TRAF_SAMPLE_DUR) ? traf->tfhd->def_sample_duration : trex->def_sample_duration;
+		def_flags = (traf->tfhd->flags & GF_ISOM_TRAF_SAMPLE_FLAGS) ? traf->tfhd->def_sample_flags : trex->def_sample_flags;
+		j=0;
+		while ((trun = (GF_TrackFragmentRunBox *)gf_list_enum(traf->TrackRuns, &j))) {
+			for (k=0; k<trun->sample_count; k++) {
+				u32 nb_samp, flags;
+				GF_TrunEntry *ent = (GF_TrunEntry*)gf_list_get(trun->entries, k);
+				if (!ent) break;
+				nb_samp = ent->nb_pack ? ent->nb_pack : 1;
+				/*same flags resolution as MergeTrack, packed samples are not signaled as sync*/
+				flags = def_flags;
+				if (trun->flags & GF_ISOM_TRUN_FLAGS) flags = ent->flags;
+				else if (!k && (trun->flags & GF_ISOM_TRUN_FIRST_FLAG)) flags = trun->first_sample_flags;
+				if (!ent->nb_pack && GF_ISOM_GET_FRAG_SYNC(flags)) {
+					if (!range->first_sync) range->first_sync = range->nb_samples + 1;
+					range->last_sync = range->nb_samples + 1;
+				}
+				/*MergeTrack signals dependency flags for all samples once one unpacked sample is merged*/
+				if (!ent->nb_pack && !trak->Media->information->sampleTable->SampleDep) {
+					trak->Media->information->sampleTable->SampleDep = (GF_SampleDependencyTypeBox *) gf_isom_box_new(GF_ISOM_BOX_TYPE_SDTP);
+					if (!trak->Media->information->sampleTable->SampleDep) return GF_OUT_OF_MEM;
+				}
+				range->nb_samples += nb_samp;
+				traf_duration += nb_samp * ((trun->flags & GF_ISOM_TRUN_DURATION) ? ent->Duration : def_duration);
+				k += nb_samp-1;
+			}
+		}
+		range->duration += traf_duration;
+		/*same as MergeTrack, done once per fragment since fragments may be merged several times*/
+		MergeTrackEditDuration(trak, traf_duration);
+	}
+
+	if (moof->other_boxes) FragmentCopyPSSH(moof, mov);
+	mov->NextMoofNumber = moof->mfhd->sequence_number;
+	mov->nb_lazy_frags++;
+	LazySetDurations(mov);
+	return GF_OK;
+}
+
+/*parses and merges the given indexed movie fragment in the sample tables*/
+static GF_Err LazyMergeFragment(GF_ISOFile *mov, u32 frag_idx)
+{
+	GF_Err e;
+	GF_Box *a;
+	u64 bytes_missing, last_top_box_start;
+
+	last_top_box_start = mov->current_top_box_start;
+	mov->current_top_box_start = mov->lazy_moof_offsets[frag_idx];
+	gf_bs_seek(mov->movieFileMap->bs, mov->current_top_box_start);
+
+	e = gf_isom_parse_root_box(&a, mov->movieFileMap->bs, &bytes_missing, GF_FALSE);
+	if (!e && (a->type != GF_ISOM_BOX_TYPE_MOOF)) {
+		gf_isom_box_del(a);
+		e = GF_ISOM_INVALID_FILE;
+	}
+	if (!e) {
+		((GF_MovieFragmentBox *)a)->mov = mov;
+		mov->moof = (GF_MovieFragmentBox *) a;
+		FixTrackID(mov);
+		FixSDTPInTRAF(mov->moof);
+		e = MergeFragment(mov->moof, mov);
+		gf_isom_box_del(a);
+		mov->moof = NULL;
+	}
+	mov->current_top_box_start = last_top_box_start;
+	return e;
+}
+
+static GF_Err LazyLoadFragment(GF_ISOFile *mov, u32 frag_idx)
+{
+	GF_Err e;
+	u32 i;
+	GF_TrackBox *trak;
+
+	if ((frag_idx >= mov->lazy_frag_start) && (frag_idx < mov->lazy_frag_end)) return GF_OK;
+
+	/*next fragment and room left in the window, append it*/
+	if ((frag_idx == mov->lazy_frag_end) && (mov->lazy_frag_end > mov->lazy_frag_start) && (mov->lazy_frag_end - mov->lazy_frag_start < mov->lazy_max_frags)) {
+		e = LazyMergeFragment(mov, frag_idx);
+		if (e) return e;
+		mov->lazy_frag_end++;
+		LazySetDurations(mov);
+		return GF_OK;
+	}
+
+	/*otherwise flush the sample tables and restart from the fragment, keeping the previous one for backward browsing*/
+	e = gf_isom_reset_tables(mov, GF_TRUE);
+	if (e) return e;
+
+	mov->lazy_frag_start = frag_idx;
+	if (frag_idx && (mov->lazy_max_frags>1)) mov->lazy_frag_start--;
+	mov->lazy_frag_end = mov->lazy_frag_start;
+	mov->NextMoofNumber = 0;
+
+	i=0;
+	while ((trak = (GF_TrackBox*)gf_list_enum(mov->moov->trackList, &i))) {
+		GF_SampleTableBox *stbl = trak->Media->information->sampleTable;
+		if (stbl->traf_map) stbl->traf_map->nb_entries = 0;
+		if (trak->sample_encryption && trak->sample_encryption->samp_aux_info) {
+			while (gf_list_count(trak->sample_encryption->samp_aux_info)) {
+				GF_CENCSampleAuxInfo *sai = (GF_CENCSampleAuxInfo *)gf_list_pop_back(trak->sample_encryption->samp_aux_info);
+				gf_isom_cenc_samp_aux_info_del(sai);
+			}
+		}
+		trak->sample_count_at_seg_start = trak->frag_ranges[mov->lazy_frag_start].first_sample;
+		trak->dts_at_seg_start = trak->frag_ranges[mov->lazy_frag_start].first_dts;
+		/*timing already resolved from tfdt when indexing*/
+		trak->first_traf_merged = 1;
+	}
+
+	while (mov->lazy_frag_end <= frag_idx) {
+		e = LazyMergeFragment(mov, mov->lazy_frag_end);
+		if (e) return e;
+		mov->lazy_frag_end++;
+	}
+	LazySetDurations(mov);
+	return GF_OK;
+}
+
+GF_Err gf_isom_lazy_load_sample(GF_ISOFile *mov, GF_TrackBox *trak, u32 sampleNumber)
+{
+	u32 low, high;
+	if (!mov->lazy_max_frags || !mov->nb_lazy_frags || !trak->frag_ranges || !sampleNumber) return GF_OK;
+
+	/*first fragment whose samples end at or after the requested one*/
+	low = 0;
+	high = mov->nb_lazy_frags-1;
+	while (low < high) {
+		u32 mid = (low + high) / 2;
+		if (trak->frag_ranges[mid].first_sample + trak->frag_ranges[mid].nb_samples < sampleNumber) low = mid+1;
+		else high = mid;
+	}
+	if (trak->frag_ranges[low].first_sample + trak->frag_ranges[low].nb_samples < sampleNumber) return GF_OK;
+	return LazyLoadFragment(mov, low);
+}
+
+GF_Err gf_isom_lazy_load_time(GF_ISOFile *mov, GF_TrackBox *trak, u64 dts)
+{
+	u32 low, high;
+	if (!mov->lazy_max_frags || !mov->nb_lazy_frags || !trak->frag_ranges) return GF_OK;
+
+	/*first fragment with samples ending after the requested time, or last fragment with samples*/
+	low = 0;
+	high = mov->nb_lazy_frags-1;
+	while (low < high) {
+		u32 mid = (low + high) / 2;
+		if (trak->frag_ranges[mid].first_dts + trak->frag_ranges[mid].duration <= dts) low = mid+1;
+		else high = mid;
+	}
+	while (low && !trak->frag_ranges[low].nb_samples) low--;
+	return LazyLoadFragment(mov, low);
+}
+
+u32 gf_isom_lazy_find_sync(GF_ISOFile *mov, GF_TrackBox *trak, u32 sampleNumber, u8 SearchMode)
+{
+	u32 k, local, prev, next, prev_in_sap, next_in_sap;
+	SAPType is_rap;
+	GF_SampleTableBox *stbl = trak->Media->information->sampleTable;
+
+	if (!sampleNumber || (sampleNumber <= trak->sample_count_at_seg_start)) return 0;
+	/*no sync table, all loaded samples are sync*/
+	if (!stbl->SyncSample) return sampleNumber;
+
+	/*same as Media_FindSyncSample, but without falling back on the sample itself*/
+	local = sampleNumber - trak->sample_count_at_seg_start;
+	stbl_GetSampleRAP(stbl->SyncSample, local, &is_rap, &prev, &next);
+	if (is_rap) return sampleNumber;
+	stbl_SearchSAPs(stbl, local, &is_rap, &prev_in_sap, &next_in_sap);
+	if (is_rap) return sampleNumber;
+	if (prev_in_sap > prev) prev = prev_in_sap;
+	if (next_in_sap && (next_in_sap < next)) next = next_in_sap;
+
+	if (SearchMode == GF_ISOM_SEARCH_SYNC_FORWARD) {
+		if (next) return next + trak->sample_count_at_seg_start;
+	} else {
+		if (prev) return prev + trak->sample_count_at_seg_start;
+	}
+	if (!mov->lazy_max_frags || !trak->frag_ranges) return 0;
+
+	/*no sync in the loaded fragments, check the index*/
+	if (SearchMode == GF_ISOM_SEARCH_SYNC_FORWARD) {
+		for (k=mov->lazy_frag_end; k<mov->nb_lazy_frags; k++) {
+			if (trak->frag_ranges[k].first_sync) return trak->frag_ranges[k].first_sample + trak->frag_ranges[k].first_sync;
+		}
+	} else {
+		k = mov->lazy_frag_start;
+		while (k) {
+			k--;
+			if (trak->frag_ranges[k].last_sync) return trak->frag_ranges[k].first_sample + trak->frag_ranges[k].last_sync;
+		}
+	}
+	return 0;
+}
+
 #endif
 
 GF_Err gf_isom_parse_movie_boxes(GF_ISOFile *mov, u64 *bytesMissing, Bool progressive_mode)
@@ -410,6 +702,25 @@ GF_Err gf_isom_parse_movie_boxes(GF_ISOFile *mov, u64 *bytesMissing, Bool progre
 					}
 
 				}
+			} else if (mov->lazy_max_frags) {
+				/*only pure fragmented files are handled, otherwise merge everything as usual*/
+				if (!mov->nb_lazy_frags) {
+					u32 k;
+					for (k=0; mov->moov && (k<gf_list_count(mov->moov->trackList)); k++) {
+						GF_TrackBox *trak = gf_list_get(mov->moov->trackList, k);
+						if (trak->Media->information->sampleTable->SampleSize->sampleCount) break;
+					}
+					if (!mov->moov || mov->is_smooth || mov->single_moof_mode || (k<gf_list_count(mov->moov->trackList)))
+						mov->lazy_max_frags = 0;
+				}
+				if (mov->lazy_max_frags) {
+					e = LazyIndexFragment((GF_MovieFragmentBox *)a, mov);
+				} else {
+					e = MergeFragment((GF_MovieFragmentBox *)a, mov);
+				}
+				mov->moof = NULL;
+				gf_isom_box_del(a);
+				if (e) return e;
 			} else if (mov->openMode==GF_ISOM_OPEN_CAT_FRAGMENTS) {
 				mov->NextMoofNumber = mov->moof->mfhd->sequence_number+1;
 				mov->moof = NULL;
@@ -545,7 +856,7 @@ GF_ISOFile *gf_isom_open_file(const char *fileName, u32 OpenMode, const char *tm
 	mov->fileName = gf_strdup(fileName);
 	mov->openMode = OpenMode;
 
-	if ( (OpenMode == GF_ISOM_OPEN_READ) || (OpenMode == GF_ISOM_OPEN_READ_DUMP) ) {
+	if ( (OpenMode == GF_ISOM_OPEN_READ) || (OpenMode == GF_ISOM_OPEN_READ_DUMP) || (OpenMode == GF_ISOM_OPEN_READ_LAZY) ) {
 		//always in read ...
 		mov->openMode = GF_ISOM_OPEN_READ;
 		mov->es_id_default_sync = -1;
@@ -568,6 +879,11 @@ GF_ISOFile *gf_isom_open_file(const char *fileName, u32 OpenMode, const char *tm
 			mov->FragmentsFlags |= GF_ISOM_FRAG_READ_DEBUG;
 #endif
 		}
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+		else if (OpenMode == GF_ISOM_OPEN_READ_LAZY) {
+			mov->lazy_max_frags = GF_ISOM_LAZY_FRAGMENT_WINDOW;
+		}
+#endif
 	} else {
 
 #ifdef GPAC_DISABLE_ISOM_WRITE
@@ -663,6 +979,8 @@ void gf_isom_delete_movie(GF_ISOFile *mov)
 		gf_free(mov->sidx_pts_store);
 	if (mov->sidx_pts_next_store)
 		gf_free(mov->sidx_pts_next_store);
+	if (mov->lazy_moof_offsets)
+		gf_free(mov->lazy_moof_offsets);
 #endif
 	if (mov->last_producer_ref_time)
 		gf_isom_box_del((GF_Box *) mov->last_producer_ref_time);
@@ -1115,7 +1433,15 @@ u32 gf_isom_sample_get_subsample_entry(GF_ISOFile *movie, u32 track, u32 sampleN
 	GF_SubSampleInformationBox *sub_samples=NULL;
 	GF_TrackBox *trak = gf_isom_get_track_from_file(movie, track);
 	if (sub_sample) *sub_sample = NULL;
-	if (!track) return 0;
+	if (!trak || !sampleNumber) return 0;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	/*in lazy fragment mode, the sample tables only describe the loaded fragments*/
+	if (movie->lazy_max_frags) {
+		gf_isom_lazy_load_sample(movie, trak, sampleNumber);
+		if (sampleNumber<=trak->sample_count_at_seg_start) return 0;
+		sampleNumber -= trak->sample_count_at_seg_start;
+	}
+#endif
 	if (!trak->Media || !trak->Media->information->sampleTable || !trak->Media->information->sampleTable->sub_samples) return 0;
 	count = gf_list_count(trak->Media->information->sampleTable->sub_samples);
 	for (i=0; i<count; i++) {
@@ -85,7 +85,7 @@ GF_EXPORT
 void gf_isom_sample_del(GF_ISOSample **samp)
 {
 	if (! *samp) return;
-	if ((*samp)->data && (*samp)->dataLength) gf_free((*samp)->data);
+	if ((*samp)->data && ((*samp)->dataLength || (*samp)->alloc_size)) gf_free((*samp)->data);
 	gf_free(*samp);
 	*samp = NULL;
 }
@@ -411,6 +411,7 @@ GF_ISOFile *gf_isom_open(const char *fileName, u32 OpenMode, const char *tmp_dir
 	switch (OpenMode & 0xFF) {
 	case GF_ISOM_OPEN_READ_DUMP:
 	case GF_ISOM_OPEN_READ:
+	case GF_ISOM_OPEN_READ_LAZY:
 		movie = gf_isom_open_file(fileName, OpenMode, NULL);
 		break;
 
@@ -790,7 +791,10 @@ u64 gf_isom_get_duration(GF_ISOFile *movie)
 	//the duration of a movie is the MaxDuration of all the tracks...
 
 #ifndef GPAC_DISABLE_ISOM_WRITE
-	gf_isom_update_duration(movie);
+#ifndef GPAC_DISABLE_ISOM_FRAGMENTS
+	if (!movie->nb_lazy_frags)
+#endif
+		gf_isom_update_duration(movie);
 #endif /*GPAC_DISABLE_ISOM_WRITE*/
 
 	return movie->moov->mvhd->duration;
@@ -873,8 +877,12 @@ u64 gf_isom_get_track_duration(GF_ISOFile *movie, u32 trackNumber)
 	if (!trak) return 0;
 
 #ifndef GPAC_DISABLE_ISOM_WRITE
-	/*in all modes except dump recompute duration in case headers are wrong*/
-	if (movie->openMode != GF_ISOM_OPEN_READ_DUMP) {
+	/*in all modes except dump recompute duration in case headers are wrong - in lazy fragment mode, it is computed from the fragment index*/
+	if ((movie->openMode != GF_ISOM_OPEN_READ_DUMP)
+#ifndef GPAC_DISABLE_ISOM_FRAGMENTS
+	        && !movie->nb_lazy_frags
+#endif
+	   ) {
 		SetTrackDuration(trak);
 	}
 #endif
@@ -1163,8 +1171,12 @@ u64 gf_isom_get_media_duration(GF_ISOFile *movie, u32 trackNumber)
 
 #ifndef GPAC_DISABLE_ISOM_WRITE
 
-	/*except in dump mode always recompute the duration*/
-	if (movie->openMode != GF_ISOM_OPEN_READ_DUMP) {
+	/*except in dump mode always recompute the duration - in lazy fragment mode, it is computed from the fragment index*/
+	if ((movie->openMode != GF_ISOM_OPEN_READ_DUMP)
+#ifndef GPAC_DISABLE_ISOM_FRAGMENTS
+	        && !movie->nb_lazy_frags
+#endif
+	   ) {
 		if ( (movie->LastError = Media_SetDuration(trak)) ) return 0;
 	}
 
@@ -1478,6 +1490,13 @@ u32 gf_isom_get_sample_count(GF_ISOFile *the_file, u32 trackNumber)
 	GF_TrackBox *trak;
 	trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !trak->Media->information->sampleTable->SampleSize) return 0;
+#ifndef GPAC_DISABLE_ISOM_FRAGMENTS
+	/*in lazy fragment mode, the sample tables only describe the loaded fragments*/
+	if (the_file->nb_lazy_frags && trak->frag_ranges) {
+		GF_TrackFragmentRange *last = &trak->frag_ranges[the_file->nb_lazy_frags-1];
+		return last->first_sample + last->nb_samples;
+	}
+#endif
 	return trak->Media->information->sampleTable->SampleSize->sampleCount
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
 	       + trak->sample_count_at_seg_start
@@ -1491,6 +1510,8 @@ u32 gf_isom_get_constant_sample_size(GF_ISOFile *the_file, u32 trackNumber)
 	GF_TrackBox *trak;
 	trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak) return 0;
+	//in compact tables, sampleSize is the field size
+	if (trak->Media->information->sampleTable->SampleSize->type == GF_ISOM_BOX_TYPE_STZ2) return 0;
 	return trak->Media->information->sampleTable->SampleSize->sampleSize;
 }
 
@@ -1518,7 +1539,7 @@ Bool gf_isom_enable_raw_pack(GF_ISOFile *the_file, u32 trackNumber, u32 pack_num
 	if (trak->Media->information->sampleTable->TimeToSample->nb_entries != 1) return GF_FALSE;
 	if (trak->Media->information->sampleTable->TimeToSample->entries[0].sampleDelta != 1) return GF_FALSE;
 	//and sample with constant size
-	if (!trak->Media->information->sampleTable->SampleSize->sampleSize) return GF_FALSE;
+	if (!gf_isom_get_constant_sample_size(the_file, trackNumber)) return GF_FALSE;
 	trak->pack_num_samples = pack_num_samples;
 	return pack_num_samples ? GF_TRUE : GF_FALSE;
 }
@@ -1577,7 +1598,15 @@ GF_Err gf_isom_get_sample_flags(GF_ISOFile *the_file, u32 trackNumber, u32 sampl
 	*dependedOn = 0;
 	*redundant = 0;
 	trak = gf_isom_get_track_from_file(the_file, trackNumber);
-	if (!trak) return GF_BAD_PARAM;
+	if (!trak || !sampleNumber) return GF_BAD_PARAM;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	/*in lazy fragment mode, the sample tables only describe the loaded fragments*/
+	if (the_file->lazy_max_frags) {
+		gf_isom_lazy_load_sample(the_file, trak, sampleNumber);
+		if (sampleNumber<=trak->sample_count_at_seg_start) return GF_BAD_PARAM;
+		sampleNumber -= trak->sample_count_at_seg_start;
+	}
+#endif
 	if (!trak->Media->information->sampleTable->SampleDep) return GF_BAD_PARAM;
 	return stbl_GetSampleDepType(trak->Media->information->sampleTable->SampleDep, sampleNumber, isLeading, dependsOn, dependedOn, redundant);
 }
@@ -1586,7 +1615,7 @@ GF_Err gf_isom_get_sample_flags(GF_ISOFile *the_file, u32 trackNumber, u32 sampl
 //this index allows to retrieve the stream description if needed (2 media in 1 track)
 //return NULL if error
 GF_EXPORT
-GF_ISOSample *gf_isom_get_sample(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *sampleDescriptionIndex)
+GF_ISOSample *gf_isom_get_sample_ex(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *sampleDescriptionIndex, GF_ISOSample *static_sample)
 {
 	GF_Err e;
 	u32 descIndex;
@@ -1596,21 +1625,35 @@ GF_ISOSample *gf_isom_get_sample(GF_ISOFile *the_file, u32 trackNumber, u32 samp
 	if (!trak) return NULL;
 
 	if (!sampleNumber) return NULL;
-	samp = gf_isom_sample_new();
-	if (!samp) return NULL;
+	if (static_sample) {
+		samp = static_sample;
+		/*buffer not allocated by us (user-provided or previous gf_isom_get_sample), don't reuse it*/
+		if (!samp->alloc_size) samp->data = NULL;
+		samp->dataLength = 0;
+		samp->nb_pack = 0;
+	} else {
+		samp = gf_isom_sample_new();
+		if (!samp) return NULL;
+	}
 
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
-	if (sampleNumber<=trak->sample_count_at_seg_start)
+	if (the_file->lazy_max_frags) gf_isom_lazy_load_sample(the_file, trak, sampleNumber);
+	if (sampleNumber<=trak->sample_count_at_seg_start) {
+		if (!static_sample) gf_isom_sample_del(&samp);
 		return NULL;
+	}
 	sampleNumber -= trak->sample_count_at_seg_start;
 #endif
 
 	e = Media_GetSample(trak->Media, sampleNumber, &samp, &descIndex, GF_FALSE, NULL);
 	if (e) {
 		gf_isom_set_last_error(the_file, e);
-		gf_isom_sample_del(&samp);
+		if (!static_sample) gf_isom_sample_del(&samp);
 		return NULL;
 	}
+	/*first fetch in a static sample, keep the allocated buffer for the next ones*/
+	if (static_sample && !samp->alloc_size && samp->data)
+		samp->alloc_size = samp->dataLength;
 	if (sampleDescriptionIndex) *sampleDescriptionIndex = descIndex;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
 	if (samp) samp->DTS += trak->dts_at_seg_start;
@@ -1619,6 +1662,12 @@ GF_ISOSample *gf_isom_get_sample(GF_ISOFile *the_file, u32 trackNumber, u32 samp
 	return samp;
 }
 
+GF_EXPORT
+GF_ISOSample *gf_isom_get_sample(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *sampleDescriptionIndex)
+{
+	return gf_isom_get_sample_ex(the_file, trackNumber, sampleNumber, sampleDescriptionIndex, NULL);
+}
+
 GF_EXPORT
 u32 gf_isom_get_sample_duration(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber)
 {
@@ -1627,6 +1676,7 @@ u32 gf_isom_get_sample_duration(GF_ISOFile *the_file, u32 trackNumber, u32 sampl
 	GF_TrackBox *trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !sampleNumber) return 0;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	if (the_file->lazy_max_frags) gf_isom_lazy_load_sample(the_file, trak, sampleNumber);
 	if (sampleNumber<=trak->sample_count_at_seg_start) return 0;
 	sampleNumber -= trak->sample_count_at_seg_start;
 #endif
@@ -1643,6 +1693,7 @@ u32 gf_isom_get_sample_size(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNum
 	GF_TrackBox *trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !sampleNumber) return 0;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	if (the_file->lazy_max_frags) gf_isom_lazy_load_sample(the_file, trak, sampleNumber);
 	if (sampleNumber<=trak->sample_count_at_seg_start) return 0;
 	sampleNumber -= trak->sample_count_at_seg_start;
 #endif
@@ -1658,6 +1709,9 @@ u8 gf_isom_get_sample_sync(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumb
 	GF_TrackBox *trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak || !sampleNumber) return 0;
 
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	if (the_file->lazy_max_frags) gf_isom_lazy_load_sample(the_file, trak, sampleNumber);
+#endif
 	if (! trak->Media->information->sampleTable->SyncSample) return 1;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
 	if (sampleNumber<=trak->sample_count_at_seg_start) return 0;
@@ -1680,6 +1734,7 @@ GF_ISOSample *gf_isom_get_sample_info(GF_ISOFile *the_file, u32 trackNumber, u32
 
 	if (!sampleNumber) return NULL;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	if (the_file->lazy_max_frags) gf_isom_lazy_load_sample(the_file, trak, sampleNumber);
 	if (sampleNumber<=trak->sample_count_at_seg_start) return NULL;
 	sampleNumber -= trak->sample_count_at_seg_start;
 #endif
@@ -1697,6 +1752,52 @@ GF_ISOSample *gf_isom_get_sample_info(GF_ISOFile *the_file, u32 trackNumber, u32
 	return samp;
 }
 
+GF_EXPORT
+GF_ISOSample *gf_isom_get_sample_ref(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *sampleDescriptionIndex, u64 *data_offset)
+{
+	GF_Err e;
+	u32 descIndex, type;
+	GF_TrackBox *trak;
+	GF_SampleEntryBox *entry;
+	GF_ISOSample *samp;
+	trak = gf_isom_get_track_from_file(the_file, trackNumber);
+	if (!trak || !data_offset) return NULL;
+
+	if (!sampleNumber) return NULL;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	if (the_file->lazy_max_frags) gf_isom_lazy_load_sample(the_file, trak, sampleNumber);
+	if (sampleNumber<=trak->sample_count_at_seg_start) return NULL;
+	sampleNumber -= trak->sample_count_at_seg_start;
+#endif
+	if (!sampleDescriptionIndex) sampleDescriptionIndex = &descIndex;
+	samp = gf_isom_sample_new();
+	if (!samp) return NULL;
+	e = Media_GetSample(trak->Media, sampleNumber, &samp, sampleDescriptionIndex, GF_TRUE, data_offset);
+	if (!e) e = Media_GetSampleDesc(trak->Media, *sampleDescriptionIndex, &entry, NULL);
+	if (!e) {
+		type = trak->Media->handler->handlerType;
+		/*samples rewritten when fetched*/
+		if ((type == GF_ISOM_MEDIA_OD) || trak->pack_num_samples
+		        || (the_file->convert_streaming_text && ((type == GF_ISOM_MEDIA_TEXT) || (type == GF_ISOM_MEDIA_SUBT)))
+		   ) {
+			e = GF_NOT_SUPPORTED;
+		}
+		/*same test as in Media_GetSample*/
+		else if (gf_isom_is_nalu_based_entry(trak->Media, entry) && !gf_isom_is_track_encrypted(the_file, trackNumber)) {
+			e = gf_isom_nalu_sample_refine_sap(trak->Media, samp, *data_offset, (GF_MPEGVisualSampleEntryBox *)entry);
+		}
+	}
+	if (e) {
+		gf_isom_set_last_error(the_file, e);
+		gf_isom_sample_del(&samp);
+		return NULL;
+	}
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	samp->DTS += trak->dts_at_seg_start;
+#endif
+	return samp;
+}
+
 //same as gf_isom_get_sample but doesn't fetch media data
 GF_EXPORT
 u64 gf_isom_get_sample_dts(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber)
@@ -1708,10 +1809,15 @@ u64 gf_isom_get_sample_dts(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumb
 
 	if (!sampleNumber) return 0;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	if (the_file->lazy_max_frags) gf_isom_lazy_load_sample(the_file, trak, sampleNumber);
 	if (sampleNumber<=trak->sample_count_at_seg_start) return 0;
 	sampleNumber -= trak->sample_count_at_seg_start;
 #endif
 	if (stbl_GetSampleDTS(trak->Media->information->sampleTable->TimeToSample, sampleNumber, &dts) != GF_OK) return 0;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	/*sample tables only describe the loaded fragments*/
+	if (the_file->lazy_max_frags) dts += trak->dts_at_seg_start;
+#endif
 	return dts;
 }
 
@@ -1768,6 +1874,7 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 	stbl = trak->Media->information->sampleTable;
 
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	if (the_file->lazy_max_frags) gf_isom_lazy_load_time(the_file, trak, desiredTime);
 	if (desiredTime < trak->dts_at_seg_start) {
 		desiredTime = 0;
 	} else {
@@ -1784,11 +1891,24 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 		SearchMode = GF_ISOM_SEARCH_SYNC_BACKWARD;
 
 	//if no syncTable, disable syncSearching, as all samples ARE sync
-	if (! trak->Media->information->sampleTable->SyncSample) {
+	//in lazy fragment mode, this only applies to the loaded fragments
+	if (! trak->Media->information->sampleTable->SyncSample
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	        && !the_file->lazy_max_frags
+#endif
+	   ) {
 		if (SearchMode == GF_ISOM_SEARCH_SYNC_FORWARD) SearchMode = GF_ISOM_SEARCH_FORWARD;
 		if (SearchMode == GF_ISOM_SEARCH_SYNC_BACKWARD) SearchMode = GF_ISOM_SEARCH_BACKWARD;
 	}
 
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	//in lazy fragment mode, the time may be after the last loaded sample but not after the last sample
+	if (the_file->lazy_max_frags && !sampleNumber && !prevSampleNumber
+	        && (stbl->SampleSize->sampleCount + trak->sample_count_at_seg_start < gf_isom_get_sample_count(the_file, trackNumber))) {
+		prevSampleNumber = stbl->SampleSize->sampleCount;
+	}
+#endif
+
 	//not found, return EOF or browse backward
 	if (!sampleNumber && !prevSampleNumber) {
 		if (SearchMode == GF_ISOM_SEARCH_SYNC_BACKWARD || SearchMode == GF_ISOM_SEARCH_BACKWARD) {
@@ -1809,7 +1929,14 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 		if (!sampleNumber) {
 			if (prevSampleNumber != stbl->SampleSize->sampleCount) {
 				sampleNumber = prevSampleNumber + 1;
-			} else {
+			}
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+			//in lazy fragment mode, the next sample may be in the next fragment
+			else if (the_file->lazy_max_frags && (prevSampleNumber + trak->sample_count_at_seg_start < gf_isom_get_sample_count(the_file, trackNumber))) {
+				sampleNumber = prevSampleNumber + 1;
+			}
+#endif
+			else {
 				sampleNumber = prevSampleNumber;
 			}
 		}
@@ -1830,6 +1957,24 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 		break;
 	}
 
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	//in lazy fragment mode, the sample or its sync sample may be in a fragment not loaded yet
+	if (the_file->lazy_max_frags) {
+		u32 num = sampleNumber + trak->sample_count_at_seg_start;
+		gf_isom_lazy_load_sample(the_file, trak, num);
+		if (IsSync) {
+			syncNum = gf_isom_lazy_find_sync(the_file, trak, num, SearchMode);
+			if (syncNum) {
+				num = syncNum;
+				gf_isom_lazy_load_sample(the_file, trak, num);
+			}
+			IsSync = 0;
+		}
+		stbl = trak->Media->information->sampleTable;
+		sampleNumber = num - trak->sample_count_at_seg_start;
+	}
+#endif
+
 	//get the sync sample num
 	if (IsSync) {
 		//get the SyncNumber
@@ -1877,7 +2022,11 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 	}
 	if (! (*sample)->IsRAP) {
 		Bool has_roll, is_rap;
-		e = gf_isom_get_sample_rap_roll_info(the_file, trackNumber, sampleNumber, &is_rap, &has_roll, NULL);
+		u32 num = sampleNumber;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+		if (the_file->lazy_max_frags) num += trak->sample_count_at_seg_start;
+#endif
+		e = gf_isom_get_sample_rap_roll_info(the_file, trackNumber, num, &is_rap, &has_roll, NULL);
 		if (e) return e;
 		if (is_rap) (*sample)->IsRAP = SAP_TYPE_3;
 	}
@@ -1888,6 +2037,10 @@ GF_Err gf_isom_get_sample_for_media_time(GF_ISOFile *the_file, u32 trackNumber,
 		*SampleNum += trak->sample_count_at_seg_start;
 #endif
 	}
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	/*in lazy fragment mode, the sample tables only describe the loaded fragments*/
+	if (the_file->lazy_max_frags) (*sample)->DTS += trak->dts_at_seg_start;
+#endif
 
 	//in shadow mode, we only get the data of the shadowing sample !
 	if (useShadow) {
@@ -2016,7 +2169,8 @@ GF_Err gf_isom_get_sample_for_movie_time(GF_ISOFile *the_file, u32 trackNumber,
 	}
 	if (sampleNumber) *sampleNumber = sampNum;
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
-	if ( (*sample) ) (*sample)->DTS += trak->dts_at_seg_start;
+	/*already done in lazy fragment mode*/
+	if ( (*sample) && !the_file->lazy_max_frags) (*sample)->DTS += trak->dts_at_seg_start;
 #endif
 
 	return GF_OK;
@@ -2189,13 +2343,21 @@ GF_Err gf_isom_get_alternate_brand(GF_ISOFile *movie, u32 BrandIndex, u32 *brand
 	return GF_OK;
 }
 
+GF_EXPORT
 GF_Err gf_isom_get_sample_padding_bits(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u8 *NbBits)
 {
 	GF_TrackBox *trak;
 
 	trak = gf_isom_get_track_from_file(the_file, trackNumber);
-	if (!trak) return GF_BAD_PARAM;
-
+	if (!trak || !sampleNumber) return GF_BAD_PARAM;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	/*in lazy fragment mode, the sample tables only describe the loaded fragments*/
+	if (the_file->lazy_max_frags) {
+		gf_isom_lazy_load_sample(the_file, trak, sampleNumber);
+		if (sampleNumber<=trak->sample_count_at_seg_start) return GF_BAD_PARAM;
+		sampleNumber -= trak->sample_count_at_seg_start;
+	}
+#endif
 
 	//Padding info
 	return stbl_GetPaddingBits(trak->Media->information->sampleTable->PaddingBits,
@@ -2511,7 +2673,7 @@ GF_Err gf_isom_get_fragment_defaults(GF_ISOFile *the_file, u32 trackNumber,
 	}
 	//size
 	if (defaultSize) {
-		*defaultSize = stbl->SampleSize->sampleSize;
+		*defaultSize = (stbl->SampleSize->type == GF_ISOM_BOX_TYPE_STZ2) ? 0 : stbl->SampleSize->sampleSize;
 	}
 	//descIndex
 	if (defaultDescriptionIndex) {
@@ -2633,6 +2795,15 @@ void gf_isom_set_single_moof_mode(GF_ISOFile *movie, Bool mode)
 {
 	movie->single_moof_mode = mode;
 }
+
+GF_EXPORT
+GF_Err gf_isom_set_lazy_fragment_window(GF_ISOFile *movie, u32 nb_frags)
+{
+	if (!movie || !nb_frags) return GF_BAD_PARAM;
+	if (!movie->lazy_max_frags) return GF_NOT_SUPPORTED;
+	movie->lazy_max_frags = nb_frags;
+	return GF_OK;
+}
 #endif
 
 GF_EXPORT
@@ -2697,6 +2868,11 @@ GF_Err gf_isom_reset_tables(GF_ISOFile *movie, Bool reset_sample_count)
 
 		gf_isom_box_array_del(stbl->sai_sizes);
 		stbl->sai_sizes = NULL;
+		/*the CENC saiz/saio built when merging fragments were just destroyed*/
+		if (trak->sample_encryption) {
+			trak->sample_encryption->cenc_saiz = NULL;
+			trak->sample_encryption->cenc_saio = NULL;
+		}
 
 		gf_isom_box_array_del(stbl->sampleGroups);
 		stbl->sampleGroups = NULL;
@@ -3309,7 +3485,7 @@ u64 gf_isom_get_media_data_size(GF_ISOFile *movie, u32 trackNumber)
 	GF_TrackBox *tk = gf_isom_get_track_from_file(movie, trackNumber);
 	if (!tk) return 0;
 	stsz = tk->Media->information->sampleTable->SampleSize;
-	if (stsz->sampleSize) return stsz->sampleSize*stsz->sampleCount;
+	if (stsz->sampleSize && (stsz->type != GF_ISOM_BOX_TYPE_STZ2)) return stsz->sampleSize*stsz->sampleCount;
 	size = 0;
 	for (i=0; i<stsz->sampleCount; i++) size += stsz->sizes[i];
 	return size;
@@ -3650,14 +3826,15 @@ u32 gf_isom_get_next_alternate_group_id(GF_ISOFile *movie)
 }
 
 
+GF_EXPORT
 u32 gf_isom_sample_has_subsamples(GF_ISOFile *movie, u32 track, u32 sampleNumber, u32 flags)
 {
 	GF_TrackBox *trak = gf_isom_get_track_from_file(movie, track);
 	if (!trak) return GF_BAD_PARAM;
-	if (!trak->Media->information->sampleTable->sub_samples) return 0;
 	return gf_isom_sample_get_subsample_entry(movie, track, sampleNumber, flags, NULL);
 }
 
+GF_EXPORT
 GF_Err gf_isom_sample_get_subsample(GF_ISOFile *movie, u32 track, u32 sampleNumber, u32 flags, u32 subSampleNumber, u32 *size, u8 *priority, u32 *reserved, Bool *discardable)
 {
 	GF_SubSampleEntry *entry;
@@ -3787,6 +3964,14 @@ GF_Err gf_isom_get_sample_rap_roll_info(GF_ISOFile *the_file, u32 trackNumber, u
 
 	trak = gf_isom_get_track_from_file(the_file, trackNumber);
 	if (!trak) return GF_BAD_PARAM;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	/*in lazy fragment mode, the sample tables only describe the loaded fragments*/
+	if (sample_number && the_file->lazy_max_frags) {
+		gf_isom_lazy_load_sample(the_file, trak, sample_number);
+		if (sample_number<=trak->sample_count_at_seg_start) return GF_OK;
+		sample_number -= trak->sample_count_at_seg_start;
+	}
+#endif
 	if (!trak->Media->information->sampleTable->sampleGroups) return GF_OK;
 
 	if (!sample_number) {
@@ -4268,9 +4453,17 @@ GF_Err gf_isom_get_sample_cenc_info(GF_ISOFile *movie, u32 track, u32 sample_num
 									u8 *crypt_byte_block, u8 *skip_byte_block, u8 *constant_IV_size, bin128 *constant_IV)
 {
 	GF_TrackBox *trak = gf_isom_get_track_from_file(movie, track);
-	GF_SampleEncryptionBox *senc = trak->sample_encryption;
+	if (!trak || !sample_number) return GF_BAD_PARAM;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	/*in lazy fragment mode, the sample tables only describe the loaded fragments*/
+	if (movie->lazy_max_frags) {
+		gf_isom_lazy_load_sample(movie, trak, sample_number);
+		if (sample_number<=trak->sample_count_at_seg_start) return GF_BAD_PARAM;
+		sample_number -= trak->sample_count_at_seg_start;
+	}
+#endif
 
-	return gf_isom_get_sample_cenc_info_ex(trak, NULL, senc, sample_number, IsEncrypted, IV_size, KID, crypt_byte_block, skip_byte_block, constant_IV_size, constant_IV);
+	return gf_isom_get_sample_cenc_info_ex(trak, NULL, trak->sample_encryption, sample_number, IsEncrypted, IV_size, KID, crypt_byte_block, skip_byte_block, constant_IV_size, constant_IV);
 }
 
 GF_EXPORT
@@ -4457,6 +4650,14 @@ Bool gf_isom_sample_was_traf_start(GF_ISOFile *movie, u32 trackNumber, u32 sampl
 
 	trak = gf_isom_get_track_from_file(movie, trackNumber);
 	if (!trak || !trak->Media) return GF_FALSE;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	/*in lazy fragment mode, the sample tables only describe the loaded fragments*/
+	if (movie->lazy_max_frags) {
+		gf_isom_lazy_load_sample(movie, trak, sampleNum);
+		if (sampleNum<=trak->sample_count_at_seg_start) return GF_FALSE;
+		sampleNum -= trak->sample_count_at_seg_start;
+	}
+#endif
 	if (!trak->Media->information->sampleTable->traf_map) return GF_FALSE;
 
 	tmap = trak->Media->information->sampleTable->traf_map;
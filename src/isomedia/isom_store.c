@@ -92,8 +92,19 @@ typedef struct
 	u32 size;
 	GF_ISOFile *movie;
 	u32 total_samples, nb_done;
+	/*in capture mode, set if the moov is written in the space reserved before the media data*/
+	Bool moov_in_reserve;
 } MovieWriter;
 
+/*in capture mode, checks if the moov fits in the space reserved before the media data, the remaining bytes (if any) being a free box*/
+static Bool MoovFitsReserve(GF_ISOFile *movie, u64 moov_size)
+{
+	if (!movie->moov_reserve_offset) return GF_FALSE;
+	if (moov_size == movie->moov_reserve_size) return GF_TRUE;
+	if (moov_size + 8 <= movie->moov_reserve_size) return GF_TRUE;
+	return GF_FALSE;
+}
+
 void CleanWriters(GF_List *writers)
 {
 	TrackWriter *writer;
@@ -160,7 +171,7 @@ GF_Err SetupWriters(MovieWriter *mw, GF_List *writers, u8 interleaving)
 		writer->chunkDur = 0;
 		writer->chunkSize = 0;
 		writer->constant_size = writer->constant_dur = 0;
-		if (writer->stbl->SampleSize->sampleSize)
+		if (writer->stbl->SampleSize->sampleSize && (writer->stbl->SampleSize->type != GF_ISOM_BOX_TYPE_STZ2))
 			writer->constant_size = writer->stbl->SampleSize->sampleSize;
 		if (writer->stbl->TimeToSample->nb_entries==1) {
 			writer->constant_dur = writer->stbl->TimeToSample->entries[0].sampleDelta;
@@ -311,6 +322,7 @@ static GF_Err WriteMoovAndMeta(GF_ISOFile *movie, GF_List *writers, GF_BitStream
 		//switch all our tables
 		i=0;
 		while ((writer = (TrackWriter*)gf_list_enum(writers, &i))) {
+			stbl_CompactSampleToChunk(writer->stsc);
 			//don't delete them !!!
 			stsc = writer->stbl->SampleToChunk;
 			stco = writer->stbl->ChunkOffset;
@@ -357,6 +369,7 @@ u64 GetMoovAndMetaSize(GF_ISOFile *movie, GF_List *writers)
 		while ((writer = (TrackWriter*)gf_list_enum(writers, &i))) {
 			size -= writer->stbl->ChunkOffset->size;
 			size -= writer->stbl->SampleToChunk->size;
+			stbl_CompactSampleToChunk(writer->stsc);
 			gf_isom_box_size((GF_Box *)writer->stsc);
 			gf_isom_box_size(writer->stco);
 			size += writer->stsc->size;
@@ -640,7 +653,9 @@ GF_Err DoWrite(MovieWriter *mw, GF_List *writers, GF_BitStream *bs, u8 Emulation
 			e = stbl_GetSampleSize(writer->stbl->SampleSize, writer->sampleNumber, &sampSize);
 			if (e) return e;
 
-			update_writer_constant_dur(movie, writer, stsc_ent, &nb_samp, &sampSize, GF_TRUE);
+			//sample runs may exceed the max chunk duration, write sample by sample
+			if (!writer->stbl->MaxChunkDur)
+				update_writer_constant_dur(movie, writer, stsc_ent, &nb_samp, &sampSize, GF_TRUE);
 
 			//update our chunks.
 			force = 0;
@@ -656,6 +671,20 @@ GF_Err DoWrite(MovieWriter *mw, GF_List *writers, GF_BitStream *bs, u8 Emulation
 			}
 			writer->chunkSize += sampSize;
 
+			if (writer->stbl->MaxChunkDur) {
+				u64 DTS;
+				u32 sample_dur;
+				stbl_GetSampleDTS_and_Duration(writer->stbl->TimeToSample, writer->sampleNumber, &DTS, &sample_dur);
+				if (force) {
+					writer->chunkDur = 0;
+				} else if (writer->chunkDur && (writer->chunkDur + sample_dur > writer->stbl->MaxChunkDur)) {
+					writer->chunkDur = 0;
+					writer->chunkSize = sampSize;
+					force = 1;
+				}
+				writer->chunkDur += sample_dur;
+			}
+
 			self_contained = ((writer->all_dref_mode==ISOM_DREF_SELF) || Media_IsSelfContained(writer->mdia, descIndex) ) ? GF_TRUE : GF_FALSE;
 
 			//update our global offset...
@@ -745,6 +774,7 @@ GF_Err WriteFlat(MovieWriter *mw, u8 moovFirst, GF_BitStream *bs, GF_BitStream *
 				if (movie->is_jp2) begin += 12;
 				if (movie->brand) begin += movie->brand->size;
 				if (movie->pdin) begin += movie->pdin->size;
+				if (movie->moov_reserve_offset) begin += movie->moov_reserve_size;
 			}
 			totSize -= begin;
 		} else {
@@ -813,18 +843,26 @@ GF_Err WriteFlat(MovieWriter *mw, u8 moovFirst, GF_BitStream *bs, GF_BitStream *
 
 			firstSize = GetMoovAndMetaSize(movie, writers);
 
-			offset = firstSize;
-			e = ShiftOffset(movie, writers, offset);
-			if (e) goto exit;
-			//get the size and see if it has changed (eg, we moved to 64 bit offsets)
-			finalSize = GetMoovAndMetaSize(movie, writers);
-			if (firstSize != finalSize) {
-				finalOffset = finalSize;
-				//OK, now we're sure about the final size.
-				//we don't need to re-emulate, as the only thing that changed is the offset
-				//so just shift the offset
-				e = ShiftOffset(movie, writers, finalOffset - offset);
+			//the moov fits in the reserved space, media data does not move and offsets are already correct
+			if (MoovFitsReserve(movie, firstSize)) {
+				mw->moov_in_reserve = GF_TRUE;
+			} else {
+				if (movie->moov_reserve_offset) {
+					GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[IsoMedia] moov size "LLU" exceeds the %d bytes reserved, moving media data\n", firstSize, movie->moov_reserve_size));
+				}
+				offset = firstSize;
+				e = ShiftOffset(movie, writers, offset);
 				if (e) goto exit;
+				//get the size and see if it has changed (eg, we moved to 64 bit offsets)
+				finalSize = GetMoovAndMetaSize(movie, writers);
+				if (firstSize != finalSize) {
+					finalOffset = finalSize;
+					//OK, now we're sure about the final size.
+					//we don't need to re-emulate, as the only thing that changed is the offset
+					//so just shift the offset
+					e = ShiftOffset(movie, writers, finalOffset - offset);
+					if (e) goto exit;
+				}
 			}
 		}
 		//OK, write the movie box.
@@ -1448,6 +1486,16 @@ GF_Err WriteToFile(GF_ISOFile *movie)
 		}
 	}
 
+	if (movie->moov) {
+		u32 i;
+		GF_TrackBox *trak;
+		i=0;
+		while ( (trak = gf_list_enum(movie->moov->trackList, &i))) {
+			e = stbl_CompactTables(trak->Media->information->sampleTable, GF_FALSE);
+			if (e) return e;
+		}
+	}
+
 	//capture mode: we don't need a new bitstream
 	if (movie->openMode == GF_ISOM_OPEN_WRITE) {
 		GF_BitStream *moov_bs = NULL;
@@ -1461,8 +1509,22 @@ GF_Err WriteToFile(GF_ISOFile *movie)
 
 			gf_bs_get_content(moov_bs, &moov_data, &moov_size);
 			gf_bs_del(moov_bs);
-			if (!e)
+			if (!e && mw.moov_in_reserve) {
+				//write the moov in the reserved space and mark the remaining bytes as free
+				GF_BitStream *file_bs = movie->editFileMap->bs;
+				u64 end = gf_bs_get_position(file_bs);
+				e = gf_bs_seek(file_bs, movie->moov_reserve_offset);
+				if (!e) {
+					gf_bs_write_data(file_bs, moov_data, moov_size);
+					if (moov_size < movie->moov_reserve_size) {
+						gf_bs_write_u32(file_bs, movie->moov_reserve_size - moov_size);
+						gf_bs_write_u32(file_bs, GF_ISOM_BOX_TYPE_FREE);
+					}
+					e = gf_bs_seek(file_bs, end);
+				}
+			} else if (!e) {
 				e = gf_bs_insert_data(movie->editFileMap->bs, (u8 *) moov_data, moov_size, movie->mdat->bsOffset);
+			}
 
 			gf_free(moov_data);
 		}
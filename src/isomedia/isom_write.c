@@ -74,6 +74,24 @@ GF_Err FlushCaptureMode(GF_ISOFile *movie)
 		e = gf_isom_box_write((GF_Box *)movie->pdin, movie->editFileMap->bs);
 		if (e) return e;
 	}
+	/*reserve space for the moov, rewritten at the end if storing in streamable mode*/
+	if (movie->moov_reserve_size) {
+		GF_FreeSpaceBox *reserve = (GF_FreeSpaceBox *) gf_isom_box_new(GF_ISOM_BOX_TYPE_FREE);
+		if (!reserve) return GF_OUT_OF_MEM;
+		reserve->dataSize = movie->moov_reserve_size - 8;
+		movie->moov_reserve_offset = gf_bs_get_position(movie->editFileMap->bs);
+		e = gf_isom_box_size((GF_Box *)reserve);
+		if (!e) e = gf_isom_box_write((GF_Box *)reserve, movie->editFileMap->bs);
+		gf_isom_box_del((GF_Box *)reserve);
+		if (e) return e;
+
+		movie->moov_size_estimate = 0;
+		if (movie->moov) {
+			e = gf_isom_box_size((GF_Box *)movie->moov);
+			if (e) return e;
+			movie->moov_size_estimate = movie->moov->size;
+		}
+	}
 	movie->mdat->bsOffset = gf_bs_get_position(movie->editFileMap->bs);
 
 	/*we have a trick here: the data will be stored on the fly, so the first
@@ -83,6 +101,20 @@ GF_Err FlushCaptureMode(GF_ISOFile *movie)
 	return GF_OK;
 }
 
+/*bytes added to the moov for each sample in capture mode: size, time to sample and chunk offset entries*/
+#define MOOV_ESTIMATE_SAMPLE_SIZE	12
+
+static void UpdateMoovEstimate(GF_ISOFile *movie)
+{
+	if (!movie->moov_reserve_offset) return;
+	if (movie->moov_size_estimate > movie->moov_reserve_size) return;
+
+	movie->moov_size_estimate += MOOV_ESTIMATE_SAMPLE_SIZE;
+	if (movie->moov_size_estimate > movie->moov_reserve_size) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[IsoMedia] Estimated moov size exceeds the %d bytes reserved, the file will be rewritten when stored\n", movie->moov_reserve_size));
+	}
+}
+
 static GF_Err CheckNoData(GF_ISOFile *movie)
 {
 	if (movie->openMode != GF_ISOM_OPEN_WRITE) return GF_OK;
@@ -746,6 +778,7 @@ GF_Err gf_isom_add_sample(GF_ISOFile *movie, u32 trackNumber, u32 StreamDescript
 			if (e) return e;
 		}
 	}
+	UpdateMoovEstimate(movie);
 
 	if (!movie->keep_utc)
 		trak->Media->mediaHeader->modificationTime = gf_isom_get_mp4time();
@@ -818,6 +851,7 @@ GF_Err gf_isom_add_sample_shadow(GF_ISOFile *movie, u32 trackNumber, GF_ISOSampl
 	}
 	if (e) return e;
 	if (offset_times) sample->DTS -= 1;
+	UpdateMoovEstimate(movie);
 
 	//OK, update duration
 	e = Media_SetDuration(trak);
@@ -943,6 +977,84 @@ GF_Err gf_isom_add_sample_reference(GF_ISOFile *movie, u32 trackNumber, u32 Stre
 
 }
 
+//opens the self-contained data map of the given sample description for writing
+static GF_Err isom_open_write_data_map(GF_ISOFile *movie, GF_TrackBox *trak, u32 StreamDescriptionIndex, u32 *descIndex)
+{
+	GF_Err e;
+	GF_SampleEntryBox *entry;
+	GF_DataEntryURLBox *Dentry;
+	u32 dataRefIndex;
+
+	e = FlushCaptureMode(movie);
+	if (e) return e;
+
+	e = unpack_track(trak);
+	if (e) return e;
+
+	*descIndex = StreamDescriptionIndex;
+	if (!StreamDescriptionIndex) {
+		*descIndex = trak->Media->information->sampleTable->currentEntryIndex;
+	}
+	e = Media_GetSampleDesc(trak->Media, *descIndex, &entry, &dataRefIndex);
+	if (e) return e;
+	if (!entry || !dataRefIndex) return GF_BAD_PARAM;
+
+	Dentry = (GF_DataEntryURLBox*)gf_list_get(trak->Media->information->dataInformation->dref->other_boxes, dataRefIndex - 1);
+	if (!Dentry || Dentry->flags != 1) return GF_BAD_PARAM;
+
+	return gf_isom_datamap_open(trak->Media, dataRefIndex, 1);
+}
+
+GF_EXPORT
+GF_Err gf_isom_add_sample_data_from_file(GF_ISOFile *movie, u32 trackNumber, u32 StreamDescriptionIndex, FILE *src, u64 src_offset, u64 size, u64 *data_offset)
+{
+	GF_Err e;
+	GF_TrackBox *trak;
+	u32 descIndex;
+
+	e = CanAccessMovie(movie, GF_ISOM_OPEN_WRITE);
+	if (e) return e;
+
+	trak = gf_isom_get_track_from_file(movie, trackNumber);
+	if (!trak || !src || !data_offset) return GF_BAD_PARAM;
+	if (trak->Media->handler->handlerType == GF_ISOM_MEDIA_OD) return GF_BAD_PARAM;
+
+	e = isom_open_write_data_map(movie, trak, StreamDescriptionIndex, &descIndex);
+	if (e) return e;
+
+	*data_offset = gf_isom_datamap_get_offset(trak->Media->information->dataHandler);
+	if (!size) return GF_OK;
+	return gf_isom_datamap_add_file_range(trak->Media->information->dataHandler, src, src_offset, size);
+}
+
+GF_EXPORT
+GF_Err gf_isom_add_sample_at_offset(GF_ISOFile *movie, u32 trackNumber, u32 StreamDescriptionIndex, const GF_ISOSample *sample, u64 data_offset)
+{
+	GF_Err e;
+	GF_TrackBox *trak;
+	u32 descIndex;
+
+	e = CanAccessMovie(movie, GF_ISOM_OPEN_WRITE);
+	if (e) return e;
+
+	trak = gf_isom_get_track_from_file(movie, trackNumber);
+	if (!trak || !sample) return GF_BAD_PARAM;
+	if (trak->Media->handler->handlerType == GF_ISOM_MEDIA_OD) return GF_BAD_PARAM;
+
+	e = isom_open_write_data_map(movie, trak, StreamDescriptionIndex, &descIndex);
+	if (e) return e;
+	//set the current to this one
+	trak->Media->information->sampleTable->currentEntryIndex = descIndex;
+
+	e = Media_AddSample(trak->Media, data_offset, sample, descIndex, 0);
+	if (e) return e;
+	UpdateMoovEstimate(movie);
+
+	if (!movie->keep_utc)
+		trak->Media->mediaHeader->modificationTime = gf_isom_get_mp4time();
+	return SetTrackDuration(trak);
+}
+
 //set the duration of the last media sample. If not set, the duration of the last sample is the
 //duration of the previous one if any, or 1000 (default value).
 GF_EXPORT
@@ -1829,6 +1941,22 @@ GF_Err gf_isom_set_storage_mode(GF_ISOFile *movie, u8 storageMode)
 	}
 }
 
+GF_EXPORT
+GF_Err gf_isom_reserve_moov_space(GF_ISOFile *movie, u32 nb_bytes)
+{
+	GF_Err e;
+	e = CanAccessMovie(movie, GF_ISOM_OPEN_WRITE);
+	if (e) return e;
+	if (movie->openMode != GF_ISOM_OPEN_WRITE) return GF_ISOM_INVALID_MODE;
+	/*the reserved space is written before the media data*/
+	e = CheckNoData(movie);
+	if (e) return e;
+
+	if (nb_bytes && (nb_bytes < 8)) nb_bytes = 8;
+	movie->moov_reserve_size = nb_bytes;
+	return GF_OK;
+}
+
 GF_EXPORT
 void gf_isom_force_64bit_chunk_offset(GF_ISOFile *file, Bool set_on)
 {
@@ -2611,7 +2739,9 @@ GF_Err gf_isom_use_compact_size(GF_ISOFile *movie, u32 trackNumber, u8 Compactio
 		//this is a weird table indeed ;)
 		if (stsz->sizes) gf_free(stsz->sizes);
 		stsz->sizes = (u32*) gf_malloc(sizeof(u32)*stsz->sampleCount);
-		memset(stsz->sizes, stsz->sampleSize, sizeof(u32));
+		if (!stsz->sizes) return GF_OUT_OF_MEM;
+		stsz->alloc_size = stsz->sampleCount;
+		for (i=0; i<stsz->sampleCount; i++) stsz->sizes[i] = stsz->sampleSize;
 	}
 	//set the SampleSize to 0 while the file is open
 	stsz->sampleSize = 0;
@@ -4506,6 +4636,44 @@ GF_Err gf_isom_hint_max_chunk_size(GF_ISOFile *movie, u32 trackNumber, u32 maxCh
 	return GF_OK;
 }
 
+//set the max chunk duration in media timescale (for file optimization)
+GF_EXPORT
+GF_Err gf_isom_hint_max_chunk_duration(GF_ISOFile *movie, u32 trackNumber, u32 maxChunkDur)
+{
+	GF_TrackBox *trak;
+
+	if (movie->openMode == GF_ISOM_OPEN_READ) return GF_ISOM_INVALID_MODE;
+	trak = gf_isom_get_track_from_file(movie, trackNumber);
+	if (!trak) return GF_BAD_PARAM;
+
+	trak->Media->information->sampleTable->MaxChunkDur = maxChunkDur;
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_isom_compact_sample_tables(GF_ISOFile *movie, u32 trackNumber, Bool use_compact_size)
+{
+	GF_TrackBox *trak;
+	GF_Err e;
+	u32 i;
+
+	e = CanAccessMovie(movie, GF_ISOM_OPEN_WRITE);
+	if (e) return e;
+
+	if (trackNumber) {
+		trak = gf_isom_get_track_from_file(movie, trackNumber);
+		if (!trak) return GF_BAD_PARAM;
+		return stbl_CompactTables(trak->Media->information->sampleTable, use_compact_size);
+	}
+	if (!movie->moov) return GF_OK;
+	i=0;
+	while ((trak = (GF_TrackBox *)gf_list_enum(movie->moov->trackList, &i))) {
+		e = stbl_CompactTables(trak->Media->information->sampleTable, use_compact_size);
+		if (e) return e;
+	}
+	return GF_OK;
+}
+
 
 GF_EXPORT
 GF_Err gf_isom_set_extraction_slc(GF_ISOFile *the_file, u32 trackNumber, u32 StreamDescriptionIndex, GF_SLConfig *slConfig)
@@ -387,9 +387,10 @@ Bool Media_IsSampleSyncShadow(GF_ShadowSyncBox *stsh, u32 sampleNumber)
 GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp, u32 *sIDX, Bool no_data, u64 *out_offset)
 {
 	GF_Err e;
-	u32 bytesRead;
+	u32 bytesRead, data_len;
 	u32 dataRefIndex, chunkNumber;
 	u64 offset, new_size;
+	char *data_ptr;
 	GF_SampleEntryBox *entry;
 	GF_StscEntry *stsc_entry;
 
@@ -486,8 +487,15 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 			(*samp)->nb_pack = left_in_chunk;
 		}
 
-		/*and finally get the data, include padding if needed*/
-		(*samp)->data = (char *) gf_malloc(sizeof(char) * ( (*samp)->dataLength + mdia->mediaTrack->padding_bytes) );
+		/*and finally get the data, include padding if needed - reuse the sample buffer if any*/
+		if ((*samp)->alloc_size) {
+			if ((*samp)->alloc_size < (*samp)->dataLength + mdia->mediaTrack->padding_bytes) {
+				(*samp)->alloc_size = (*samp)->dataLength + mdia->mediaTrack->padding_bytes;
+				(*samp)->data = (char *) gf_realloc((*samp)->data, sizeof(char) * (*samp)->alloc_size);
+			}
+		} else {
+			(*samp)->data = (char *) gf_malloc(sizeof(char) * ( (*samp)->dataLength + mdia->mediaTrack->padding_bytes) );
+		}
 		if (mdia->mediaTrack->padding_bytes)
 			memset((*samp)->data + (*samp)->dataLength, 0, sizeof(char) * mdia->mediaTrack->padding_bytes);
 
@@ -510,6 +518,9 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 		mdia->BytesMissing = 0;
 	}
 
+	data_ptr = (*samp)->data;
+	data_len = (*samp)->dataLength;
+
 	//finally rewrite the sample if this is an OD Access Unit or NAL-based one
 	//we do this even if sample size is zero because of sample implicit reconstruction rules (especially tile tracks)
 	if (mdia->handler->handlerType == GF_ISOM_MEDIA_OD) {
@@ -537,6 +548,9 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 		e = gf_isom_rewrite_text_sample(*samp, *sIDX, (u32) dur);
 		if (e) return e;
 	}
+	/*rewriters reallocate the sample data to its new size*/
+	if ((*samp)->alloc_size && (((*samp)->data != data_ptr) || ((*samp)->dataLength != data_len)))
+		(*samp)->alloc_size = (*samp)->dataLength;
 	return GF_OK;
 }
 
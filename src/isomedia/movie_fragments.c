@@ -895,7 +895,7 @@ GF_Err StoreFragment(GF_ISOFile *movie, Bool load_mdat_only, s32 data_offset_dif
 		if (e) return e;
 		//we assume we never write large MDATs in fragment mode which should always be true
 		mdat_size = (u32) (moof_start - movie->moof->fragment_offset);
-		gf_bs_write_u32(bs, (u32) mdat_size);
+		gf_bs_write_u32(bs, (u32) (mdat_size + movie->moof->data_refs_size));
 		gf_bs_write_u32(bs, GF_ISOM_BOX_TYPE_MDAT);
 		e = gf_bs_seek(bs, moof_start);
 		if (e) return e;
@@ -1000,6 +1000,14 @@ GF_Err StoreFragment(GF_ISOFile *movie, Bool load_mdat_only, s32 data_offset_dif
 		gf_bs_write_data(bs, buffer, mdat_size);
 		gf_free(buffer);
 	}
+	//and copy sample data added by reference
+	for (i=0; i<movie->moof->nb_data_refs; i++) {
+		GF_FragmentDataRef *ref = &movie->moof->data_refs[i];
+		if (gf_bs_write_file_range(bs, movie->moof->data_refs_src, ref->offset, ref->size) != ref->size) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso fragment] Failed to copy "LLU" bytes of sample data at offset "LLU"\n", ref->size, ref->offset));
+			return GF_IO_ERR;
+		}
+	}
 
 	if (moof_size) *moof_size = (u32) movie->moof->size;
 
@@ -2044,9 +2052,8 @@ u32 GetRunSize(GF_TrackFragmentRunBox *trun)
 	return size;
 }
 
-GF_EXPORT
-GF_Err gf_isom_fragment_add_sample(GF_ISOFile *movie, u32 TrackID, const GF_ISOSample *sample, u32 DescIndex,
-                                   u32 Duration, u8 PaddingBits, u16 DegradationPriority, Bool redundant_coding)
+static GF_Err isom_fragment_add_sample(GF_ISOFile *movie, u32 TrackID, const GF_ISOSample *sample, u32 DescIndex,
+                                   u32 Duration, u8 PaddingBits, u16 DegradationPriority, Bool redundant_coding, FILE *src, u64 src_offset)
 {
 	u32 count, buffer_size;
 	char *buffer;
@@ -2062,10 +2069,25 @@ GF_Err gf_isom_fragment_add_sample(GF_ISOFile *movie, u32 TrackID, const GF_ISOS
 	if (!traf)
 		return GF_BAD_PARAM;
 
+	if (src) {
+		/*referenced data is copied after the moof at store time, only supported for moof first without segments or caching*/
+		if (!movie->moof_first || movie->use_segments || traf->DataCache)
+			return GF_NOT_SUPPORTED;
+		if (traf->trex->track->Media->handler->handlerType == GF_ISOM_MEDIA_OD)
+			return GF_NOT_SUPPORTED;
+		if (movie->moof->data_refs_src && (movie->moof->data_refs_src != src))
+			return GF_BAD_PARAM;
+	}
+	/*referenced data is written at the end of the mdat, we cannot add regular data after it*/
+	else if (movie->moof->nb_data_refs && sample->dataLength) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso fragment] Cannot add sample data after samples added by reference in the same fragment\n"));
+		return GF_BAD_PARAM;
+	}
+
 	if (!traf->tfhd->sample_desc_index)
 		traf->tfhd->sample_desc_index = DescIndex ? DescIndex : traf->trex->def_sample_desc_index;
 
-	pos = gf_bs_get_position(movie->editFileMap->bs);
+	pos = gf_bs_get_position(movie->editFileMap->bs) + movie->moof->data_refs_size;
 
 
 	//WARNING: we change stream description, create a new TRAF
@@ -2100,7 +2122,7 @@ GF_Err gf_isom_fragment_add_sample(GF_ISOFile *movie, u32 TrackID, const GF_ISOS
 		traf = traf_2;
 	}
 
-	pos = gf_bs_get_position(movie->editFileMap->bs);
+	pos = gf_bs_get_position(movie->editFileMap->bs) + movie->moof->data_refs_size;
 	//add TRUN entry
 	count = gf_list_count(traf->TrackRuns);
 	if (count) {
@@ -2165,7 +2187,28 @@ GF_Err gf_isom_fragment_add_sample(GF_ISOFile *movie, u32 TrackID, const GF_ISOS
 	}
 
 	//finally write the data
-	if (sample->dataLength) {
+	if (src) {
+		if (sample->dataLength) {
+			GF_FragmentDataRef *ref = movie->moof->nb_data_refs ? &movie->moof->data_refs[movie->moof->nb_data_refs-1] : NULL;
+			//merge contiguous ranges
+			if (ref && (ref->offset + ref->size == src_offset)) {
+				ref->size += sample->dataLength;
+			} else {
+				if (movie->moof->nb_data_refs == movie->moof->alloc_data_refs) {
+					movie->moof->alloc_data_refs = movie->moof->alloc_data_refs ? 2*movie->moof->alloc_data_refs : 32;
+					movie->moof->data_refs = (GF_FragmentDataRef*)gf_realloc(movie->moof->data_refs, sizeof(GF_FragmentDataRef) * movie->moof->alloc_data_refs);
+					if (!movie->moof->data_refs) return GF_OUT_OF_MEM;
+				}
+				ref = &movie->moof->data_refs[movie->moof->nb_data_refs];
+				ref->offset = src_offset;
+				ref->size = sample->dataLength;
+				movie->moof->nb_data_refs++;
+			}
+			movie->moof->data_refs_size += sample->dataLength;
+			movie->moof->data_refs_src = src;
+		}
+	}
+	else if (sample->dataLength) {
 		if (!traf->DataCache) {
 			if (!gf_bs_write_data(movie->editFileMap->bs, sample->data, sample->dataLength)) {
 				GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[iso fragment] Could not add a sample with a size of %u bytes (no DataCache)\n", sample->dataLength));
@@ -2195,6 +2238,21 @@ GF_Err gf_isom_fragment_add_sample(GF_ISOFile *movie, u32 TrackID, const GF_ISOS
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_isom_fragment_add_sample(GF_ISOFile *movie, u32 TrackID, const GF_ISOSample *sample, u32 DescIndex,
+                                   u32 Duration, u8 PaddingBits, u16 DegradationPriority, Bool redundant_coding)
+{
+	return isom_fragment_add_sample(movie, TrackID, sample, DescIndex, Duration, PaddingBits, DegradationPriority, redundant_coding, NULL, 0);
+}
+
+GF_EXPORT
+GF_Err gf_isom_fragment_add_sample_ref(GF_ISOFile *movie, u32 TrackID, const GF_ISOSample *sample, u32 DescIndex,
+                                   u32 Duration, u8 PaddingBits, u16 DegradationPriority, Bool redundant_coding, FILE *src, u64 src_offset)
+{
+	if (!src) return GF_BAD_PARAM;
+	return isom_fragment_add_sample(movie, TrackID, sample, DescIndex, Duration, PaddingBits, DegradationPriority, redundant_coding, src, src_offset);
+}
+
 GF_EXPORT
 GF_Err gf_isom_fragment_add_sai(GF_ISOFile *output, GF_ISOFile *input, u32 TrackID, u32 SampleNum, u32 SampleDescIndex)
 {
@@ -2308,6 +2366,7 @@ GF_Err gf_isom_fragment_append_data(GF_ISOFile *movie, u32 TrackID, char *data,
 
 	//finally write the data
 	if (!traf->DataCache) {
+		if (movie->moof->nb_data_refs) return GF_BAD_PARAM;
 		gf_bs_write_data(movie->editFileMap->bs, data, data_size);
 	} else if (trun->cache) {
 		gf_bs_write_data(trun->cache, data, data_size);
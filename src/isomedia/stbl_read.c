@@ -474,8 +474,8 @@ sample_found:
 	
 	//ok, get the size of all the previous samples in the chunk
 	offsetInChunk = 0;
-	//constant size
-	if (stbl->SampleSize->sampleSize) {
+	//constant size - in compact tables, sampleSize is the field size
+	if (stbl->SampleSize->sampleSize && (stbl->SampleSize->type != GF_ISOM_BOX_TYPE_STZ2)) {
 		u32 diff = sampleNumber - stbl->SampleToChunk->firstSampleInCurrentChunk;
 		offsetInChunk += diff * stbl->SampleSize->sampleSize;
 	} else {
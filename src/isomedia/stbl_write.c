@@ -582,7 +582,13 @@ GF_Err stbl_AppendDependencyType(GF_SampleTableBox *stbl, u32 isLeading, u32 dep
 	flags |= dependedOn << 2;
 	flags |= redundant;
 
-
+	/*samples appended without dependency info (packed fragment runs) have no dependency flags, so that entries stay aligned with sample numbers*/
+	if (stbl->SampleSize && (sdtp->sampleCount + 1 < stbl->SampleSize->sampleCount)) {
+		sdtp->sample_info = (u8*) gf_realloc(sdtp->sample_info, sizeof(u8) * (stbl->SampleSize->sampleCount - 1));
+		if (!sdtp->sample_info) return GF_OUT_OF_MEM;
+		memset(sdtp->sample_info + sdtp->sampleCount, 0, sizeof(u8) * (stbl->SampleSize->sampleCount - 1 - sdtp->sampleCount));
+		sdtp->sampleCount = stbl->SampleSize->sampleCount - 1;
+	}
 	sdtp->sample_info = (u8*) gf_realloc(sdtp->sample_info, sizeof(u8) * (sdtp->sampleCount + 1));
 	if (!sdtp->sample_info) return GF_OUT_OF_MEM;
 	sdtp->sample_info[sdtp->sampleCount] = flags;
@@ -1942,6 +1948,114 @@ GF_Err stbl_SetChunkAndOffset(GF_SampleTableBox *stbl, u32 sampleNumber, u32 Str
 	return GF_OK;
 }
 
+//merges consecutive sample to chunk entries with the same chunk layout
+void stbl_CompactSampleToChunk(GF_SampleToChunkBox *stsc)
+{
+	u32 i, j;
+	if (!stsc || (stsc->nb_entries<2)) return;
+
+	j=0;
+	for (i=1; i<stsc->nb_entries; i++) {
+		GF_StscEntry *ent = &stsc->entries[j];
+		GF_StscEntry *next = &stsc->entries[i];
+		if ((ent->samplesPerChunk == next->samplesPerChunk)
+		        && (ent->sampleDescriptionIndex == next->sampleDescriptionIndex)
+		        && (ent->isEdited == next->isEdited)
+		   ) {
+			ent->nextChunk = next->nextChunk;
+			continue;
+		}
+		j++;
+		if (j != i) stsc->entries[j] = *next;
+	}
+	if (j+1 == stsc->nb_entries) return;
+	stsc->nb_entries = j+1;
+	//reset the read cache
+	stsc->currentIndex = 0;
+	stsc->firstSampleInCurrentChunk = 0;
+	stsc->currentChunk = 0;
+	stsc->ghostNumber = 0;
+}
+
+//merges redundant entries in time to sample, composition offset and sample size tables
+//sample to chunk tables are rebuilt by the writers and compacted when storing the file
+GF_Err stbl_CompactTables(GF_SampleTableBox *stbl, Bool use_compact_size)
+{
+	u32 i, j, size;
+	GF_TimeToSampleBox *stts;
+	GF_CompositionOffsetBox *ctts;
+	GF_SampleSizeBox *stsz;
+	if (!stbl) return GF_BAD_PARAM;
+
+	stts = stbl->TimeToSample;
+	if (stts && (stts->nb_entries>1)) {
+		j=0;
+		for (i=1; i<stts->nb_entries; i++) {
+			//a last entry of packed samples with no delta is still being written, don't merge it
+			if ((i+1==stts->nb_entries) && !stts->entries[i].sampleDelta && (stts->entries[i].sampleCount>1))
+				break;
+			if (stts->entries[j].sampleDelta == stts->entries[i].sampleDelta) {
+				stts->entries[j].sampleCount += stts->entries[i].sampleCount;
+				continue;
+			}
+			j++;
+			if (j != i) stts->entries[j] = stts->entries[i];
+		}
+		if (i<stts->nb_entries) {
+			j++;
+			if (j != i) stts->entries[j] = stts->entries[i];
+		}
+		if (j+1 != stts->nb_entries) {
+			stts->nb_entries = j+1;
+			stts->r_FirstSampleInEntry = stts->r_currentEntryIndex = 0;
+			stts->r_CurrentDTS = 0;
+		}
+	}
+
+	ctts = stbl->CompositionOffset;
+	//in unpack mode, entries are merged when repacking
+	if (ctts && !ctts->unpack_mode && (ctts->nb_entries>1)) {
+		j=0;
+		for (i=1; i<ctts->nb_entries; i++) {
+			if (ctts->entries[j].decodingOffset == ctts->entries[i].decodingOffset) {
+				ctts->entries[j].sampleCount += ctts->entries[i].sampleCount;
+				continue;
+			}
+			j++;
+			if (j != i) ctts->entries[j] = ctts->entries[i];
+		}
+		if (j+1 != ctts->nb_entries) {
+			ctts->nb_entries = j+1;
+			ctts->r_FirstSampleInEntry = ctts->r_currentEntryIndex = 0;
+		}
+	}
+
+	stsz = stbl->SampleSize;
+	if (!stsz || !stsz->sampleCount || stsz->sampleSize || !stsz->sizes) return GF_OK;
+	//stz2 tables are checked for constant sizes at write time
+	if (stsz->type == GF_ISOM_BOX_TYPE_STZ2) return GF_OK;
+
+	size = stsz->sizes[0];
+	for (i=1; i<stsz->sampleCount; i++) {
+		if (stsz->sizes[i] != size) break;
+	}
+	if (i==stsz->sampleCount) {
+		gf_free(stsz->sizes);
+		stsz->sizes = NULL;
+		stsz->alloc_size = 0;
+		stsz->sampleSize = size;
+		return GF_OK;
+	}
+	if (!use_compact_size) return GF_OK;
+
+	//use a compact table if all sizes fit on 16 bits, the field size is chosen at write time
+	for (i=0; i<stsz->sampleCount; i++) {
+		if (stsz->sizes[i] > 0xFFFF) return GF_OK;
+	}
+	stsz->type = GF_ISOM_BOX_TYPE_STZ2;
+	return GF_OK;
+}
+
 GF_EXPORT
 GF_Err gf_isom_refresh_size_info(GF_ISOFile *file, u32 trackNumber)
 {
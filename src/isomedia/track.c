@@ -420,6 +420,35 @@ GF_Err SetTrackDuration(GF_TrackBox *trak)
 
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
 
+/*extends the edits with an empty duration by the duration of a merged track fragment*/
+void MergeTrackEditDuration(GF_TrackBox *trak, u64 traf_duration)
+{
+	u32 i;
+	if (!traf_duration || !trak->editBox || !trak->editBox->editList) return;
+
+	for (i=0; i<gf_list_count(trak->editBox->editList->entryList); i++) {
+		GF_EdtsEntry *ent = gf_list_get(trak->editBox->editList->entryList, i);
+		if (ent->was_empty_dur) {
+			u64 extend_dur = traf_duration;
+			extend_dur *= trak->moov->mvhd->timeScale;
+			extend_dur /= trak->Media->mediaHeader->timeScale;
+			ent->segmentDuration += extend_dur;
+		}
+		else if (!ent->segmentDuration) {
+			ent->was_empty_dur = GF_TRUE;
+			if ((s64) traf_duration > ent->mediaTime)
+				traf_duration -= ent->mediaTime;
+			else
+				traf_duration = 0;
+
+			ent->segmentDuration = traf_duration;
+			ent->segmentDuration *= trak->moov->mvhd->timeScale;
+			ent->segmentDuration /= trak->Media->mediaHeader->timeScale;
+		}
+
+	}
+}
+
 GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, u64 moof_offset, u64 *cumulated_offset, Bool is_first_merge)
 {
 	u32 i, j, chunk_size, track_num;
@@ -575,29 +604,9 @@ GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, u64 moof_offset,
 			stbl_AppendDependencyType(trak->Media->information->sampleTable, GF_ISOM_GET_FRAG_LEAD(flags), GF_ISOM_GET_FRAG_DEPENDS(flags), GF_ISOM_GET_FRAG_DEPENDED(flags), GF_ISOM_GET_FRAG_REDUNDANT(flags));
 		}
 	}
-	if (traf_duration && trak->editBox && trak->editBox->editList) {
-		for (i=0; i<gf_list_count(trak->editBox->editList->entryList); i++) {
-			GF_EdtsEntry *ent = gf_list_get(trak->editBox->editList->entryList, i);
-			if (ent->was_empty_dur) {
-				u64 extend_dur = traf_duration;
-				extend_dur *= trak->moov->mvhd->timeScale;
-				extend_dur /= trak->Media->mediaHeader->timeScale;
-				ent->segmentDuration += extend_dur;
-			}
-			else if (!ent->segmentDuration) {
-				ent->was_empty_dur = GF_TRUE;
-				if ((s64) traf_duration > ent->mediaTime)
-					traf_duration -= ent->mediaTime;
-				else
-					traf_duration = 0;
-
-				ent->segmentDuration = traf_duration;
-				ent->segmentDuration *= trak->moov->mvhd->timeScale;
-				ent->segmentDuration /= trak->Media->mediaHeader->timeScale;
-			}
-
-		}
-	}
+	/*in lazy fragment mode, edits are extended when indexing the fragment*/
+	if (!trak->moov->mov->lazy_max_frags)
+		MergeTrackEditDuration(trak, traf_duration);
 
 	//in any case, update the cumulated offset
 	//this will handle hypothetical files mixing MOOF offset and implicit non-moof offset
@@ -935,9 +935,8 @@ static void gf_dash_load_segment_timeline(GF_DASHSegmenter *dasher, GF_BitStream
 	count = gf_cfg_get_key_count(dasher->dash_ctx, "SegmentsStartTimes");
 	for (i=0; i<count; i++) {
 		u64 start, dur;
-		const char *fileName = gf_cfg_get_key_name(dasher->dash_ctx, "SegmentsStartTimes", i);
-		const char *MPDTime = gf_cfg_get_key(dasher->dash_ctx, "SegmentsStartTimes", fileName);
-		if (!fileName)
+		const char *MPDTime = gf_cfg_get_key_value(dasher->dash_ctx, "SegmentsStartTimes", i);
+		if (!MPDTime)
 			break;
 
 		sscanf(MPDTime, ""LLU"-"LLU"-"LLU"@%s", &start, &dur, &scale, szRepID);
@@ -1780,8 +1779,7 @@ restart_fragmentation_pass:
 		char sKey[100];
 		count = gf_cfg_get_key_count(dasher->dash_ctx, RepURLsSecName);
 		for (i=0; i<count; i++) {
-			const char *key_name = gf_cfg_get_key_name(dasher->dash_ctx, RepURLsSecName, i);
-			opt = gf_cfg_get_key(dasher->dash_ctx, RepURLsSecName, key_name);
+			opt = gf_cfg_get_key_value(dasher->dash_ctx, RepURLsSecName, i);
 			sprintf(szMPDTempLine, "      %s\n", opt);
 			gf_bs_write_data(mpd_bs, szMPDTempLine, (u32) strlen(szMPDTempLine));
 		}
@@ -3134,37 +3132,47 @@ write_rep_only:
 		period_duration += (u64)segment_start_time; //change to get a Double period duration
 		count = gf_list_count(fragmenters);
 		for (i=0; i<count; i++) {
+			char szKeys[6][100], szVals[6][100];
+			const char *keys[6], *vals[6];
+			u32 j, nb_keys = 0;
 			tf = (GF_ISOMTrackFragmenter *)gf_list_get(fragmenters, i);
 
 			/*InitialTSOffset is used when joining different files - if we are still in the same file , do not update it*/
 			if (tf->done) {
-				sprintf(sKey, "TKID_%d_NextDecodingTime", tf->TrackID);
-				sprintf(sOpt, LLU, tf->InitialTSOffset + tf->next_sample_dts);
-				gf_cfg_set_key(dasher->dash_ctx, RepSecName, sKey, sOpt);
+				sprintf(szKeys[nb_keys], "TKID_%d_NextDecodingTime", tf->TrackID);
+				sprintf(szVals[nb_keys], LLU, tf->InitialTSOffset + tf->next_sample_dts);
+				vals[nb_keys] = szVals[nb_keys];
+				nb_keys++;
 			}
 
 			if (dasher->subduration) {
-				sprintf(sKey, "TKID_%d_NextSampleNum", tf->TrackID);
-				sprintf(sOpt, "%d", tf->SampleNum);
-				gf_cfg_set_key(dasher->dash_ctx, RepSecName, sKey, tf->done ? NULL : sOpt);
-
-				sprintf(sKey, "TKID_%d_LastSampleCTS", tf->TrackID);
-				sprintf(sOpt, LLU, tf->last_sample_cts);
-				gf_cfg_set_key(dasher->dash_ctx, RepSecName, sKey, tf->done ? NULL : sOpt);
-
-				sprintf(sKey, "TKID_%d_NextSampleDTS", tf->TrackID);
-				sprintf(sOpt, LLU, tf->next_sample_dts);
-				gf_cfg_set_key(dasher->dash_ctx, RepSecName, sKey, tf->done ? NULL : sOpt);
-
-				sprintf(sKey, "TKID_%d_MediaTimeToPresTime", tf->TrackID);
-				sprintf(sOpt, "%d", tf->media_time_to_pres_time_shift);
-				gf_cfg_set_key(dasher->dash_ctx, RepSecName, sKey, sOpt);
-
-				sprintf(sKey, "TKID_%d_LoopTSOffset", tf->TrackID);
-				sprintf(sOpt, LLU, tf->loop_ts_offset);
-				gf_cfg_set_key(dasher->dash_ctx, RepSecName, sKey, (tf->done && dasher->disable_loop) ? NULL : sOpt);
-
-			}
+				sprintf(szKeys[nb_keys], "TKID_%d_NextSampleNum", tf->TrackID);
+				sprintf(szVals[nb_keys], "%d", tf->SampleNum);
+				vals[nb_keys] = tf->done ? NULL : szVals[nb_keys];
+				nb_keys++;
+
+				sprintf(szKeys[nb_keys], "TKID_%d_LastSampleCTS", tf->TrackID);
+				sprintf(szVals[nb_keys], LLU, tf->last_sample_cts);
+				vals[nb_keys] = tf->done ? NULL : szVals[nb_keys];
+				nb_keys++;
+
+				sprintf(szKeys[nb_keys], "TKID_%d_NextSampleDTS", tf->TrackID);
+				sprintf(szVals[nb_keys], LLU, tf->next_sample_dts);
+				vals[nb_keys] = tf->done ? NULL : szVals[nb_keys];
+				nb_keys++;
+
+				sprintf(szKeys[nb_keys], "TKID_%d_MediaTimeToPresTime", tf->TrackID);
+				sprintf(szVals[nb_keys], "%d", tf->media_time_to_pres_time_shift);
+				vals[nb_keys] = szVals[nb_keys];
+				nb_keys++;
+
+				sprintf(szKeys[nb_keys], "TKID_%d_LoopTSOffset", tf->TrackID);
+				sprintf(szVals[nb_keys], LLU, tf->loop_ts_offset);
+				vals[nb_keys] = (tf->done && dasher->disable_loop) ? NULL : szVals[nb_keys];
+				nb_keys++;
+			}
+			for (j=0; j<nb_keys; j++) keys[j] = szKeys[j];
+			gf_cfg_set_keys(dasher->dash_ctx, RepSecName, nb_keys, keys, vals);
 		}
 		sprintf(sOpt, "%d", cur_seg);
 		gf_cfg_set_key(dasher->dash_ctx, RepSecName, "NextSegmentIndex", sOpt);
@@ -4974,8 +4982,7 @@ static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *
 			u32 count, i;
 			count = gf_cfg_get_key_count(dasher->dash_ctx, szRepURLsSecName);
 			for (i=0; i<count; i++) {
-				const char *key_name = gf_cfg_get_key_name(dasher->dash_ctx, szRepURLsSecName, i);
-				opt = gf_cfg_get_key(dasher->dash_ctx, szRepURLsSecName, key_name);
+				opt = gf_cfg_get_key_value(dasher->dash_ctx, szRepURLsSecName, i);
 				fprintf(dasher->mpd, "     %s\n", opt);
 			}
 		}
@@ -5101,26 +5108,22 @@ static GF_Err dasher_mp2t_segment_file(GF_DashSegInput *dash_input, const char *
 	fprintf(dasher->mpd, "   </Representation>\n");
 
 	if (dasher->dash_ctx) {
-		sprintf(szOpt, "%u", bandwidth);
-		gf_cfg_set_key(dasher->dash_ctx, szSectionName, "Bandwidth", szOpt);
-
-		sprintf(szOpt, "%u", segment_index);
-		gf_cfg_set_key(dasher->dash_ctx, szSectionName, "StartIndex", szOpt);
-
-		sprintf(szOpt, LLU, (u64) (dasher->dash_scale*ts_seg.segment_duration) );
-		gf_cfg_set_key(dasher->dash_ctx, szSectionName, "CumulatedDuration", szOpt);
-
-		sprintf(szOpt, LLU, next_pcr_shift + pcr_shift);
-		gf_cfg_set_key(dasher->dash_ctx, szSectionName, "PCR90kOffset", szOpt);
+		char szVals[7][100];
+		const char *vals[7];
+		const char *keys[7] = {"Bandwidth", "StartIndex", "CumulatedDuration", "PCR90kOffset", "ByteOffset", "DurationAtLastPass", "InitialDTSOffset"};
 
-		sprintf(szOpt, LLU, ts_seg.suspend_indexing);
-		gf_cfg_set_key(dasher->dash_ctx, szSectionName, "ByteOffset", ts_seg.suspend_indexing ? szOpt : NULL);
-
-		sprintf(szOpt, LLD, ts_seg.duration_at_last_pass);
-		gf_cfg_set_key(dasher->dash_ctx, szSectionName, "DurationAtLastPass", ts_seg.suspend_indexing ? szOpt : NULL);
-
-		sprintf(szOpt, LLU, ts_seg.PCR_DTS_initial_diff);
-		gf_cfg_set_key(dasher->dash_ctx, szSectionName, "InitialDTSOffset", ts_seg.suspend_indexing ? szOpt : NULL);
+		sprintf(szVals[0], "%u", bandwidth);
+		sprintf(szVals[1], "%u", segment_index);
+		sprintf(szVals[2], LLU, (u64) (dasher->dash_scale*ts_seg.segment_duration) );
+		sprintf(szVals[3], LLU, next_pcr_shift + pcr_shift);
+		sprintf(szVals[4], LLU, ts_seg.suspend_indexing);
+		sprintf(szVals[5], LLD, ts_seg.duration_at_last_pass);
+		sprintf(szVals[6], LLU, ts_seg.PCR_DTS_initial_diff);
+		for (i=0; i<7; i++) {
+			/*resume info is only kept when indexing was suspended*/
+			vals[i] = ((i>=4) && !ts_seg.suspend_indexing) ? NULL : szVals[i];
+		}
+		gf_cfg_set_keys(dasher->dash_ctx, szSectionName, 7, keys, vals);
 	}
 
 	if (ts_seg.sidx && ts_seg.index_bs) {
@@ -6056,7 +6059,7 @@ static Bool gf_dasher_cleanup(GF_DASHSegmenter *dasher)
 			char szSecName[200];
 			u32 j;
 			const char *fileName = gf_cfg_get_key_name(dasher->dash_ctx, "SegmentsStartTimes", i);
-			const char *opt = gf_cfg_get_key(dasher->dash_ctx, "SegmentsStartTimes", fileName);
+			const char *opt = gf_cfg_get_key_value(dasher->dash_ctx, "SegmentsStartTimes", i);
 			if (!fileName)
 				break;
 
@@ -6088,7 +6091,7 @@ static Bool gf_dasher_cleanup(GF_DASHSegmenter *dasher)
 			/*remove URLs*/
 			for (j=0; j<gf_cfg_get_key_count(dasher->dash_ctx, szSecName); j++) {
 				const char *entry = gf_cfg_get_key_name(dasher->dash_ctx, szSecName, j);
-				const char *name = gf_cfg_get_key(dasher->dash_ctx, szSecName, entry);
+				const char *name = gf_cfg_get_key_value(dasher->dash_ctx, szSecName, j);
 				if (strstr(name, fileName)) {
 					gf_cfg_set_key(dasher->dash_ctx, szSecName, entry, NULL);
 					break;
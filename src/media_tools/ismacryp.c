@@ -31,6 +31,7 @@
 #include <gpac/constants.h>
 #include <gpac/internal/isomedia_dev.h>
 #include <gpac/crypt.h>
+#include <gpac/thread.h>
 #include <math.h>
 
 
@@ -43,6 +44,8 @@ typedef struct
 	Bool in_text_header;
 	//global for all tracks unless overriden
 	u32 def_crypt_type;
+	//global for all tracks unless overriden
+	u32 nb_threads;
 
 	GF_Err parse_error;
 } GF_CryptInfo;
@@ -83,6 +86,9 @@ void isma_ea_node_start(void *sax_cbck, const char *node_name, const char *name_
 			if (!stricmp(att->name, "type")) {
 				info->def_crypt_type = get_crypt_type(att->value);
 			}
+			else if (!stricmp(att->name, "threads")) {
+				info->nb_threads = atoi(att->value);
+			}
 		}
 		return;
 	}
@@ -97,6 +103,7 @@ void isma_ea_node_start(void *sax_cbck, const char *node_name, const char *name_
 		tkc->IsEncrypted = 1;
 		tkc->sai_saved_box_type = GF_ISOM_BOX_TYPE_SENC;
 		tkc->scheme_type = info->def_crypt_type;
+		tkc->nb_threads = info->nb_threads;
 		gf_list_add(info->tcis, tkc);
 
 		if (!strcmp(node_name, "OMATrack")) {
@@ -284,6 +291,9 @@ void isma_ea_node_start(void *sax_cbck, const char *node_name, const char *name_
 				else if (!strcmp(att->value, "always")) tkc->block_align = 2;
 				else tkc->block_align = 0;
 			}
+			else if (!stricmp(att->name, "threads")) {
+				tkc->nb_threads = atoi(att->value);
+			}
 		}
 
 		if (has_common_key) info->has_common_key = 1;
@@ -1003,6 +1013,177 @@ static void cenc_resync_IV(GF_Crypt *mc, char IV[16], u8 IV_size)
 	memcpy(IV, next_IV+1, 16*sizeof(char));
 }
 
+/*computes the IV of the next sample once nb_bytes have been cyphered with IV in CTR mode, without any cypher context.
+This produces the same IV as cenc_resync_IV: the counter has been increased once per started block*/
+static void cenc_next_IV(char IV[16], u8 IV_size, u64 nb_bytes)
+{
+	s32 i;
+	u64 nb_blocks = (nb_bytes + 15) / 16;
+
+	for (i=15; (i>=0) && nb_blocks; i--) {
+		u32 v = (u8) IV[i] + (u32) (nb_blocks & 0xFF);
+		IV[i] = (char) v;
+		nb_blocks = (nb_blocks >> 8) + (v >> 8);
+	}
+	if (IV_size == 8) {
+		increase_counter(IV, IV_size);
+		memset(&IV[8], 0, 8*sizeof(char));
+	} else if (nb_bytes % 16) {
+		increase_counter(IV, IV_size);
+	}
+}
+
+/*deferred cyphering: byte ranges of the output sample to cypher, in cypher order. A range of size 0 resets the CBC IV*/
+typedef struct
+{
+	u32 offset, size;
+} CENCCryptOp;
+
+typedef struct
+{
+	CENCCryptOp *ops;
+	u32 nb_ops, nb_alloc;
+	u64 nb_bytes;
+} CENCCryptOps;
+
+static void cenc_push_op(CENCCryptOps *cops, u32 offset, u32 size)
+{
+	if (cops->nb_ops == cops->nb_alloc) {
+		cops->nb_alloc = cops->nb_alloc ? 2*cops->nb_alloc : 32;
+		cops->ops = (CENCCryptOp*)gf_realloc(cops->ops, sizeof(CENCCryptOp) * cops->nb_alloc);
+	}
+	cops->ops[cops->nb_ops].offset = offset;
+	cops->ops[cops->nb_ops].size = size;
+	cops->nb_ops++;
+	cops->nb_bytes += size;
+}
+
+/*cyphers data, or only records its location in the output sample if cyphering is deferred*/
+static void cenc_crypt_data(GF_Crypt *mc, CENCCryptOps *cops, char *data, u32 size, u64 out_offset)
+{
+	if (!cops) {
+		gf_crypt_encrypt(mc, data, size);
+	} else if (size) {
+		cenc_push_op(cops, (u32) out_offset, size);
+	}
+}
+
+static void cenc_reset_IV(GF_Crypt *mc, CENCCryptOps *cops, char IV[16])
+{
+	if (!cops) {
+		gf_crypt_set_IV(mc, IV, 16);
+	} else {
+		cenc_push_op(cops, 0, 0);
+	}
+}
+
+/*reusable state of the sample encryption functions, samples are cyphered in place and auxiliary info is written in a buffer kept across samples*/
+typedef struct
+{
+	/*read bitstream on the sample data, used for parsing*/
+	GF_BitStream *bs;
+	/*sample auxiliary info: IV, then subsample count and entries if any*/
+	char *sai;
+	u32 sai_size, sai_alloc;
+	u32 nb_entries;
+	/*last subsample entry, not yet written. It is extended by the next units as long as it has no encrypted bytes*/
+	GF_CENCSubSampleEntry entry;
+	Bool has_entry;
+	/*set when the sample auxiliary info could not be allocated, further writes are ignored*/
+	GF_Err error;
+} CENCSampleState;
+
+static GF_Err cenc_sai_write(CENCSampleState *st, u32 val, u32 nb_bytes)
+{
+	if (st->error) return st->error;
+	if (st->sai_size + nb_bytes > st->sai_alloc) {
+		u32 sai_alloc = 2*st->sai_alloc + 64;
+		char *sai = (char*)gf_realloc(st->sai, sizeof(char) * sai_alloc);
+		if (!sai) {
+			st->error = GF_OUT_OF_MEM;
+			return GF_OUT_OF_MEM;
+		}
+		st->sai = sai;
+		st->sai_alloc = sai_alloc;
+	}
+	while (nb_bytes) {
+		nb_bytes--;
+		st->sai[st->sai_size++] = (char) ((val >> (8*nb_bytes)) & 0xFF);
+	}
+	return GF_OK;
+}
+
+static GF_BitStream *cenc_sample_state_start(CENCSampleState *st, GF_ISOSample *samp, char IV[16], u32 IV_size)
+{
+	u32 i;
+	if (!st->bs) {
+		st->bs = gf_bs_new(samp->data, samp->dataLength, GF_BITSTREAM_READ);
+	} else {
+		gf_bs_reassign_buffer(st->bs, samp->data, samp->dataLength);
+	}
+	st->sai_size = 0;
+	st->nb_entries = 0;
+	st->has_entry = GF_FALSE;
+	st->error = GF_OK;
+	for (i=0; i<IV_size; i++)
+		cenc_sai_write(st, (u8) IV[i], 1);
+	//subsample count, removed if no subsamples
+	if (cenc_sai_write(st, 0, 2)) return NULL;
+	return st->bs;
+}
+
+static void cenc_sai_close_entry(CENCSampleState *st)
+{
+	if (!st->has_entry) return;
+	cenc_sai_write(st, st->entry.bytes_clear_data, 2);
+	cenc_sai_write(st, st->entry.bytes_encrypted_data, 4);
+	st->nb_entries++;
+	st->has_entry = GF_FALSE;
+}
+
+static void cenc_sai_add_entry(CENCSampleState *st, u32 bytes_clear_data, u32 bytes_encrypted_data)
+{
+	//prev entry is not a VCL, append this NAL
+	if (st->has_entry && !st->entry.bytes_encrypted_data) {
+		st->entry.bytes_clear_data += bytes_clear_data;
+		st->entry.bytes_encrypted_data += bytes_encrypted_data;
+	} else {
+		cenc_sai_close_entry(st);
+		st->entry.bytes_clear_data = bytes_clear_data;
+		st->entry.bytes_encrypted_data = bytes_encrypted_data;
+		st->has_entry = GF_TRUE;
+	}
+	//check bytes of clear is not larger than 16bits
+	while (st->entry.bytes_clear_data > 0xFFFF) {
+		cenc_sai_write(st, 0xFFFF, 2);
+		cenc_sai_write(st, 0, 4);
+		st->nb_entries++;
+		st->entry.bytes_clear_data -= 0xFFFF;
+	}
+}
+
+static GF_Err cenc_sai_end(CENCSampleState *st)
+{
+	u32 IV_size;
+	cenc_sai_close_entry(st);
+	if (st->error) return st->error;
+	IV_size = st->sai_size - 2 - 6*st->nb_entries;
+	if (st->nb_entries) {
+		st->sai[IV_size] = (char) ((st->nb_entries >> 8) & 0xFF);
+		st->sai[IV_size+1] = (char) (st->nb_entries & 0xFF);
+	} else {
+		st->sai_size = IV_size;
+	}
+	return GF_OK;
+}
+
+static void cenc_sample_state_reset(CENCSampleState *st)
+{
+	if (st->bs) gf_bs_del(st->bs);
+	if (st->sai) gf_free(st->sai);
+	memset(st, 0, sizeof(CENCSampleState));
+}
+
 //parses slice header and returns its size
 static u32 gf_cenc_get_clear_bytes(GF_TrackCryptInfo *tci, GF_BitStream *plaintext_bs, char *samp_data, u32 nal_size, u32 bytes_in_nalhr)
 {
@@ -1111,29 +1292,18 @@ typedef enum {
 	ENC_VP9,  /*custom, see https://www.webmproject.org/vp9/mp4/*/
 } GF_Enc_BsFmt;
 
-static GF_Err gf_cenc_encrypt_sample_ctr(GF_Crypt *mc, GF_TrackCryptInfo *tci, GF_ISOSample *samp, GF_Enc_BsFmt bs_type, u32 nalu_size_length_in_bytes, char IV[16], u32 IV_size, char **sai, u32 *saiz,
-										 u32 bytes_in_nalhr, u8 crypt_byte_block, u8 skip_byte_block)
+static GF_Err gf_cenc_encrypt_sample_ctr(GF_Crypt *mc, GF_TrackCryptInfo *tci, GF_ISOSample *samp, GF_Enc_BsFmt bs_type, u32 nalu_size_length_in_bytes, char IV[16], u32 IV_size, CENCSampleState *st,
+										 u32 bytes_in_nalhr, u8 crypt_byte_block, u8 skip_byte_block, CENCCryptOps *cops)
 {
-	GF_BitStream *plaintext_bs = NULL, *cyphertext_bs, *sai_bs = NULL;
-	GF_CENCSubSampleEntry *prev_entry = NULL;
-	char *buffer;
-	u32 max_size_in_bytes, unit_size = 0;
+	GF_BitStream *plaintext_bs;
+	u32 unit_size = 0;
+	/*write position in sample data: the sample is cyphered in place, only empty NAL units are removed*/
+	u32 out_pos = 0;
 	GF_Err e = GF_OK;
-	GF_List *subsamples = NULL;
-
-	plaintext_bs = cyphertext_bs = sai_bs = NULL;
-	max_size_in_bytes = 4096;
-	buffer = (char*)gf_malloc(sizeof(char) * max_size_in_bytes);
-	memset(buffer, 0, max_size_in_bytes);
-	plaintext_bs = gf_bs_new(samp->data, samp->dataLength, GF_BITSTREAM_READ);
-	cyphertext_bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
-	sai_bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
-	gf_bs_write_data(sai_bs, IV, IV_size);
-	subsamples = gf_list_new();
-	if (!subsamples) {
-		e = GF_IO_ERR;
-		goto exit;
-	}
+
+	plaintext_bs = cenc_sample_state_start(st, samp, IV, IV_size);
+	if (!plaintext_bs) return GF_OUT_OF_MEM;
+
 	if ((bs_type == ENC_OBU) || (bs_type == ENC_VP9))
 		nalu_size_length_in_bytes = 0;
 
@@ -1190,8 +1360,8 @@ static GF_Err gf_cenc_encrypt_sample_ctr(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 					unit_size = clear_bytes + ranges[0].encrypted;
 					if (ranges[0].encrypted >= 16) {
 						//A subsample SHALL be created for each tile >= 16 bytes. If previous range had encrypted bytes, create a new one, otherwise merge in prev
-						if (prev_entry && prev_entry->bytes_encrypted_data)
-							prev_entry = NULL;
+						if (st->has_entry && st->entry.bytes_encrypted_data)
+							cenc_sai_close_entry(st);
 					} else {
 						clear_bytes = unit_size;
 					}
@@ -1256,8 +1426,8 @@ static GF_Err gf_cenc_encrypt_sample_ctr(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 				//not clearly defined in the spec (so we do the same as in AV1 which is more clearly defined):
 				if (frame_sizes[0] - clear_bytes >= 16) {
 					//A subsample SHALL be created for each tile >= 16 bytes. If previous range had encrypted bytes, create a new one, otherwise merge in prev
-					if (prev_entry && prev_entry->bytes_encrypted_data)
-						prev_entry = NULL;
+					if (st->has_entry && st->entry.bytes_encrypted_data)
+						cenc_sai_close_entry(st);
 				} else {
 					clear_bytes = unit_size;
 				}
@@ -1271,10 +1441,7 @@ static GF_Err gf_cenc_encrypt_sample_ctr(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 
 
 			while (nb_ranges) {
-				if (unit_size > max_size_in_bytes) {
-					buffer = (char*)gf_realloc(buffer, sizeof(char)*unit_size);
-					max_size_in_bytes = unit_size;
-				}
+				u32 read_pos;
 
 				// adjust so that encrypted bytes are a multiple of 16 bytes: cenc SHOULD, cens SHALL, we always do it
 				if (unit_size > clear_bytes) {
@@ -1301,23 +1468,25 @@ static GF_Err gf_cenc_encrypt_sample_ctr(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 					}
 				}
 
-				/*read clear data and transfer to output*/
-				gf_bs_read_data(plaintext_bs, buffer, clear_bytes);
-				if (bs_type == ENC_NALU)
-					gf_bs_write_int(cyphertext_bs, unit_size, 8*nalu_size_length_in_bytes);
-
-				gf_bs_write_data(cyphertext_bs, buffer, clear_bytes);
+				/*clear data stays in place, move the unit if empty NAL units were removed before it*/
+				read_pos = (u32) gf_bs_get_position(plaintext_bs);
+				if (bs_type == ENC_NALU) {
+					read_pos -= nalu_size_length_in_bytes;
+					if (read_pos != out_pos)
+						memmove(samp->data + out_pos, samp->data + read_pos, nalu_size_length_in_bytes + unit_size);
+					out_pos += nalu_size_length_in_bytes;
+				}
+				out_pos += clear_bytes;
 
-				//read data to encrypt
+				//encrypt data in place
 				if (unit_size > clear_bytes) {
-					gf_bs_read_data(plaintext_bs, buffer, unit_size - clear_bytes);
-
+					char *data = samp->data + out_pos;
 					//pattern encryption
 					if (crypt_byte_block && skip_byte_block) {
 						u32 pos = 0;
 						u32 res = unit_size - clear_bytes;
 						while (res) {
-							gf_crypt_encrypt(mc, buffer+pos, res >= (u32) (16*crypt_byte_block) ? 16*crypt_byte_block : res);
+							cenc_crypt_data(mc, cops, data+pos, res >= (u32) (16*crypt_byte_block) ? 16*crypt_byte_block : res, out_pos + pos);
 							if (res >= (u32) (16 * (crypt_byte_block + skip_byte_block))) {
 								pos += 16 * (crypt_byte_block + skip_byte_block);
 								res -= 16 * (crypt_byte_block + skip_byte_block);
@@ -1326,33 +1495,13 @@ static GF_Err gf_cenc_encrypt_sample_ctr(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 							}
 						}
 					} else {
-						gf_crypt_encrypt(mc, buffer, unit_size - clear_bytes);
+						cenc_crypt_data(mc, cops, data, unit_size - clear_bytes, out_pos);
 					}
-
-					/*write encrypted data to bitstream*/
-					gf_bs_write_data(cyphertext_bs, buffer, unit_size - clear_bytes);
-				}
-				//prev entry is not a VCL, append this NAL
-				if (prev_entry && !prev_entry->bytes_encrypted_data) {
-					prev_entry->bytes_clear_data += nalu_size_length_in_bytes + clear_bytes;
-					prev_entry->bytes_encrypted_data += unit_size - clear_bytes;
-				} else {
-					prev_entry = (GF_CENCSubSampleEntry *)gf_malloc(sizeof(GF_CENCSubSampleEntry));
-					prev_entry->bytes_clear_data = nalu_size_length_in_bytes + clear_bytes;
-					prev_entry->bytes_encrypted_data = unit_size - clear_bytes;
-					gf_list_add(subsamples, prev_entry);
-				}
-				//check bytes of clear is not larger than 16bits
-				while (prev_entry->bytes_clear_data > 0xFFFF) {
-					GF_CENCSubSampleEntry *split_entry = (GF_CENCSubSampleEntry *)gf_malloc(sizeof(GF_CENCSubSampleEntry));
-					split_entry->bytes_clear_data = prev_entry->bytes_clear_data - 0xFFFF;
-					split_entry->bytes_encrypted_data = prev_entry->bytes_encrypted_data;
-					prev_entry->bytes_clear_data = 0xFFFF;
-					prev_entry->bytes_encrypted_data = 0;
-					gf_list_add(subsamples, split_entry);
-					prev_entry = split_entry;
+					out_pos += unit_size - clear_bytes;
 				}
+				gf_bs_skip_bytes(plaintext_bs, unit_size);
 
+				cenc_sai_add_entry(st, nalu_size_length_in_bytes + clear_bytes, unit_size - clear_bytes);
 
 				nb_ranges--;
 				if (!nb_ranges) break;
@@ -1362,7 +1511,7 @@ static GF_Err gf_cenc_encrypt_sample_ctr(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 				case ENC_OBU:
 					clear_bytes = ranges[range_idx].clear;
 					unit_size = clear_bytes + ranges[range_idx].encrypted;
-					prev_entry = NULL; //a subsample SHALL be created for each tile.
+					cenc_sai_close_entry(st); //a subsample SHALL be created for each tile.
 					break;
 				case ENC_VP9:
 					if (nb_ranges > 1) {
@@ -1372,7 +1521,7 @@ static GF_Err gf_cenc_encrypt_sample_ctr(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 						unit_size = clear_bytes = ranges[range_idx].clear;
 						assert(ranges[range_idx].encrypted == 0);
 					}
-					prev_entry = NULL; //a subsample SHALL be created for each tile.
+					cenc_sai_close_entry(st); //a subsample SHALL be created for each tile.
 					break;
 				default:
 					GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[CENC] Detected unexpected subrange in bitstream format %d\n", bs_type));
@@ -1382,69 +1531,34 @@ static GF_Err gf_cenc_encrypt_sample_ctr(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 			}
 		} else {
 			assert(bs_type == ENC_FULL_SAMPLE);
-			if (samp->dataLength > max_size_in_bytes) {
-				buffer = (char*)gf_realloc(buffer, sizeof(char)*samp->dataLength);
-				max_size_in_bytes = samp->dataLength;
-			}
-
-			gf_bs_read_data(plaintext_bs, buffer, samp->dataLength);
-			gf_crypt_encrypt(mc, buffer, samp->dataLength);
-			gf_bs_write_data(cyphertext_bs, buffer, samp->dataLength);
+			cenc_crypt_data(mc, cops, samp->data, samp->dataLength, 0);
+			gf_bs_skip_bytes(plaintext_bs, samp->dataLength);
+			out_pos = samp->dataLength;
 		}
 	}
 
-
-	if (samp->data) {
-		gf_free(samp->data);
-		samp->data = NULL;
-		samp->dataLength = 0;
-	}
-	gf_bs_get_content(cyphertext_bs, &samp->data, &samp->dataLength);
-	if (gf_list_count(subsamples)) {
-		gf_bs_write_u16(sai_bs, gf_list_count(subsamples));
-		while (gf_list_count(subsamples)) {
-			GF_CENCSubSampleEntry *ptr = (GF_CENCSubSampleEntry *)gf_list_get(subsamples, 0);
-			gf_list_rem(subsamples, 0);
-			gf_bs_write_u16(sai_bs, ptr->bytes_clear_data);
-			gf_bs_write_u32(sai_bs, ptr->bytes_encrypted_data);
-			gf_free(ptr);
-		}
-	}
-	gf_list_del(subsamples);
-	gf_bs_get_content(sai_bs, sai, saiz);
-	cenc_resync_IV(mc, IV, IV_size);
+	samp->dataLength = out_pos;
+	e = cenc_sai_end(st);
+	if (e) goto exit;
+	if (cops)
+		cenc_next_IV(IV, IV_size, cops->nb_bytes);
+	else
+		cenc_resync_IV(mc, IV, IV_size);
 
 exit:
-	if (buffer) gf_free(buffer);
-	if (plaintext_bs) gf_bs_del(plaintext_bs);
-	if (cyphertext_bs) gf_bs_del(cyphertext_bs);
-	if (sai_bs) gf_bs_del(sai_bs);
 	return e;
 }
 
 
-static GF_Err gf_cenc_encrypt_sample_cbc(GF_Crypt *mc, GF_TrackCryptInfo *tci, GF_ISOSample *samp, GF_Enc_BsFmt bs_type, u32 nalu_size_length_in_bytes, char IV[16], u32 IV_size, char **sai, u32 *saiz,
-										u32 bytes_in_nalhr, u8 crypt_byte_block, u8 skip_byte_block) {
-	GF_BitStream *plaintext_bs = NULL, *cyphertext_bs = NULL, *sai_bs = NULL;
-	GF_CENCSubSampleEntry *prev_entry = NULL;
-	char *buffer = NULL;
-	u32 max_size, unit_size;
+static GF_Err gf_cenc_encrypt_sample_cbc(GF_Crypt *mc, GF_TrackCryptInfo *tci, GF_ISOSample *samp, GF_Enc_BsFmt bs_type, u32 nalu_size_length_in_bytes, char IV[16], u32 IV_size, CENCSampleState *st,
+										u32 bytes_in_nalhr, u8 crypt_byte_block, u8 skip_byte_block, CENCCryptOps *cops) {
+	GF_BitStream *plaintext_bs;
+	u32 unit_size;
 	GF_Err e = GF_OK;
-	GF_List *subsamples;
 
-	plaintext_bs = cyphertext_bs = sai_bs = NULL;
-	max_size = 4096;
-	buffer = (char*)gf_malloc(sizeof(char) * max_size);
-	memset(buffer, 0, max_size);
-	plaintext_bs = gf_bs_new(samp->data, samp->dataLength, GF_BITSTREAM_READ);
-	cyphertext_bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
-	sai_bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
-	gf_bs_write_data(sai_bs, IV, IV_size);
-	subsamples = gf_list_new();
-	if (!subsamples) {
-		e = GF_IO_ERR;
-		goto exit;
-	}
+	plaintext_bs = cenc_sample_state_start(st, samp, IV, IV_size);
+	if (!plaintext_bs) return GF_OUT_OF_MEM;
+
 	if ((bs_type == ENC_OBU) || (bs_type == ENC_VP9))
 		nalu_size_length_in_bytes = 0;
 
@@ -1461,8 +1575,6 @@ static GF_Err gf_cenc_encrypt_sample_cbc(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 			if (bs_type == ENC_NALU) {
 				unit_size = gf_bs_read_int(plaintext_bs, 8*nalu_size_length_in_bytes);
 
-				gf_bs_write_int(cyphertext_bs, unit_size, 8*nalu_size_length_in_bytes);
-
 				clear_bytes = gf_cenc_get_clear_bytes(tci, plaintext_bs, samp->data, unit_size, bytes_in_nalhr);
 			} else if (bs_type == ENC_OBU) {
 				ObuType obut;
@@ -1494,8 +1606,8 @@ static GF_Err gf_cenc_encrypt_sample_cbc(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 					unit_size = clear_bytes + ranges[0].encrypted;
 					if (ranges[0].encrypted >= 16) {
 						//A subsample SHALL be created for each tile >= 16 bytes. If previous range had encrypted bytes, create a new one, otherwise merge in prev
-						if (prev_entry && prev_entry->bytes_encrypted_data)
-							prev_entry = NULL;
+						if (st->has_entry && st->entry.bytes_encrypted_data)
+							cenc_sai_close_entry(st);
 					} else {
 						clear_bytes = unit_size;
 					}
@@ -1517,12 +1629,6 @@ static GF_Err gf_cenc_encrypt_sample_cbc(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 			}
 
 			while (nb_ranges) {
-				if (unit_size+1 > max_size) {
-					buffer = (char*)gf_realloc(buffer, sizeof(char)*(unit_size+1));
-					memset(buffer, 0, sizeof(char)*(unit_size+1));
-					max_size = unit_size + 1;
-				}
-
 				//in cbcs, we don't adjust bytes_encrypted_data to be a multiple of 16 bytes and leave the last block unencrypted
 				//except in AV1, where BytesOfProtectedData SHALL end on the last byte of the decode_tile structure
 				if ( ( (bs_type != ENC_OBU) && (bs_type != ENC_VP9) ) && (tci->scheme_type == GF_CRYPT_TYPE_CBCS) ) {
@@ -1535,22 +1641,21 @@ static GF_Err gf_cenc_encrypt_sample_cbc(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 					clear_bytes += ret;
 					clear_bytes_at_end = 0;
 				}
-				//copy over clear bytes
+				//clear bytes stay in place
 				if (clear_bytes) {
 					assert(gf_bs_available(plaintext_bs) >= clear_bytes);
-
-					gf_bs_read_data(plaintext_bs, buffer, clear_bytes);
-					gf_bs_write_data(cyphertext_bs, buffer, clear_bytes);
+					gf_bs_skip_bytes(plaintext_bs, clear_bytes);
 				}
 
 				if (unit_size - clear_bytes) {
-					//read the bytes to be encrypted
+					//encrypt data in place, the non encrypted bytes at the end of the block are left untouched
+					u32 out_pos = (u32) gf_bs_get_position(plaintext_bs);
+					char *data = samp->data + out_pos;
 					assert(gf_bs_available(plaintext_bs) >= unit_size - clear_bytes);
-					gf_bs_read_data(plaintext_bs, buffer, unit_size - clear_bytes);
 
 					//cbcs scheme (constant IV), reinit at each sub sample,
 					if (!IV_size)
-						gf_crypt_set_IV(mc, IV, 16);
+						cenc_reset_IV(mc, cops, IV);
 					//pattern encryption
 					if (crypt_byte_block && skip_byte_block) {
 						u32 pos = 0;
@@ -1558,7 +1663,7 @@ static GF_Err gf_cenc_encrypt_sample_cbc(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 						assert((res % 16) == 0);
 
 						while (res) {
-							gf_crypt_encrypt(mc, buffer + pos, res >= (u32) (16*crypt_byte_block) ? 16*crypt_byte_block : res);
+							cenc_crypt_data(mc, cops, data + pos, res >= (u32) (16*crypt_byte_block) ? 16*crypt_byte_block : res, out_pos + pos);
 							if (res >= (u32) (16 * (crypt_byte_block + skip_byte_block))) {
 								pos += 16 * (crypt_byte_block + skip_byte_block);
 								res -= 16 * (crypt_byte_block + skip_byte_block);
@@ -1567,10 +1672,9 @@ static GF_Err gf_cenc_encrypt_sample_cbc(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 							}
 						}
 					} else {
-						gf_crypt_encrypt(mc, buffer, unit_size - clear_bytes - clear_bytes_at_end);
+						cenc_crypt_data(mc, cops, data, unit_size - clear_bytes - clear_bytes_at_end, out_pos);
 					}
-					//write the cyphered data, including the non encrypted bytes at the end of the block
-					gf_bs_write_data(cyphertext_bs, buffer, unit_size - clear_bytes);
+					gf_bs_skip_bytes(plaintext_bs, unit_size - clear_bytes);
 				}
 
 				//for NALU-based, subsamples. Otherwise, if bytes in clear at the beginning, subsample
@@ -1580,30 +1684,8 @@ static GF_Err gf_cenc_encrypt_sample_cbc(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 				{
 					//note that we write encrypted data to cover the complete byte range after the slice header
 					//but the last incomplete block might be unencrypted, but is still signaled in bytes_encrypted, as per the spec
-
-					//prev entry is not a VCL, append this NAL
-					if (prev_entry && !prev_entry->bytes_encrypted_data) {
-						prev_entry->bytes_clear_data += nalu_size_length_in_bytes + clear_bytes;
-						prev_entry->bytes_encrypted_data += unit_size - clear_bytes;
-					} else {
-						prev_entry = (GF_CENCSubSampleEntry *)gf_malloc(sizeof(GF_CENCSubSampleEntry));
-						prev_entry->bytes_clear_data = nalu_size_length_in_bytes + clear_bytes;
-						prev_entry->bytes_encrypted_data = unit_size - clear_bytes;
-						gf_list_add(subsamples, prev_entry);
-					}
-
-					//check bytes of clear is not larger than 16bits
-					while (prev_entry->bytes_clear_data > 0xFFFF) {
-						GF_CENCSubSampleEntry *split_entry = (GF_CENCSubSampleEntry *)gf_malloc(sizeof(GF_CENCSubSampleEntry));
-						split_entry->bytes_clear_data = prev_entry->bytes_clear_data - 0xFFFF;
-						split_entry->bytes_encrypted_data = prev_entry->bytes_encrypted_data;
-						prev_entry->bytes_clear_data = 0xFFFF;
-						prev_entry->bytes_encrypted_data = 0;
-						gf_list_add(subsamples, split_entry);
-						prev_entry = split_entry;
-					}
-					assert((s32)prev_entry->bytes_encrypted_data >= 0);
-					assert(prev_entry->bytes_encrypted_data <= samp->dataLength);
+					cenc_sai_add_entry(st, nalu_size_length_in_bytes + clear_bytes, unit_size - clear_bytes);
+					assert(st->entry.bytes_encrypted_data <= samp->dataLength);
 				}
 				nb_ranges--;
 				if (!nb_ranges) break;
@@ -1612,60 +1694,27 @@ static GF_Err gf_cenc_encrypt_sample_cbc(GF_Crypt *mc, GF_TrackCryptInfo *tci, G
 				clear_bytes = ranges[av1_tile_idx].clear;
 				unit_size = clear_bytes + ranges[av1_tile_idx].encrypted;
 				//A subsample SHALL be created for each tile.
-				prev_entry = NULL;
+				cenc_sai_close_entry(st);
 			}
 		} else {
-			u32 clear_trailing;
-
-			if (samp->dataLength > max_size) {
-				buffer = (char*)gf_realloc(buffer, sizeof(char)*samp->dataLength);
-				max_size = samp->dataLength;
-			}
-
-			gf_bs_read_data(plaintext_bs, buffer, samp->dataLength);
-			clear_trailing = samp->dataLength % 16;
+			u32 clear_trailing = samp->dataLength % 16;
 
 			//cbcs scheme with constant IV, reinit at each sample,
 			if (!IV_size)
-				gf_crypt_set_IV(mc, IV, 16);
+				cenc_reset_IV(mc, cops, IV);
 
+			//trailing bytes are left in the clear
 			if (samp->dataLength >= 16) {
-				gf_crypt_encrypt(mc, buffer, samp->dataLength - clear_trailing);
-				gf_bs_write_data(cyphertext_bs, buffer, samp->dataLength - clear_trailing);
-			}
-			if (clear_trailing) {
-				gf_bs_write_data(cyphertext_bs, buffer+samp->dataLength - clear_trailing, clear_trailing);
+				cenc_crypt_data(mc, cops, samp->data, samp->dataLength - clear_trailing, 0);
 			}
+			gf_bs_skip_bytes(plaintext_bs, samp->dataLength);
 		}
 	}
-
-	if (samp->data) {
-		gf_free(samp->data);
-		samp->data = NULL;
-		samp->dataLength = 0;
-	}
-	gf_bs_get_content(cyphertext_bs, &samp->data, &samp->dataLength);
-	if (gf_list_count(subsamples)) {
-		gf_bs_write_u16(sai_bs, gf_list_count(subsamples));
-		while (gf_list_count(subsamples)) {
-			GF_CENCSubSampleEntry *ptr = (GF_CENCSubSampleEntry *)gf_list_get(subsamples, 0);
-			gf_list_rem(subsamples, 0);
-			gf_bs_write_u16(sai_bs, ptr->bytes_clear_data);
-			gf_bs_write_u32(sai_bs, ptr->bytes_encrypted_data);
-			gf_free(ptr);
-		}
-	}
-	gf_list_del(subsamples);
-	gf_bs_get_content(sai_bs, sai, saiz);
+	e = cenc_sai_end(st);
 
 exit:
-	if (buffer) gf_free(buffer);
-	if (plaintext_bs) gf_bs_del(plaintext_bs);
-	if (cyphertext_bs) gf_bs_del(cyphertext_bs);
-	if (sai_bs) gf_bs_del(sai_bs);
 	return e;
 }
-
 #if !defined(GPAC_DISABLE_AV_PARSERS) && !defined(GPAC_DISABLE_HEVC)
 static void hevc_parse_ps(GF_HEVCConfig *hevccfg, HEVCState *hevc, u32 nal_type)
 {
@@ -1682,6 +1731,240 @@ static void hevc_parse_ps(GF_HEVCConfig *hevccfg, HEVCState *hevc, u32 nal_type)
 }
 #endif
 
+/*CENC encryption pipeline: the calling thread reads and parses samples (recording the ranges to cypher),
+workers cypher the samples with their own AES context, and the calling thread writes back cyphered samples in decoding order*/
+typedef struct
+{
+	GF_ISOSample *samp;
+	u32 sample_number, stsd_idx;
+	char *sai;
+	u32 sai_size, sai_alloc;
+	bin128 key;
+	char IV[16];
+	CENCCryptOps cops;
+	GF_Err error;
+	Bool done;
+} CENCEncJob;
+
+typedef struct
+{
+	Bool ctr_mode;
+	u32 nb_workers;
+	GF_Thread **threads;
+	GF_Mutex *mx;
+	GF_Semaphore *todo, *done;
+	/*ring of jobs, in decoding order*/
+	CENCEncJob *jobs;
+	u32 nb_jobs, first_job, nb_pending, next_todo;
+	u32 nb_done_tokens;
+	Bool exit;
+} CENCEncPool;
+
+static GF_Err cenc_enc_run_job(CENCEncPool *pool, GF_Crypt **mc, CENCEncJob *job)
+{
+	u32 i;
+	GF_Err e;
+	if (! *mc) {
+		*mc = gf_crypt_open(GF_AES_128, pool->ctr_mode ? GF_CTR : GF_CBC);
+		if (! *mc) return GF_IO_ERR;
+		e = gf_crypt_init(*mc, job->key, job->IV);
+		if (e) {
+			gf_crypt_close(*mc);
+			*mc = NULL;
+			return e;
+		}
+	} else {
+		e = gf_crypt_set_key(*mc, job->key);
+		if (e) {
+			gf_crypt_close(*mc);
+			*mc = NULL;
+			return e;
+		}
+	}
+	if (pool->ctr_mode) {
+		char state[17];
+		state[0] = 0;
+		memcpy(state+1, job->IV, 16);
+		gf_crypt_set_IV(*mc, state, 17);
+	} else {
+		gf_crypt_set_IV(*mc, job->IV, 16);
+	}
+	for (i=0; i<job->cops.nb_ops; i++) {
+		CENCCryptOp *op = &job->cops.ops[i];
+		if (!op->size) {
+			gf_crypt_set_IV(*mc, job->IV, 16);
+		} else {
+			gf_crypt_encrypt(*mc, job->samp->data + op->offset, op->size);
+		}
+	}
+	return GF_OK;
+}
+
+static u32 cenc_enc_worker_run(void *par)
+{
+	CENCEncPool *pool = (CENCEncPool *)par;
+	GF_Crypt *mc = NULL;
+	while (1) {
+		CENCEncJob *job;
+		GF_Err e;
+		gf_sema_wait(pool->todo);
+		gf_mx_p(pool->mx);
+		if (pool->exit) {
+			gf_mx_v(pool->mx);
+			break;
+		}
+		job = &pool->jobs[pool->next_todo];
+		pool->next_todo = (pool->next_todo + 1) % pool->nb_jobs;
+		gf_mx_v(pool->mx);
+
+		e = cenc_enc_run_job(pool, &mc, job);
+
+		gf_mx_p(pool->mx);
+		job->error = e;
+		job->done = GF_TRUE;
+		gf_mx_v(pool->mx);
+		gf_sema_notify(pool->done, 1);
+	}
+	if (mc) gf_crypt_close(mc);
+	return 0;
+}
+
+static void cenc_enc_pool_del(CENCEncPool *pool)
+{
+	u32 i;
+	gf_mx_p(pool->mx);
+	pool->exit = GF_TRUE;
+	gf_mx_v(pool->mx);
+	gf_sema_notify(pool->todo, pool->nb_workers);
+	for (i=0; i<pool->nb_workers; i++) {
+		gf_th_stop(pool->threads[i]);
+		gf_th_del(pool->threads[i]);
+	}
+	for (i=0; i<pool->nb_jobs; i++) {
+		CENCEncJob *job = &pool->jobs[i];
+		if (job->samp) gf_isom_sample_del(&job->samp);
+		if (job->sai) gf_free(job->sai);
+		if (job->cops.ops) gf_free(job->cops.ops);
+	}
+	gf_sema_del(pool->todo);
+	gf_sema_del(pool->done);
+	gf_mx_del(pool->mx);
+	gf_free(pool->threads);
+	gf_free(pool->jobs);
+	gf_free(pool);
+}
+
+static CENCEncPool *cenc_enc_pool_new(GF_TrackCryptInfo *tci)
+{
+	u32 i, nb_threads = tci->nb_threads;
+	CENCEncPool *pool;
+
+	if (!nb_threads) {
+		GF_SystemRTInfo rti;
+		memset(&rti, 0, sizeof(GF_SystemRTInfo));
+		gf_sys_get_rti(0xFFFFFFFF, &rti, 0);
+		nb_threads = rti.nb_cores ? rti.nb_cores : 1;
+	}
+	if (nb_threads<2) return NULL;
+
+	GF_SAFEALLOC(pool, CENCEncPool);
+	if (!pool) return NULL;
+	pool->ctr_mode = tci->ctr_mode;
+	pool->nb_jobs = 4*nb_threads;
+	pool->jobs = (CENCEncJob *) gf_malloc(sizeof(CENCEncJob) * pool->nb_jobs);
+	memset(pool->jobs, 0, sizeof(CENCEncJob) * pool->nb_jobs);
+	pool->threads = (GF_Thread **) gf_malloc(sizeof(GF_Thread *) * nb_threads);
+	pool->todo = gf_sema_new(pool->nb_jobs + nb_threads, 0);
+	pool->done = gf_sema_new(pool->nb_jobs, 0);
+	pool->mx = gf_mx_new("CENCEncrypt");
+	for (i=0; i<nb_threads; i++) {
+		GF_Thread *th = gf_th_new("CENCEncrypt");
+		if (gf_th_run(th, cenc_enc_worker_run, pool) != GF_OK) {
+			gf_th_del(th);
+			break;
+		}
+		pool->threads[pool->nb_workers] = th;
+		pool->nb_workers++;
+	}
+	if (!pool->nb_workers) {
+		cenc_enc_pool_del(pool);
+		return NULL;
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_AUTHOR, ("[CENC] Encrypting track %d using %d threads\n", tci->trackID, pool->nb_workers));
+	return pool;
+}
+
+/*gets the next free job, or NULL if the oldest job must be written first*/
+static CENCEncJob *cenc_enc_pool_get_job(CENCEncPool *pool)
+{
+	CENCEncJob *job;
+	if (pool->nb_pending == pool->nb_jobs) return NULL;
+	job = &pool->jobs[(pool->first_job + pool->nb_pending) % pool->nb_jobs];
+	job->cops.nb_ops = 0;
+	job->cops.nb_bytes = 0;
+	job->error = GF_OK;
+	job->done = GF_FALSE;
+	return job;
+}
+
+static void cenc_enc_pool_submit(CENCEncPool *pool)
+{
+	gf_mx_p(pool->mx);
+	pool->nb_pending++;
+	gf_mx_v(pool->mx);
+	gf_sema_notify(pool->todo, 1);
+}
+
+/*waits for the oldest job and writes the cyphered sample and its auxiliary info*/
+static GF_Err cenc_enc_pool_write_job(CENCEncPool *pool, GF_ISOFile *mp4, u32 track, GF_TrackCryptInfo *tci, u32 crypt_stsd_idx, Bool use_subsamples, u32 count)
+{
+	GF_Err e;
+	CENCEncJob *job = &pool->jobs[pool->first_job];
+
+	//each job notifies the done semaphore once: tokens consumed while waiting for the oldest job belong to later jobs
+	while (1) {
+		Bool done;
+		gf_mx_p(pool->mx);
+		done = job->done;
+		gf_mx_v(pool->mx);
+		if (done) break;
+		gf_sema_wait(pool->done);
+		pool->nb_done_tokens++;
+	}
+	if (pool->nb_done_tokens) pool->nb_done_tokens--;
+	else gf_sema_wait(pool->done);
+
+	e = job->error;
+	if (!e) {
+		gf_isom_update_sample(mp4, track, job->sample_number, job->samp, 1);
+
+		if (crypt_stsd_idx != job->stsd_idx) {
+			gf_isom_change_sample_desc_index(mp4, track, job->sample_number, crypt_stsd_idx);
+		}
+		if (job->sai_size) {
+			e = gf_isom_track_cenc_add_sample_info(mp4, track, tci->sai_saved_box_type, tci->IV_size, job->sai, job->sai_size, use_subsamples, NULL);
+		}
+		gf_set_progress("CENC Encrypt", job->sample_number, count);
+	}
+	gf_isom_sample_del(&job->samp);
+	job->sai_size = 0;
+
+	gf_mx_p(pool->mx);
+	pool->first_job = (pool->first_job + 1) % pool->nb_jobs;
+	pool->nb_pending--;
+	gf_mx_v(pool->mx);
+	return e;
+}
+
+static GF_Err cenc_enc_pool_flush(CENCEncPool *pool, GF_ISOFile *mp4, u32 track, GF_TrackCryptInfo *tci, u32 crypt_stsd_idx, Bool use_subsamples, u32 count)
+{
+	while (pool->nb_pending) {
+		GF_Err e = cenc_enc_pool_write_job(pool, mp4, track, tci, crypt_stsd_idx, use_subsamples, count);
+		if (e) return e;
+	}
+	return GF_OK;
+}
+
 /*encrypts track - logs, progress: info callbacks, NULL for default*/
 GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*progress)(void *cbk, u64 done, u64 total), void *cbk)
 {
@@ -1690,22 +1973,23 @@ GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*pro
 	GF_ISOSample *samp = NULL;
 	GF_Crypt *mc;
 	Bool all_rap = GF_FALSE;
-	u32 i, count, stsd_idx, track, saiz_len, nb_samp_encrypted, nalu_size_length, idx, bytes_in_nalhr;
+	u32 i, count, stsd_idx, track, nb_samp_encrypted, nalu_size_length, idx, bytes_in_nalhr;
 	GF_ESD *esd;
 	Bool has_crypted_samp;
 	GF_Enc_BsFmt bs_type = ENC_FULL_SAMPLE;
 	Bool use_subsamples = GF_FALSE;
-	char *saiz_buf;
 	Bool use_seig = GF_FALSE;
 	Bool has_seig = GF_FALSE;
 	u32 clear_stsd_idx = 1;
 	u32 crypt_stsd_idx = 1;
 	GF_BitStream *bs;
+	CENCEncPool *pool = NULL;
+	CENCSampleState st;
 
 	nalu_size_length = 0;
 	mc = NULL;
-	saiz_buf = NULL;
 	bs = NULL;
+	memset(&st, 0, sizeof(CENCSampleState));
 	bytes_in_nalhr = 0;
 
 	track = gf_isom_get_track_by_id(mp4, tci->trackID);
@@ -1851,6 +2135,11 @@ GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*pro
 		e = GF_IO_ERR;
 		goto exit;
 	}
+	//samples can be cyphered independently if their IV does not depend on the cyphered data of the previous sample:
+	//in CTR mode the next IV is computed from the number of cyphered bytes, in CBC mode this is only the case for constant IVs
+	if (tci->ctr_mode || !tci->IV_size) {
+		pool = cenc_enc_pool_new(tci);
+	}
 
 	if ((tci->sel_enc_type==GF_CRYPT_SELENC_CLEAR_FORCED) && tci->force_clear_stsd_idx) {
 		e = gf_isom_clone_sample_description(mp4, track, mp4, track, 1, NULL, NULL, &clear_stsd_idx);
@@ -1920,7 +2209,13 @@ GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*pro
 	for (i = 0; i < count; i++) {
 		bin128 NULL_IV;
 		Bool forced_clear = GF_FALSE;
-		saiz_len=0;
+		CENCEncJob *job = NULL;
+		if (pool) {
+			while (! (job = cenc_enc_pool_get_job(pool)) ) {
+				e = cenc_enc_pool_write_job(pool, mp4, track, tci, crypt_stsd_idx, use_subsamples, count);
+				if (e) goto exit;
+			}
+		}
 		samp = gf_isom_get_sample(mp4, track, i+1, &stsd_idx);
 		if (!samp) {
 			e = GF_IO_ERR;
@@ -1933,11 +2228,14 @@ GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*pro
 				gf_isom_get_sample_rap_roll_info(mp4, track, i+1, (Bool *) &samp->IsRAP, NULL, NULL);
 
 			if (!samp->IsRAP && !all_rap) {
+				if (pool) {
+					e = cenc_enc_pool_flush(pool, mp4, track, tci, crypt_stsd_idx, use_subsamples, count);
+					if (e) goto exit;
+				}
 				//sample is not encrypted, put an empty SAI (size 0)
 				e = gf_isom_track_cenc_add_sample_info(mp4, track, tci->sai_saved_box_type, 0, NULL, 0, GF_FALSE, NULL);
 				if (e)
 					goto exit;
-				saiz_buf = NULL;
 
 				memset(NULL_IV, 0, 16);
 				e = gf_isom_set_sample_cenc_group(mp4, track, i+1, 0, 0, NULL_IV, 0, 0, 0, NULL);
@@ -1952,11 +2250,14 @@ GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*pro
 			break;
 		case GF_CRYPT_SELENC_NON_RAP:
 			if (samp->IsRAP || all_rap) {
+				if (pool) {
+					e = cenc_enc_pool_flush(pool, mp4, track, tci, crypt_stsd_idx, use_subsamples, count);
+					if (e) goto exit;
+				}
 				//sample is not encrypted, put an empty SAI (size 0)
 				e = gf_isom_track_cenc_add_sample_info(mp4, track, tci->sai_saved_box_type, 0, NULL, 0, GF_FALSE, NULL);
 				if (e)
 					goto exit;
-				saiz_buf = NULL;
 
 				memset(NULL_IV, 0, 16);
 				e = gf_isom_set_sample_cenc_group(mp4, track, i+1, 0, 0, NULL_IV, 0, 0, 0, NULL);
@@ -1972,6 +2273,10 @@ GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*pro
 		case GF_CRYPT_SELENC_CLEAR_FORCED:
 			forced_clear = GF_TRUE;
 		case GF_CRYPT_SELENC_CLEAR:
+			if (pool) {
+				e = cenc_enc_pool_flush(pool, mp4, track, tci, crypt_stsd_idx, use_subsamples, count);
+				if (e) goto exit;
+			}
 			if (!forced_clear || !tci->force_clear_stsd_idx) {
 				memset(NULL_IV, 0, 16);
 
@@ -1985,7 +2290,6 @@ GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*pro
 				}
 				if (e)
 					goto exit;
-				saiz_buf = NULL;
 
 				if (!forced_clear) {
 					e = gf_isom_set_sample_cenc_group(mp4, track, i + 1, 0, 0, NULL_IV, 0, 0, 0, NULL);
@@ -2039,11 +2343,13 @@ GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*pro
 					memcpy(IV, tci->constant_IV, sizeof(char)*16);
 				} else {
 					GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[CENC] No IV set and invalid constant IV size %d crypt info file\n", tci->constant_IV_size));
-					return GF_BAD_PARAM;
+					e = GF_BAD_PARAM;
+					goto exit;
 				}
 			} else {
 				GF_LOG(GF_LOG_ERROR, GF_LOG_AUTHOR, ("[CENC] Invalid IV size %d in crypt info file\n", tci->IV_size));
-				return GF_NOT_SUPPORTED;
+				e = GF_NOT_SUPPORTED;
+				goto exit;
 			}
 
 			e = gf_crypt_init(mc, tci->key, IV);
@@ -2081,8 +2387,13 @@ GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*pro
 			if (e) goto exit;
 		}
 
+		if (job) {
+			//IV and key used for this sample, the sample functions update IV for the next sample
+			memcpy(job->IV, IV, 16);
+			memcpy(job->key, tci->key, 16);
+		}
 		if (tci->ctr_mode) {
-			e = gf_cenc_encrypt_sample_ctr(mc, tci, samp, bs_type, nalu_size_length, IV, tci->IV_size, &saiz_buf, &saiz_len, bytes_in_nalhr, tci->crypt_byte_block, tci->skip_byte_block);
+			e = gf_cenc_encrypt_sample_ctr(mc, tci, samp, bs_type, nalu_size_length, IV, tci->IV_size, &st, bytes_in_nalhr, tci->crypt_byte_block, tci->skip_byte_block, job ? &job->cops : NULL);
 			if (e) goto exit;
 		} else {
 			//in cbcs scheme, if Per_Sample_IV_size is not 0 (no constant IV), fetch current IV
@@ -2090,10 +2401,28 @@ GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*pro
 				u32 IV_size = 16;
 				gf_crypt_get_IV(mc, IV, &IV_size);
 			}
-			e = gf_cenc_encrypt_sample_cbc(mc, tci, samp, bs_type, nalu_size_length, IV, tci->IV_size, &saiz_buf, &saiz_len, bytes_in_nalhr, tci->crypt_byte_block, tci->skip_byte_block);
+			e = gf_cenc_encrypt_sample_cbc(mc, tci, samp, bs_type, nalu_size_length, IV, tci->IV_size, &st, bytes_in_nalhr, tci->crypt_byte_block, tci->skip_byte_block, job ? &job->cops : NULL);
 			if (e) goto exit;
 		}
 
+		if (job) {
+			char *sai = job->sai;
+			u32 sai_alloc = job->sai_alloc;
+			job->samp = samp;
+			job->sample_number = i+1;
+			job->stsd_idx = stsd_idx;
+			//swap auxiliary info buffers, the job one will be reused for the next samples
+			job->sai = st.sai;
+			job->sai_size = st.sai_size;
+			job->sai_alloc = st.sai_alloc;
+			st.sai = sai;
+			st.sai_alloc = sai_alloc;
+			samp = NULL;
+			cenc_enc_pool_submit(pool);
+			nb_samp_encrypted++;
+			continue;
+		}
+
 		gf_isom_update_sample(mp4, track, i+1, samp, 1);
 
 		if (crypt_stsd_idx != stsd_idx) {
@@ -2102,26 +2431,30 @@ GF_Err gf_cenc_encrypt_track(GF_ISOFile *mp4, GF_TrackCryptInfo *tci, void (*pro
 		gf_isom_sample_del(&samp);
 		samp = NULL;
 
-		if (saiz_len) {
-			e = gf_isom_track_cenc_add_sample_info(mp4, track, tci->sai_saved_box_type, tci->IV_size, saiz_buf, saiz_len, use_subsamples, NULL);
+		if (st.sai_size) {
+			e = gf_isom_track_cenc_add_sample_info(mp4, track, tci->sai_saved_box_type, tci->IV_size, st.sai, st.sai_size, use_subsamples, NULL);
 			if (e)
 				goto exit;
 		}
-		gf_free(saiz_buf);
-		saiz_buf = NULL;
 
 		nb_samp_encrypted++;
 		gf_set_progress("CENC Encrypt", i+1, count);
 	}
 
+	if (pool) {
+		e = cenc_enc_pool_flush(pool, mp4, track, tci, crypt_stsd_idx, use_subsamples, count);
+		if (e) goto exit;
+	}
+
 	gf_isom_set_cts_packing(mp4, track, GF_FALSE);
 	//not strictly needed but we call it in case bitrate info in source is wrong
 	gf_media_update_bitrate(mp4, track);
 
 exit:
+	if (pool) cenc_enc_pool_del(pool);
 	if (samp) gf_isom_sample_del(&samp);
 	if (mc) gf_crypt_close(mc);
-	if (saiz_buf) gf_free(saiz_buf);
+	cenc_sample_state_reset(&st);
 	if (bs) gf_bs_del(bs);
 	if (tci->av1.config) gf_odf_av1_cfg_del(tci->av1.config);
 	return e;
@@ -3495,6 +3495,8 @@ GF_Err gf_media_fragment_file(GF_ISOFile *input, const char *output_file, Double
 	GF_List *fragmenters;
 	u32 MaxFragmentDuration;
 	GF_TrackFragmenter *tf;
+	FILE *src = NULL;
+	u64 data_offset;
 	Bool drop_version = gf_isom_drop_date_version_info_enabled(input);
 
 	//create output file
@@ -3599,6 +3601,32 @@ GF_Err gf_media_fragment_file(GF_ISOFile *input, const char *output_file, Double
 		goto err_exit;
 	}
 
+	/*if all media data is in the input file, samples are added by reference and their data is copied
+	by large ranges (kernel-side when possible) when each fragment is written*/
+	if ((gf_isom_get_mode(input) == GF_ISOM_OPEN_READ) && gf_isom_get_filename(input)) {
+		src = gf_fopen(gf_isom_get_filename(input), "rb");
+		count = gf_list_count(fragmenters);
+		for (i=0; src && (i<count); i++) {
+			tf = (GF_TrackFragmenter *)gf_list_get(fragmenters, i);
+			gf_isom_set_nalu_extract_mode(input, tf->OriginalTrack, GF_ISOM_NALU_EXTRACT_INSPECT);
+			for (j=0; j<gf_isom_get_sample_description_count(input, tf->OriginalTrack); j++) {
+				if (!gf_isom_is_self_contained(input, tf->OriginalTrack, j+1)) break;
+			}
+			if (j<gf_isom_get_sample_description_count(input, tf->OriginalTrack)) break;
+			//check samples of this track can be used as is
+			if (tf->SampleCount) {
+				sample = gf_isom_get_sample_ref(input, tf->OriginalTrack, 1, &descIndex, &data_offset);
+				if (!sample) break;
+				gf_isom_sample_del(&sample);
+			}
+		}
+		if (src && (i<count)) {
+			gf_fclose(src);
+			src = NULL;
+		}
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_AUTHOR, ("[ISOBMFF Fragmenting] %s sample data\n", src ? "Copying file ranges for" : "Loading"));
+	}
+
 	nb_done = 0;
 
 	while ( (count = gf_list_count(fragmenters)) ) {
@@ -3630,13 +3658,24 @@ GF_Err gf_media_fragment_file(GF_ISOFile *input, const char *output_file, Double
 			//ok write samples
 			while (1) {
 				if (!sample) {
-					sample = gf_isom_get_sample(input, tf->OriginalTrack, tf->SampleNum + 1, &descIndex);
+					if (src)
+						sample = gf_isom_get_sample_ref(input, tf->OriginalTrack, tf->SampleNum + 1, &descIndex, &data_offset);
+					else
+						sample = gf_isom_get_sample(input, tf->OriginalTrack, tf->SampleNum + 1, &descIndex);
+				}
+				if (!sample) {
+					e = gf_isom_last_error(input);
+					if (!e) e = GF_IO_ERR;
+					goto err_exit;
 				}
 				gf_isom_get_sample_padding_bits(input, tf->OriginalTrack, tf->SampleNum+1, &NbBits);
 
 				defaultDuration = gf_isom_get_sample_duration(input, tf->OriginalTrack, tf->SampleNum + 1);
 
-				e = gf_isom_fragment_add_sample(output, tf->TrackID, sample, descIndex, defaultDuration, NbBits, 0, 0);
+				if (src)
+					e = gf_isom_fragment_add_sample_ref(output, tf->TrackID, sample, descIndex, defaultDuration, NbBits, 0, 0, src, data_offset);
+				else
+					e = gf_isom_fragment_add_sample(output, tf->TrackID, sample, descIndex, defaultDuration, NbBits, 0, 0);
 				if (e) goto err_exit;
 
 				e = gf_isom_fragment_add_sai(output, input, tf->TrackID, tf->SampleNum + 1, descIndex);
@@ -3681,6 +3720,8 @@ err_exit:
 	gf_list_del(fragmenters);
 	if (e) gf_isom_delete(output);
   else gf_isom_close(output);
+	//data of the last fragment is copied when closing the output
+	if (src) gf_fclose(src);
 	gf_set_progress("ISO File Fragmenting", nb_samp, nb_samp);
 	return e;
 #else
@@ -731,6 +731,9 @@ static const char *QCP_SMV_GUID = "\x75\x2B\x7C\x8D\x97\xA7\x46\xED\x98\x5E\xD5\
 #endif // GPAC_DISABLE_AV_PARSERS
 
 
+/*size of the write cache used when exporting to file*/
+#define EXPORT_OUTPUT_BUFFER_SIZE	(1024*1024)
+
 #define DUMP_AVCPARAM(_params) \
 		count = gf_list_count(_params); \
 		for (i=0;i<count;i++) { \
@@ -751,6 +754,25 @@ static const char *QCP_SMV_GUID = "\x75\x2B\x7C\x8D\x97\xA7\x46\xED\x98\x5E\xD5\
 		} \
 	} \
 
+/*writes a NAL unit with start code, appending it to the pending range when the NAL size field can be rewritten in place*/
+#define EXPORT_NALU(_ptr, _size) \
+	if (nal_unit_size==4) { \
+		_ptr[-4] = _ptr[-3] = _ptr[-2] = 0; \
+		_ptr[-1] = 1; \
+		if (!pending_start) pending_start = _ptr - 4; \
+		pending_end = _ptr + _size; \
+	} else { \
+		gf_bs_write_u32(bs, 1); \
+		gf_bs_write_data(bs, _ptr, _size); \
+	}
+
+/*writes the pending range of NAL units*/
+#define EXPORT_NALU_FLUSH \
+	if (pending_start) { \
+		gf_bs_write_data(bs, pending_start, (u32) (pending_end - pending_start)); \
+		pending_start = NULL; \
+	}
+
 
 GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 {
@@ -769,6 +791,7 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 	GF_M4ADecSpecInfo a_cfg;
 	const char *stxtcfg;
 	GF_BitStream *bs;
+	GF_ISOSample *static_samp;
 	u32 track, i, di, count, m_type, m_stype, dsi_size, qcp_type;
 	Bool is_ogg, has_qcp_pad, is_vobsub;
 	u32 aac_type, aac_mode;
@@ -778,6 +801,7 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 	Bool is_webvtt = GF_FALSE;
 	dsi_size = 0;
 	dsi = NULL;
+	static_samp = NULL;
 	hevccfg = NULL;
 	avccfg = NULL;
 	svccfg = NULL;
@@ -1414,9 +1438,13 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 		gf_isom_enable_raw_pack(dumper->file, track, 2048);
 	}
 
+	/*write by large blocks and fetch all samples in the same buffer*/
+	gf_bs_set_output_buffering(bs, EXPORT_OUTPUT_BUFFER_SIZE);
+	static_samp = gf_isom_sample_new();
+
 	/* Start exporting samples */
 	for (i=0; i<count; i++) {
-		GF_ISOSample *samp = gf_isom_get_sample(dumper->file, track, i+1, &di);
+		GF_ISOSample *samp = gf_isom_get_sample_ex(dumper->file, track, i+1, &di, static_samp);
 		if (!samp) {
 			e = gf_isom_last_error(dumper->file);
 			break;
@@ -1428,6 +1456,9 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 			Bool has_aud = GF_FALSE;
 			Bool write_dsi = GF_FALSE;
 			char *ptr = samp->data;
+			/*with 4-bytes NAL size fields, sizes are replaced in place by start codes and consecutive NAL units are written at once*/
+			char *pending_start = NULL;
+			char *pending_end = NULL;
 			nal_unit_size = 0;
 			if (avccfg) nal_unit_size= avccfg->nal_unit_size;
 			else if (svccfg) nal_unit_size = svccfg->nal_unit_size;
@@ -1481,9 +1512,10 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 
 				if (is_aud) {
 					if (!has_aud) {
-						gf_bs_write_u32(bs, 1);
-						gf_bs_write_data(bs, ptr, nal_size);
+						EXPORT_NALU(ptr, nal_size)
 						has_aud = GF_TRUE;
+					} else {
+						EXPORT_NALU_FLUSH
 					}
 					ptr += nal_size;
 					remain -= nal_size;
@@ -1492,6 +1524,7 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 
 				if (!has_aud) {
 					has_aud = GF_TRUE;
+					EXPORT_NALU_FLUSH
 					gf_bs_write_u32(bs, 1);
 					if (avccfg || svccfg || mvccfg) {
 						u32 hdr = ptr[0] & 0x60;
@@ -1513,14 +1546,15 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 
 				if (write_dsi) {
 					write_dsi = GF_FALSE;
+					EXPORT_NALU_FLUSH
 					gf_bs_write_data(bs, dsi, dsi_size);
 				}
 
-				gf_bs_write_u32(bs, 1);
-				gf_bs_write_data(bs, ptr, nal_size);
+				EXPORT_NALU(ptr, nal_size)
 				ptr += nal_size;
 				remain -= nal_size;
 			}
+			EXPORT_NALU_FLUSH
 		}
 		/*adts frame header*/
 		else if (aac_mode > 0) {
@@ -1558,7 +1592,6 @@ GF_Err gf_media_export_native(GF_MediaExporter *dumper)
 		if (samp->nb_pack)
 			i += samp->nb_pack-1;
 
-		gf_isom_sample_del(&samp);
 		gf_set_progress("Media Export", i+1, count);
 		if (dumper->flags & GF_EXPORT_DO_ABORT) break;
 	}
@@ -1569,6 +1602,7 @@ exit:
 	if (mvccfg) gf_odf_avc_cfg_del(mvccfg);
 	if (hevccfg) gf_odf_hevc_cfg_del(hevccfg);
 	if (lhvccfg) gf_odf_hevc_cfg_del(lhvccfg);
+	if (static_samp) gf_isom_sample_del(&static_samp);
 	gf_bs_del(bs);
 	if (dsi) gf_free(dsi);
 	if (!is_stdout)
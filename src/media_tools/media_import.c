@@ -4824,9 +4824,251 @@ GF_Err gf_media_avc_rewrite_samples(GF_ISOFile *file, u32 track, u32 prev_size,
 
 #ifndef GPAC_DISABLE_AV_PARSERS
 
+/*NAL unit reader for Annex-B imports: a dedicated thread reads the source file by large blocks, locates
+start codes and hands complete NAL units to the importer through a bounded queue of units, so that disk IO and
+start code scanning overlap with NAL header parsing and sample writing*/
+
+/*size of a read-ahead block, grown if a single NAL unit is larger*/
+#define NALU_READER_BLOCK_SIZE	(1024*1024)
+/*number of NAL units queued between the reader thread and the importer*/
+#define NALU_READER_QUEUE_SIZE	64
+
+typedef struct
+{
+	char *data;
+	u32 alloc_size;
+	/*size of the NAL unit up to the next start code, and size without trailing zero bytes*/
+	u32 nal_and_trailing_size, nal_size;
+	/*offset of the NAL unit (after start code) in the source file*/
+	u64 nal_start;
+	/*set once the end of the source has been reached, no data in this unit*/
+	Bool eos;
+} NALUnit;
+
+typedef struct
+{
+	FILE *src;
+	Bool keep_trailing;
+
+	/*read-ahead block, block_offset is the file offset of the first byte of the block*/
+	char *block;
+	u32 block_alloc, block_size, block_pos;
+	u64 block_offset;
+	Bool src_eof;
+
+	NALUnit units[NALU_READER_QUEUE_SIZE];
+	u32 write_idx, read_idx;
+	/*the unit currently processed by the importer, released at next fetch*/
+	NALUnit *cur;
+	GF_Semaphore *free_units, *ready_units;
+	GF_Thread *th;
+	Bool threaded;
+	volatile Bool abort;
+	/*set by the reader when a buffer cannot be allocated, the end of the source is then signaled*/
+	GF_Err error;
+
+	/*stats*/
+	u64 nb_bytes, nb_nalus, start_time;
+	u32 nb_reader_waits, nb_importer_waits;
+} NALUReader;
+
+/*locates the next 3 or 4 bytes start code in data, starting the search at from. Returns the position of
+the start code or size if none is found*/
+static u32 nalu_reader_find_start_code(const char *data, u32 size, u32 from, u32 *sc_size)
+{
+	u32 pos = (from<2) ? 2 : from;
+	while (pos < size) {
+		const char *p = (const char *)memchr(data+pos, 1, size-pos);
+		if (!p) return size;
+		pos = (u32) (p - data);
+		if (!data[pos-1] && !data[pos-2]) {
+			if ((pos>=3) && !data[pos-3]) {
+				*sc_size = 4;
+				return pos-3;
+			}
+			*sc_size = 3;
+			return pos-2;
+		}
+		pos++;
+	}
+	return size;
+}
+
+/*discards consumed bytes and appends new data to the read-ahead block, growing it if full*/
+static void nalu_reader_refill(NALUReader *rd)
+{
+	u32 read;
+	if (rd->block_pos) {
+		memmove(rd->block, rd->block + rd->block_pos, rd->block_size - rd->block_pos);
+		rd->block_offset += rd->block_pos;
+		rd->block_size -= rd->block_pos;
+		rd->block_pos = 0;
+	}
+	if (rd->block_size == rd->block_alloc) {
+		char *block = (char*)gf_realloc(rd->block, sizeof(char)*2*rd->block_alloc);
+		if (!block) {
+			rd->error = GF_OUT_OF_MEM;
+			return;
+		}
+		rd->block = block;
+		rd->block_alloc *= 2;
+	}
+	read = (u32) fread(rd->block + rd->block_size, 1, rd->block_alloc - rd->block_size, rd->src);
+	if (!read) rd->src_eof = GF_TRUE;
+	rd->block_size += read;
+	rd->nb_bytes += read;
+}
+
+/*extracts the next NAL unit of the source into nu*/
+static void nalu_reader_fill_unit(NALUReader *rd, NALUnit *nu)
+{
+	u32 nal_size, sc_size = 0;
+	u32 scanned = 0;
+
+	while (1) {
+		u32 avail = rd->block_size - rd->block_pos;
+		nal_size = nalu_reader_find_start_code(rd->block + rd->block_pos, avail, scanned, &sc_size);
+		if ((nal_size<avail) || rd->src_eof) break;
+		/*resume the search on the last bytes, they may be the beginning of a start code*/
+		scanned = (avail>3) ? avail-3 : 0;
+		nalu_reader_refill(rd);
+		if (rd->error) break;
+	}
+	if (rd->error || (!nal_size && rd->src_eof && (rd->block_pos == rd->block_size))) {
+		nu->eos = GF_TRUE;
+		nu->nal_size = nu->nal_and_trailing_size = 0;
+		return;
+	}
+	if (nal_size > nu->alloc_size) {
+		char *data = (char*)gf_realloc(nu->data, sizeof(char)*nal_size);
+		if (!data) {
+			rd->error = GF_OUT_OF_MEM;
+			nu->eos = GF_TRUE;
+			nu->nal_size = nu->nal_and_trailing_size = 0;
+			return;
+		}
+		nu->data = data;
+		nu->alloc_size = nal_size;
+	}
+	nu->eos = GF_FALSE;
+	nu->nal_start = rd->block_offset + rd->block_pos;
+	nu->nal_and_trailing_size = nu->nal_size = nal_size;
+	memcpy(nu->data, rd->block + rd->block_pos, nal_size);
+	rd->block_pos += nal_size;
+
+	if (rd->block_pos < rd->block_size) {
+		/*consume start code*/
+		rd->block_pos += sc_size;
+	} else if (!rd->keep_trailing) {
+		/*trailing zero bytes at the end of the stream are not part of the last NAL unit*/
+		u32 nb_zeros = 0;
+		while ((nb_zeros < nal_size) && !nu->data[nal_size-nb_zeros-1])
+			nb_zeros++;
+		if (nb_zeros>=3) nu->nal_size -= nb_zeros;
+	}
+	rd->nb_nalus++;
+}
+
+static u32 nalu_reader_run(void *par)
+{
+	NALUReader *rd = (NALUReader *)par;
+	while (1) {
+		NALUnit *nu;
+		if (!gf_sema_wait_for(rd->free_units, 0)) {
+			rd->nb_reader_waits++;
+			gf_sema_wait(rd->free_units);
+		}
+		if (rd->abort) break;
+
+		nu = &rd->units[rd->write_idx];
+		nalu_reader_fill_unit(rd, nu);
+		rd->write_idx = (rd->write_idx + 1) % NALU_READER_QUEUE_SIZE;
+		gf_sema_notify(rd->ready_units, 1);
+		if (nu->eos) break;
+	}
+	return 0;
+}
+
+/*creates a reader starting at the current position of src, which must be right after the first start code*/
+static NALUReader *nalu_reader_new(FILE *src, u64 start, Bool keep_trailing)
+{
+	NALUReader *rd;
+	GF_SAFEALLOC(rd, NALUReader);
+	if (!rd) return NULL;
+	rd->src = src;
+	rd->keep_trailing = keep_trailing;
+	rd->block_alloc = NALU_READER_BLOCK_SIZE;
+	rd->block = (char*)gf_malloc(sizeof(char)*rd->block_alloc);
+	if (!rd->block) {
+		gf_free(rd);
+		return NULL;
+	}
+	rd->block_offset = start;
+	gf_fseek(src, start, SEEK_SET);
+	rd->start_time = gf_sys_clock_high_res();
+
+	rd->free_units = gf_sema_new(NALU_READER_QUEUE_SIZE, NALU_READER_QUEUE_SIZE);
+	rd->ready_units = gf_sema_new(NALU_READER_QUEUE_SIZE, 0);
+	rd->th = gf_th_new("NALUReader");
+	if (rd->free_units && rd->ready_units && rd->th && (gf_th_run(rd->th, nalu_reader_run, rd) == GF_OK)) {
+		rd->threaded = GF_TRUE;
+	} else {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_AUTHOR, ("[NALU Import] Cannot start reader thread, reading NAL units from importer thread\n"));
+	}
+	return rd;
+}
+
+/*releases the previously fetched unit and returns the next NAL unit, or NULL at the end of the source*/
+static NALUnit *nalu_reader_next(NALUReader *rd)
+{
+	NALUnit *nu;
+	if (!rd->threaded) {
+		nu = &rd->units[0];
+		nalu_reader_fill_unit(rd, nu);
+		return nu->eos ? NULL : nu;
+	}
+	if (rd->cur) {
+		if (rd->cur->eos) return NULL;
+		rd->cur = NULL;
+		gf_sema_notify(rd->free_units, 1);
+	}
+	if (!gf_sema_wait_for(rd->ready_units, 0)) {
+		rd->nb_importer_waits++;
+		gf_sema_wait(rd->ready_units);
+	}
+	nu = &rd->units[rd->read_idx];
+	rd->read_idx = (rd->read_idx + 1) % NALU_READER_QUEUE_SIZE;
+	rd->cur = nu;
+	return nu->eos ? NULL : nu;
+}
+
+static void nalu_reader_del(NALUReader *rd)
+{
+	u32 i;
+	u64 dur;
+	if (!rd) return;
+	if (rd->threaded) {
+		rd->abort = GF_TRUE;
+		gf_sema_notify(rd->free_units, 1);
+		gf_th_stop(rd->th);
+	}
+	dur = gf_sys_clock_high_res() - rd->start_time;
+	GF_LOG(GF_LOG_INFO, GF_LOG_AUTHOR, ("[NALU Import] "LLU" NAL units in "LLU" bytes read in "LLU" ms (%.2f MB/s) - reader waited %u times for importer, importer waited %u times for reader\n",
+		rd->nb_nalus, rd->nb_bytes, dur/1000, dur ? ((Double)rd->nb_bytes) / dur : 0, rd->nb_reader_waits, rd->nb_importer_waits));
+
+	if (rd->th) gf_th_del(rd->th);
+	if (rd->free_units) gf_sema_del(rd->free_units);
+	if (rd->ready_units) gf_sema_del(rd->ready_units);
+	for (i=0; i<NALU_READER_QUEUE_SIZE; i++) {
+		if (rd->units[i].data) gf_free(rd->units[i].data);
+	}
+	gf_free(rd->block);
+	gf_free(rd);
+}
+
 static GF_Err gf_import_avc_h264(GF_MediaImporter *import)
 {
-	u64 nal_start, nal_end, total_size;
+	u64 nal_start, total_size;
 	u32 nal_size, track, trackID, di, cur_samp, nb_i, nb_idr, nb_p, nb_b, nb_sp, nb_si, nb_sei, max_w, max_h, max_total_delay, nb_nalus;
 	s32 idx, sei_recovery_frame_count;
 	u64 duration;
@@ -4838,6 +5080,8 @@ static GF_Err gf_import_avc_h264(GF_MediaImporter *import)
 	GF_AVCConfig *avccfg, *svccfg, *dstcfg;
 	GF_BitStream *bs;
 	GF_BitStream *sample_data;
+	NALUReader *reader;
+	NALUnit *nu;
 	Bool flush_sample, sample_is_rap, sample_has_islice, sample_has_slice, is_islice, first_nal, slice_is_ref, has_cts_offset, detect_fps, is_paff, set_subsamples, slice_force_ref;
 	u32 ref_frame, timescale, copy_size, size_length, dts_inc;
 	s32 last_poc, max_last_poc, max_last_b_poc, poc_diff, prev_last_poc, min_poc, poc_shift;
@@ -4849,7 +5093,6 @@ static GF_Err gf_import_avc_h264(GF_MediaImporter *import)
 	Double FPS;
 	char *buffer;
 	Bool sample_is_ref, has_redundant;
-	u32 max_size = 4096;
 
 	if (import->flags & GF_IMPORT_PROBE_ONLY) {
 		import->nb_tracks = 1;
@@ -4887,7 +5130,8 @@ restart_import:
 	svccfg = gf_odf_avc_cfg_new();
 	/*we don't handle split import (one track / layer)*/
 	svccfg->complete_representation = 1;
-	buffer = (char*)gf_malloc(sizeof(char) * max_size);
+	buffer = NULL;
+	reader = NULL;
 	sample_data = NULL;
 	first_avc = GF_TRUE;
 	last_svc_sps = 0;
@@ -4936,6 +5180,14 @@ restart_import:
 	is_paff = GF_FALSE;
 	total_size = gf_bs_get_size(bs);
 	nal_start = gf_bs_get_position(bs);
+	/*NAL units are now fetched from the reader thread and parsed from memory*/
+	gf_bs_del(bs);
+	bs = NULL;
+	reader = nalu_reader_new(mdia, nal_start, (import->flags & GF_IMPORT_KEEP_TRAILING) ? GF_TRUE : GF_FALSE);
+	if (!reader) {
+		e = GF_OUT_OF_MEM;
+		goto exit;
+	}
 	duration = (u64) ( ((Double)import->duration) * timescale / 1000.0);
 
 	nb_i = nb_idr = nb_p = nb_b = nb_sp = nb_si = nb_sei = 0;
@@ -4954,24 +5206,16 @@ restart_import:
 	priority_prev_nalu_prefix = 0;
 	nb_nalus = 0;
 
-	while (gf_bs_available(bs)) {
+	while ((nu = nalu_reader_next(reader)) != NULL) {
 		u8 nal_hdr, skip_nal, is_subseq, add_sps, nal_ref_idc;
-		u32 nal_and_trailing_size;
 
-		nal_and_trailing_size = nal_size = gf_media_nalu_next_start_code_bs(bs);
-		if (!(import->flags & GF_IMPORT_KEEP_TRAILING)) {
-			nal_size = gf_media_nalu_payload_end_bs(bs);
-		}
-
-		if (nal_size>max_size) {
-			buffer = (char*)gf_realloc(buffer, sizeof(char)*nal_size);
-			max_size = nal_size;
-		}
+		nal_start = nu->nal_start;
+		nal_size = nu->nal_size;
+		/*work on the memory buffer of the unit, parsers may read up to the next start code*/
+		buffer = nu->data;
+		if (!bs) bs = gf_bs_new(buffer, nu->nal_and_trailing_size, GF_BITSTREAM_READ);
+		else gf_bs_reassign_buffer(bs, buffer, nu->nal_and_trailing_size);
 
-		/*read the file, and work on a memory buffer*/
-		gf_bs_read_data(bs, buffer, nal_size);
-
-		gf_bs_seek(bs, nal_start);
 		nal_hdr = gf_bs_read_u8(bs);
 		nal_type = nal_hdr & 0x1F;
 
@@ -5117,7 +5361,8 @@ restart_import:
 					avccfg = NULL;
 					gf_odf_avc_cfg_del(svccfg);
 					svccfg = NULL;
-					gf_free(buffer);
+					nalu_reader_del(reader);
+					reader = NULL;
 					buffer = NULL;
 					gf_bs_del(bs);
 					bs = NULL;
@@ -5632,29 +5877,12 @@ restart_import:
 			}
 		}
 
-		gf_bs_align(bs);
-		nal_end = gf_bs_get_position(bs);
-		assert(nal_start <= nal_end);
-		assert(nal_end <= nal_start + nal_and_trailing_size);
-		if (nal_end != nal_start + nal_and_trailing_size)
-			gf_bs_seek(bs, nal_start + nal_and_trailing_size);
-
-		if (!gf_bs_available(bs)) break;
 		if (duration && (dts_inc*cur_samp > duration)) break;
 		if (import->flags & GF_IMPORT_DO_ABORT) break;
-
-		/*consume next start code*/
-		nal_start = gf_media_nalu_next_start_code_bs(bs);
-		if (nal_start) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[avc-h264] invalid nal_size (%u)? Skipping "LLU" bytes to reach next start code\n", nal_size, nal_start));
-			gf_bs_skip_bytes(bs, nal_start);
-		}
-		nal_start = gf_media_nalu_is_start_code(bs);
-		if (!nal_start) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[avc-h264] error: no start code found ("LLU" bytes read out of "LLU") - leaving\n", gf_bs_get_position(bs), gf_bs_get_size(bs)));
-			break;
-		}
-		nal_start = gf_bs_get_position(bs);
+	}
+	if (reader->error) {
+		e = gf_import_message(import, reader->error, "Cannot allocate memory for NAL unit reading");
+		goto exit;
 	}
 
 	/*final flush*/
@@ -5879,8 +6107,8 @@ exit:
 	if (sample_data) gf_bs_del(sample_data);
 	gf_odf_avc_cfg_del(avccfg);
 	gf_odf_avc_cfg_del(svccfg);
-	gf_free(buffer);
-	gf_bs_del(bs);
+	nalu_reader_del(reader);
+	if (bs) gf_bs_del(bs);
 	gf_fclose(mdia);
 	return e;
 }
@@ -6104,7 +6332,7 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 	return GF_NOT_SUPPORTED;
 #else
 	Bool detect_fps;
-	u64 nal_start, nal_end, total_size;
+	u64 nal_start, total_size;
 	u32 i, nal_size, track, trackID, di, cur_samp, nb_i, nb_idr, nb_p, nb_b, nb_sp, nb_si, nb_sei, max_w, max_h, max_w_b, max_h_b, max_total_delay, nb_nalus, hevc_base_track;
 	s32 idx, sei_recovery_frame_count;
 	u64 duration;
@@ -6116,6 +6344,8 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 	GF_HEVCParamArray *spss, *ppss, *vpss;
 	GF_BitStream *bs;
 	GF_BitStream *sample_data;
+	NALUReader *reader;
+	NALUnit *nu;
 	Bool flush_sample, flush_next_sample, is_empty_sample, sample_has_islice, sample_has_vps, sample_has_sps, is_islice, first_nal, slice_is_ref, has_cts_offset, is_paff, set_subsamples, slice_force_ref;
 	u32 ref_frame, timescale, copy_size, size_length, dts_inc;
 	s32 last_poc, max_last_poc, max_last_b_poc, poc_diff, prev_last_poc, min_poc, poc_shift;
@@ -6132,7 +6362,6 @@ static GF_Err gf_import_hevc(GF_MediaImporter *import)
 
 	Double FPS;
 	char *buffer;
-	u32 max_size = 4096;
 
 	if (import->flags & GF_IMPORT_PROBE_ONLY) {
 		import->nb_tracks = 1;
@@ -6173,7 +6402,8 @@ restart_import:
 	lhvc_cfg = gf_odf_hevc_cfg_new();
 	lhvc_cfg->complete_representation = GF_TRUE;
 	lhvc_cfg->is_lhvc = GF_TRUE;
-	buffer = (char*)gf_malloc(sizeof(char) * max_size);
+	buffer = NULL;
+	reader = NULL;
 	sample_data = NULL;
 	first_hevc = GF_TRUE;
 	sei_recovery_frame_count = -1;
@@ -6226,6 +6456,14 @@ restart_import:
 	is_paff = GF_FALSE;
 	total_size = gf_bs_get_size(bs);
 	nal_start = gf_bs_get_position(bs);
+	/*NAL units are now fetched from the reader thread*/
+	gf_bs_del(bs);
+	bs = NULL;
+	reader = nalu_reader_new(mdia, nal_start, (import->flags & GF_IMPORT_KEEP_TRAILING) ? GF_TRUE : GF_FALSE);
+	if (!reader) {
+		e = GF_OUT_OF_MEM;
+		goto exit;
+	}
 	duration = (u64) ( ((Double)import->duration) * timescale / 1000.0);
 
 	nb_i = nb_idr = nb_p = nb_b = nb_sp = nb_si = nb_sei = 0;
@@ -6243,29 +6481,17 @@ restart_import:
 	is_empty_sample = GF_TRUE;
 	memset(max_temporal_id, 0, 64*sizeof(u8));
 
-	while (gf_bs_available(bs)) {
+	while ((nu = nalu_reader_next(reader)) != NULL) {
 		s32 res;
 		GF_HEVCConfig *prev_cfg;
 		u8 nal_unit_type, temporal_id, layer_id;
 		Bool skip_nal, add_sps, is_slice, has_vcl_nal;
-		u32 nal_and_trailing_size;
 
 		has_vcl_nal = GF_FALSE;
-		nal_and_trailing_size = nal_size = gf_media_nalu_next_start_code_bs(bs);
-		if (!(import->flags & GF_IMPORT_KEEP_TRAILING)) {
-			nal_size = gf_media_nalu_payload_end_bs(bs);
-		}
-
-
-		if (nal_size>max_size) {
-			buffer = (char*)gf_realloc(buffer, sizeof(char)*nal_size);
-			max_size = nal_size;
-		}
-
-		/*read the file, and work on a memory buffer*/
-		gf_bs_read_data(bs, buffer, nal_size);
-
-//		gf_bs_seek(bs, nal_start);
+		nal_start = nu->nal_start;
+		nal_size = nu->nal_size;
+		/*work on the memory buffer of the unit*/
+		buffer = nu->data;
 
 		res = gf_media_hevc_parse_nalu(buffer, nal_size, &hevc, &nal_unit_type, &temporal_id, &layer_id);
 
@@ -6452,10 +6678,9 @@ restart_import:
 					hevc_cfg = NULL;
 					gf_odf_hevc_cfg_del(lhvc_cfg);
 					lhvc_cfg = NULL;
-					gf_free(buffer);
+					nalu_reader_del(reader);
+					reader = NULL;
 					buffer = NULL;
-					gf_bs_del(bs);
-					bs = NULL;
 					gf_fseek(mdia, 0, SEEK_SET);
 					goto restart_import;
 				}
@@ -6951,29 +7176,12 @@ restart_import:
 		}
 
 next_nal:
-		gf_bs_align(bs);
-		nal_end = gf_bs_get_position(bs);
-		assert(nal_start <= nal_end);
-		assert(nal_end <= nal_start + nal_and_trailing_size);
-		if (nal_end != nal_start + nal_and_trailing_size)
-			gf_bs_seek(bs, nal_start + nal_and_trailing_size);
-
-		if (!gf_bs_available(bs)) break;
 		if (duration && (dts_inc*cur_samp > duration)) break;
 		if (import->flags & GF_IMPORT_DO_ABORT) break;
-
-		/*consume next start code*/
-		nal_start = gf_media_nalu_next_start_code_bs(bs);
-		if (nal_start) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[hevc] invalid nal_size (%u)? Skipping "LLU" bytes to reach next start code\n", nal_size, nal_start));
-			gf_bs_skip_bytes(bs, nal_start);
-		}
-		nal_start = gf_media_nalu_is_start_code(bs);
-		if (!nal_start) {
-			GF_LOG(GF_LOG_ERROR, GF_LOG_CODING, ("[hevc] error: no start code found ("LLU" bytes read out of "LLU") - leaving\n", gf_bs_get_position(bs), gf_bs_get_size(bs)));
-			break;
-		}
-		nal_start = gf_bs_get_position(bs);
+	}
+	if (reader->error) {
+		e = gf_import_message(import, reader->error, "Cannot allocate memory for NAL unit reading");
+		goto exit;
 	}
 
 	/*final flush*/
@@ -7293,8 +7501,8 @@ exit:
 	if (sample_data) gf_bs_del(sample_data);
 	gf_odf_hevc_cfg_del(hevc_cfg);
 	gf_odf_hevc_cfg_del(lhvc_cfg);
-	gf_free(buffer);
-	gf_bs_del(bs);
+	nalu_reader_del(reader);
+	if (bs) gf_bs_del(bs);
 	gf_fclose(mdia);
 	return e;
 #endif //GPAC_DISABLE_HEVC
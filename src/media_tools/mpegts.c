@@ -4096,16 +4096,14 @@ static u32 gf_m2ts_demuxer_run(void *_p)
 				/*process chunk*/
 				if (is_rtp) {
 #ifndef GPAC_DISABLE_STREAMING
-					char *pck;
+					const char *pck;
 					seq_num = ((data[2] << 8) & 0xFF00) | (data[3] & 0xFF);
 					gf_rtp_reorderer_add(ch, (void *) data, size, seq_num);
 
-					pck = (char *) gf_rtp_reorderer_get(ch, &size);
-					if (pck) {
-						gf_m2ts_process_data(ts, pck+12, size-12);
+					while ((pck = gf_rtp_reorderer_get_packet(ch, &size, NULL)) != NULL) {
+						gf_m2ts_process_data(ts, (char *) pck+12, size-12);
 						if (record_to)
-							fwrite(data+12, size-12, 1, record_to);
-						gf_free(pck);
+							fwrite(pck+12, size-12, 1, record_to);
 					}
 #else
 					gf_m2ts_process_data(ts, data+12, size-12);
@@ -88,11 +88,11 @@ static void gf_es_reset(GF_Channel *ch, Bool for_start)
 	ch->min_computed_cts = 0;
 	gf_es_buffer_off(ch);
 
-	if (ch->buffer) gf_free(ch->buffer);
+	gf_db_pool_release_data(ch->db_pool, ch->buffer, ch->allocSize);
 	ch->buffer = NULL;
 	ch->len = ch->allocSize = 0;
 
-	gf_db_unit_del(ch->AU_buffer_first);
+	gf_db_pool_release_unit(ch->db_pool, ch->AU_buffer_first);
 	ch->AU_buffer_first = ch->AU_buffer_last = NULL;
 	ch->AU_Count = 0;
 	ch->BufferTime = 0;
@@ -115,6 +115,7 @@ GF_Channel *gf_es_new(GF_ESD *esd)
 	if (!tmp) return NULL;
 
 	tmp->mx = gf_mx_new("Channel");
+	tmp->db_pool = gf_db_pool_new();
 	tmp->esd = esd;
 	tmp->es_state = GF_ESM_ES_SETUP;
 
@@ -194,6 +195,10 @@ void gf_es_del(GF_Channel *ch)
 	if (ch->ipmp_tool)
 		gf_modules_close_interface((GF_BaseInterface *) ch->ipmp_tool);
 
+	if (ch->db_pool) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_SYNC, ("[SyncLayer] ES%d decoding buffer pool: %d/%d AU headers and %d/%d payloads recycled\n", ch->esd->ESID, ch->db_pool->unit_hits, ch->db_pool->unit_hits + ch->db_pool->unit_misses, ch->db_pool->data_hits, ch->db_pool->data_hits + ch->db_pool->data_misses));
+		gf_db_pool_del(ch->db_pool);
+	}
 	if (ch->mx) gf_mx_del(ch->mx);
 	gf_free(ch);
 }
@@ -282,8 +287,9 @@ static void gf_es_wait_rap(GF_Channel *ch)
 	/*if using RAP signal and codec not resilient, wait for rap. If RAP isn't signaled, this will be ignored*/
 	if (ch->codec_resilient != GF_CODEC_RESILIENT_ALWAYS)
 		ch->stream_state = 2;
-	if (ch->buffer) gf_free(ch->buffer);
+	gf_db_pool_release_data(ch->db_pool, ch->buffer, ch->allocSize);
 	ch->buffer = NULL;
+	ch->len = ch->allocSize = 0;
 	ch->AULength = 0;
 	ch->au_sn = 0;
 }
@@ -293,11 +299,11 @@ void gf_es_reset_buffers(GF_Channel *ch)
 	GF_LOG(GF_LOG_ERROR, GF_LOG_SYNC, ("[SyncLayer] ES%d (%s): reseting buffers (%d AUs)\n", ch->esd->ESID, ch->odm->net_service->url, ch->AU_Count));
 	gf_mx_p(ch->mx);
 
-	if (ch->buffer) gf_free(ch->buffer);
+	gf_db_pool_release_data(ch->db_pool, ch->buffer, ch->allocSize);
 	ch->buffer = NULL;
 	ch->len = ch->allocSize = 0;
 
-	gf_db_unit_del(ch->AU_buffer_first);
+	gf_db_pool_release_unit(ch->db_pool, ch->AU_buffer_first);
 	ch->AU_buffer_first = ch->AU_buffer_last = NULL;
 	ch->AU_Count = 0;
 
@@ -315,7 +321,7 @@ void gf_es_reset_timing(GF_Channel *ch, Bool reset_buffer)
 	gf_mx_p(ch->mx);
 
 	if (reset_buffer) {
-		if (ch->buffer) gf_free(ch->buffer);
+		gf_db_pool_release_data(ch->db_pool, ch->buffer, ch->allocSize);
 		ch->buffer = NULL;
 		ch->len = ch->allocSize = 0;
 	}
@@ -455,25 +461,27 @@ static void gf_es_dispatch_au(GF_Channel *ch, u32 duration)
 
 	if (!ch->buffer || !ch->len) {
 		if (ch->buffer) {
-			gf_free(ch->buffer);
+			gf_db_pool_release_data(ch->db_pool, ch->buffer, ch->allocSize);
 			ch->buffer = NULL;
+			ch->allocSize = 0;
 		}
 		return;
 	}
 
 	if (ch->odm->codec && ch->odm->codec->decode_only_rap && !ch->IsRap) {
 		if (ch->buffer) {
-			gf_free(ch->buffer);
+			gf_db_pool_release_data(ch->db_pool, ch->buffer, ch->allocSize);
 			ch->buffer = NULL;
+			ch->allocSize = 0;
 		}
 		return;
 	}
 
-	au = gf_db_unit_new();
+	au = gf_db_pool_get_unit(ch->db_pool);
 	if (!au) {
-		gf_free(ch->buffer);
+		gf_db_pool_release_data(ch->db_pool, ch->buffer, ch->allocSize);
 		ch->buffer = NULL;
-		ch->len = 0;
+		ch->len = ch->allocSize = 0;
 		return;
 	}
 
@@ -493,6 +501,7 @@ static void gf_es_dispatch_au(GF_Channel *ch, u32 duration)
 	}
 	au->data = ch->buffer;
 	au->dataLength = ch->len;
+	au->allocSize = ch->allocSize;
 	au->PaddingBits = ch->padingBits;
 	au->sender_ntp = ch->sender_ntp;
 	ch->sender_ntp = 0;
@@ -503,8 +512,8 @@ static void gf_es_dispatch_au(GF_Channel *ch, u32 duration)
 	au->next = NULL;
 	ch->buffer = NULL;
 
-	if (ch->len + ch->media_padding_bytes != ch->allocSize) {
-		au->data = (char*)gf_realloc(au->data, sizeof(char) * (au->dataLength + ch->media_padding_bytes));
+	if (ch->len + ch->media_padding_bytes > ch->allocSize) {
+		au->data = gf_db_pool_resize_data(ch->db_pool, au->data, au->dataLength, &au->allocSize, au->dataLength + ch->media_padding_bytes);
 	}
 	if (ch->media_padding_bytes) memset(au->data + au->dataLength, 0, sizeof(char)*ch->media_padding_bytes);
 
@@ -523,7 +532,7 @@ static void gf_es_dispatch_au(GF_Channel *ch, u32 duration)
 			GF_LOG(GF_LOG_ERROR, GF_LOG_SYNC, ("[SyncLayer] ES%d (%s): Something really wrong,  decoding buffer exceeded (%d ms vs %d max) - trashing buffers\n", ch->esd->ESID, ch->odm->net_service->url, ch->BufferTime, ch->MaxBuffer));
 
 		}
-		gf_db_unit_del(ch->AU_buffer_first->next);
+		gf_db_pool_release_unit(ch->db_pool, ch->AU_buffer_first->next);
 		ch->AU_buffer_first->next = NULL;
 		ch->AU_buffer_last = ch->AU_buffer_first;
 		ch->AU_Count = 1;
@@ -665,8 +674,7 @@ static void gf_es_dispatch_au(GF_Channel *ch, u32 duration)
 				}
 				assert(au_prev);
 				if (au_prev->next && (au_prev->next->DTS==au->DTS)) {
-					gf_free(au->data);
-					gf_free(au);
+					gf_db_pool_release_unit(ch->db_pool, au);
 				} else {
 					au->next = au_prev->next;
 					au_prev->next = au;
@@ -772,10 +780,10 @@ void gf_es_receive_skip_sl(GF_ClientService *serv, GF_Channel *ch, const char *S
 	if (!StreamLength) return;
 
 	gf_es_lock(ch, 1);
-	au = gf_db_unit_new();
+	au = gf_db_pool_get_unit(ch->db_pool);
 	au->flags = GF_DB_AU_RAP;
 	au->DTS = gf_clock_time(ch->clock);
-	au->data = (char*)gf_malloc(sizeof(char) * (ch->media_padding_bytes + StreamLength));
+	au->data = gf_db_pool_get_data(ch->db_pool, ch->media_padding_bytes + StreamLength, &au->allocSize);
 	memcpy(au->data, StreamBuf, sizeof(char) * StreamLength);
 	if (ch->media_padding_bytes) memset(au->data + StreamLength, 0, sizeof(char)*ch->media_padding_bytes);
 	au->dataLength = StreamLength;
@@ -1130,7 +1138,7 @@ void gf_es_receive_sl_packet(GF_ClientService *serv, GF_Channel *ch, char *paylo
 			if (!ch->IsClockInit && !ch->skip_time_check_for_pending) gf_es_check_timing(ch);
 			gf_es_dispatch_au(ch, 0);
 		} else {
-			gf_free(ch->buffer);
+			gf_db_pool_release_data(ch->db_pool, ch->buffer, ch->allocSize);
 			ch->buffer = NULL;
 			ch->AULength = 0;
 			ch->len = ch->allocSize = 0;
@@ -1392,14 +1400,12 @@ void gf_es_receive_sl_packet(GF_ClientService *serv, GF_Channel *ch, char *paylo
 		assert(!ch->buffer);
 		/*ignore length fields*/
 		size = payload_size + ch->media_padding_bytes;
-		ch->buffer = (char*)gf_malloc(sizeof(char) * size);
+		/*padding bytes are set when dispatching the AU*/
+		ch->buffer = gf_db_pool_get_data(ch->db_pool, size, &ch->allocSize);
 		if (!ch->buffer) {
 			assert(0);
 			return;
 		}
-
-		ch->allocSize = size;
-		memset(ch->buffer, 0, sizeof(char) * size);
 		ch->len = 0;
 	}
 	if (!ch->esd->slConfig->usePaddingFlag) hdr.paddingFlag = 0;
@@ -1452,17 +1458,12 @@ void gf_es_receive_sl_packet(GF_ClientService *serv, GF_Channel *ch, char *paylo
 
 	} else {
 		/*check if enough space*/
-		size = ch->allocSize;
-		if (size && (payload_size + ch->len <= size)) {
-			memcpy(ch->buffer+ch->len, payload, payload_size);
-			ch->len += payload_size;
-		} else {
-			size = payload_size + ch->len + ch->media_padding_bytes;
-			ch->buffer = (char*)gf_realloc(ch->buffer, sizeof(char) * size);
-			memcpy(ch->buffer+ch->len, payload, payload_size);
-			ch->allocSize = size;
-			ch->len += payload_size;
+		size = payload_size + ch->len + ch->media_padding_bytes;
+		if (size > ch->allocSize) {
+			ch->buffer = gf_db_pool_resize_data(ch->db_pool, ch->buffer, ch->len, &ch->allocSize, size);
 		}
+		memcpy(ch->buffer+ch->len, payload, payload_size);
+		ch->len += payload_size;
 		if (hdr.paddingFlag) ch->padingBits = hdr.paddingBits;
 	}
 
@@ -1702,7 +1703,7 @@ void gf_es_drop_au(GF_Channel *ch)
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_SYNC, ("[ODM%d] ES%d (%s) Droping AU CTS %d\n", ch->odm->OD->objectDescriptorID, ch->esd->ESID, ch->odm->net_service->url, au->CTS));
 
 	au->next = NULL;
-	gf_db_unit_del(au);
+	gf_db_pool_release_unit(ch->db_pool, au);
 	ch->AU_Count -= 1;
 
 	if (!ch->AU_Count && ch->AU_buffer_first) {
@@ -308,6 +308,14 @@ GF_Err gf_codec_add_channel(GF_Codec *codec, GF_Channel *ch)
 			if (gf_codec_get_capability(codec, &cap) == GF_OK)
 				codec->trusted_cts = cap.cap.valueInt;
 
+			/*FIFO composition memory, decoder and compositor can exchange units without locking*/
+			codec->CB->lock_free = GF_FALSE;
+			if (codec->is_reordering && !codec->CB->no_allocation) {
+				const char *sOpt = gf_cfg_get_key(codec->odm->term->user->config, "Systems", "LockFreeCompositionMemory");
+				if (!sOpt) gf_cfg_set_key(codec->odm->term->user->config, "Systems", "LockFreeCompositionMemory", "yes");
+				if (!sOpt || !strcmp(sOpt, "yes")) codec->CB->lock_free = GF_TRUE;
+			}
+
 		}
 
 		if (codec->flags & GF_ESM_CODEC_IS_RAW_MEDIA) {
@@ -565,7 +573,7 @@ refetch_AU:
 				memcpy(baseAU->data, base_au, baseAU->dataLength);
 				memcpy(baseAU->data + baseAU->dataLength , AU->data, AU->dataLength);
 			} else {
-				baseAU->data = gf_realloc(baseAU->data, baseAU->dataLength + AU->dataLength);
+				baseAU->data = gf_db_pool_resize_data((*activeChannel)->db_pool, baseAU->data, baseAU->dataLength, &baseAU->allocSize, baseAU->dataLength + AU->dataLength);
 				memcpy(baseAU->data + baseAU->dataLength , AU->data, AU->dataLength);
 			}
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_CODEC, ("[%s] ODM%d#CH%d (%s) AU DTS %u CTS %u size %d reaggregated on base layer %d - base DTS %d size %d\n", codec->decio->module_name, codec->odm->OD->objectDescriptorID, ch->esd->ESID, ch->odm->net_service->url, AU->DTS, AU->CTS, AU->dataLength, (*activeChannel)->esd->ESID, baseAU->DTS, baseAU->dataLength));
@@ -2049,6 +2057,35 @@ static u32 get_codec_confidence(GF_Codec *codec, GF_BaseDecoder *ifce, GF_ESD *e
 	return conf;
 }
 
+/*the modules cache keeps the list of stream types handled by each decoder interface, as given by CanHandleStream
+without ESD, so that modules not handling a stream type are not loaded when browsing all modules for a decoder.
+Decoders not replying to the stream type query (no ESD) are marked with "*" and always loaded and probed*/
+static Bool codec_caps_may_handle(GF_Terminal *term, u32 plug_idx, u32 ifce_type, u32 stream_type)
+{
+	char szST[10];
+	const char *caps = gf_modules_get_capabilities(term->user->modules, plug_idx, ifce_type);
+	if (!caps || !strcmp(caps, "*")) return GF_TRUE;
+	sprintf(szST, " %02X ", stream_type);
+	return strstr(caps, szST) ? GF_TRUE : GF_FALSE;
+}
+
+static void codec_caps_build(GF_Terminal *term, u32 plug_idx, u32 ifce_type, GF_BaseDecoder *ifce)
+{
+	u32 st;
+	char caps[3*256 + 2];
+	if (!ifce->CanHandleStream) return;
+	if (gf_modules_get_capabilities(term->user->modules, plug_idx, ifce_type)) return;
+
+	strcpy(caps, " ");
+	for (st=1; st<256; st++) {
+		if (ifce->CanHandleStream(ifce, st, NULL, 0) != GF_CODEC_NOT_SUPPORTED) {
+			sprintf(caps + strlen(caps), "%02X ", st);
+		}
+	}
+	if (!caps[1]) strcpy(caps, "*");
+	gf_modules_set_capabilities(term->user->modules, plug_idx, ifce_type, caps);
+}
+
 Bool decio_blacklisted(GF_Codec *codec, const char *ifce_name)
 {
 	u32 i, count;
@@ -2182,8 +2219,10 @@ static GF_Err Codec_LoadModule(GF_Codec *codec, GF_ESD *esd, u32 PL)
 	/*not found, check all modules*/
 	plugCount = gf_modules_get_count(term->user->modules);
 	for (i = 0; i < plugCount ; i++) {
+		if (!codec_caps_may_handle(term, i, ifce_type, esd->decoderConfig->streamType)) continue;
 		ifce = (GF_BaseDecoder *) gf_modules_load_interface(term->user->modules, i, ifce_type);
 		if (!ifce) continue;
+		codec_caps_build(term, i, ifce_type, ifce);
 		if (ifce->CanHandleStream && !decio_blacklisted(codec, ifce->module_name)) {
 			u32 conf = get_codec_confidence(codec, ifce, esd, PL);
 			
@@ -26,6 +26,7 @@
 
 
 #include <gpac/internal/terminal_dev.h>
+#include <gpac/term_info.h>
 #include "media_memory.h"
 #include <gpac/internal/compositor_dev.h>
 
@@ -42,6 +43,10 @@ enum
 	/*only used by threaded decs to signal end of thread*/
 	GF_MM_CE_DEAD = 1<<4,
 	GF_MM_CE_DISCARDED = 1<<5,
+	/*decoder is scheduled by the decoder pool rather than by its own thread*/
+	GF_MM_CE_POOLED = 1<<6,
+	/*only used by pooled decs removed from within their own decoding task: entry is destroyed by the worker*/
+	GF_MM_CE_POOL_RELEASE = 1<<7,
 };
 
 typedef struct
@@ -51,8 +56,44 @@ typedef struct
 	/*for threaded decoders*/
 	GF_Thread *thread;
 	GF_Mutex *mx;
+	/*for pooled decoders: index of the worker owning the decoder*/
+	u32 worker;
 } CodecEntry;
 
+/*decoder pool used in multi-threaded mode: a fixed set of workers, each owning a queue of decoders.
+A decoder is only ever processed by one worker at a time (the one holding the codec mutex), which keeps
+decoding order intact. A worker with nothing to do in its own queue steals a decoding step from the most loaded worker*/
+typedef struct __dec_pool GF_DecoderPool;
+
+typedef struct
+{
+	GF_DecoderPool *pool;
+	GF_Thread *thread;
+	/*protects the codec queue of the worker*/
+	GF_Mutex *mx;
+	GF_List *codecs;
+	u32 index;
+	/*next codec to process in the queue*/
+	u32 pos;
+	Bool dead;
+
+	/*stats*/
+	u64 nb_tasks, nb_steals;
+	u64 busy_time;
+} GF_DecWorker;
+
+struct __dec_pool
+{
+	GF_Terminal *term;
+	GF_List *workers;
+	/*signaled when a decoder is started or when the pool is destroyed*/
+	GF_Semaphore *sema;
+	Bool running;
+	u64 start_time;
+};
+
+static void mm_pool_del(GF_DecoderPool *pool);
+
 GF_Err gf_term_init_scheduler(GF_Terminal *term, u32 threading_mode)
 {
 	term->mm_mx = gf_mx_new("MediaManager");
@@ -82,6 +123,10 @@ GF_Err gf_term_init_scheduler(GF_Terminal *term, u32 threading_mode)
 
 void gf_term_stop_scheduler(GF_Terminal *term)
 {
+	if (term->dec_pool) {
+		mm_pool_del(term->dec_pool);
+		term->dec_pool = NULL;
+	}
 	if (term->mm_thread) {
 		u32 count, i;
 
@@ -93,6 +138,7 @@ void gf_term_stop_scheduler(GF_Terminal *term)
 		for (i=0; i<count; i++) {
 			CodecEntry *ce = gf_list_get(term->codecs, i);
 			if (ce->flags & GF_MM_CE_DISCARDED) {
+				if (ce->mx) gf_mx_del(ce->mx);
 				gf_free(ce);
 				gf_list_rem(term->codecs, i);
 				count--;
@@ -118,6 +164,280 @@ static CodecEntry *mm_get_codec(GF_List *list, GF_Codec *codec)
 }
 
 
+static CodecEntry *mm_pool_pick(GF_DecWorker *wk)
+{
+	u32 i, count;
+	CodecEntry *ce;
+	gf_mx_p(wk->mx);
+	count = gf_list_count(wk->codecs);
+	for (i=0; i<count; i++) {
+		u32 idx = (wk->pos + i) % count;
+		ce = (CodecEntry*)gf_list_get(wk->codecs, idx);
+		if (!(ce->flags & GF_MM_CE_RUNNING) || ce->dec->force_cb_resize) continue;
+		/*codec is being decoded by another worker or locked by the compositor*/
+		if (!gf_mx_try_lock(ce->mx)) continue;
+		wk->pos = idx+1;
+		gf_mx_v(wk->mx);
+		return ce;
+	}
+	gf_mx_v(wk->mx);
+	return NULL;
+}
+
+static CodecEntry *mm_pool_steal(GF_DecoderPool *pool, GF_DecWorker *thief)
+{
+	u32 i, j, count, max_load;
+	GF_DecWorker *wk, *victim;
+	CodecEntry *ce;
+
+	victim = NULL;
+	max_load = 0;
+	count = gf_list_count(pool->workers);
+	for (i=0; i<count; i++) {
+		u32 load = 0;
+		wk = (GF_DecWorker*)gf_list_get(pool->workers, i);
+		if (wk == thief) continue;
+		gf_mx_p(wk->mx);
+		j=0;
+		while ((ce = (CodecEntry*)gf_list_enum(wk->codecs, &j))) {
+			if (ce->flags & GF_MM_CE_RUNNING) load++;
+		}
+		gf_mx_v(wk->mx);
+		if (load > max_load) {
+			max_load = load;
+			victim = wk;
+		}
+	}
+	/*only steal from a worker with more than one active decoder, otherwise we would just bounce the decoder between workers*/
+	if (!victim || (max_load<2)) return NULL;
+
+	gf_mx_p(victim->mx);
+	count = gf_list_count(victim->codecs);
+	for (i=0; i<count; i++) {
+		/*start from the end of the victim queue, its owner works from its current position*/
+		u32 idx = (victim->pos + count - 1 - i) % count;
+		ce = (CodecEntry*)gf_list_get(victim->codecs, idx);
+		if (!(ce->flags & GF_MM_CE_RUNNING) || ce->dec->force_cb_resize) continue;
+		if (!gf_mx_try_lock(ce->mx)) continue;
+		gf_mx_v(victim->mx);
+		return ce;
+	}
+	gf_mx_v(victim->mx);
+	return NULL;
+}
+
+static u32 RunPoolWorker(void *par)
+{
+	GF_Err e;
+	CodecEntry *ce;
+	GF_DecWorker *wk = (GF_DecWorker *)par;
+	GF_DecoderPool *pool = wk->pool;
+	GF_Terminal *term = pool->term;
+	u32 round_tasks = 0;
+	Bool round_boost = GF_FALSE;
+	u64 round_start = gf_sys_clock_high_res();
+
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CORE, ("[DecoderPool] Worker %d entering thread ID %d\n", wk->index, gf_th_id() ));
+
+	while (pool->running) {
+		u64 time_taken;
+		Bool release, stolen = GF_FALSE;
+		ce = mm_pool_pick(wk);
+		if (!ce) {
+			ce = mm_pool_steal(pool, wk);
+			stolen = GF_TRUE;
+		}
+		if (!ce) {
+			/*nothing to do, wait for a decoder to be started*/
+			gf_sema_wait_for(pool->sema, term->frame_duration);
+			round_tasks = 0;
+			round_boost = GF_FALSE;
+			round_start = gf_sys_clock_high_res();
+			continue;
+		}
+
+		time_taken = gf_sys_clock_high_res();
+		/*decoder may have been stopped while we were grabbing its mutex*/
+		if (ce->flags & GF_MM_CE_RUNNING) {
+			e = gf_codec_process(ce->dec, term->frame_duration);
+			if (e) gf_term_message(term, ce->dec->odm->net_service->url, "Decoding Error", e);
+
+			/*same as in RunSingleDec*/
+			if (!ce->dec->CB || (ce->dec->CB->UnitCount == ce->dec->CB->Capacity))
+				ce->dec->PriorityBoost = 0;
+			if (ce->dec->PriorityBoost) round_boost = GF_TRUE;
+		}
+		/*entry may be destroyed by another thread as soon as we release the codec mutex*/
+		release = (ce->flags & GF_MM_CE_POOL_RELEASE) ? GF_TRUE : GF_FALSE;
+		gf_mx_v(ce->mx);
+		if (release) {
+			gf_mx_del(ce->mx);
+			gf_free(ce);
+		}
+		time_taken = gf_sys_clock_high_res() - time_taken;
+
+		wk->nb_tasks++;
+		if (stolen) wk->nb_steals++;
+		wk->busy_time += time_taken;
+
+		/*regulate once per round on our queue, rather than once per decoder*/
+		round_tasks++;
+		if (stolen || (round_tasks >= gf_list_count(wk->codecs))) {
+			if (!round_boost && (gf_sys_clock_high_res() - round_start < 20000))
+				gf_sleep(1);
+			round_tasks = 0;
+			round_boost = GF_FALSE;
+			round_start = gf_sys_clock_high_res();
+		}
+	}
+	wk->dead = GF_TRUE;
+	return 0;
+}
+
+static GF_DecoderPool *mm_pool_new(GF_Terminal *term)
+{
+	u32 i, nb_threads = 0;
+	const char *sOpt;
+	GF_DecoderPool *pool;
+
+	sOpt = gf_cfg_get_key(term->user->config, "Systems", "DecoderThreads");
+	if (sOpt) nb_threads = atoi(sOpt);
+	if (!nb_threads) {
+		GF_SystemRTInfo rti;
+		memset(&rti, 0, sizeof(GF_SystemRTInfo));
+		gf_sys_get_rti(0xFFFFFFFF, &rti, 0);
+		nb_threads = rti.nb_cores;
+	}
+	if (!nb_threads) nb_threads = 1;
+
+	GF_SAFEALLOC(pool, GF_DecoderPool);
+	if (!pool) return NULL;
+	pool->term = term;
+	pool->workers = gf_list_new();
+	pool->sema = gf_sema_new(nb_threads, 0);
+	pool->running = GF_TRUE;
+	pool->start_time = gf_sys_clock_high_res();
+
+	for (i=0; i<nb_threads; i++) {
+		char szName[20];
+		GF_DecWorker *wk;
+		GF_SAFEALLOC(wk, GF_DecWorker);
+		if (!wk) break;
+		sprintf(szName, "DecWorker%d", i);
+		wk->pool = pool;
+		wk->index = i;
+		wk->codecs = gf_list_new();
+		wk->mx = gf_mx_new(szName);
+		wk->thread = gf_th_new(szName);
+		gf_list_add(pool->workers, wk);
+		gf_th_run(wk->thread, RunPoolWorker, wk);
+		gf_th_set_priority(wk->thread, term->priority);
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_MEDIA, ("[Terminal] Decoder pool created with %d threads\n", gf_list_count(pool->workers) ));
+	return pool;
+}
+
+static void mm_pool_del(GF_DecoderPool *pool)
+{
+	u32 i, count;
+	pool->running = GF_FALSE;
+	count = gf_list_count(pool->workers);
+	gf_sema_notify(pool->sema, count);
+	for (i=0; i<count; i++) {
+		GF_DecWorker *wk = (GF_DecWorker*)gf_list_get(pool->workers, i);
+		while (!wk->dead) gf_sleep(1);
+		gf_th_del(wk->thread);
+		gf_mx_del(wk->mx);
+		gf_list_del(wk->codecs);
+		gf_free(wk);
+	}
+	gf_list_del(pool->workers);
+	gf_sema_del(pool->sema);
+	gf_free(pool);
+}
+
+/*assigns the codec to the least loaded worker of the pool*/
+static void mm_pool_attach(GF_Terminal *term, CodecEntry *ce)
+{
+	u32 i, count, min_load;
+	GF_DecWorker *wk, *target;
+
+	if (!term->dec_pool) term->dec_pool = mm_pool_new(term);
+	if (!term->dec_pool) return;
+
+	if (!ce->mx) ce->mx = gf_mx_new(ce->dec->decio ? ce->dec->decio->module_name : "RAW");
+
+	target = NULL;
+	min_load = 0;
+	count = gf_list_count(term->dec_pool->workers);
+	for (i=0; i<count; i++) {
+		u32 load;
+		wk = (GF_DecWorker*)gf_list_get(term->dec_pool->workers, i);
+		gf_mx_p(wk->mx);
+		load = gf_list_count(wk->codecs);
+		gf_mx_v(wk->mx);
+		if (!target || (load<min_load)) {
+			target = wk;
+			min_load = load;
+		}
+	}
+	if (!target) return;
+
+	gf_mx_p(target->mx);
+	gf_list_add(target->codecs, ce);
+	gf_mx_v(target->mx);
+	ce->worker = target->index;
+	ce->flags |= GF_MM_CE_THREADED | GF_MM_CE_POOLED;
+}
+
+/*removes the codec from its worker and waits for any pending decoding step to be done. Returns GF_FALSE if called
+from within the decoding step of this codec, in which case the codec mutex is still held by the caller*/
+static Bool mm_pool_detach(GF_Terminal *term, CodecEntry *ce)
+{
+	GF_DecWorker *wk = (GF_DecWorker*)gf_list_get(term->dec_pool->workers, ce->worker);
+	if (wk) {
+		gf_mx_p(wk->mx);
+		gf_list_del_item(wk->codecs, ce);
+		gf_mx_v(wk->mx);
+	}
+	ce->flags &= ~(GF_MM_CE_THREADED | GF_MM_CE_POOLED);
+	if (gf_mx_get_num_locks(ce->mx) > 0) return GF_FALSE;
+	gf_mx_p(ce->mx);
+	gf_mx_v(ce->mx);
+	return GF_TRUE;
+}
+
+GF_EXPORT
+GF_Err gf_term_get_decoder_pool_info(GF_Terminal *term, GF_DecoderPoolInfo *info)
+{
+	u32 i, count;
+	u64 now;
+	GF_DecoderPool *pool;
+	if (!term || !info) return GF_BAD_PARAM;
+	memset(info, 0, sizeof(GF_DecoderPoolInfo));
+	pool = term->dec_pool;
+	if (!pool) return GF_OK;
+
+	now = gf_sys_clock_high_res();
+	info->run_time = now - pool->start_time;
+	count = gf_list_count(pool->workers);
+	info->nb_threads = count;
+	for (i=0; i<count; i++) {
+		GF_DecWorker *wk = (GF_DecWorker*)gf_list_get(pool->workers, i);
+		gf_mx_p(wk->mx);
+		info->nb_decoders += gf_list_count(wk->codecs);
+		gf_mx_v(wk->mx);
+		info->nb_tasks += wk->nb_tasks;
+		info->nb_steals += wk->nb_steals;
+		info->busy_time += wk->busy_time;
+	}
+	if (count && info->run_time) {
+		info->usage = (u32) (100 * info->busy_time / (count * info->run_time));
+	}
+	return GF_OK;
+}
+
+
 void gf_term_add_codec(GF_Terminal *term, GF_Codec *codec)
 {
 	u32 i, count;
@@ -167,6 +487,15 @@ void gf_term_add_codec(GF_Terminal *term, GF_Codec *codec)
 	if (codec->flags & GF_ESM_CODEC_IS_RAW_MEDIA)
 		threaded = 0;
 
+	/*in multi-threaded mode, threaded codecs are scheduled on the decoder pool*/
+	if (threaded && (term->flags & GF_TERM_MULTI_THREAD)) {
+		mm_pool_attach(term, cd);
+		if (cd->flags & GF_MM_CE_POOLED) {
+			gf_list_add(term->codecs, cd);
+			goto exit;
+		}
+	}
+
 	if (threaded) {
 		cd->thread = gf_th_new(cd->dec->decio->module_name);
 		cd->mx = gf_mx_new(cd->dec->decio->module_name);
@@ -252,6 +581,20 @@ void gf_term_remove_codec(GF_Terminal *term, GF_Codec *codec)
 			gf_th_del(ce->thread);
 			gf_mx_del(ce->mx);
 		}
+		else if (ce->flags & GF_MM_CE_POOLED) {
+			ce->flags &= ~GF_MM_CE_RUNNING;
+			if (!mm_pool_detach(term, ce)) {
+				/*we are in the decoding step of this codec, let the worker destroy the entry*/
+				if (locked) {
+					ce->flags |= GF_MM_CE_POOL_RELEASE;
+					gf_list_rem(term->codecs, i-1);
+				} else {
+					ce->flags |= GF_MM_CE_DISCARDED;
+				}
+				break;
+			}
+			if (locked) gf_mx_del(ce->mx);
+		}
 		if (locked) {
 			gf_free(ce);
 			gf_list_rem(term->codecs, i-1);
@@ -481,6 +824,8 @@ void gf_term_start_codec(GF_Codec *codec, Bool is_resume)
 		if (ce->thread) {
 			gf_th_run(ce->thread, RunSingleDec, ce);
 			gf_th_set_priority(ce->thread, term->priority);
+		} else if (ce->flags & GF_MM_CE_POOLED) {
+			gf_sema_notify(term->dec_pool->sema, 1);
 		} else {
 			term->cumulated_priority += ce->dec->Priority+1;
 		}
@@ -551,7 +896,7 @@ void gf_term_stop_codec(GF_Codec *codec, u32 reason)
 	/*don't wait for end of thread since this can be triggered within the decoding thread*/
 	if (ce->flags & GF_MM_CE_RUNNING) {
 		ce->flags &= ~GF_MM_CE_RUNNING;
-		if (!ce->thread)
+		if (!ce->thread && !(ce->flags & GF_MM_CE_POOLED))
 			term->cumulated_priority -= codec->Priority+1;
 	}
 	if (codec->CB) gf_cm_abort_buffering(codec->CB);
@@ -564,7 +909,7 @@ void gf_term_stop_codec(GF_Codec *codec, u32 reason)
 void gf_term_set_threading(GF_Terminal *term, u32 mode)
 {
 	u32 i;
-	Bool thread_it, restart_it;
+	Bool thread_it, pool_it, restart_it;
 	CodecEntry *ce;
 
 	switch (mode) {
@@ -590,13 +935,18 @@ void gf_term_set_threading(GF_Terminal *term, u32 mode)
 
 	i=0;
 	while ((ce = (CodecEntry*)gf_list_enum(term->codecs, &i))) {
+		if (ce->flags & GF_MM_CE_DISCARDED) continue;
+
 		thread_it = 0;
+		pool_it = 0;
 		/*free mode, decoder wants threading - do */
 		if ((mode == GF_TERM_THREAD_FREE) && (ce->flags & GF_MM_CE_REQ_THREAD)) thread_it = 1;
-		else if (mode == GF_TERM_THREAD_MULTI) thread_it = 1;
+		/*multi mode, decoder is scheduled on the decoder pool*/
+		else if (mode == GF_TERM_THREAD_MULTI) pool_it = 1;
 
-		if (thread_it && (ce->flags & GF_MM_CE_THREADED)) continue;
-		if (!thread_it && !(ce->flags & GF_MM_CE_THREADED)) continue;
+		if (pool_it && (ce->flags & GF_MM_CE_POOLED)) continue;
+		if (thread_it && (ce->flags & GF_MM_CE_THREADED) && !(ce->flags & GF_MM_CE_POOLED)) continue;
+		if (!thread_it && !pool_it && !(ce->flags & GF_MM_CE_THREADED)) continue;
 
 		restart_it = 0;
 		if (ce->flags & GF_MM_CE_RUNNING) {
@@ -604,7 +954,11 @@ void gf_term_set_threading(GF_Terminal *term, u32 mode)
 			ce->flags &= ~GF_MM_CE_RUNNING;
 		}
 
-		if (ce->flags & GF_MM_CE_THREADED) {
+		if (ce->flags & GF_MM_CE_POOLED) {
+			mm_pool_detach(term, ce);
+			gf_mx_del(ce->mx);
+			ce->mx = NULL;
+		} else if (ce->flags & GF_MM_CE_THREADED) {
 			/*wait for thread to die*/
 			while (!(ce->flags & GF_MM_CE_DEAD)) gf_sleep(1);
 			ce->flags &= ~GF_MM_CE_DEAD;
@@ -617,6 +971,15 @@ void gf_term_set_threading(GF_Terminal *term, u32 mode)
 			term->cumulated_priority -= ce->dec->Priority+1;
 		}
 
+		if (pool_it) {
+			mm_pool_attach(term, ce);
+			/*pool creation failure, run in our own thread*/
+			if (!(ce->flags & GF_MM_CE_POOLED)) {
+				gf_mx_del(ce->mx);
+				ce->mx = NULL;
+				thread_it = 1;
+			}
+		}
 		if (thread_it) {
 			ce->flags |= GF_MM_CE_THREADED;
 			ce->thread = gf_th_new(ce->dec->decio->module_name);
@@ -628,6 +991,8 @@ void gf_term_set_threading(GF_Terminal *term, u32 mode)
 			if (ce->thread) {
 				gf_th_run(ce->thread, RunSingleDec, ce);
 				gf_th_set_priority(ce->thread, term->priority);
+			} else if (ce->flags & GF_MM_CE_POOLED) {
+				gf_sema_notify(term->dec_pool->sema, 1);
 			} else {
 				term->cumulated_priority += ce->dec->Priority+1;
 			}
@@ -678,9 +1043,16 @@ void gf_term_set_priority(GF_Terminal *term, s32 Priority)
 
 	i=0;
 	while ((ce = (CodecEntry*)gf_list_enum(term->codecs, &i))) {
-		if (ce->flags & GF_MM_CE_THREADED)
+		if (ce->thread)
 			gf_th_set_priority(ce->thread, Priority);
 	}
+	if (term->dec_pool) {
+		GF_DecWorker *wk;
+		i=0;
+		while ((wk = (GF_DecWorker*)gf_list_enum(term->dec_pool->workers, &i))) {
+			gf_th_set_priority(wk->thread, Priority);
+		}
+	}
 	term->priority = Priority;
 	gf_mx_v(term->mm_mx);
 }
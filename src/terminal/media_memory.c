@@ -49,11 +49,173 @@ void gf_db_unit_del(GF_DBUnit *db)
 	}
 }
 
+/*max number of free AU headers and free payloads per class kept by a pool*/
+#define GF_DB_POOL_MAX_UNITS	256
+#define GF_DB_POOL_MAX_BUFFERS	32
+/*max amount of memory kept in free payloads of a pool*/
+#define GF_DB_POOL_MAX_BYTES	(8*1024*1024)
+
+GF_DBUnitPool *gf_db_pool_new()
+{
+	GF_DBUnitPool *pool;
+	GF_SAFEALLOC(pool, GF_DBUnitPool);
+	if (!pool) return NULL;
+	pool->mx = gf_mx_new("DBPool");
+	return pool;
+}
+
+void gf_db_pool_del(GF_DBUnitPool *pool)
+{
+	u32 i;
+	if (!pool) return;
+	while (pool->units) {
+		GF_DBUnit *next = pool->units->next;
+		gf_free(pool->units);
+		pool->units = next;
+	}
+	for (i=0; i<GF_DB_POOL_NUM_CLASSES; i++) {
+		while (pool->buffers[i]) {
+			char *next = *(char **) pool->buffers[i];
+			gf_free(pool->buffers[i]);
+			pool->buffers[i] = next;
+		}
+	}
+	gf_mx_del(pool->mx);
+	gf_free(pool);
+}
+
+GF_DBUnit *gf_db_pool_get_unit(GF_DBUnitPool *pool)
+{
+	GF_DBUnit *db;
+	if (!pool) return gf_db_unit_new();
+
+	gf_mx_p(pool->mx);
+	db = pool->units;
+	if (db) {
+		pool->units = db->next;
+		pool->nb_units--;
+		pool->unit_hits++;
+		gf_mx_v(pool->mx);
+		memset(db, 0, sizeof(GF_DBUnit));
+		return db;
+	}
+	pool->unit_misses++;
+	gf_mx_v(pool->mx);
+	return gf_db_unit_new();
+}
+
+static s32 gf_db_pool_get_class(u32 size)
+{
+	s32 i;
+	for (i=0; i<GF_DB_POOL_NUM_CLASSES; i++) {
+		if (size <= (u32) (256<<i)) return i;
+	}
+	return -1;
+}
+
+char *gf_db_pool_get_data(GF_DBUnitPool *pool, u32 size, u32 *alloc_size)
+{
+	char *data;
+	s32 idx = gf_db_pool_get_class(size);
+	/*too large for the pool*/
+	if (!pool || (idx<0)) {
+		*alloc_size = size;
+		if (pool) {
+			gf_mx_p(pool->mx);
+			pool->data_misses++;
+			gf_mx_v(pool->mx);
+		}
+		return (char*)gf_malloc(sizeof(char) * size);
+	}
+	*alloc_size = 256<<idx;
+
+	gf_mx_p(pool->mx);
+	data = pool->buffers[idx];
+	if (data) {
+		pool->buffers[idx] = *(char **) data;
+		pool->nb_buffers[idx]--;
+		pool->cached_bytes -= *alloc_size;
+		pool->data_hits++;
+		gf_mx_v(pool->mx);
+		return data;
+	}
+	pool->data_misses++;
+	gf_mx_v(pool->mx);
+	return (char*)gf_malloc(sizeof(char) * (*alloc_size));
+}
+
+void gf_db_pool_release_data(GF_DBUnitPool *pool, char *data, u32 alloc_size)
+{
+	s32 idx;
+	if (!data) return;
+	idx = gf_db_pool_get_class(alloc_size);
+	/*unknown size or not matching a size class*/
+	if (!pool || !alloc_size || (idx<0) || (alloc_size != (u32) (256<<idx))) {
+		gf_free(data);
+		return;
+	}
+	gf_mx_p(pool->mx);
+	if ((pool->nb_buffers[idx] >= GF_DB_POOL_MAX_BUFFERS) || (pool->cached_bytes + alloc_size > GF_DB_POOL_MAX_BYTES)) {
+		gf_mx_v(pool->mx);
+		gf_free(data);
+		return;
+	}
+	*(char **) data = pool->buffers[idx];
+	pool->buffers[idx] = data;
+	pool->nb_buffers[idx]++;
+	pool->cached_bytes += alloc_size;
+	gf_mx_v(pool->mx);
+}
+
+char *gf_db_pool_resize_data(GF_DBUnitPool *pool, char *data, u32 data_size, u32 *alloc_size, u32 new_size)
+{
+	char *new_data;
+	u32 new_alloc_size;
+	if (data && (new_size <= *alloc_size)) return data;
+
+	/*too large for the pool, realloc*/
+	if (data && (gf_db_pool_get_class(new_size)<0)) {
+		*alloc_size = new_size;
+		return (char*)gf_realloc(data, sizeof(char) * new_size);
+	}
+	new_data = gf_db_pool_get_data(pool, new_size, &new_alloc_size);
+	if (!new_data) return NULL;
+	if (data) {
+		if (data_size) memcpy(new_data, data, sizeof(char) * data_size);
+		gf_db_pool_release_data(pool, data, *alloc_size);
+	}
+	*alloc_size = new_alloc_size;
+	return new_data;
+}
+
+void gf_db_pool_release_unit(GF_DBUnitPool *pool, GF_DBUnit *db)
+{
+	if (!pool) {
+		gf_db_unit_del(db);
+		return;
+	}
+	while (db) {
+		GF_DBUnit *next = db->next;
+		if (db->data) gf_db_pool_release_data(pool, db->data, db->allocSize);
+		db->data = NULL;
+
+		gf_mx_p(pool->mx);
+		if (pool->nb_units < GF_DB_POOL_MAX_UNITS) {
+			db->next = pool->units;
+			pool->units = db;
+			pool->nb_units++;
+			db = NULL;
+		}
+		gf_mx_v(pool->mx);
+		if (db) gf_free(db);
+		db = next;
+	}
+}
+
 static GF_CMUnit *gf_cm_unit_new()
 {
-	GF_CMUnit *tmp;
-	GF_SAFEALLOC(tmp, GF_CMUnit)
-	if (tmp) memset(tmp, 0, sizeof(GF_CMUnit));
+	GF_CMUnit *tmp = (GF_CMUnit *) gf_malloc(GF_CM_UNIT_ALLOC_SIZE);
+	if (tmp) memset(tmp, 0, GF_CM_UNIT_ALLOC_SIZE);
 	return tmp;
 }
 
@@ -168,7 +330,7 @@ void gf_cm_del(GF_CompositionMemory *cb)
 void gf_cm_rewind_input(GF_CompositionMemory *cb)
 {
 	if (cb->UnitCount) {
-		cb->UnitCount--;
+		safe_int_dec(&cb->UnitCount);
 		cb->input = cb->input->prev;
 		cb->input->dataLength = 0;
 	}
@@ -341,6 +503,36 @@ void gf_cm_unlock_input(GF_CompositionMemory *cb, GF_CMUnit *cu, u32 cu_size, Bo
 		cu->TS = 0;
 		return;
 	}
+	cu->publish_time = gf_sys_clock_high_res();
+
+	/*FIFO mode without locking on the decoder side: the input is only moved by the decoder, the output only by the compositor
+	under the object lock. Publish the unit by incrementing the unit count (full barrier, so that the unit content is written
+	before) then setting its length, which the compositor checks with gf_cm_unit_ready before reading the unit.
+	Resets move both input and output under the object lock: they wait for the current publication, and publications starting
+	during a reset use the locked path. Only status changes need the object lock*/
+	if (cb->lock_free && codec_reordering && !cu->dataLength) {
+		safe_int_inc(&cb->nb_publishing);
+		if (!cb->nb_resetting) {
+			cb->input = cb->input->next;
+			cu->RenderedLength = 0;
+			safe_int_inc(&cb->UnitCount);
+			cu->dataLength = cu_size;
+			safe_int_dec(&cb->nb_publishing);
+
+			if (cb->Status == CB_BUFFER) {
+				gf_odm_lock(cb->odm, 1);
+				if ( (cb->Status == CB_BUFFER) && (cb->UnitCount >= cb->Capacity) ) {
+					cb->Status = CB_BUFFER_DONE;
+					if (cb->odm->codec->type == GF_STREAM_AUDIO)
+						cb_set_buffer_off(cb);
+				}
+				gf_odm_lock(cb->odm, 0);
+			}
+			return;
+		}
+		safe_int_dec(&cb->nb_publishing);
+	}
+
 	gf_odm_lock(cb->odm, 1);
 //		assert(cu->frame);
 
@@ -353,7 +545,7 @@ void gf_cm_unlock_input(GF_CompositionMemory *cb, GF_CMUnit *cu, u32 cu_size, Bo
 
 	if (cu) {
 		/*FIXME - if the CU already has data, this is spatial scalability so same num buffers*/
-		if (!cu->dataLength) cb->UnitCount += 1;
+		if (!cu->dataLength) safe_int_inc(&cb->UnitCount);
 		cu->dataLength = cu_size;
 		cu->RenderedLength = 0;
 
@@ -382,11 +574,24 @@ void gf_cm_unlock_input(GF_CompositionMemory *cb, GF_CMUnit *cu, u32 cu_size, Bo
 
 /*Reset composition memory. Note we don't reset the content of each frame since it would lead to green frames
 when using bitmap (visual), where data is not cached*/
+/*called with the object locked before modifying input and output, waits for the unit being published without lock if any*/
+static void cm_reset_start(GF_CompositionMemory *cb)
+{
+	safe_int_inc(&cb->nb_resetting);
+	while (cb->nb_publishing) gf_sleep(0);
+}
+
+static void cm_reset_end(GF_CompositionMemory *cb)
+{
+	safe_int_dec(&cb->nb_resetting);
+}
+
 void gf_cm_reset(GF_CompositionMemory *cb)
 {
 	GF_CMUnit *cu;
 
 	gf_odm_lock(cb->odm, 1);
+	cm_reset_start(cb);
 	cu = cb->input;
 	cu->RenderedLength = 0;
 	if (cu->dataLength && cb->odm->raw_frame_sema)  {
@@ -417,6 +622,7 @@ void gf_cm_reset(GF_CompositionMemory *cb)
 	if (cb->odm->mo) cb->odm->mo->timestamp = 0;
 
 	cb->output = cb->input;
+	cm_reset_end(cb);
 	gf_odm_lock(cb->odm, 0);
 }
 
@@ -443,6 +649,7 @@ void gf_cm_resize(GF_CompositionMemory *cb, u32 newCapacity)
 
 	/*lock buffer*/
 	gf_odm_lock(cb->odm, 1);
+	cm_reset_start(cb);
 	cu = cb->input;
 
 	cb->UnitSize = newCapacity;
@@ -470,6 +677,7 @@ void gf_cm_resize(GF_CompositionMemory *cb, u32 newCapacity)
 	
 	cb->UnitCount = 0;
 	cb->output = cb->input;
+	cm_reset_end(cb);
 	gf_odm_lock(cb->odm, 0);
 }
 
@@ -483,6 +691,7 @@ void gf_cm_reinit(GF_CompositionMemory *cb, u32 UnitSize, u32 Capacity)
 	if (!Capacity || !UnitSize) return;
 
 	gf_odm_lock(cb->odm, 1);
+	cm_reset_start(cb);
 	if (cb->input) {
 		/*break the loop and destroy*/
 		cb->input->prev->next = NULL;
@@ -517,9 +726,18 @@ void gf_cm_reinit(GF_CompositionMemory *cb, u32 UnitSize, u32 Capacity)
 	cu->next = cb->input;
 	cb->input->prev = cu;
 	cb->output = cb->input;
+	cm_reset_end(cb);
 	gf_odm_lock(cb->odm, 0);
 }
 
+Bool gf_cm_unit_ready(GF_CompositionMemory *cb, GF_CMUnit *cu)
+{
+	if (!cu->dataLength) return GF_FALSE;
+	/*lock-free mode: the decoder writes the unit length last, read it before the unit content*/
+	if (cb->lock_free) gf_memory_barrier();
+	return GF_TRUE;
+}
+
 /*access to the first available CU for rendering
 this is a blocking call since input may change the output (temporal scalability)*/
 GF_CMUnit *gf_cm_get_output(GF_CompositionMemory *cb)
@@ -542,7 +760,7 @@ GF_CMUnit *gf_cm_get_output(GF_CompositionMemory *cb)
 	}
 
 	/*no output*/
-	if (!cb->UnitCount || !cb->output->dataLength) {
+	if (!cb->UnitCount || !gf_cm_unit_ready(cb, cb->output)) {
 		if ((cb->Status != CB_STOP) && cb->HasSeenEOS && (cb->odm && cb->odm->codec)) {
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_MEDIA, ("[ODM%d] Switching composition memory to stop state - time %d\n", cb->odm->OD->objectDescriptorID, (u32) cb->odm->media_stop_time));
 
@@ -583,6 +801,13 @@ GF_CMUnit *gf_cm_get_output(GF_CompositionMemory *cb)
 			gf_odm_signal_eos(cb->odm);
 		}
 	}
+	if (cb->output->publish_time) {
+		u32 handoff = (u32) (gf_sys_clock_high_res() - cb->output->publish_time);
+		cb->output->publish_time = 0;
+		cb->nb_handoffs++;
+		cb->total_handoff_time += handoff;
+		if (handoff > cb->max_handoff_time) cb->max_handoff_time = handoff;
+	}
 	if (cb->output->sender_ntp) {
 		cb->LastRenderedNTPDiff = gf_net_get_ntp_diff_ms(cb->output->sender_ntp);
 		cb->LastRenderedNTP = cb->output->sender_ntp;
@@ -610,6 +835,7 @@ void gf_cm_output_kept(GF_CompositionMemory *cb)
 /*drop the output CU*/
 void gf_cm_drop_output(GF_CompositionMemory *cb)
 {
+	GF_CMUnit *cu;
 	gf_cm_output_kept(cb);
 
 	/*WARNING: in RAW mode, we (for the moment) only have one unit - setting output->dataLength to 0 means the input is available
@@ -635,15 +861,17 @@ void gf_cm_drop_output(GF_CompositionMemory *cb)
 		}
 	}
 
-	/*reset the output*/
-	cb->output->dataLength = 0;
-	if (cb->output->frame) {
-		cb->output->frame->Release(cb->output->frame);
-		cb->output->frame = NULL;
+	/*reset the output - the unit length is reset last since this is what makes the unit available again to the decoder*/
+	cu = cb->output;
+	if (cu->frame) {
+		cu->frame->Release(cu->frame);
+		cu->frame = NULL;
 	}
-	cb->output->TS = 0;
-	cb->output = cb->output->next;
-	cb->UnitCount -= 1;
+	cu->TS = 0;
+	cu->publish_time = 0;
+	cb->output = cu->next;
+	safe_int_dec(&cb->UnitCount);
+	cu->dataLength = 0;
 
 	if (!cb->HasSeenEOS && cb->UnitCount <= cb->Min) {
 		cb->odm->codec->PriorityBoost = 1;
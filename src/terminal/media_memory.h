@@ -65,12 +65,50 @@ typedef struct _decoding_buffer
 
 	u32 dataLength;
 	char *data;
+	/*allocated size of data, 0 if unknown. Data is recycled by the decoding buffer pool when matching one of its size classes*/
+	u32 allocSize;
 } GF_DBUnit;
 
 GF_DBUnit *gf_db_unit_new();
 void gf_db_unit_del(GF_DBUnit *db);
 
 
+/*number of payload size classes of the decoding buffer pool, from 256 bytes to 8 MBytes*/
+#define GF_DB_POOL_NUM_CLASSES	16
+
+/*decoding buffer pool: recycles AU headers and payload buffers of a channel, payloads being
+kept in power-of-2 size classes. All functions are thread-safe*/
+typedef struct _db_unit_pool
+{
+	GF_Mutex *mx;
+	/*free AU headers*/
+	GF_DBUnit *units;
+	u32 nb_units;
+	/*free payload buffers per size class, chained through their first bytes*/
+	char *buffers[GF_DB_POOL_NUM_CLASSES];
+	u32 nb_buffers[GF_DB_POOL_NUM_CLASSES];
+	/*amount of memory kept in free payload buffers*/
+	u32 cached_bytes;
+
+	/*stats*/
+	u32 unit_hits, unit_misses;
+	u32 data_hits, data_misses;
+} GF_DBUnitPool;
+
+GF_DBUnitPool *gf_db_pool_new();
+void gf_db_pool_del(GF_DBUnitPool *pool);
+/*gets a blank AU header*/
+GF_DBUnit *gf_db_pool_get_unit(GF_DBUnitPool *pool);
+/*releases a chain of AU headers and their payloads*/
+void gf_db_pool_release_unit(GF_DBUnitPool *pool, GF_DBUnit *db);
+/*gets a payload buffer of at least size bytes, alloc_size is set to the allocated size*/
+char *gf_db_pool_get_data(GF_DBUnitPool *pool, u32 size, u32 *alloc_size);
+/*releases a payload buffer. Buffers of unknown size (alloc_size 0) or not matching a size class are destroyed*/
+void gf_db_pool_release_data(GF_DBUnitPool *pool, char *data, u32 alloc_size);
+/*grows a payload buffer to at least new_size bytes, keeping the first data_size bytes*/
+char *gf_db_pool_resize_data(GF_DBUnitPool *pool, char *data, u32 data_size, u32 *alloc_size, u32 new_size);
+
+
 /*composition memory (composition buffer) status*/
 enum
 {
@@ -102,8 +140,16 @@ typedef struct _composition_unit {
 	u64 sender_ntp;
 	
 	GF_MediaDecoderFrame *frame;
+
+	/*time in us at which the unit was made available to the compositor, 0 once fetched*/
+	u64 publish_time;
 } GF_CMUnit;
 
+/*units are allocated on cache line boundaries so that the decoder filling a unit and the compositor reading
+the previous one never write to the same cache line*/
+#define GF_CM_CACHE_LINE	64
+#define GF_CM_UNIT_ALLOC_SIZE	( (sizeof(GF_CMUnit) + GF_CM_CACHE_LINE - 1) & ~(GF_CM_CACHE_LINE - 1) )
+
 
 /*composition buffer (circular buffer of CUs)*/
 struct _composition_memory
@@ -112,8 +158,11 @@ struct _composition_memory
 	if temporal scalability is enabled, this is the LAST DELIVERED CU
 	otherwise this is the next available CU slot*/
 	GF_CMUnit *input;
+	/*input and output are modified by different threads, keep them on separate cache lines*/
+	u8 input_pad[GF_CM_CACHE_LINE - sizeof(GF_CMUnit *)];
 	/*output is the next available frme for rendering*/
 	GF_CMUnit *output;
+	u8 output_pad[GF_CM_CACHE_LINE - sizeof(GF_CMUnit *)];
 	/*capacity is the number of allocated buffers*/
 	u32 Capacity;
 	/*Min is the triggering of the media manager*/
@@ -124,8 +173,15 @@ struct _composition_memory
 
 	/*Status of the buffer*/
 	u32 Status;
-	/*Number of active units*/
+	/*Number of active units - always modified with safe_int_inc/safe_int_dec*/
 	u32 UnitCount;
+	/*single producer / single consumer mode: only used with non-reordering (FIFO) decoders. The decoder publishes
+	units without locking the object manager, the unit count and data length acting as the synchronization points.
+	The compositor side still locks the object manager*/
+	Bool lock_free;
+	/*lock-free mode: set while a unit is published without lock, and while the units are reset. A reset waits for the
+	current publication, a publication during a reset goes through the locked path. Modified with safe_int_inc/safe_int_dec*/
+	u32 nb_publishing, nb_resetting;
 
 	/*OD manager ruling this CB*/
 	struct _od_manager *odm;
@@ -140,6 +196,10 @@ struct _composition_memory
 
 	u64 LastRenderedNTP;
 	s32 LastRenderedNTPDiff;
+
+	/*decoder to compositor hand-off statistics, in us: time between unit publication and its first fetch*/
+	u32 nb_handoffs, max_handoff_time;
+	u64 total_handoff_time;
 };
 
 /*a composition buffer only has fixed-size unit*/
@@ -159,6 +219,8 @@ void gf_cm_rewind_input(GF_CompositionMemory *cb);
 
 /*fetch output buffer, NULL if output is empty*/
 GF_CMUnit *gf_cm_get_output(GF_CompositionMemory *cb);
+/*checks if a unit holds data. In lock-free mode, the unit content is read after this check*/
+Bool gf_cm_unit_ready(GF_CompositionMemory *cb, GF_CMUnit *cu);
 /*release the output buffer once rendered */
 void gf_cm_drop_output(GF_CompositionMemory *cb);
 /*notifies the output has not been discarded: sets render length to 0 and check clock resume if needed*/
@@ -555,7 +555,7 @@ char *gf_mo_fetch_data(GF_MediaObject *mo, GF_MOFetchMode resync, u32 upload_tim
 	if (bench_mode && resync) {
 		resync = GF_MO_FETCH;
 		if (mo->timestamp == CU->TS) {
-			if (CU->next->dataLength) {
+			if (gf_cm_unit_ready(codec->CB, CU->next)) {
 				gf_cm_drop_output(codec->CB);
 				CU = gf_cm_get_output(codec->CB);
 			}
@@ -582,7 +582,7 @@ char *gf_mo_fetch_data(GF_MediaObject *mo, GF_MOFetchMode resync, u32 upload_tim
 				}
 			}
 			//if the next AU is at most 200 ms from the current clock use no drop mode
-			else if (CU->next->dataLength && (CU->next->TS + 200 >= obj_time)) {
+			else if (gf_cm_unit_ready(codec->CB, CU->next) && (CU->next->TS + 200 >= obj_time)) {
 				skip_resync = GF_TRUE;
 			} else {
 				GF_LOG(GF_LOG_DEBUG, GF_LOG_MEDIA, ("[ODM%d] At %u frame TS %u next frame TS %d too late in no-drop mode, enabling drop - resync mode %d\n", mo->odm->OD->objectDescriptorID, obj_time, CU->TS, CU->next->TS, resync));
@@ -599,7 +599,7 @@ char *gf_mo_fetch_data(GF_MediaObject *mo, GF_MOFetchMode resync, u32 upload_tim
 		//the time threshold for fecthing is given by the caller
 		if ( (gf_clock_is_started(codec->ck) || mo->odm->term->use_step_mode)
 
-			&& (mo->timestamp==CU->TS) && CU->next->dataLength && (CU->next->TS <= obj_time + upload_time_ms) ) {
+			&& (mo->timestamp==CU->TS) && gf_cm_unit_ready(codec->CB, CU->next) && (CU->next->TS <= obj_time + upload_time_ms) ) {
 			
 			gf_cm_drop_output(codec->CB);
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_MEDIA, ("[ODM%d] Switching to next CU CTS %u now %u\n", mo->odm->OD->objectDescriptorID, CU->next->TS, obj_time));
@@ -621,7 +621,7 @@ char *gf_mo_fetch_data(GF_MediaObject *mo, GF_MOFetchMode resync, u32 upload_tim
 				GF_LOG(GF_LOG_DEBUG, GF_LOG_MEDIA, ("[ODM%d] Try to drop frame TS %u next frame TS %u length %d obj time %u\n", mo->odm->OD->objectDescriptorID, CU->TS, CU->next->TS, CU->next->dataLength, obj_time));
 			}
 
-			if (!CU->next->dataLength) {
+			if (!gf_cm_unit_ready(codec->CB, CU->next)) {
 				if (force_decode_mode) {
 					obj_time = gf_clock_time(codec->ck);
 					gf_odm_lock(mo->odm, 0);
@@ -630,7 +630,7 @@ char *gf_mo_fetch_data(GF_MediaObject *mo, GF_MOFetchMode resync, u32 upload_tim
 						gf_term_lock_codec(codec, GF_FALSE, GF_TRUE);
 					}
 					gf_odm_lock(mo->odm, 1);
-					if (!CU->next->dataLength) {
+					if (!gf_cm_unit_ready(codec->CB, CU->next)) {
 						break;
 					}
 				} else {
@@ -663,7 +663,7 @@ char *gf_mo_fetch_data(GF_MediaObject *mo, GF_MOFetchMode resync, u32 upload_tim
 	mo->frame = CU->data + CU->RenderedLength;
 	mo->media_frame = CU->frame;
 
-	if (CU->next->dataLength) {
+	if (gf_cm_unit_ready(codec->CB, CU->next)) {
 		diff = (s32) (CU->next->TS) - (s32) obj_time;
 	} else  {
 		diff = mo->odm->codec->min_frame_dur;
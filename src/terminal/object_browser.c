@@ -247,6 +247,7 @@ GF_Err gf_term_get_object_info(GF_Terminal *term, GF_ObjectManager *odm, GF_Medi
 
 	info->buffer = -2;
 	info->db_unit_count = 0;
+	info->db_pool_hits = info->db_pool_misses = 0;
 
 	/*Warning: is_open==2 means object setup, don't check then*/
 	if (odm->state==GF_ODM_STATE_IN_SETUP) {
@@ -273,6 +274,10 @@ GF_Err gf_term_get_object_info(GF_Terminal *term, GF_ObjectManager *odm, GF_Medi
 			i=0;
 			while ((ch = (GF_Channel*)gf_list_enum(odm->channels, &i))) {
 				info->db_unit_count += ch->AU_Count;
+				if (ch->db_pool) {
+					info->db_pool_hits += ch->db_pool->unit_hits + ch->db_pool->data_hits;
+					info->db_pool_misses += ch->db_pool->unit_misses + ch->db_pool->data_misses;
+				}
 				if (!ch->is_pulling || ch->MaxBuffer) {
 					if (ch->MaxBuffer) info->buffer = 0;
 					buf += ch->BufferTime;
@@ -319,6 +324,9 @@ GF_Err gf_term_get_object_info(GF_Terminal *term, GF_ObjectManager *odm, GF_Medi
 		if (codec->CB) {
 			info->cb_max_count = codec->CB->Capacity;
 			info->cb_unit_count = codec->CB->UnitCount;
+			info->lock_free_cb = codec->CB->lock_free;
+			if (codec->CB->nb_handoffs) info->avg_handoff_time = (u32) (codec->CB->total_handoff_time / codec->CB->nb_handoffs);
+			info->max_handoff_time = codec->CB->max_handoff_time;
 			if (codec->direct_vout) {
 				info->direct_video_memory = 1;
 			}
@@ -767,9 +767,9 @@ GF_Terminal *gf_term_new(GF_User *user)
 	}
 	gf_mx_v(tmp->mm_mx);
 
-	if (0 == gf_cfg_get_key_count(user->config, "MimeTypes")) {
+	/*register mime types at first launch, or again if modules were added, removed or modified*/
+	if (!gf_cfg_get_key_count(user->config, "MimeTypes") || gf_modules_manifest_changed(user->modules)) {
 		GF_LOG(GF_LOG_INFO, GF_LOG_MEDIA, ("[Terminal] Initializing Mime Types..."));
-		/* No mime-types detected, probably the first launch */
 		for (i=0; i< gf_modules_get_count(user->modules); i++) {
 			GF_BaseInterface *ifce = gf_modules_load_interface(user->modules, i, GF_NET_CLIENT_INTERFACE);
 			if (ifce) {
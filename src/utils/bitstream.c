@@ -1167,6 +1167,79 @@ GF_Err gf_bs_transfer(GF_BitStream *dst, GF_BitStream *src)
 	return GF_OK;
 }
 
+/*block size used when copying file ranges through memory*/
+#define BS_FILE_COPY_BLOCK_SIZE	0x100000
+
+#if defined(GPAC_CONFIG_LINUX) && !defined(GPAC_ANDROID)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/sendfile.h>
+
+/*kernel-side copy between two files, returns the number of bytes copied*/
+static u64 bs_copy_file_range_sys(s32 fd_in, u64 src_offset, s32 fd_out, u64 dst_offset, u64 size)
+{
+	u64 done = 0;
+#ifdef SYS_copy_file_range
+	while (done < size) {
+		loff_t off_in = (loff_t) (src_offset + done);
+		loff_t off_out = (loff_t) (dst_offset + done);
+		ssize_t res = syscall(SYS_copy_file_range, fd_in, &off_in, fd_out, &off_out, (size_t) (size - done), 0);
+		if (res <= 0) break;
+		done += res;
+	}
+	if (done == size) return done;
+#endif
+	/*copy_file_range not available (old kernel, cross-filesystem copy): use sendfile*/
+	if (lseek64(fd_out, (off64_t) (dst_offset + done), SEEK_SET) < 0) return done;
+	while (done < size) {
+		off64_t off_in = (off64_t) (src_offset + done);
+		ssize_t res = sendfile64(fd_out, fd_in, &off_in, (size_t) (size - done));
+		if (res <= 0) break;
+		done += res;
+	}
+	return done;
+}
+#endif
+
+GF_EXPORT
+u64 gf_bs_write_file_range(GF_BitStream *bs, FILE *src, u64 src_offset, u64 size)
+{
+	u64 done = 0;
+	char *block;
+	if (!bs || !src || !size) return 0;
+	if (!gf_bs_is_align(bs)) return 0;
+
+	if (bs->bsmode == GF_BITSTREAM_FILE_WRITE) {
+		if (bs->buffer_io)
+			bs_flush_cache(bs);
+#if defined(GPAC_CONFIG_LINUX) && !defined(GPAC_ANDROID)
+		fflush(bs->stream);
+		done = bs_copy_file_range_sys(fileno(src), src_offset, fileno(bs->stream), bs->position, size);
+		if (done) {
+			/*data was written behind the back of the stream, resync it*/
+			bs->position += done;
+			if (bs->position > bs->size) bs->size = bs->position;
+		}
+		gf_fseek(bs->stream, bs->position, SEEK_SET);
+#endif
+	}
+	if (done == size) return done;
+
+	/*copy through memory*/
+	block = (char*)gf_malloc(sizeof(char) * (u32) MIN(size - done, BS_FILE_COPY_BLOCK_SIZE));
+	if (!block) return done;
+	gf_fseek(src, src_offset + done, SEEK_SET);
+	while (done < size) {
+		u32 to_read = (u32) MIN(size - done, BS_FILE_COPY_BLOCK_SIZE);
+		u32 read = (u32) fread(block, 1, to_read, src);
+		if (!read) break;
+		if (gf_bs_write_data(bs, block, read) != read) break;
+		done += read;
+	}
+	gf_free(block);
+	return done;
+}
+
 GF_EXPORT
 void gf_bs_flush(GF_BitStream *bs)
 {
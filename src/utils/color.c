@@ -27,6 +27,17 @@
 #include <gpac/tools.h>
 #include <gpac/constants.h>
 #include <gpac/color.h>
+#include <gpac/thread.h>
+
+#if defined(WIN32) && !defined(__GNUC__)
+# include <intrin.h>
+# define GPAC_HAS_SSE2
+#else
+# ifdef __SSE2__
+#  include <emmintrin.h>
+#  define GPAC_HAS_SSE2
+# endif
+#endif
 
 #ifndef GPAC_DISABLE_PLAYER
 
@@ -59,6 +70,147 @@ static void yuv2rgb_init(void)
 	}
 }
 
+#ifdef GPAC_HAS_SSE2
+
+/*SSE2 versions of the YUV loaders, computing the same values as the lookup tables above: lines are converted by
+blocks of 16 pixels, the remaining pixels are converted by the C loaders*/
+#define YUV_SSE2_BLOCK	16
+
+/*converts 8 pixels to RGBA - y, u and v hold 16 bits samples, one chroma sample per pixel, a holds 8 alpha bytes*/
+static GFINLINE void yuv_to_rgba_sse2(u8 *dst, __m128i y, __m128i u, __m128i v, __m128i a)
+{
+	__m128i r, g, b, lo, hi, rg, ba;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i c_r = _mm_setr_epi16(FIX_OUT(1.164), FIX_OUT(1.596), FIX_OUT(1.164), FIX_OUT(1.596), FIX_OUT(1.164), FIX_OUT(1.596), FIX_OUT(1.164), FIX_OUT(1.596));
+	const __m128i c_b = _mm_setr_epi16(FIX_OUT(1.164), FIX_OUT(2.018), FIX_OUT(1.164), FIX_OUT(2.018), FIX_OUT(1.164), FIX_OUT(2.018), FIX_OUT(1.164), FIX_OUT(2.018));
+	const __m128i c_g = _mm_setr_epi16(FIX_OUT(1.164), -FIX_OUT(0.391), FIX_OUT(1.164), -FIX_OUT(0.391), FIX_OUT(1.164), -FIX_OUT(0.391), FIX_OUT(1.164), -FIX_OUT(0.391));
+	const __m128i c_gv = _mm_setr_epi16(-FIX_OUT(0.813), 0, -FIX_OUT(0.813), 0, -FIX_OUT(0.813), 0, -FIX_OUT(0.813), 0);
+
+	y = _mm_sub_epi16(y, _mm_set1_epi16(16));
+	u = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	v = _mm_sub_epi16(v, _mm_set1_epi16(128));
+
+	lo = _mm_madd_epi16(_mm_unpacklo_epi16(y, v), c_r);
+	hi = _mm_madd_epi16(_mm_unpackhi_epi16(y, v), c_r);
+	r = _mm_packs_epi32(_mm_srai_epi32(lo, SCALEBITS_OUT), _mm_srai_epi32(hi, SCALEBITS_OUT));
+
+	lo = _mm_madd_epi16(_mm_unpacklo_epi16(y, u), c_b);
+	hi = _mm_madd_epi16(_mm_unpackhi_epi16(y, u), c_b);
+	b = _mm_packs_epi32(_mm_srai_epi32(lo, SCALEBITS_OUT), _mm_srai_epi32(hi, SCALEBITS_OUT));
+
+	lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(y, u), c_g), _mm_madd_epi16(_mm_unpacklo_epi16(v, zero), c_gv));
+	hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(y, u), c_g), _mm_madd_epi16(_mm_unpackhi_epi16(v, zero), c_gv));
+	g = _mm_packs_epi32(_mm_srai_epi32(lo, SCALEBITS_OUT), _mm_srai_epi32(hi, SCALEBITS_OUT));
+
+	/*saturating packs perform the clipping*/
+	r = _mm_packus_epi16(r, r);
+	g = _mm_packus_epi16(g, g);
+	b = _mm_packus_epi16(b, b);
+	rg = _mm_unpacklo_epi8(r, g);
+	ba = _mm_unpacklo_epi8(b, a);
+	_mm_storeu_si128((__m128i *) dst, _mm_unpacklo_epi16(rg, ba));
+	_mm_storeu_si128((__m128i *) (dst+16), _mm_unpackhi_epi16(rg, ba));
+}
+
+/*8 bits planar line, chroma is horizontally subsampled unless full_chroma is set. a_src may be NULL for opaque pixels.
+Returns the number of converted pixels*/
+static u32 yuv_load_line_sse2(u8 *dst, u8 *y_src, u8 *u_src, u8 *v_src, u8 *a_src, u32 width, Bool full_chroma)
+{
+	u32 x, nb_blocks = width / YUV_SSE2_BLOCK;
+	const __m128i zero = _mm_setzero_si128();
+	__m128i a = _mm_set1_epi8((char) 0xFF);
+
+	for (x=0; x<nb_blocks; x++) {
+		__m128i y, u, v, u_lo, u_hi, v_lo, v_hi;
+		y = _mm_loadu_si128((__m128i *) y_src);
+		if (full_chroma) {
+			u = _mm_loadu_si128((__m128i *) u_src);
+			v = _mm_loadu_si128((__m128i *) v_src);
+			u_lo = _mm_unpacklo_epi8(u, zero);
+			u_hi = _mm_unpackhi_epi8(u, zero);
+			v_lo = _mm_unpacklo_epi8(v, zero);
+			v_hi = _mm_unpackhi_epi8(v, zero);
+			u_src += 16;
+			v_src += 16;
+		} else {
+			u = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *) u_src), zero);
+			v = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *) v_src), zero);
+			u_lo = _mm_unpacklo_epi16(u, u);
+			u_hi = _mm_unpackhi_epi16(u, u);
+			v_lo = _mm_unpacklo_epi16(v, v);
+			v_hi = _mm_unpackhi_epi16(v, v);
+			u_src += 8;
+			v_src += 8;
+		}
+		if (a_src) {
+			a = _mm_loadu_si128((__m128i *) a_src);
+			a_src += 16;
+		}
+		yuv_to_rgba_sse2(dst, _mm_unpacklo_epi8(y, zero), u_lo, v_lo, a);
+		yuv_to_rgba_sse2(dst+32, _mm_unpackhi_epi8(y, zero), u_hi, v_hi, _mm_srli_si128(a, 8));
+		y_src += 16;
+		dst += 64;
+	}
+	return nb_blocks * YUV_SSE2_BLOCK;
+}
+
+/*10 bits planar line, samples are scaled down to 8 bits as in the C loaders*/
+static u32 yuv_10_load_line_sse2(u8 *dst, u16 *y_src, u16 *u_src, u16 *v_src, u32 width, Bool full_chroma)
+{
+	u32 x, nb_blocks = width / YUV_SSE2_BLOCK;
+	const __m128i a = _mm_set1_epi8((char) 0xFF);
+
+	for (x=0; x<nb_blocks; x++) {
+		__m128i u, v, u_lo, u_hi, v_lo, v_hi;
+		if (full_chroma) {
+			u_lo = _mm_srli_epi16(_mm_loadu_si128((__m128i *) u_src), 2);
+			u_hi = _mm_srli_epi16(_mm_loadu_si128((__m128i *) (u_src+8)), 2);
+			v_lo = _mm_srli_epi16(_mm_loadu_si128((__m128i *) v_src), 2);
+			v_hi = _mm_srli_epi16(_mm_loadu_si128((__m128i *) (v_src+8)), 2);
+			u_src += 16;
+			v_src += 16;
+		} else {
+			u = _mm_srli_epi16(_mm_loadu_si128((__m128i *) u_src), 2);
+			v = _mm_srli_epi16(_mm_loadu_si128((__m128i *) v_src), 2);
+			u_lo = _mm_unpacklo_epi16(u, u);
+			u_hi = _mm_unpackhi_epi16(u, u);
+			v_lo = _mm_unpacklo_epi16(v, v);
+			v_hi = _mm_unpackhi_epi16(v, v);
+			u_src += 8;
+			v_src += 8;
+		}
+		yuv_to_rgba_sse2(dst, _mm_srli_epi16(_mm_loadu_si128((__m128i *) y_src), 2), u_lo, v_lo, a);
+		yuv_to_rgba_sse2(dst+32, _mm_srli_epi16(_mm_loadu_si128((__m128i *) (y_src+8)), 2), u_hi, v_hi, a);
+		y_src += 16;
+		dst += 64;
+	}
+	return nb_blocks * YUV_SSE2_BLOCK;
+}
+
+/*YUYV packed line*/
+static u32 yuyv_load_line_sse2(u8 *dst, u8 *src, u32 width)
+{
+	u32 x, nb_blocks = width / 8;
+	const __m128i a = _mm_set1_epi8((char) 0xFF);
+	const __m128i mask_y = _mm_set1_epi16(0xFF);
+	const __m128i mask_u = _mm_set1_epi32(0xFFFF);
+
+	for (x=0; x<nb_blocks; x++) {
+		__m128i yuyv, uv, u, v;
+		yuyv = _mm_loadu_si128((__m128i *) src);
+		/*one U and V sample per 32 bits, duplicated for both pixels*/
+		uv = _mm_srli_epi16(yuyv, 8);
+		u = _mm_and_si128(uv, mask_u);
+		v = _mm_srli_epi32(uv, 16);
+		yuv_to_rgba_sse2(dst, _mm_and_si128(yuyv, mask_y), _mm_or_si128(u, _mm_slli_epi32(u, 16)), _mm_or_si128(v, _mm_slli_epi32(v, 16)), a);
+		src += 16;
+		dst += 32;
+	}
+	return nb_blocks * 8;
+}
+
+#endif
+
 static void gf_yuv_load_lines_planar(unsigned char *dst, s32 dststride, unsigned char *y_src, unsigned char *u_src, unsigned char * v_src, s32 y_stride, s32 uv_stride, s32 width)
 {
 	u32 hw, x;
@@ -66,7 +218,17 @@ static void gf_yuv_load_lines_planar(unsigned char *dst, s32 dststride, unsigned
 	unsigned char *y_src2 = (unsigned char *) y_src + y_stride;
 
 	hw = width / 2;
-	for (x = 0; x < hw; x++) {
+	x = 0;
+#ifdef GPAC_HAS_SSE2
+	x = yuv_load_line_sse2(dst, y_src, u_src, v_src, NULL, width, GF_FALSE);
+	yuv_load_line_sse2(dst2, y_src2, u_src, v_src, NULL, width, GF_FALSE);
+	y_src += x;
+	y_src2 += x;
+	dst += 4*x;
+	dst2 += 4*x;
+	x /= 2;
+#endif
+	for (; x < hw; x++) {
 		s32 u, v;
 		s32 b_u, g_uv, r_v, rgb_y;
 
@@ -118,7 +280,21 @@ static void gf_yuv422_load_lines_planar(unsigned char *dst, s32 dststride, unsig
 	unsigned char *v_src2 = (unsigned char *)v_src + uv_stride;
 
 	hw = width / 2;
-	for (x = 0; x < hw; x++) {
+	x = 0;
+#ifdef GPAC_HAS_SSE2
+	x = yuv_load_line_sse2(dst, y_src, u_src, v_src, NULL, width, GF_FALSE);
+	yuv_load_line_sse2(dst2, y_src2, u_src2, v_src2, NULL, width, GF_FALSE);
+	y_src += x;
+	y_src2 += x;
+	u_src += x/2;
+	v_src += x/2;
+	u_src2 += x/2;
+	v_src2 += x/2;
+	dst += 4*x;
+	dst2 += 4*x;
+	x /= 2;
+#endif
+	for (; x < hw; x++) {
 		s32 b_u, g_uv, r_v, rgb_y;
 
 
@@ -176,7 +352,21 @@ static void gf_yuv444_load_lines_planar(unsigned char *dst, s32 dststride, unsig
 	unsigned char *v_src2 = (unsigned char *)v_src + uv_stride;
 
 	hw = width / 2;
-	for (x = 0; x < hw; x++) {
+	x = 0;
+#ifdef GPAC_HAS_SSE2
+	x = yuv_load_line_sse2(dst, y_src, u_src, v_src, NULL, width, GF_TRUE);
+	yuv_load_line_sse2(dst2, y_src2, u_src2, v_src2, NULL, width, GF_TRUE);
+	y_src += x;
+	y_src2 += x;
+	u_src += x;
+	v_src += x;
+	u_src2 += x;
+	v_src2 += x;
+	dst += 4*x;
+	dst2 += 4*x;
+	x /= 2;
+#endif
+	for (; x < hw; x++) {
 		s32 b_u, g_uv, r_v, rgb_y;
 
 
@@ -248,7 +438,17 @@ static void gf_yuv_10_load_lines_planar(unsigned char *dst, s32 dststride, unsig
 
 
 	hw = width / 2;
-	for (x = 0; x < hw; x++) {
+	x = 0;
+#ifdef GPAC_HAS_SSE2
+	x = yuv_10_load_line_sse2(dst, y_src, u_src, v_src, width, GF_FALSE);
+	yuv_10_load_line_sse2(dst2, y_src2, u_src, v_src, width, GF_FALSE);
+	y_src += x;
+	y_src2 += x;
+	dst += 4*x;
+	dst2 += 4*x;
+	x /= 2;
+#endif
+	for (; x < hw; x++) {
 		s32 u, v;
 		s32 b_u, g_uv, r_v, rgb_y;
 
@@ -305,7 +505,21 @@ static void gf_yuv422_10_load_lines_planar(unsigned char *dst, s32 dststride, un
 
 
 	hw = width / 2;
-	for (x = 0; x < hw; x++) {
+	x = 0;
+#ifdef GPAC_HAS_SSE2
+	x = yuv_10_load_line_sse2(dst, y_src, u_src, v_src, width, GF_FALSE);
+	yuv_10_load_line_sse2(dst2, y_src2, u_src2, v_src2, width, GF_FALSE);
+	y_src += x;
+	y_src2 += x;
+	u_src += x/2;
+	v_src += x/2;
+	u_src2 += x/2;
+	v_src2 += x/2;
+	dst += 4*x;
+	dst2 += 4*x;
+	x /= 2;
+#endif
+	for (; x < hw; x++) {
 		s32 b_u, g_uv, r_v, rgb_y;
 
 		b_u = B_U[*u_src >> 2];
@@ -368,7 +582,21 @@ static void gf_yuv444_10_load_lines_planar(unsigned char *dst, s32 dststride, un
 
 
 	hw = width / 2;
-	for (x = 0; x < hw; x++) {
+	x = 0;
+#ifdef GPAC_HAS_SSE2
+	x = yuv_10_load_line_sse2(dst, y_src, u_src, v_src, width, GF_TRUE);
+	yuv_10_load_line_sse2(dst2, y_src2, u_src2, v_src2, width, GF_TRUE);
+	y_src += x;
+	y_src2 += x;
+	u_src += x;
+	v_src += x;
+	u_src2 += x;
+	v_src2 += x;
+	dst += 4*x;
+	dst2 += 4*x;
+	x /= 2;
+#endif
+	for (; x < hw; x++) {
 		s32 b_u, g_uv, r_v, rgb_y;
 
 
@@ -434,7 +662,16 @@ static void gf_yuv_load_lines_packed(unsigned char *dst, s32 dststride, unsigned
 	u32 hw, x;
 
 	hw = width / 2;
-	for (x = 0; x < hw; x++) {
+	x = 0;
+#ifdef GPAC_HAS_SSE2
+	x = yuyv_load_line_sse2(dst, y_src, width);
+	dst += 4*x;
+	y_src += 2*x;
+	u_src += 2*x;
+	v_src += 2*x;
+	x /= 2;
+#endif
+	for (; x < hw; x++) {
 		s32 u, v;
 		s32 b_u, g_uv, r_v, rgb_y;
 
@@ -476,7 +713,19 @@ static void gf_yuva_load_lines(unsigned char *dst, s32 dststride, unsigned char
 	yuv2rgb_init();
 
 	hw = width / 2;
-	for (x = 0; x < hw; x++) {
+	x = 0;
+#ifdef GPAC_HAS_SSE2
+	x = yuv_load_line_sse2(dst, y_src, u_src, v_src, a_src, width, GF_FALSE);
+	yuv_load_line_sse2(dst2, y_src2, u_src, v_src, a_src2, width, GF_FALSE);
+	y_src += x;
+	y_src2 += x;
+	a_src += x;
+	a_src2 += x;
+	dst += 4*x;
+	dst2 += 4*x;
+	x /= 2;
+#endif
+	for (; x < hw; x++) {
 		s32 u, v;
 		s32 b_u, g_uv, r_v, rgb_y;
 
@@ -532,6 +781,36 @@ static s32 mul255(s32 a, s32 b)
 typedef void (*copy_row_proto)(u8 *src, u32 src_w, u8 *_dst, u32 dst_w, s32 h_inc, s32 x_pitch, u8 alpha);
 typedef void (*load_line_proto)(u8 *src_bits, u32 x_offset, u32 y_offset, u32 y_pitch, u32 src_width, u32 src_height, u8 *dst_bits);
 
+#ifdef GPAC_HAS_SSE2
+/*copies an unscaled row of RGBA pixels to a 32 bits surface by blocks of 4 pixels, swapping R and B if needed. As in
+the C code, transparent pixels leave the destination untouched. Returns the number of copied pixels*/
+static u32 copy_row_32_sse2(u8 *src, u8 *dst, u32 dst_w, Bool swap_rb)
+{
+	u32 i, nb_blocks = dst_w / 4;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask_a = _mm_set1_epi32((s32) 0xFF000000);
+	const __m128i mask_g = _mm_set1_epi32(0x0000FF00);
+	const __m128i mask_r = _mm_set1_epi32(0x00FF0000);
+	const __m128i mask_b = _mm_set1_epi32(0x000000FF);
+
+	for (i=0; i<nb_blocks; i++) {
+		__m128i px = _mm_loadu_si128((__m128i *) src);
+		__m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(px, mask_a), zero);
+		if (swap_rb) {
+			px = _mm_or_si128(_mm_and_si128(px, mask_g), _mm_or_si128(_mm_and_si128(_mm_slli_epi32(px, 16), mask_r), _mm_and_si128(_mm_srli_epi32(px, 16), mask_b)));
+		}
+		px = _mm_or_si128(px, mask_a);
+		if (_mm_movemask_epi8(transparent)) {
+			px = _mm_or_si128(_mm_and_si128(transparent, _mm_loadu_si128((__m128i *) dst)), _mm_andnot_si128(transparent, px));
+		}
+		_mm_storeu_si128((__m128i *) dst, px);
+		src += 16;
+		dst += 16;
+	}
+	return nb_blocks * 4;
+}
+#endif
+
 static void copy_row_rgb_555(u8 *src, u32 src_w, u8 *_dst, u32 dst_w, s32 h_inc, s32 x_pitch, u8 alpha)
 {
 	s32 pos;
@@ -632,6 +911,15 @@ static void copy_row_bgrx(u8 *src, u32 src_w, u8 *dst, u32 dst_w, s32 h_inc, s32
 	u8 a=0, r=0, g=0, b=0;
 	s32 pos = 0x10000L;
 
+#ifdef GPAC_HAS_SSE2
+	if ((h_inc == 0x10000L) && (x_pitch == 4)) {
+		u32 done = copy_row_32_sse2(src, dst, dst_w, GF_TRUE);
+		src += 4*done;
+		dst += 4*done;
+		dst_w -= done;
+	}
+#endif
+
 	while (dst_w) {
 		while ( pos >= 0x10000L ) {
 			r = *src++;
@@ -657,6 +945,15 @@ static void copy_row_rgbx(u8 *src, u32 src_w, u8 *dst, u32 dst_w, s32 h_inc, s32
 	u8 a=0, r=0, g=0, b=0;
 	s32 pos = 0x10000L;
 
+#ifdef GPAC_HAS_SSE2
+	if ((h_inc == 0x10000L) && (x_pitch == 4)) {
+		u32 done = copy_row_32_sse2(src, dst, dst_w, GF_FALSE);
+		src += 4*done;
+		dst += 4*done;
+		dst_w -= done;
+	}
+#endif
+
 	while ( dst_w) {
 		while ( pos >= 0x10000L ) {
 			r = *src++;
@@ -1302,22 +1599,266 @@ static void gf_cmx_apply_argb(GF_ColorMatrix *_this, u8 *a_, u8 *r_, u8 *g_, u8
 
 //#define COLORKEY_MPEG4_STRICT
 
+/*stretch parameters, shared by all threads processing a stretch*/
+typedef struct
+{
+	GF_VideoSurface *src;
+	u32 yuv_planar_type;
+	load_line_proto load_line;
+	copy_row_proto copy_row;
+	GF_ColorMatrix *cmat;
+	GF_ColorKey *key;
+	u8 ka, kr, kg, kb, kl, kh;
+	u8 alpha;
+	Bool flip, force_load_odd_yuv_lines, no_memcpy;
+	u32 src_w, dst_w, dst_w_size;
+	s32 inc_x, inc_y, x_off, src_row, dst_x_pitch, dst_pitch_y;
+	u8 *dst_bits;
+} StretchCtx;
+
+static void stretch_load_yuv_lines(StretchCtx *ctx, u32 the_row, u8 *tmp)
+{
+	GF_VideoSurface *src = ctx->src;
+	switch (ctx->yuv_planar_type) {
+	case 1:
+		load_line_yv12(src->video_buffer, ctx->x_off, the_row, src->pitch_y, ctx->src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
+		break;
+	case 3:
+		load_line_yv12_10((char *)src->video_buffer, ctx->x_off, the_row, src->pitch_y, ctx->src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
+		break;
+	case 4:
+		load_line_yuv422(src->video_buffer, ctx->x_off, the_row, src->pitch_y, ctx->src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
+		break;
+	case 5:
+		load_line_yuv444(src->video_buffer, ctx->x_off, the_row, src->pitch_y, ctx->src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
+		break;
+	case 6:
+		load_line_yuv422_10((char *)src->video_buffer, ctx->x_off, the_row, src->pitch_y, ctx->src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
+		break;
+	case 7:
+		load_line_yuv444_10((char *)src->video_buffer, ctx->x_off, the_row, src->pitch_y, ctx->src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
+		break;
+	default:
+		load_line_yuva(src->video_buffer, ctx->x_off, the_row, src->pitch_y, ctx->src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr, (u8 *)src->a_ptr);
+		break;
+	}
+}
+
+/*applies color matrix and color key on loaded pixels*/
+static void stretch_process_pixels(StretchCtx *ctx, u8 *tmp, u32 nb_pixels)
+{
+	u32 i;
+	if (ctx->cmat) {
+		for (i=0; i<nb_pixels; i++) {
+			u32 idx = 4*i;
+			gf_cmx_apply_argb(ctx->cmat, &tmp[idx+3], &tmp[idx], &tmp[idx+1], &tmp[idx+2]);
+		}
+	}
+	if (ctx->key) {
+		for (i=0; i<nb_pixels; i++) {
+			u32 idx = 4*i;
+			s32 thres, v;
+			v = tmp[idx]-ctx->kr;
+			thres = ABS(v);
+			v = tmp[idx+1]-ctx->kg;
+			thres += ABS(v);
+			v = tmp[idx+2]-ctx->kb;
+			thres += ABS(v);
+			thres/=3;
+#ifdef COLORKEY_MPEG4_STRICT
+			if (thres < ctx->kl) tmp[idx+3] = 0;
+			else if (thres <= ctx->kh) tmp[idx+3] = (thres-ctx->kl)*ctx->ka / (ctx->kh-ctx->kl);
+#else
+			if (thres < ctx->kh) tmp[idx+3] = 0;
+#endif
+			else tmp[idx+3] = ctx->ka;
+		}
+	}
+}
+
+/*stretches nb_rows destination rows starting at first_row - tmp holds two lines of source pixels*/
+static void stretch_rows(StretchCtx *ctx, u32 first_row, u32 nb_rows, u8 *tmp)
+{
+	GF_VideoSurface *src = ctx->src;
+	u8 *rows = tmp;
+	u8 *dst_bits, *dst_bits_prev = NULL;
+	s32 src_row, pos_y, prev_row = -1;
+	Bool yuv_init = GF_FALSE;
+	/*source position of the first row, as if all previous rows had been processed*/
+	u64 pos = 0x10000L + ((u64) first_row) * ctx->inc_y;
+
+	src_row = ctx->src_row + (s32) (pos >> 16);
+	pos_y = (s32) (pos & 0xFFFF);
+	dst_bits = ctx->dst_bits + ((s32) first_row) * ctx->dst_pitch_y;
+
+	while (nb_rows) {
+		while ( pos_y >= 0x10000L ) {
+			src_row++;
+			pos_y -= 0x10000L;
+		}
+		/*new row, check if conversion is needed*/
+		if (prev_row != src_row) {
+			u32 the_row = src_row - 1;
+			if (ctx->yuv_planar_type) {
+				if (the_row % 2) {
+					if (!yuv_init || ctx->force_load_odd_yuv_lines) {
+						yuv_init = GF_TRUE;
+						the_row--;
+						if (ctx->flip) the_row = src->height - 2 - the_row;
+						stretch_load_yuv_lines(ctx, the_row, tmp);
+						stretch_process_pixels(ctx, tmp, 2*ctx->src_w);
+					}
+					rows = ctx->flip ? tmp : tmp + ctx->src_w * 4;
+				}
+				else {
+					if (ctx->flip) the_row = src->height - 2 - the_row;
+					stretch_load_yuv_lines(ctx, the_row, tmp);
+					yuv_init = GF_TRUE;
+					rows = ctx->flip ? tmp + ctx->src_w * 4 : tmp;
+					stretch_process_pixels(ctx, tmp, 2*ctx->src_w);
+				}
+			} else {
+				if (ctx->flip) the_row = src->height-1 - the_row;
+				ctx->load_line((u8*)src->video_buffer, ctx->x_off, the_row, src->pitch_y, ctx->src_w, src->height, tmp);
+				rows = tmp;
+				stretch_process_pixels(ctx, tmp, ctx->src_w);
+			}
+			ctx->copy_row(rows, ctx->src_w, dst_bits, ctx->dst_w, ctx->inc_x, ctx->dst_x_pitch, ctx->alpha);
+		}
+		/*do NOT use memcpy if the target buffer is not in systems memory*/
+		else if (ctx->no_memcpy) {
+			ctx->copy_row(rows, ctx->src_w, dst_bits, ctx->dst_w, ctx->inc_x, ctx->dst_x_pitch, ctx->alpha);
+		} else if (dst_bits && dst_bits_prev) {
+			memcpy(dst_bits, dst_bits_prev, ctx->dst_w_size);
+		}
+
+		pos_y += ctx->inc_y;
+		prev_row = src_row;
+
+		dst_bits_prev = dst_bits;
+		dst_bits += ctx->dst_pitch_y;
+		nb_rows--;
+	}
+}
+
+/*large stretches are split in bands of destination rows processed by a pool of threads*/
+#define STRETCH_MIN_PIXELS	(640*360)
+#define STRETCH_MIN_ROWS	32
+
+typedef struct
+{
+	GF_StretchPool *pool;
+	GF_Thread *th;
+	GF_Semaphore *start;
+	StretchCtx *ctx;
+	u32 first_row, nb_rows;
+	u8 *tmp;
+	u32 tmp_size;
+} StretchWorker;
+
+struct _stretch_pool
+{
+	/*the calling thread processes the first band*/
+	u32 nb_workers;
+	StretchWorker *workers;
+	GF_Semaphore *done;
+	/*a single stretch is split at a time, concurrent stretches run on their calling thread*/
+	GF_Mutex *mx;
+	Bool exit;
+};
+
+static u32 stretch_worker_run(void *par)
+{
+	StretchWorker *sw = (StretchWorker *)par;
+	while (1) {
+		gf_sema_wait(sw->start);
+		if (sw->pool->exit) break;
+		stretch_rows(sw->ctx, sw->first_row, sw->nb_rows, sw->tmp);
+		gf_sema_notify(sw->pool->done, 1);
+	}
+	return 0;
+}
+
+GF_EXPORT
+void gf_stretch_pool_del(GF_StretchPool *pool)
+{
+	u32 i;
+	if (!pool) return;
+	gf_mx_p(pool->mx);
+	pool->exit = GF_TRUE;
+	for (i=0; i<pool->nb_workers; i++) {
+		StretchWorker *sw = &pool->workers[i];
+		gf_sema_notify(sw->start, 1);
+		gf_th_stop(sw->th);
+		gf_th_del(sw->th);
+		gf_sema_del(sw->start);
+		if (sw->tmp) gf_free(sw->tmp);
+	}
+	gf_mx_v(pool->mx);
+	gf_sema_del(pool->done);
+	gf_mx_del(pool->mx);
+	gf_free(pool->workers);
+	gf_free(pool);
+}
+
+GF_EXPORT
+GF_StretchPool *gf_stretch_pool_new(u32 nb_threads)
+{
+	u32 i;
+	GF_StretchPool *pool;
+	if (!nb_threads) {
+		GF_SystemRTInfo rti;
+		memset(&rti, 0, sizeof(GF_SystemRTInfo));
+		gf_sys_get_rti(0xFFFFFFFF, &rti, 0);
+		nb_threads = rti.nb_cores ? rti.nb_cores : 1;
+	}
+	if (nb_threads<2) return NULL;
+
+	GF_SAFEALLOC(pool, GF_StretchPool);
+	if (!pool) return NULL;
+	pool->workers = (StretchWorker *) gf_malloc(sizeof(StretchWorker) * (nb_threads-1));
+	pool->done = gf_sema_new(nb_threads, 0);
+	pool->mx = gf_mx_new("StretchBits");
+	if (!pool->workers || !pool->done || !pool->mx) {
+		if (pool->workers) gf_free(pool->workers);
+		if (pool->done) gf_sema_del(pool->done);
+		if (pool->mx) gf_mx_del(pool->mx);
+		gf_free(pool);
+		return NULL;
+	}
+	memset(pool->workers, 0, sizeof(StretchWorker) * (nb_threads-1));
+	for (i=0; i<nb_threads-1; i++) {
+		StretchWorker *sw = &pool->workers[pool->nb_workers];
+		sw->pool = pool;
+		sw->start = gf_sema_new(1, 0);
+		sw->th = gf_th_new("StretchBits");
+		if (gf_th_run(sw->th, stretch_worker_run, sw) != GF_OK) {
+			gf_th_del(sw->th);
+			gf_sema_del(sw->start);
+			break;
+		}
+		pool->nb_workers++;
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_CORE, ("[Color] Software stretch uses %d threads\n", pool->nb_workers+1));
+	return pool;
+}
+
 GF_EXPORT
 GF_Err gf_stretch_bits(GF_VideoSurface *dst, GF_VideoSurface *src, GF_Window *dst_wnd, GF_Window *src_wnd, u8 alpha, Bool flip, GF_ColorKey *key, GF_ColorMatrix *cmat)
 {
-	u8 *tmp, *rows;
-	u8 ka=0, kr=0, kg=0, kb=0, kl=0, kh=0;
-	s32 src_row;
+	return gf_stretch_bits_ex(NULL, dst, src, dst_wnd, src_wnd, alpha, flip, key, cmat);
+}
+
+GF_EXPORT
+GF_Err gf_stretch_bits_ex(GF_StretchPool *pool, GF_VideoSurface *dst, GF_VideoSurface *src, GF_Window *dst_wnd, GF_Window *src_wnd, u8 alpha, Bool flip, GF_ColorKey *key, GF_ColorMatrix *cmat)
+{
+	u8 *tmp;
 	u32 i, yuv_planar_type = 0;
-	Bool no_memcpy;
-	Bool force_load_odd_yuv_lines = GF_FALSE;
-	Bool yuv_init = GF_FALSE;
 	Bool has_alpha = (alpha!=0xFF) ? GF_TRUE : GF_FALSE;
-	u32 dst_bpp, dst_w_size;
-	s32 pos_y, inc_y, inc_x, prev_row, x_off;
+	u32 dst_bpp, tmp_size, nb_bands;
 	u32 src_w, src_h, dst_w, dst_h;
-	u8 *dst_bits = NULL, *dst_bits_prev = NULL, *dst_temp_bits = NULL;
 	s32 dst_x_pitch = dst->pitch_x;
+	StretchCtx ctx;
 
 	copy_row_proto copy_row = NULL;
 	load_line_proto load_line = NULL;
@@ -1464,218 +2005,85 @@ GF_Err gf_stretch_bits(GF_VideoSurface *dst, GF_VideoSurface *src, GF_Window *ds
 
 	if (yuv_planar_type && (src_w%2)) src_w++;
 
-	tmp = (u8 *) gf_malloc(sizeof(u8) * src_w * (yuv_planar_type ? 8 : 4) );
-	rows = tmp;
-
-	if ( (src_h / dst_h) * dst_h != src_h) force_load_odd_yuv_lines = GF_TRUE;
-
-	pos_y = 0x10000;
-	inc_y = (src_h << 16) / dst_h;
-	inc_x = (src_w << 16) / dst_w;
-	x_off = src_wnd ? src_wnd->x : 0;
-	src_row = src_wnd ? src_wnd->y : 0;
-
-	prev_row = -1;
-
-	dst_bits = (u8 *) dst->video_buffer;
-	if (dst_wnd) dst_bits += ((s32)dst_wnd->x) * dst_x_pitch + ((s32)dst_wnd->y) * dst->pitch_y;
-
-	dst_w_size = dst_bpp*dst_w;
-
-	/*small opt here: if we need to fetch data from destination, and if destination is
-	hardware memory, we work on a copy of the destination line*/
-	if (has_alpha && dst->is_hardware_memory)
-		dst_temp_bits = (u8 *) gf_malloc(sizeof(u8) * dst_bpp * dst_w);
+	memset(&ctx, 0, sizeof(StretchCtx));
+	ctx.src = src;
+	ctx.yuv_planar_type = yuv_planar_type;
+	ctx.load_line = load_line;
+	ctx.copy_row = copy_row;
+	ctx.cmat = cmat;
+	ctx.alpha = alpha;
+	ctx.flip = flip;
+	ctx.src_w = src_w;
+	ctx.dst_w = dst_w;
+
+	if ( (src_h / dst_h) * dst_h != src_h) ctx.force_load_odd_yuv_lines = GF_TRUE;
+
+	ctx.inc_y = (src_h << 16) / dst_h;
+	ctx.inc_x = (src_w << 16) / dst_w;
+	ctx.x_off = src_wnd ? src_wnd->x : 0;
+	ctx.src_row = src_wnd ? src_wnd->y : 0;
+
+	ctx.dst_bits = (u8 *) dst->video_buffer;
+	if (dst_wnd) ctx.dst_bits += ((s32)dst_wnd->x) * dst_x_pitch + ((s32)dst_wnd->y) * dst->pitch_y;
+	ctx.dst_x_pitch = dst_x_pitch;
+	ctx.dst_pitch_y = dst->pitch_y;
+	ctx.dst_w_size = dst_bpp*dst_w;
 
 	if (key) {
-		ka = key->alpha;
-		kr = key->r;
-		kg = key->g;
-		kb = key->b;
-		kl = key->low;
-		kh = key->high;
-		if (kh==kl) kh++;
+		ctx.key = key;
+		ctx.ka = key->alpha;
+		ctx.kr = key->r;
+		ctx.kg = key->g;
+		ctx.kb = key->b;
+		ctx.kl = key->low;
+		ctx.kh = key->high;
+		if (ctx.kh==ctx.kl) ctx.kh++;
 	}
 
 	/*do NOT use memcpy if the target buffer is not in systems memory*/
-	no_memcpy = (has_alpha || dst->is_hardware_memory || (dst_bpp!=dst_x_pitch)) ? GF_TRUE : GF_FALSE;
-
-	while (dst_h) {
-		while ( pos_y >= 0x10000L ) {
-			src_row++;
-			pos_y -= 0x10000L;
-		}
-		/*new row, check if conversion is needed*/
-		if (prev_row != src_row) {
-			u32 the_row = src_row - 1;
-			if (yuv_planar_type) {
-				if (the_row % 2) {
-					if (!yuv_init || force_load_odd_yuv_lines) {
-						yuv_init = GF_TRUE;
-						the_row--;
-						if (flip) the_row = src->height - 2 - the_row;
-						if (yuv_planar_type == 1) {
-							load_line_yv12(src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-						}
-						else if (yuv_planar_type == 4) {
-							load_line_yuv422(src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-						}
-						else if (yuv_planar_type == 5) {
-							load_line_yuv444(src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-						}
-						else if (yuv_planar_type == 3) {
-							load_line_yv12_10((char *)src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-						}
-						else if (yuv_planar_type == 6) {
-							load_line_yuv422_10((char *)src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-						}
-						else if (yuv_planar_type == 7) {
-							load_line_yuv444_10((char *)src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-						}
-						else {
-							load_line_yuva(src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr, (u8 *)src->a_ptr);
-						}
-
-						if (cmat) {
-							for (i=0; i<2*src_w; i++) {
-								u32 idx = 4*i;
-								gf_cmx_apply_argb(cmat, (u8 *) &tmp[idx+3], (u8 *) &tmp[idx], (u8 *) &tmp[idx+1], (u8 *) &tmp[idx+2]);
-							}
-						}
-						if (key) {
-							for (i=0; i<2*src_w; i++) {
-								u32 idx = 4*i;
-								s32 thres, v;
-								v = tmp[idx]-kr;
-								thres = ABS(v);
-								v = tmp[idx+1]-kg;
-								thres += ABS(v);
-								v = tmp[idx+2]-kb;
-								thres += ABS(v);
-								thres/=3;
-#ifdef COLORKEY_MPEG4_STRICT
-								if (thres < kl) tmp[idx+3] = 0;
-								else if (thres <= kh) tmp[idx+3] = (thres-kl)*ka / (kh-kl);
-#else
-								if (thres < kh) tmp[idx+3] = 0;
-#endif
-								else tmp[idx+3] = ka;
-							}
-						}
-					}
-					rows = flip ? tmp : tmp + src_w * 4;
-				}
-				else {
-					if (flip) the_row = src->height - 2 - the_row;
-					if (yuv_planar_type == 1) {
-						load_line_yv12(src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-					}
-					else if (yuv_planar_type == 4) {
-						load_line_yuv422(src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-					}
-					else if (yuv_planar_type == 5) {
-						load_line_yuv444(src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-					}
-					else if (yuv_planar_type == 3) {
-						load_line_yv12_10((char *)src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-					}
-					else if (yuv_planar_type == 6) {
-						load_line_yuv422_10((char *)src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-					}
-					else if (yuv_planar_type == 7) {
-						load_line_yuv444_10((char *)src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr);
-					}
-					else {
-						load_line_yuva(src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp, (u8 *)src->u_ptr, (u8 *)src->v_ptr, (u8 *)src->a_ptr);
-					}
-					yuv_init = GF_TRUE;
-					rows = flip ? tmp + src_w * 4 : tmp;
-
-					if (cmat) {
-						for (i=0; i<2*src_w; i++) {
-							u32 idx = 4*i;
-							gf_cmx_apply_argb(cmat, &tmp[idx+3], &tmp[idx], &tmp[idx+1], &tmp[idx+2]);
-						}
-					}
-					if (key) {
-						for (i=0; i<2*src_w; i++) {
-							u32 idx = 4*i;
-							s32 thres, v;
-							v = tmp[idx]-kr;
-							thres = ABS(v);
-							v = tmp[idx+1]-kg;
-							thres += ABS(v);
-							v = tmp[idx+2]-kb;
-							thres += ABS(v);
-							thres/=3;
-#ifdef COLORKEY_MPEG4_STRICT
-							if (thres < kl) tmp[idx+3] = 0;
-							else if (thres <= kh) tmp[idx+3] = (thres-kl)*ka / (kh-kl);
-#else
-							if (thres < kh) tmp[idx+3] = 0;
-#endif
-							else tmp[idx+3] = ka;
-						}
-					}
-				}
-			} else {
-				if (flip) the_row = src->height-1 - the_row;
-				load_line((u8*)src->video_buffer, x_off, the_row, src->pitch_y, src_w, src->height, tmp);
-				rows = tmp;
-				if (cmat) {
-					for (i=0; i<src_w; i++) {
-						u32 idx = 4*i;
-						gf_cmx_apply_argb(cmat, &tmp[idx+3], &tmp[idx], &tmp[idx+1], &tmp[idx+2]);
-					}
-				}
-				if (key) {
-					for (i=0; i<src_w; i++) {
-						u32 idx = 4*i;
-						s32 thres, v;
-						v = tmp[idx]-kr;
-						thres = ABS(v);
-						v = tmp[idx+1]-kg;
-						thres += ABS(v);
-						v = tmp[idx+2]-kb;
-						thres += ABS(v);
-						thres/=3;
-#ifdef COLORKEY_MPEG4_STRICT
-						if (thres < kl) tmp[idx+3] = 0;
-						else if (thres <= kh) tmp[idx+3] = (thres-kl)*ka / (kh-kl);
-#else
-						if (thres < kh) tmp[idx+3] = 0;
-#endif
-						else tmp[idx+3] = ka;
-					}
+	ctx.no_memcpy = (has_alpha || dst->is_hardware_memory || (dst_bpp!=dst_x_pitch)) ? GF_TRUE : GF_FALSE;
+
+	tmp_size = sizeof(u8) * src_w * (yuv_planar_type ? 8 : 4);
+	tmp = (u8 *) gf_malloc(tmp_size);
+
+	nb_bands = 1;
+	if (pool && (dst_w * dst_h >= STRETCH_MIN_PIXELS) && gf_mx_try_lock(pool->mx)) {
+		nb_bands = MIN(pool->nb_workers + 1, dst_h / STRETCH_MIN_ROWS);
+		/*allocate the line buffers of the workers, use fewer bands on failure*/
+		for (i=1; i<nb_bands; i++) {
+			StretchWorker *sw = &pool->workers[i-1];
+			if (sw->tmp_size < tmp_size) {
+				u8 *sw_tmp = (u8 *) gf_realloc(sw->tmp, tmp_size);
+				if (!sw_tmp) {
+					nb_bands = i;
+					break;
 				}
-			}
-			/*FIXME - this should be configurable, and tested against each graphics card*/
-			if (0&&dst_temp_bits) {
-				/*load from video memory*/
-				memcpy(dst_temp_bits, dst_bits, dst_w_size);
-				/*merge*/
-				copy_row(rows, src_w, dst_temp_bits, dst_w, inc_x, dst_x_pitch, alpha);
-				/*copy to video memory*/
-				memcpy(dst_bits, dst_temp_bits, dst_w_size);
-			} else {
-				copy_row(rows, src_w, dst_bits, dst_w, inc_x, dst_x_pitch, alpha);
+				sw->tmp = sw_tmp;
+				sw->tmp_size = tmp_size;
 			}
 		}
-		/*do NOT use memcpy if the target buffer is not in systems memory*/
-		else if (no_memcpy) {
-			copy_row(rows, src_w, dst_bits, dst_w, inc_x, dst_x_pitch, alpha);
-		} else if (dst_bits && dst_bits_prev) {
-			memcpy(dst_bits, dst_bits_prev, dst_w_size);
+		if (nb_bands<2) {
+			gf_mx_v(pool->mx);
+			nb_bands = 1;
 		}
+	}
 
-		pos_y += inc_y;
-		prev_row = src_row;
-
-		dst_bits_prev = dst_bits;
-		dst_bits += dst->pitch_y;
-		dst_h--;
+	if (nb_bands>1) {
+		for (i=1; i<nb_bands; i++) {
+			StretchWorker *sw = &pool->workers[i-1];
+			sw->ctx = &ctx;
+			sw->first_row = dst_h * i / nb_bands;
+			sw->nb_rows = dst_h * (i+1) / nb_bands - sw->first_row;
+			gf_sema_notify(sw->start, 1);
+		}
+		stretch_rows(&ctx, 0, dst_h / nb_bands, tmp);
+		for (i=1; i<nb_bands; i++) {
+			gf_sema_wait(pool->done);
+		}
+		gf_mx_v(pool->mx);
+	} else {
+		stretch_rows(&ctx, 0, dst_h, tmp);
 	}
-	if (dst_temp_bits) gf_free(dst_temp_bits);
 	gf_free(tmp);
 	return GF_OK;
 }
@@ -1851,16 +2259,6 @@ void gf_cmx_apply_fixed(GF_ColorMatrix *_this, Fixed *a, Fixed *r, Fixed *g, Fix
 
 
 
-#if defined(WIN32) && !defined(__GNUC__)
-# include <intrin.h>
-# define GPAC_HAS_SSE2
-#else
-# ifdef __SSE2__
-#  include <emmintrin.h>
-#  define GPAC_HAS_SSE2
-# endif
-#endif
-
 #ifdef GPAC_HAS_SSE2
 
 static GF_Err gf_color_write_yv12_10_to_yuv_intrin(GF_VideoSurface *vs_dst,  unsigned char *pY, unsigned char *pU, unsigned char*pV, u32 src_stride, u32 src_width, u32 src_height, const GF_Window *_src_wnd, Bool swap_uv)
@@ -28,40 +28,194 @@
 
 #define MAX_INI_LINE			2046
 
-typedef struct
+/*initial size of section and key hash tables, always a power of 2*/
+#define INI_HASH_MIN_SIZE	16
+
+typedef struct __ini_key
 {
 	char *name;
 	char *value;
+	u32 hash;
+	/*next key in the same hash bucket*/
+	struct __ini_key *next;
 } IniKey;
 
-typedef struct
+typedef struct __ini_section
 {
 	char *section_name;
+	/*keys in insertion order, as saved in the file*/
 	GF_List *keys;
+	u32 hash;
+	/*next section in the same hash bucket*/
+	struct __ini_section *next;
+	IniKey **key_table;
+	u32 key_table_size;
 } IniSection;
 
 struct __tag_config
 {
 	char *fileName;
+	/*sections in insertion order, as saved in the file*/
 	GF_List *sections;
+	IniSection **sec_table;
+	u32 sec_table_size;
 	Bool hasChanged, skip_changes;
 };
 
+/*djb2 on lower-cased names, so that case-insensitive lookups can use the same tables*/
+static u32 ini_hash(const char *name)
+{
+	u32 h = 5381;
+	while (*name) {
+		u8 c = (u8) *name++;
+		if ((c>='A') && (c<='Z')) c += 'a' - 'A';
+		h = ((h << 5) + h) ^ c;
+	}
+	return h;
+}
+
+static u32 ini_table_size(u32 size, u32 nb_items)
+{
+	if (!size) size = INI_HASH_MIN_SIZE;
+	while (size < nb_items) size *= 2;
+	return size;
+}
+
+/*entries are appended to their bucket so that the first of duplicated names, in list order, is the one found*/
+static void ini_key_link(IniSection *sec, IniKey *key)
+{
+	IniKey **slot = &sec->key_table[key->hash & (sec->key_table_size-1)];
+	while (*slot) slot = &(*slot)->next;
+	key->next = NULL;
+	*slot = key;
+}
+
+static void ini_key_unlink(IniSection *sec, IniKey *key)
+{
+	IniKey **slot = &sec->key_table[key->hash & (sec->key_table_size-1)];
+	while (*slot) {
+		if (*slot == key) {
+			*slot = key->next;
+			return;
+		}
+		slot = &(*slot)->next;
+	}
+}
+
+/*adds the key at the given position in the key list, or at the end if position is negative*/
+static void ini_add_key(IniSection *sec, IniKey *key, s32 position)
+{
+	u32 i, count;
+	key->hash = ini_hash(key->name);
+	if (position<0) gf_list_add(sec->keys, key);
+	else gf_list_insert(sec->keys, key, (u32) position);
+
+	count = gf_list_count(sec->keys);
+	if (count <= sec->key_table_size) {
+		ini_key_link(sec, key);
+		return;
+	}
+	/*grow and rebuild from the list to keep bucket order*/
+	if (sec->key_table) gf_free(sec->key_table);
+	sec->key_table_size = ini_table_size(2*sec->key_table_size, count);
+	sec->key_table = (IniKey **) gf_malloc(sizeof(IniKey *) * sec->key_table_size);
+	memset(sec->key_table, 0, sizeof(IniKey *) * sec->key_table_size);
+	for (i=0; i<count; i++) {
+		IniKey *k = (IniKey *) gf_list_get(sec->keys, i);
+		/*keys being removed by gf_cfg_set_keys*/
+		if (!k->name) continue;
+		ini_key_link(sec, k);
+	}
+}
+
+static IniKey *ini_find_key(IniSection *sec, const char *keyName, Bool ignore_case)
+{
+	IniKey *key;
+	if (!sec->key_table) return NULL;
+	key = sec->key_table[ini_hash(keyName) & (sec->key_table_size-1)];
+	while (key) {
+		if (ignore_case ? !stricmp(key->name, keyName) : !strcmp(key->name, keyName)) return key;
+		key = key->next;
+	}
+	return NULL;
+}
+
+static void ini_section_link(GF_Config *iniFile, IniSection *sec)
+{
+	IniSection **slot = &iniFile->sec_table[sec->hash & (iniFile->sec_table_size-1)];
+	while (*slot) slot = &(*slot)->next;
+	sec->next = NULL;
+	*slot = sec;
+}
+
+static void ini_section_unlink(GF_Config *iniFile, IniSection *sec)
+{
+	IniSection **slot = &iniFile->sec_table[sec->hash & (iniFile->sec_table_size-1)];
+	while (*slot) {
+		if (*slot == sec) {
+			*slot = sec->next;
+			return;
+		}
+		slot = &(*slot)->next;
+	}
+}
+
+/*creates a new section at the end of the section list - name is owned by the section*/
+static IniSection *ini_add_section(GF_Config *iniFile, char *name)
+{
+	u32 i, count;
+	IniSection *sec;
+	GF_SAFEALLOC(sec, IniSection);
+	if (!sec) return NULL;
+	sec->section_name = name;
+	sec->keys = gf_list_new();
+	sec->hash = ini_hash(name);
+	gf_list_add(iniFile->sections, sec);
+
+	count = gf_list_count(iniFile->sections);
+	if (count <= iniFile->sec_table_size) {
+		ini_section_link(iniFile, sec);
+		return sec;
+	}
+	if (iniFile->sec_table) gf_free(iniFile->sec_table);
+	iniFile->sec_table_size = ini_table_size(2*iniFile->sec_table_size, count);
+	iniFile->sec_table = (IniSection **) gf_malloc(sizeof(IniSection *) * iniFile->sec_table_size);
+	memset(iniFile->sec_table, 0, sizeof(IniSection *) * iniFile->sec_table_size);
+	for (i=0; i<count; i++) {
+		ini_section_link(iniFile, (IniSection *) gf_list_get(iniFile->sections, i));
+	}
+	return sec;
+}
+
+static IniSection *ini_find_section(GF_Config *iniFile, const char *secName, Bool ignore_case)
+{
+	IniSection *sec;
+	if (!iniFile->sec_table) return NULL;
+	sec = iniFile->sec_table[ini_hash(secName) & (iniFile->sec_table_size-1)];
+	while (sec) {
+		if (ignore_case ? !stricmp(sec->section_name, secName) : !strcmp(sec->section_name, secName)) return sec;
+		sec = sec->next;
+	}
+	return NULL;
+}
+
+static void DelKey(IniKey *k)
+{
+	if (k->value) gf_free(k->value);
+	if (k->name) gf_free(k->name);
+	gf_free(k);
+}
 
 static void DelSection(IniSection *ptr)
 {
-	IniKey *k;
 	if (!ptr) return;
 	if (ptr->keys) {
 		while (gf_list_count(ptr->keys)) {
-			k = (IniKey *) gf_list_get(ptr->keys, 0);
-			if (k->value) gf_free(k->value);
-			if (k->name) gf_free(k->name);
-			gf_free(k);
-			gf_list_rem(ptr->keys, 0);
+			DelKey((IniKey *) gf_list_pop_back(ptr->keys));
 		}
 		gf_list_del(ptr->keys);
 	}
+	if (ptr->key_table) gf_free(ptr->key_table);
 	if (ptr->section_name) gf_free(ptr->section_name);
 	gf_free(ptr);
 }
@@ -71,16 +225,15 @@ static void DelSection(IniSection *ptr)
  * \param iniFile The structure to clear
  */
 static void gf_cfg_clear(GF_Config * iniFile) {
-	IniSection *p;
 	if (!iniFile) return;
 	if (iniFile->sections) {
 		while (gf_list_count(iniFile->sections)) {
-			p = (IniSection *) gf_list_get(iniFile->sections, 0);
-			DelSection(p);
-			gf_list_rem(iniFile->sections, 0);
+			DelSection((IniSection *) gf_list_pop_back(iniFile->sections));
 		}
 		gf_list_del(iniFile->sections);
 	}
+	if (iniFile->sec_table)
+		gf_free(iniFile->sec_table);
 	if (iniFile->fileName)
 		gf_free(iniFile->fileName);
 	memset((void *)iniFile, 0, sizeof(GF_Config));
@@ -147,18 +300,13 @@ GF_Err gf_cfg_parse_config_file(GF_Config * tmp, const char * filePath, const ch
 
 		/* new section */
 		if (line[0] == '[') {
-			p = (IniSection *) gf_malloc(sizeof(IniSection));
-			p->keys = gf_list_new();
-			p->section_name = gf_strdup(line + 1);
-			p->section_name[strlen(line) - 2] = 0;
-			while (p->section_name[strlen(p->section_name) - 1] == ']' || p->section_name[strlen(p->section_name) - 1] == ' ') p->section_name[strlen(p->section_name) - 1] = 0;
-			gf_list_add(tmp->sections, p);
+			char *name = gf_strdup(line + 1);
+			name[strlen(line) - 2] = 0;
+			while (name[strlen(name) - 1] == ']' || name[strlen(name) - 1] == ' ') name[strlen(name) - 1] = 0;
+			p = ini_add_section(tmp, name);
 		}
 		else if (strlen(line) && (strchr(line, '=') != NULL) ) {
 			if (!p) {
-				gf_list_del(tmp->sections);
-				gf_free(tmp->fileName);
-				gf_free(tmp);
 				gf_fclose(file);
 				gf_free(line);
 				return GF_IO_ERR;
@@ -181,7 +329,7 @@ GF_Err gf_cfg_parse_config_file(GF_Config * tmp, const char * filePath, const ch
 					k->value = gf_strdup("");
 				}
 			}
-			gf_list_add(p->keys, k);
+			ini_add_key(p, k, -1);
 		}
 	}
 	gf_free(line);
@@ -286,100 +434,102 @@ void gf_cfg_remove(GF_Config *iniFile)
 GF_EXPORT
 const char *gf_cfg_get_key(GF_Config *iniFile, const char *secName, const char *keyName)
 {
-	u32 i;
-	IniSection *sec;
 	IniKey *key;
-
-	i=0;
-	while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i)) ) {
-		if (!strcmp(secName, sec->section_name)) goto get_key;
-	}
-	return NULL;
-
-get_key:
-	i=0;
-	while ( (key = (IniKey *) gf_list_enum(sec->keys, &i)) ) {
-		if (!strcmp(key->name, keyName)) return key->value;
-	}
-	return NULL;
+	IniSection *sec = ini_find_section(iniFile, secName, GF_FALSE);
+	if (!sec) return NULL;
+	key = ini_find_key(sec, keyName, GF_FALSE);
+	return key ? key->value : NULL;
 }
 
 GF_EXPORT
 const char *gf_cfg_get_ikey(GF_Config *iniFile, const char *secName, const char *keyName)
 {
-	u32 i;
-	IniSection *sec;
 	IniKey *key;
-
-	i=0;
-	while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i)) ) {
-		if (!stricmp(secName, sec->section_name)) goto get_key;
-	}
-	return NULL;
-
-get_key:
-	i=0;
-	while ( (key = (IniKey *) gf_list_enum(sec->keys, &i)) ) {
-		if (!stricmp(key->name, keyName)) return key->value;
-	}
-	return NULL;
+	IniSection *sec = ini_find_section(iniFile, secName, GF_TRUE);
+	if (!sec) return NULL;
+	key = ini_find_key(sec, keyName, GF_TRUE);
+	return key ? key->value : NULL;
 }
 
-
 GF_EXPORT
-GF_Err gf_cfg_set_key(GF_Config *iniFile, const char *secName, const char *keyName, const char *keyValue)
+GF_Err gf_cfg_set_keys(GF_Config *iniFile, const char *secName, u32 nb_keys, const char **keyNames, const char **keyValues)
 {
-	u32 i;
+	u32 i, nb_removed;
 	Bool has_changed = GF_TRUE;
 	IniSection *sec;
 	IniKey *key;
 
-	if (!iniFile || !secName || !keyName) return GF_BAD_PARAM;
+	if (!iniFile || !secName || (nb_keys && (!keyNames || !keyValues))) return GF_BAD_PARAM;
+	for (i=0; i<nb_keys; i++) {
+		if (!keyNames[i]) return GF_BAD_PARAM;
+	}
 
 	if (!strnicmp(secName, "temp", 4)) has_changed = GF_FALSE;
 
-	i=0;
-	while ((sec = (IniSection *) gf_list_enum(iniFile->sections, &i)) ) {
-		if (!strcmp(secName, sec->section_name)) goto get_key;
+	sec = ini_find_section(iniFile, secName, GF_FALSE);
+	if (!sec) {
+		sec = ini_add_section(iniFile, gf_strdup(secName));
+		if (!sec) return GF_OUT_OF_MEM;
+		if (has_changed) iniFile->hasChanged = GF_TRUE;
 	}
-	/* need a new key */
-	sec = (IniSection *) gf_malloc(sizeof(IniSection));
-	sec->section_name = gf_strdup(secName);
-	sec->keys = gf_list_new();
-	if (has_changed) iniFile->hasChanged = GF_TRUE;
-	gf_list_add(iniFile->sections, sec);
 
-get_key:
-	i=0;
-	while ( (key = (IniKey *) gf_list_enum(sec->keys, &i) ) ) {
-		if (!strcmp(key->name, keyName)) goto set_value;
-	}
-	if (!keyValue) return GF_OK;
-	/* need a new key */
-	key = (IniKey *) gf_malloc(sizeof(IniKey));
-	key->name = gf_strdup(keyName);
-	key->value = gf_strdup("");
-	if (has_changed) iniFile->hasChanged = GF_TRUE;
-	gf_list_add(sec->keys, key);
+	nb_removed = 0;
+	for (i=0; i<nb_keys; i++) {
+		key = ini_find_key(sec, keyNames[i], GF_FALSE);
+		if (!keyValues[i]) {
+			if (!key) continue;
+			/*unlink now, the key list is compacted once all keys are processed*/
+			ini_key_unlink(sec, key);
+			gf_free(key->name);
+			key->name = NULL;
+			nb_removed++;
+			if (has_changed) iniFile->hasChanged = GF_TRUE;
+			continue;
+		}
+		if (!key) {
+			key = (IniKey *) gf_malloc(sizeof(IniKey));
+			key->name = gf_strdup(keyNames[i]);
+			key->value = gf_strdup(keyValues[i]);
+			ini_add_key(sec, key, -1);
+			if (has_changed) iniFile->hasChanged = GF_TRUE;
+			continue;
+		}
+		/* same value, don't update */
+		if (!strcmp(key->value, keyValues[i])) continue;
 
-set_value:
-	if (!keyValue) {
-		gf_list_del_item(sec->keys, key);
-		if (key->name) gf_free(key->name);
-		if (key->value) gf_free(key->value);
-		gf_free(key);
+		gf_free(key->value);
+		key->value = gf_strdup(keyValues[i]);
 		if (has_changed) iniFile->hasChanged = GF_TRUE;
-		return GF_OK;
 	}
-	/* same value, don't update */
-	if (!strcmp(key->value, keyValue)) return GF_OK;
 
-	if (key->value) gf_free(key->value);
-	key->value = gf_strdup(keyValue);
-	if (has_changed) iniFile->hasChanged = GF_TRUE;
+	if (nb_removed==1) {
+		i=0;
+		while ( (key = (IniKey *) gf_list_enum(sec->keys, &i) ) ) {
+			if (key->name) continue;
+			gf_list_rem(sec->keys, i-1);
+			DelKey(key);
+			break;
+		}
+	} else if (nb_removed) {
+		GF_List *keys = gf_list_new();
+		i=0;
+		while ( (key = (IniKey *) gf_list_enum(sec->keys, &i) ) ) {
+			if (key->name) gf_list_add(keys, key);
+			else DelKey(key);
+		}
+		gf_list_del(sec->keys);
+		sec->keys = keys;
+	}
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_cfg_set_key(GF_Config *iniFile, const char *secName, const char *keyName, const char *keyValue)
+{
+	if (!keyName) return GF_BAD_PARAM;
+	return gf_cfg_set_keys(iniFile, secName, 1, &keyName, &keyValue);
+}
+
 GF_EXPORT
 u32 gf_cfg_get_section_count(GF_Config *iniFile)
 {
@@ -397,70 +547,60 @@ const char *gf_cfg_get_section_name(GF_Config *iniFile, u32 secIndex)
 GF_EXPORT
 u32 gf_cfg_get_key_count(GF_Config *iniFile, const char *secName)
 {
-	u32 i = 0;
-	IniSection *sec;
-	while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i)) ) {
-		if (!strcmp(secName, sec->section_name)) return gf_list_count(sec->keys);
-	}
-	return 0;
+	IniSection *sec = ini_find_section(iniFile, secName, GF_FALSE);
+	return sec ? gf_list_count(sec->keys) : 0;
 }
 
 GF_EXPORT
 const char *gf_cfg_get_key_name(GF_Config *iniFile, const char *secName, u32 keyIndex)
 {
-	u32 i = 0;
-	IniSection *sec;
-	while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i) ) ) {
-		if (!strcmp(secName, sec->section_name)) {
-			IniKey *key = (IniKey *) gf_list_get(sec->keys, keyIndex);
-			return key ? key->name : NULL;
-		}
-	}
-	return NULL;
+	IniKey *key;
+	IniSection *sec = ini_find_section(iniFile, secName, GF_FALSE);
+	if (!sec) return NULL;
+	key = (IniKey *) gf_list_get(sec->keys, keyIndex);
+	return key ? key->name : NULL;
+}
+
+GF_EXPORT
+const char *gf_cfg_get_key_value(GF_Config *iniFile, const char *secName, u32 keyIndex)
+{
+	IniKey *key;
+	IniSection *sec = ini_find_section(iniFile, secName, GF_FALSE);
+	if (!sec) return NULL;
+	key = (IniKey *) gf_list_get(sec->keys, keyIndex);
+	return key ? key->value : NULL;
 }
 
 GF_EXPORT
 void gf_cfg_del_section(GF_Config *iniFile, const char *secName)
 {
-	u32 i;
 	IniSection *p;
 	if (!iniFile) return;
 
-	i = 0;
-	while ((p = (IniSection*)gf_list_enum(iniFile->sections, &i))) {
-		if (!strcmp(secName, p->section_name)) {
-			DelSection(p);
-			gf_list_rem(iniFile->sections, i-1);
-			iniFile->hasChanged = GF_TRUE;
-			return;
-		}
-	}
+	p = ini_find_section(iniFile, secName, GF_FALSE);
+	if (!p) return;
+	ini_section_unlink(iniFile, p);
+	gf_list_del_item(iniFile->sections, p);
+	DelSection(p);
+	iniFile->hasChanged = GF_TRUE;
 }
 
 GF_EXPORT
 GF_Err gf_cfg_insert_key(GF_Config *iniFile, const char *secName, const char *keyName, const char *keyValue, u32 index)
 {
-	u32 i;
 	IniSection *sec;
 	IniKey *key;
 
 	if (!iniFile || !secName || !keyName|| !keyValue) return GF_BAD_PARAM;
 
-	i=0;
-	while ( (sec = (IniSection *) gf_list_enum(iniFile->sections, &i) ) ) {
-		if (!strcmp(secName, sec->section_name)) break;
-	}
+	sec = ini_find_section(iniFile, secName, GF_FALSE);
 	if (!sec) return GF_BAD_PARAM;
-
-	i=0;
-	while ( (key = (IniKey *) gf_list_enum(sec->keys, &i) ) ) {
-		if (!strcmp(key->name, keyName)) return GF_BAD_PARAM;
-	}
+	if (ini_find_key(sec, keyName, GF_FALSE)) return GF_BAD_PARAM;
 
 	key = (IniKey *) gf_malloc(sizeof(IniKey));
 	key->name = gf_strdup(keyName);
 	key->value = gf_strdup(keyValue);
-	gf_list_insert(sec->keys, key, index);
+	ini_add_key(sec, key, (s32) index);
 	iniFile->hasChanged = GF_TRUE;
 	return GF_OK;
 }
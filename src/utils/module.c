@@ -528,6 +528,40 @@ const char *gf_modules_get_file_name(GF_ModuleManager *pm, u32 i)
 	return inst->name;
 }
 
+GF_EXPORT
+const char *gf_modules_get_capabilities(GF_ModuleManager *pm, u32 whichplug, u32 InterfaceFamily)
+{
+	char szKey[GF_MAX_PATH];
+	ModuleInstance *inst;
+	if (!pm || !pm->cfg) return NULL;
+	inst = (ModuleInstance *) gf_list_get(pm->plug_list, whichplug);
+	if (!inst) return NULL;
+	snprintf(szKey, GF_MAX_PATH, "%s:%s", inst->name, gf_4cc_to_str(InterfaceFamily));
+	return gf_cfg_get_key(pm->cfg, "PluginsCache", szKey);
+}
+
+GF_EXPORT
+GF_Err gf_modules_set_capabilities(GF_ModuleManager *pm, u32 whichplug, u32 InterfaceFamily, const char *caps)
+{
+	char szKey[GF_MAX_PATH];
+	ModuleInstance *inst;
+	if (!pm || !pm->cfg) return GF_BAD_PARAM;
+	inst = (ModuleInstance *) gf_list_get(pm->plug_list, whichplug);
+	if (!inst) return GF_BAD_PARAM;
+	snprintf(szKey, GF_MAX_PATH, "%s:%s", inst->name, gf_4cc_to_str(InterfaceFamily));
+	return gf_cfg_set_key(pm->cfg, "PluginsCache", szKey, caps);
+}
+
+GF_EXPORT
+Bool gf_modules_manifest_changed(GF_ModuleManager *pm)
+{
+	Bool res;
+	if (!pm) return GF_FALSE;
+	res = pm->manifest_changed;
+	pm->manifest_changed = GF_FALSE;
+	return res;
+}
+
 GF_EXPORT
 const char *gf_module_get_file_name(GF_BaseInterface *ifce)
 {
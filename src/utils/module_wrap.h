@@ -72,6 +72,11 @@ struct __tag_mod_man
 
 	/* Mutex to handle simultaneous calls to the load_interface function */
 	GF_Mutex *mutex;
+
+	/*set when a module file was added, removed or modified since the manifest was written, until the module cache is flushed*/
+	Bool manifest_dirty;
+	/*set once the module cache has been flushed because of module changes*/
+	Bool manifest_changed;
 };
 
 #ifdef __cplusplus
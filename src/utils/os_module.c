@@ -25,6 +25,8 @@
 
 #include "module_wrap.h"
 #include <gpac/network.h>
+#include <gpac/config_file.h>
+#include <gpac/version.h>
 
 #if defined(WIN32) || defined(_WIN32_WCE)
 #include <windows.h>
@@ -257,6 +259,17 @@ static Bool enum_modules(void *cbck, char *item_name, char *item_path, GF_FileEn
 		gf_free(inst);
 		return GF_FALSE;
 	}
+	/*check the module file against the manifest*/
+	if (file_info && pm->cfg) {
+		char szSig[100];
+		const char *sig = gf_cfg_get_key(pm->cfg, "PluginsManifest", item_name);
+		sprintf(szSig, LLU":"LLU, file_info->size, file_info->last_modified);
+		if (!sig || strcmp(sig, szSig)) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_CORE, ("[Core] Module %s %s since last run\n", item_name, sig ? "modified" : "added"));
+			gf_cfg_set_key(pm->cfg, "PluginsManifest", item_name, szSig);
+			pm->manifest_dirty = GF_TRUE;
+		}
+	}
 	inst->plugman = pm;
 	inst->name = gf_strdup(item_name);
 	inst->dir = gf_strdup(item_path);
@@ -290,6 +303,42 @@ static void load_static_modules(GF_ModuleManager *pm)
 	}
 }
 
+/*the module manifest (PluginsManifest section) records the size and modification time of each module file found,
+and the GPAC version for static modules. The module cache (PluginsCache section) stores the interfaces and capabilities
+of each module so that they don't have to be loaded to be queried; it is only trusted as long as the manifest is
+unchanged and is flushed whenever a module is added, removed or modified*/
+static void check_module_manifest(GF_ModuleManager *pm)
+{
+	u32 i, count;
+	const char *opt;
+	pm->manifest_changed = GF_FALSE;
+	if (!pm->cfg) return;
+
+	opt = gf_cfg_get_key(pm->cfg, "PluginsManifest", "GPACVersion");
+	if (!opt || strcmp(opt, GPAC_FULL_VERSION)) {
+		gf_cfg_set_key(pm->cfg, "PluginsManifest", "GPACVersion", GPAC_FULL_VERSION);
+		pm->manifest_dirty = GF_TRUE;
+	}
+	/*purge removed modules*/
+	count = gf_cfg_get_key_count(pm->cfg, "PluginsManifest");
+	for (i=0; i<count; i++) {
+		const char *name = gf_cfg_get_key_name(pm->cfg, "PluginsManifest", i);
+		if (!strcmp(name, "GPACVersion")) continue;
+		if (gf_module_is_loaded(pm, (char *) name)) continue;
+		GF_LOG(GF_LOG_INFO, GF_LOG_CORE, ("[Core] Module %s removed since last run\n", name));
+		gf_cfg_set_key(pm->cfg, "PluginsManifest", name, NULL);
+		pm->manifest_dirty = GF_TRUE;
+		i--;
+		count--;
+	}
+	if (!pm->manifest_dirty) return;
+
+	GF_LOG(GF_LOG_INFO, GF_LOG_CORE, ("[Core] Modules changed since last run, flushing modules cache\n"));
+	gf_cfg_del_section(pm->cfg, "PluginsCache");
+	pm->manifest_dirty = GF_FALSE;
+	pm->manifest_changed = GF_TRUE;
+}
+
 /*refresh modules - note we don't check for deleted modules but since we've open them the OS should forbid delete*/
 GF_EXPORT
 u32 gf_modules_refresh(GF_ModuleManager *pm)
@@ -320,6 +369,7 @@ u32 gf_modules_refresh(GF_ModuleManager *pm)
 
 #endif
 	}
+	check_module_manifest(pm);
 
 	return gf_list_count(pm->plug_list);
 }
@@ -23,6 +23,11 @@
  *
  */
 
+/*for recvmmsg*/
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #ifndef GPAC_DISABLE_CORE_TOOLS
 
 #if defined(WIN32) || defined(_WIN32_WCE)
@@ -106,12 +111,34 @@ static int wsa_init = 0;
 
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#ifdef __linux__
+#include <netinet/udp.h>
+#include <sys/epoll.h>
+#endif
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <arpa/inet.h>
 
 #include <gpac/network.h>
 
+#if defined(__linux__) && defined(MSG_WAITFORONE) && defined(SO_TIMESTAMP)
+#define GPAC_HAS_RECVMMSG
+#define GPAC_HAS_SENDMMSG
+/*max number of datagrams handled by a single recvmmsg or sendmmsg call*/
+#define GF_SK_MAX_BATCH	64
+#endif
+
+#if !defined(__SYMBIAN32__) && !defined(__BEOS__)
+#include <poll.h>
+#define GPAC_HAS_POLL
+#endif
+
+#if defined(__linux__) && defined(EPOLLET)
+#define GPAC_HAS_EPOLL
+/*max number of events fetched by a single epoll_wait call*/
+#define GF_SK_GROUP_MAX_EVENTS	256
+#endif
+
 /*not defined on solaris*/
 #if !defined(INADDR_NONE)
 # if (defined(sun) && defined(__SVR4))
@@ -170,7 +197,13 @@ enum
 	GF_SOCK_IS_LISTENING = 1<<13,
 	/*socket is bound to a specific dest (server) or source (client) */
 	GF_SOCK_HAS_PEER = 1<<14,
-	GF_SOCK_IS_MIP = 1<<15
+	GF_SOCK_IS_MIP = 1<<15,
+	/*kernel reception timestamps have been requested*/
+	GF_SOCK_HAS_TIMESTAMP = 1<<16,
+	/*socket is in the epoll set of its group*/
+	GF_SOCK_IN_EPOLL = 1<<17,
+	/*socket is in the ready list of its group*/
+	GF_SOCK_IS_READY = 1<<18
 };
 
 struct __tag_socket
@@ -186,8 +219,33 @@ struct __tag_socket
 	u32 dest_addr_len;
 
 	u32 usec_wait;
+	/*socket group the socket is registered to, if any*/
+	GF_SockGroup *group;
 };
 
+static void gf_sk_group_socket_closed(GF_Socket *sock);
+
+#ifdef GPAC_HAS_POLL
+//waits at most usec_wait for the socket to be readable or writable, poll is not limited to FD_SETSIZE descriptors
+static s32 gf_sk_poll(GF_Socket *sock, Bool for_write)
+{
+	struct pollfd pfd;
+	pfd.fd = sock->socket;
+	pfd.events = for_write ? POLLOUT : POLLIN;
+	pfd.revents = 0;
+#ifdef __linux__
+	{
+		struct timespec ts;
+		ts.tv_sec = sock->usec_wait / 1000000;
+		ts.tv_nsec = (sock->usec_wait % 1000000) * 1000;
+		return ppoll(&pfd, 1, &ts, NULL);
+	}
+#else
+	return poll(&pfd, 1, (sock->usec_wait + 999) / 1000);
+#endif
+}
+#endif
+
 
 
 /*
@@ -455,6 +513,7 @@ static void gf_sk_free(GF_Socket *sock)
 		setsockopt(sock->socket, IPPROTO_IP, IP_DROP_MEMBERSHIP, (char *) &mreq, sizeof(mreq));
 #endif
 	}
+	if (sock->group) gf_sk_group_socket_closed(sock);
 	if (sock->socket) closesocket(sock->socket);
 	sock->socket = (SOCKET) 0L;
 
@@ -470,6 +529,7 @@ GF_EXPORT
 void gf_sk_del(GF_Socket *sock)
 {
 	assert( sock );
+	if (sock->group) gf_sk_group_unregister(sock->group, sock);
 	gf_sk_free(sock);
 #ifdef WIN32
 	wsa_init --;
@@ -860,8 +920,10 @@ GF_Err gf_sk_send(GF_Socket *sock, const char *buffer, u32 length)
 	Bool not_ready = GF_FALSE;
 #ifndef __SYMBIAN32__
 	int ready;
+#ifndef GPAC_HAS_POLL
 	struct timeval timeout;
 	fd_set Group;
+#endif
 #endif
 
 	//the socket must be bound or connected
@@ -869,6 +931,9 @@ GF_Err gf_sk_send(GF_Socket *sock, const char *buffer, u32 length)
 
 #ifndef __SYMBIAN32__
 	//can we write?
+#ifdef GPAC_HAS_POLL
+	ready = gf_sk_poll(sock, GF_TRUE);
+#else
 	FD_ZERO(&Group);
 	FD_SET(sock->socket, &Group);
 	timeout.tv_sec = 0;
@@ -876,6 +941,7 @@ GF_Err gf_sk_send(GF_Socket *sock, const char *buffer, u32 length)
 
 	//TODO CHECK IF THIS IS CORRECT
 	ready = select((int) sock->socket+1, NULL, &Group, NULL, &timeout);
+#endif
 	if (ready == SOCKET_ERROR) {
 		switch (LASTSOCKERROR) {
 		case EAGAIN:
@@ -886,7 +952,11 @@ GF_Err gf_sk_send(GF_Socket *sock, const char *buffer, u32 length)
 	}
 
 	//should never happen (to check: is writeability is guaranteed for not-connected sockets)
+#ifdef GPAC_HAS_POLL
+	if (!ready) {
+#else
 	if (!ready || !FD_ISSET(sock->socket, &Group)) {
+#endif
 		not_ready = GF_TRUE;
 	}
 #endif
@@ -920,6 +990,168 @@ GF_Err gf_sk_send(GF_Socket *sock, const char *buffer, u32 length)
 	return GF_OK;
 }
 
+#if defined(GPAC_HAS_SENDMMSG) && defined(UDP_SEGMENT)
+/*max number of segments and payload size of a single UDP GSO send*/
+#define GF_SK_MAX_GSO_SEGMENTS	64
+#define GF_SK_MAX_GSO_SIZE	65000
+
+static Bool udp_gso_unavailable = GF_FALSE;
+
+//sends datagrams of the same size, except the last one which may be shorter, in one call using UDP segmentation offload
+static GF_Err gf_sk_send_gso(GF_Socket *sock, const char **buffers, const u32 *sizes, u32 nb_buffers)
+{
+	u32 i;
+	u16 seg_size;
+	struct msghdr msg;
+	struct iovec iovs[GF_SK_MAX_GSO_SEGMENTS];
+	char ctrl[CMSG_SPACE(sizeof(u16))];
+	struct cmsghdr *cmsg;
+
+	memset(&msg, 0, sizeof(struct msghdr));
+	memset(ctrl, 0, sizeof(ctrl));
+	for (i=0; i<nb_buffers; i++) {
+		iovs[i].iov_base = (void *) buffers[i];
+		iovs[i].iov_len = sizes[i];
+	}
+	msg.msg_iov = iovs;
+	msg.msg_iovlen = nb_buffers;
+	if (sock->flags & GF_SOCK_HAS_PEER) {
+		msg.msg_name = &sock->dest_addr;
+		msg.msg_namelen = sock->dest_addr_len;
+	}
+	msg.msg_control = ctrl;
+	msg.msg_controllen = sizeof(ctrl);
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = IPPROTO_UDP;
+	cmsg->cmsg_type = UDP_SEGMENT;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(u16));
+	seg_size = (u16) sizes[0];
+	memcpy(CMSG_DATA(cmsg), &seg_size, sizeof(u16));
+
+	if (sendmsg(sock->socket, &msg, 0) == SOCKET_ERROR) {
+		switch (LASTSOCKERROR) {
+		case EAGAIN:
+			return GF_IP_SOCK_WOULD_BLOCK;
+		case EIO:
+		case ENOPROTOOPT:
+		case EOPNOTSUPP:
+			GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[socket] UDP segmentation offload not supported (error %d)\n", LASTSOCKERROR));
+			udp_gso_unavailable = GF_TRUE;
+			return GF_NOT_SUPPORTED;
+		case EINVAL:
+		case EMSGSIZE:
+			//segments too large for this path, send them one by one
+			return GF_NOT_SUPPORTED;
+		default:
+			return GF_IP_NETWORK_FAILURE;
+		}
+	}
+	return GF_OK;
+}
+#endif
+
+#ifdef GPAC_HAS_SENDMMSG
+static Bool sendmmsg_unavailable = GF_FALSE;
+
+static GF_Err gf_sk_send_mmsg(GF_Socket *sock, const char **buffers, const u32 *sizes, u32 nb_buffers)
+{
+	u32 i, count, nb_sent = 0;
+	s32 res;
+	struct mmsghdr msgs[GF_SK_MAX_BATCH];
+	struct iovec iovs[GF_SK_MAX_BATCH];
+
+	while (nb_sent < nb_buffers) {
+		count = MIN(nb_buffers - nb_sent, GF_SK_MAX_BATCH);
+		memset(msgs, 0, sizeof(struct mmsghdr) * count);
+		for (i=0; i<count; i++) {
+			iovs[i].iov_base = (void *) buffers[nb_sent+i];
+			iovs[i].iov_len = sizes[nb_sent+i];
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			if (sock->flags & GF_SOCK_HAS_PEER) {
+				msgs[i].msg_hdr.msg_name = &sock->dest_addr;
+				msgs[i].msg_hdr.msg_namelen = sock->dest_addr_len;
+			}
+		}
+		res = sendmmsg(sock->socket, msgs, count, 0);
+		if (res == SOCKET_ERROR) {
+			switch (LASTSOCKERROR) {
+			case ENOSYS:
+				if (nb_sent) return GF_IP_NETWORK_FAILURE;
+				GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[socket] sendmmsg not supported, using single datagram emission\n"));
+				sendmmsg_unavailable = GF_TRUE;
+				return GF_NOT_SUPPORTED;
+			case EAGAIN:
+				return GF_IP_SOCK_WOULD_BLOCK;
+			default:
+				return GF_IP_NETWORK_FAILURE;
+			}
+		}
+		nb_sent += res;
+	}
+	return GF_OK;
+}
+#endif
+
+GF_EXPORT
+GF_Err gf_sk_send_batch(GF_Socket *sock, const char **buffers, const u32 *sizes, u32 nb_buffers)
+{
+	GF_Err e;
+	u32 i;
+
+	if (!sock || !sock->socket || !buffers || !sizes) return GF_BAD_PARAM;
+	if (!nb_buffers) return GF_OK;
+
+	if (!(sock->flags & GF_SOCK_IS_TCP)) {
+#if defined(GPAC_HAS_SENDMMSG) && defined(UDP_SEGMENT)
+		i = 0;
+		while (!udp_gso_unavailable && (i<nb_buffers)) {
+			u32 j, total = sizes[i];
+			//gather datagrams of the same size, the last one of the run may be shorter
+			for (j=i+1; (j<nb_buffers) && (j-i < GF_SK_MAX_GSO_SEGMENTS); j++) {
+				if ((sizes[j] > sizes[i]) || (total + sizes[j] > GF_SK_MAX_GSO_SIZE)) break;
+				total += sizes[j];
+				if (sizes[j] < sizes[i]) {
+					j++;
+					break;
+				}
+			}
+			e = GF_NOT_SUPPORTED;
+			if (j-i > 1) e = gf_sk_send_gso(sock, buffers+i, sizes+i, j-i);
+			else j = i+1;
+
+			if (e == GF_NOT_SUPPORTED) {
+				if (udp_gso_unavailable) break;
+				for (; i<j; i++) {
+					e = gf_sk_send(sock, buffers[i], sizes[i]);
+					if (e) return e;
+				}
+			} else if (e) {
+				return e;
+			}
+			i = j;
+		}
+		if (i==nb_buffers) return GF_OK;
+		buffers += i;
+		sizes += i;
+		nb_buffers -= i;
+#endif
+
+#ifdef GPAC_HAS_SENDMMSG
+		if (!sendmmsg_unavailable) {
+			e = gf_sk_send_mmsg(sock, buffers, sizes, nb_buffers);
+			if (e != GF_NOT_SUPPORTED) return e;
+		}
+#endif
+	}
+
+	for (i=0; i<nb_buffers; i++) {
+		e = gf_sk_send(sock, buffers[i], sizes[i]);
+		if (e) return e;
+	}
+	return GF_OK;
+}
+
 
 GF_EXPORT
 u32 gf_sk_is_multicast_address(const char *multi_IPAdd)
@@ -1168,36 +1400,190 @@ struct __tag_sock_group
 {
 	GF_List *sockets;
 	fd_set group;
+#ifdef GPAC_HAS_EPOLL
+	/*epoll set in edge-triggered mode, -1 if not available*/
+	int epoll_fd;
+	/*sockets reported readable by epoll and still readable at the last select*/
+	GF_List *ready;
+	/*registered sockets not yet in the epoll set, because not opened yet or reopened since registration*/
+	GF_List *pending;
+	struct epoll_event events[GF_SK_GROUP_MAX_EVENTS];
+	struct pollfd *ready_fds;
+	u32 ready_fds_alloc;
+#endif
 };
 
+GF_EXPORT
 GF_SockGroup *gf_sk_group_new()
 {
 	GF_SockGroup *tmp;
 	GF_SAFEALLOC(tmp, GF_SockGroup);
 	tmp->sockets = gf_list_new();
 	FD_ZERO(&tmp->group);
+#ifdef GPAC_HAS_EPOLL
+	tmp->ready = gf_list_new();
+	tmp->pending = gf_list_new();
+	tmp->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (tmp->epoll_fd < 0) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] cannot create epoll set (error %d), using select for socket group\n", LASTSOCKERROR));
+	}
+#endif
 	return tmp;
 }
 
+GF_EXPORT
 void gf_sk_group_del(GF_SockGroup *sg)
 {
+	GF_Socket *sk;
+	u32 i=0;
+	while ((sk = gf_list_enum(sg->sockets, &i))) {
+		sk->group = NULL;
+		sk->flags &= ~(GF_SOCK_IN_EPOLL | GF_SOCK_IS_READY);
+	}
 	gf_list_del(sg->sockets);
+#ifdef GPAC_HAS_EPOLL
+	if (sg->epoll_fd >= 0) close(sg->epoll_fd);
+	gf_list_del(sg->ready);
+	gf_list_del(sg->pending);
+	if (sg->ready_fds) gf_free(sg->ready_fds);
+#endif
 	gf_free(sg);
 }
 
+#ifdef GPAC_HAS_EPOLL
+static Bool gf_sk_group_epoll_add(GF_SockGroup *sg, GF_Socket *sk)
+{
+	struct epoll_event ev;
+	if (!sk->socket) return GF_FALSE;
+	memset(&ev, 0, sizeof(struct epoll_event));
+	ev.events = EPOLLIN | EPOLLET;
+	ev.data.ptr = sk;
+	if (epoll_ctl(sg->epoll_fd, EPOLL_CTL_ADD, sk->socket, &ev) < 0) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] cannot add socket to epoll set (error %d)\n", LASTSOCKERROR));
+		return GF_FALSE;
+	}
+	sk->flags |= GF_SOCK_IN_EPOLL;
+	return GF_TRUE;
+}
+
+static void gf_sk_group_epoll_remove(GF_SockGroup *sg, GF_Socket *sk)
+{
+	if (sk->flags & GF_SOCK_IN_EPOLL) {
+		epoll_ctl(sg->epoll_fd, EPOLL_CTL_DEL, sk->socket, NULL);
+	} else {
+		gf_list_del_item(sg->pending, sk);
+	}
+	if (sk->flags & GF_SOCK_IS_READY) gf_list_del_item(sg->ready, sk);
+	sk->flags &= ~(GF_SOCK_IN_EPOLL | GF_SOCK_IS_READY);
+}
+#endif
+
+//the descriptor of the socket is about to be closed, it will be added back to the epoll set once reopened
+static void gf_sk_group_socket_closed(GF_Socket *sock)
+{
+#ifdef GPAC_HAS_EPOLL
+	GF_SockGroup *sg = sock->group;
+	if (sg->epoll_fd < 0) return;
+	gf_sk_group_epoll_remove(sg, sock);
+	gf_list_add(sg->pending, sock);
+#endif
+}
+
+GF_EXPORT
 void gf_sk_group_register(GF_SockGroup *sg, GF_Socket *sk)
 {
 	if (sg && sk) {
+		if (sk->group == sg) return;
+		if (sk->group) gf_sk_group_unregister(sk->group, sk);
+		sk->group = sg;
 		gf_list_add(sg->sockets, sk);
+#ifdef GPAC_HAS_EPOLL
+		if ((sg->epoll_fd >= 0) && !gf_sk_group_epoll_add(sg, sk))
+			gf_list_add(sg->pending, sk);
+#endif
 	}
 }
+
+GF_EXPORT
 void gf_sk_group_unregister(GF_SockGroup *sg, GF_Socket *sk)
 {
-	if (sg && sk) {
+	if (sg && sk && (sk->group == sg)) {
 		gf_list_del_item(sg->sockets, sk);
+#ifdef GPAC_HAS_EPOLL
+		if (sg->epoll_fd >= 0) gf_sk_group_epoll_remove(sg, sk);
+#endif
+		sk->group = NULL;
+	}
+}
+
+#ifdef GPAC_HAS_EPOLL
+//epoll only reports sockets becoming readable: sockets reported earlier stay in the ready list as long as they are readable
+static GF_Err gf_sk_group_epoll_wait(GF_SockGroup *sg, u32 usec_wait)
+{
+	s32 i, nb_ready;
+	u32 count;
+	GF_Socket *sk;
+
+	//add sockets opened since their registration
+	for (i=0; i<(s32) gf_list_count(sg->pending); i++) {
+		sk = gf_list_get(sg->pending, i);
+		if (gf_sk_group_epoll_add(sg, sk)) {
+			gf_list_rem(sg->pending, i);
+			i--;
+		}
+	}
+
+	//drop sockets drained since the last call
+	count = gf_list_count(sg->ready);
+	if (count) {
+		if (count > sg->ready_fds_alloc) {
+			sg->ready_fds_alloc = count;
+			sg->ready_fds = gf_realloc(sg->ready_fds, sizeof(struct pollfd) * sg->ready_fds_alloc);
+		}
+		for (i=0; i<(s32) count; i++) {
+			sk = gf_list_get(sg->ready, i);
+			sg->ready_fds[i].fd = sk->socket;
+			sg->ready_fds[i].events = POLLIN;
+			sg->ready_fds[i].revents = 0;
+		}
+		if (poll(sg->ready_fds, count, 0) < 0) {
+			for (i=0; i<(s32) count; i++) sg->ready_fds[i].revents = POLLIN;
+		}
+		for (i=(s32) count-1; i>=0; i--) {
+			if (sg->ready_fds[i].revents) continue;
+			sk = gf_list_get(sg->ready, i);
+			sk->flags &= ~GF_SOCK_IS_READY;
+			gf_list_rem(sg->ready, i);
+		}
+	}
+
+	nb_ready = epoll_wait(sg->epoll_fd, sg->events, GF_SK_GROUP_MAX_EVENTS, gf_list_count(sg->ready) ? 0 : (s32) ((usec_wait+999) / 1000));
+	if (nb_ready < 0) {
+		switch (LASTSOCKERROR) {
+		case EINTR:
+			GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] network is lost\n"));
+			break;
+		default:
+			GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] cannot wait on epoll set (error %d)\n", LASTSOCKERROR));
+			return GF_IP_NETWORK_FAILURE;
+		}
+		nb_ready = 0;
+	}
+	for (i=0; i<nb_ready; i++) {
+		sk = (GF_Socket *) sg->events[i].data.ptr;
+		if (sk->flags & GF_SOCK_IS_READY) continue;
+		sk->flags |= GF_SOCK_IS_READY;
+		gf_list_add(sg->ready, sk);
 	}
+	if (!gf_list_count(sg->ready)) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_NETWORK, ("[socket] nothing to be read on socket group\n"));
+		return GF_IP_NETWORK_EMPTY;
+	}
+	return GF_OK;
 }
+#endif
 
+GF_EXPORT
 GF_Err gf_sk_group_select(GF_SockGroup *sg, u32 usec_wait)
 {
 	s32 ready;
@@ -1206,6 +1592,10 @@ GF_Err gf_sk_group_select(GF_SockGroup *sg, u32 usec_wait)
 	u32 max_fd=0;
 	GF_Socket *sock;
 
+#ifdef GPAC_HAS_EPOLL
+	if (sg->epoll_fd >= 0) return gf_sk_group_epoll_wait(sg, usec_wait);
+#endif
+
 	FD_ZERO(&sg->group);
 	while ((sock = gf_list_enum(sg->sockets, &i))) {
 		FD_SET(sock->socket, &sg->group);
@@ -1243,24 +1633,72 @@ GF_Err gf_sk_group_select(GF_SockGroup *sg, u32 usec_wait)
 	return GF_OK;
 }
 
+GF_EXPORT
 Bool gf_sk_group_sock_is_set(GF_SockGroup *sg, GF_Socket *sk)
 {
-	if (sg && sk && FD_ISSET(sk->socket, &sg->group)) return GF_TRUE;
+	if (!sg || !sk) return GF_FALSE;
+#ifdef GPAC_HAS_EPOLL
+	if (sg->epoll_fd >= 0) return ((sk->group == sg) && (sk->flags & GF_SOCK_IS_READY)) ? GF_TRUE : GF_FALSE;
+#endif
+	if (FD_ISSET(sk->socket, &sg->group)) return GF_TRUE;
 	return GF_FALSE;
 }
 
 
+#ifndef __SYMBIAN32__
+//waits at most usec_wait for the socket to be readable
+static GF_Err gf_sk_wait_readable(GF_Socket *sock)
+{
+	s32 ready;
+#ifdef GPAC_HAS_POLL
+	//can we read?
+	ready = gf_sk_poll(sock, GF_FALSE);
+#else
+	struct timeval timeout;
+	fd_set Group;
+
+	//can we read?
+	timeout.tv_sec = 0;
+	timeout.tv_usec = sock->usec_wait;
+	FD_ZERO(&Group);
+	FD_SET(sock->socket, &Group);
+	ready = select((int) sock->socket+1, &Group, NULL, NULL, &timeout);
+#endif
+
+	if (ready == SOCKET_ERROR) {
+		switch (LASTSOCKERROR) {
+		case EBADF:
+			GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] cannot select, BAD descriptor\n"));
+			return GF_IP_CONNECTION_CLOSED;
+		case EAGAIN:
+			return GF_IP_SOCK_WOULD_BLOCK;
+		case EINTR:
+			/* Interrupted system call, not really important... */
+			GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] network is lost\n"));
+			return GF_IP_NETWORK_EMPTY;
+		default:
+			GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] cannot select (error %d)\n", LASTSOCKERROR));
+			return GF_IP_NETWORK_FAILURE;
+		}
+	}
+#ifdef GPAC_HAS_POLL
+	if (!ready) {
+#else
+	if (!ready || !FD_ISSET(sock->socket, &Group)) {
+#endif
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_NETWORK, ("[socket] nothing to be read - ready %d\n", ready));
+		return GF_IP_NETWORK_EMPTY;
+	}
+	return GF_OK;
+}
+#endif
+
 //fetch nb bytes on a socket and fill the buffer from startFrom
 //length is the allocated size of the receiving buffer
 //BytesRead is the number of bytes read from the network
 GF_Err gf_sk_receive_internal(GF_Socket *sock, char *buffer, u32 length, u32 startFrom, u32 *BytesRead, Bool do_select)
 {
 	s32 res;
-#ifndef __SYMBIAN32__
-	s32 ready;
-	struct timeval timeout;
-	fd_set Group;
-#endif
 
 	*BytesRead = 0;
 	if (!sock || !sock->socket) return GF_BAD_PARAM;
@@ -1268,33 +1706,8 @@ GF_Err gf_sk_receive_internal(GF_Socket *sock, char *buffer, u32 length, u32 sta
 
 #ifndef __SYMBIAN32__
 	if (do_select) {
-		//can we read?
-		timeout.tv_sec = 0;
-		timeout.tv_usec = sock->usec_wait;
-		FD_ZERO(&Group);
-		FD_SET(sock->socket, &Group);
-		ready = select((int) sock->socket+1, &Group, NULL, NULL, &timeout);
-
-		if (ready == SOCKET_ERROR) {
-			switch (LASTSOCKERROR) {
-			case EBADF:
-				GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] cannot select, BAD descriptor\n"));
-				return GF_IP_CONNECTION_CLOSED;
-			case EAGAIN:
-				return GF_IP_SOCK_WOULD_BLOCK;
-			case EINTR:
-				/* Interrupted system call, not really important... */
-				GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] network is lost\n"));
-				return GF_IP_NETWORK_EMPTY;
-			default:
-				GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] cannot select (error %d)\n", LASTSOCKERROR));
-				return GF_IP_NETWORK_FAILURE;
-			}
-		}
-		if (!ready || !FD_ISSET(sock->socket, &Group)) {
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_NETWORK, ("[socket] nothing to be read - ready %d\n", ready));
-			return GF_IP_NETWORK_EMPTY;
-		}
+		GF_Err e = gf_sk_wait_readable(sock);
+		if (e) return e;
 	}
 #endif
 	if (sock->flags & GF_SOCK_HAS_PEER)
@@ -1346,6 +1759,134 @@ GF_Err gf_sk_receive_no_select(GF_Socket *sock, char *buffer, u32 length, u32 st
 	return gf_sk_receive_internal(sock, buffer, length, startFrom, BytesRead, GF_FALSE);
 }
 
+#ifdef GPAC_HAS_RECVMMSG
+static Bool recvmmsg_unavailable = GF_FALSE;
+
+static GF_Err gf_sk_receive_mmsg(GF_Socket *sock, char **buffers, u32 buffer_size, u32 *sizes, u64 *ntp_times, u32 nb_buffers, u32 *nb_read)
+{
+	s32 i, res, count;
+	GF_Err e;
+	struct mmsghdr msgs[GF_SK_MAX_BATCH];
+	struct iovec iovs[GF_SK_MAX_BATCH];
+	char ctrl[GF_SK_MAX_BATCH][CMSG_SPACE(sizeof(struct timeval))];
+	struct timeval now;
+	u64 now_ntp;
+
+	if (nb_buffers > GF_SK_MAX_BATCH) nb_buffers = GF_SK_MAX_BATCH;
+
+	e = gf_sk_wait_readable(sock);
+	if (e) return e;
+
+	if (ntp_times && !(sock->flags & GF_SOCK_HAS_TIMESTAMP)) {
+		int on = 1;
+		if (setsockopt(sock->socket, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on)) == SOCKET_ERROR) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[socket] kernel timestamps not available (error %d)\n", LASTSOCKERROR));
+		}
+		sock->flags |= GF_SOCK_HAS_TIMESTAMP;
+	}
+
+	memset(msgs, 0, sizeof(struct mmsghdr) * nb_buffers);
+	for (i=0; i<(s32) nb_buffers; i++) {
+		iovs[i].iov_base = buffers[i];
+		iovs[i].iov_len = buffer_size;
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		if (ntp_times) {
+			msgs[i].msg_hdr.msg_control = ctrl[i];
+			msgs[i].msg_hdr.msg_controllen = sizeof(ctrl[i]);
+		}
+		//all peer addresses go to the same place, the last one is kept as with recvfrom
+		if (sock->flags & GF_SOCK_HAS_PEER) {
+			msgs[i].msg_hdr.msg_name = &sock->dest_addr;
+			msgs[i].msg_hdr.msg_namelen = sizeof(sock->dest_addr);
+		}
+	}
+	res = recvmmsg(sock->socket, msgs, nb_buffers, MSG_DONTWAIT, NULL);
+	if (res == SOCKET_ERROR) {
+		switch (LASTSOCKERROR) {
+		case ENOSYS:
+			GF_LOG(GF_LOG_INFO, GF_LOG_NETWORK, ("[socket] recvmmsg not supported, using single datagram reception\n"));
+			recvmmsg_unavailable = GF_TRUE;
+			return GF_NOT_SUPPORTED;
+		case EAGAIN:
+			return GF_IP_SOCK_WOULD_BLOCK;
+		case EINTR:
+			return GF_IP_NETWORK_EMPTY;
+		default:
+			GF_LOG(GF_LOG_ERROR, GF_LOG_NETWORK, ("[socket] error reading - socket error %d\n", LASTSOCKERROR));
+			return GF_IP_NETWORK_FAILURE;
+		}
+	}
+	if (!res) return GF_IP_NETWORK_EMPTY;
+
+	if (ntp_times) {
+		gettimeofday(&now, NULL);
+		now_ntp = gf_net_get_ntp_ts();
+	}
+	count = 0;
+	for (i=0; i<res; i++) {
+		//truncated datagrams are dropped, the packet is incomplete
+		if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_NETWORK, ("[socket] datagram larger than %d bytes, dropping\n", buffer_size));
+			continue;
+		}
+		//move the datagram to the first free buffer
+		if (count != i) memcpy(buffers[count], buffers[i], msgs[i].msg_len);
+		sizes[count] = msgs[i].msg_len;
+		if (ntp_times) {
+			struct cmsghdr *cmsg;
+			ntp_times[count] = now_ntp;
+			for (cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+				struct timeval tv;
+				s64 age;
+				if ((cmsg->cmsg_level != SOL_SOCKET) || (cmsg->cmsg_type != SCM_TIMESTAMP)) continue;
+				memcpy(&tv, CMSG_DATA(cmsg), sizeof(struct timeval));
+				//kernel time is in UTC, shift the current NTP time by the packet age to respect the NTP shift in use
+				age = ((s64) now.tv_sec - tv.tv_sec) * 1000000 + ((s64) now.tv_usec - tv.tv_usec);
+				if (age>0) ntp_times[count] -= (((u64) age) << 32) / 1000000;
+				break;
+			}
+		}
+		count++;
+	}
+	if (sock->flags & GF_SOCK_HAS_PEER)
+		sock->dest_addr_len = msgs[res-1].msg_hdr.msg_namelen;
+
+	*nb_read = count;
+	return count ? GF_OK : GF_IP_NETWORK_EMPTY;
+}
+#endif
+
+GF_EXPORT
+GF_Err gf_sk_receive_batch(GF_Socket *sock, char **buffers, u32 buffer_size, u32 *sizes, u64 *ntp_times, u32 nb_buffers, u32 *nb_read)
+{
+	GF_Err e = GF_OK;
+	u32 i, usec_wait;
+
+	*nb_read = 0;
+	if (!sock || !sock->socket || !buffers || !sizes || !nb_buffers) return GF_BAD_PARAM;
+	if (sock->flags & GF_SOCK_IS_TCP) return GF_BAD_PARAM;
+
+#ifdef GPAC_HAS_RECVMMSG
+	if (!recvmmsg_unavailable) {
+		e = gf_sk_receive_mmsg(sock, buffers, buffer_size, sizes, ntp_times, nb_buffers, nb_read);
+		if (e != GF_NOT_SUPPORTED) return e;
+	}
+#endif
+
+	//only wait for the first datagram
+	usec_wait = sock->usec_wait;
+	for (i=0; i<nb_buffers; i++) {
+		e = gf_sk_receive_internal(sock, buffers[i], buffer_size, 0, &sizes[i], GF_TRUE);
+		sock->usec_wait = 0;
+		if (e) break;
+		if (ntp_times) ntp_times[i] = gf_net_get_ntp_ts();
+		(*nb_read)++;
+	}
+	sock->usec_wait = usec_wait;
+	return *nb_read ? GF_OK : e;
+}
+
 GF_EXPORT
 GF_Err gf_sk_listen(GF_Socket *sock, u32 MaxConnection)
 {
@@ -1365,14 +1906,19 @@ GF_Err gf_sk_accept(GF_Socket *sock, GF_Socket **newConnection)
 	SOCKET sk;
 #ifndef __SYMBIAN32__
 	s32 ready;
+#ifndef GPAC_HAS_POLL
 	struct timeval timeout;
 	fd_set Group;
+#endif
 #endif
 	*newConnection = NULL;
 	if (!sock || !(sock->flags & GF_SOCK_IS_LISTENING) ) return GF_BAD_PARAM;
 
 #ifndef __SYMBIAN32__
 	//can we read?
+#ifdef GPAC_HAS_POLL
+	ready = gf_sk_poll(sock, GF_FALSE);
+#else
 	FD_ZERO(&Group);
 	FD_SET(sock->socket, &Group);
 	timeout.tv_sec = 0;
@@ -1380,6 +1926,7 @@ GF_Err gf_sk_accept(GF_Socket *sock, GF_Socket **newConnection)
 
 	//TODO - check if this is correct
 	ready = select((int) sock->socket+1, &Group, NULL, NULL, &timeout);
+#endif
 	if (ready == SOCKET_ERROR) {
 		switch (LASTSOCKERROR) {
 		case EAGAIN:
@@ -1388,8 +1935,12 @@ GF_Err gf_sk_accept(GF_Socket *sock, GF_Socket **newConnection)
 			return GF_IP_NETWORK_FAILURE;
 		}
 	}
+#ifdef GPAC_HAS_POLL
+	if (!ready) return GF_IP_NETWORK_EMPTY;
+#else
 	if (!ready || !FD_ISSET(sock->socket, &Group)) return GF_IP_NETWORK_EMPTY;
 #endif
+#endif
 
 #ifdef GPAC_HAS_IPV6
 	client_address_size = sizeof(struct sockaddr_in6);